@@ -29,6 +29,7 @@ typedef enum {
     CRYPTOMODULE_OK = 0,
     CRYPTOMODULE_ERR_INVALID_INPUT,
     CRYPTOMODULE_ERR_CRYPTO_FAILURE,
+    CRYPTOMODULE_ERR_OUT_OF_MEMORY,
     /* ... */
 } cryptomodule_status_t;
 
@@ -56,6 +57,9 @@ typedef struct {
 
 /* Core Header */
 #include "cryptomodule_utils.h"
+#include "cryptomodule_cpu.h"
+#include "cryptomodule_alloc.h"
+#include "cryptomodule_secure.h"
 #include "cryptomodule_test.h"
 
 /* Block ciphers */
@@ -70,20 +74,29 @@ typedef struct {
 #include "mode/mode_cbc.h"
 #include "mode/mode_ctr.h"
 #include "mode/mode_gcm.h"
+#include "mode/mode_xts.h"
+#include "mode/mode_ccm.h"
+#include "mode/mode_gcm_siv.h"
+#include "mode/mode_kw.h"
 
 /* RNG */
-// #include "ctr_drbg.h"
+#include "rng/drbg.h"
+#include "rng/ctr_drbg.h"
+#include "rng/hmac_drbg.h"
+#include "rng/hash_drbg.h"
 
 /* Hash functions */
-// #include "sha2.h"
-// #include "sha3.h"
-// #include "lsh.h"
+#include "sha/sha2.h"
+#include "sha/sha3.h"
+#include "lsh/lsh.h"
 
 /* MAC */
-// #include "hmac.h"
+#include "mac/cmac.h"
+#include "mac/hmac.h"
 
 /* KDF */
-// #include "pbkdf.h"
+#include "kdf/pbkdf.h"
+#include "kdf/hkdf.h"
 
 /* Key Setup */
 // #include "ecdh.h"
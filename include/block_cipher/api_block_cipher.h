@@ -84,6 +84,46 @@ static inline const char *block_cipher_type_to_string(BlockCipherType type) {
     }
 }
 
+#define BLOCK_CIPHER_TYPE_COUNT 9   /* Number of known BlockCipherType values (UNKNOWN excluded) */
+
+/**
+ * @brief Dense index (0 .. BLOCK_CIPHER_TYPE_COUNT - 1) of a BlockCipherType, for lookup tables.
+ * @param type The BlockCipherType value.
+ * @return The index, or -1 for BLOCK_CIPHER_UNKNOWN and values that are not cipher types.
+ */
+static inline int block_cipher_type_index(BlockCipherType type) {
+    switch (type) {
+        case BLOCK_CIPHER_AES128:   return 0;
+        case BLOCK_CIPHER_AES192:   return 1;
+        case BLOCK_CIPHER_AES256:   return 2;
+        case BLOCK_CIPHER_ARIA128:  return 3;
+        case BLOCK_CIPHER_ARIA192:  return 4;
+        case BLOCK_CIPHER_ARIA256:  return 5;
+        case BLOCK_CIPHER_LEA128:   return 6;
+        case BLOCK_CIPHER_LEA192:   return 7;
+        case BLOCK_CIPHER_LEA256:   return 8;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Key size in bytes of a BlockCipherType (16, 24 or 32), or 0 for an unknown type.
+ */
+static inline size_t block_cipher_key_size(BlockCipherType type) {
+    int index = block_cipher_type_index(type);
+    return index < 0 ? 0 : (size_t)(16 + 8 * (index % 3));
+}
+
+/**
+ * @brief Name of the cipher family of a BlockCipherType (e.g., "AES" for BLOCK_CIPHER_AES256).
+ * @return The family name, as accepted by block_cipher_factory, or "UNKNOWN".
+ */
+static inline const char *block_cipher_family_name(BlockCipherType type) {
+    static const char *const names[] = { "AES", "ARIA", "LEA" };
+    int index = block_cipher_type_index(type);
+    return index < 0 ? "UNKNOWN" : names[index / 3];
+}
+
 /**
  * @brief Block cipher direction enumeration.
  * @details This enumeration defines the direction of the block cipher operation.
@@ -165,6 +205,25 @@ typedef struct __BlockCipherApi__ {
         u8* out, 
         BlockCipherDirection dir);
 
+    /**
+     * @brief Process several independent blocks in one call (optional).
+     * @param cipher_ctx Pointer to the context.
+     * @param in Pointer to num_blocks contiguous input blocks.
+     * @param out Pointer to the buffer for num_blocks contiguous output blocks.
+     * @param num_blocks Number of blocks to process.
+     * @param dir Direction of the cipher (ENCRYPTION_MODE or DECRYPTION_MODE).
+     * @return Status of the operation (BLOCK_CIPHER_OK or error code).
+     * @details Ciphers that can interleave the rounds of several blocks provide this entry
+     *          so that parallel modes (ECB, CTR, ...) are not bound by single-block latency.
+     *          It may be NULL; use block_cipher_process_blocks() which falls back to cipher_process.
+     */
+    block_cipher_status_t (*cipher_process_blocks)(
+        BlockCipherContext* cipher_ctx, 
+        const u8* in, 
+        u8* out, 
+        size_t num_blocks, 
+        BlockCipherDirection dir);
+
     /**
      * @brief Dispose of the block cipher context.
      * @param cipher_ctx Pointer to the context to be disposed of.
@@ -224,14 +283,121 @@ static inline void clear_block_cipher_ctx(BlockCipherContext *cipher_ctx) {
     if (cipher_ctx) memset(cipher_ctx, 0, sizeof(*cipher_ctx));
 }
 
+/**
+ * @brief Process num_blocks contiguous blocks with the cipher bound to the context.
+ * @param cipher_ctx Pointer to an initialized context.
+ * @param in Pointer to the input blocks.
+ * @param out Pointer to the output blocks (may alias in).
+ * @param num_blocks Number of blocks to process.
+ * @param dir Direction of the cipher.
+ * @return Status of the operation (BLOCK_CIPHER_OK or error code).
+ * @details Uses the cipher's multi-block entry when available and falls back to one
+ *          cipher_process call per block otherwise.
+ */
+static inline block_cipher_status_t block_cipher_process_blocks(
+    BlockCipherContext *cipher_ctx, const u8 *in, u8 *out, size_t num_blocks, BlockCipherDirection dir) {
+    if (!cipher_ctx || !cipher_ctx->cipher_api) return BLOCK_CIPHER_INVALID_PARAMETER;
+    if (cipher_ctx->cipher_api->cipher_process_blocks) {
+        return cipher_ctx->cipher_api->cipher_process_blocks(cipher_ctx, in, out, num_blocks, dir);
+    }
+    for (size_t i = 0; i < num_blocks; i++) {
+        block_cipher_status_t status = cipher_ctx->cipher_api->cipher_process(
+            cipher_ctx, in + i * BLOCK_SIZE, out + i * BLOCK_SIZE, dir);
+        if (status != BLOCK_CIPHER_OK) return status;
+    }
+    return BLOCK_CIPHER_OK;
+}
+
+/**
+ * @brief Allocate a zeroed context bound to cipher_api with cryptomodule_alloc().
+ * @return The context (cipher_init still has to be called), or NULL if memory is exhausted.
+ */
+BlockCipherContext *block_cipher_ctx_new(const BlockCipherApi *cipher_api);
+
+/**
+ * @brief Dispose of a context of block_cipher_ctx_new() (cipher_dispose, then a wipe) and release it.
+ * @param cipher_ctx The context; NULL is ignored.
+ */
+void block_cipher_ctx_free(BlockCipherContext *cipher_ctx);
+
+/**
+ * @brief Get the block cipher API specialized for a BlockCipherType.
+ * @param type The block cipher type (e.g., BLOCK_CIPHER_AES128).
+ * @return Pointer to the BlockCipherApi for the type, or NULL if unknown.
+ * @details This is a lookup in a table indexed by block_cipher_type_index(), meant to be done
+ *          once (e.g., when a configuration is loaded) and kept. The returned API is fixed to the
+ *          key size of the type: its cipher_init rejects other key lengths, and its process
+ *          functions run the round count of the type without looking it up per block. Ciphers
+ *          without a specialized implementation return their family API.
+ */
+const BlockCipherApi *block_cipher_get_api(BlockCipherType type);
+
+/**
+ * @brief Get the block cipher API for a key of key_len bytes.
+ * @param type The block cipher type (e.g., BLOCK_CIPHER_AES128).
+ * @param key_len Length of the key that will be passed to cipher_init.
+ * @return The specialized API of block_cipher_get_api() if key_len is the key size of the type,
+ *         the family API of block_cipher_factory_by_type() otherwise, or NULL if unknown.
+ * @details Modes use it so that a context whose type and key length disagree keeps working.
+ */
+const BlockCipherApi *block_cipher_resolve(BlockCipherType type, size_t key_len);
+
+/**
+ * @brief Fused CTR kernel: XOR num_blocks blocks of in with the keystream E(counter), E(counter + 1), ...
+ * @details The counter is a 128-bit big-endian block and is left at the next unused value; in and
+ *          out may alias. The context must hold an encryption key schedule.
+ */
+typedef void (*block_cipher_ctr_kernel)(
+    BlockCipherContext *cipher_ctx, u8 counter[BLOCK_SIZE], const u8 *in, u8 *out, size_t num_blocks);
+
+/**
+ * @brief Fused CBC kernel: encrypt or decrypt num_blocks blocks chained from iv.
+ * @details iv is updated to the last ciphertext block, so consecutive calls continue the chain;
+ *          in and out may alias. The context must hold the key schedule of the kernel's direction.
+ */
+typedef void (*block_cipher_cbc_kernel)(
+    BlockCipherContext *cipher_ctx, u8 iv[BLOCK_SIZE], const u8 *in, u8 *out, size_t num_blocks);
+
+/**
+ * @brief The fused cipher+mode kernels of one cipher type.
+ * @details Each kernel runs the bulk loop of a mode with the rounds of the cipher inlined and the
+ *          round count fixed, so a mode selects one when it is initialized and keeps it as a single
+ *          function pointer: the per-block work then has no vtable load and no branch on the direction.
+ */
+typedef struct __BlockCipherModeKernels__ {
+    block_cipher_ctr_kernel ctr;            // CTR (both directions)
+    block_cipher_cbc_kernel cbc_encrypt;    // CBC encryption (serial)
+    block_cipher_cbc_kernel cbc_decrypt;    // CBC decryption (blocks decrypted in parallel)
+} BlockCipherModeKernels;
+
+/**
+ * @brief Get the fused mode kernels for a context set up with block_cipher_resolve(type, key_len).
+ * @param type The block cipher type (e.g., BLOCK_CIPHER_AES256).
+ * @param key_len Length of the key passed to cipher_init.
+ * @return The kernels of the type, or NULL if the type has none or key_len is not its key size; the
+ *         mode then keeps a generic kernel that goes through the cipher API.
+ */
+const BlockCipherModeKernels *block_cipher_get_mode_kernels(BlockCipherType type, size_t key_len);
+
 /**
  * @brief Factory function to create a block cipher API.
- * @param name Name of the cipher (e.g., "AES").
+ * @param name Name of the cipher family (e.g., "AES") or of a type (e.g., "AES-128").
  * @return Pointer to the BlockCipherApi structure for the specified cipher, or NULL if not found.
- * @details This function is used to create a block cipher API based on the specified name.
+ * @details A family name returns the family API, which takes any of its key sizes; a type name,
+ *          as printed by block_cipher_type_to_string(), returns block_cipher_get_api() of the type.
+ *          Kept for compatibility: callers that know the type should use the enum lookups.
  */
 const BlockCipherApi *block_cipher_factory(const char *cipher_name);
 
+/**
+ * @brief Factory function to get a block cipher API from a BlockCipherType.
+ * @param type The block cipher type (e.g., BLOCK_CIPHER_AES128).
+ * @return Pointer to the BlockCipherApi structure for the cipher family, or NULL if unknown.
+ * @details The key size carried by the type is not encoded in the returned API;
+ *          it is selected by the key length passed to cipher_init.
+ */
+const BlockCipherApi *block_cipher_factory_by_type(BlockCipherType type);
+
 /**
  * @brief Factory function to create a block cipher API.
  * @param name Name of the cipher (e.g., "AES").
@@ -11,11 +11,65 @@ extern "C" {
 /* Get the AES block cipher vtable. */
 const BlockCipherApi* get_aes_api(void);
 
+/* Get the AES vtables fixed to one key size (see block_cipher_get_api). */
+const BlockCipherApi* get_aes128_api(void);
+const BlockCipherApi* get_aes192_api(void);
+const BlockCipherApi* get_aes256_api(void);
+
+/* Get the fused CTR/CBC kernels of the vtables above (see block_cipher_get_mode_kernels). */
+const BlockCipherModeKernels* get_aes128_mode_kernels(void);
+const BlockCipherModeKernels* get_aes192_mode_kernels(void);
+const BlockCipherModeKernels* get_aes256_mode_kernels(void);
+
 void aes_set_encrypt_key(const u8 *key, size_t bytes, u32 *rk);
 void aes_set_decrypt_key(const u8 *key, size_t bytes, u32 *rk);
 void aes_encrypt(const u8 *in, u8 *out, const u32 *rk, int r);
 void aes_decrypt(const u8 *in, u8 *out, const u32 *rk, int r);
 
+/* Number of blocks whose rounds are interleaved by aes_encrypt_blocks/aes_decrypt_blocks. */
+#define AES_INTERLEAVE 4
+
+/* Process num_blocks contiguous blocks; in and out may alias. */
+void aes_encrypt_blocks(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r);
+void aes_decrypt_blocks(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r);
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AES_HAVE_X86 1      /* AES-NI batch backend (built with per-function target attributes) */
+#else
+#define AES_HAVE_X86 0
+#endif
+
+/*
+ * Key-agile batch: block i of in is encrypted under its own schedule rks[i] (aes_set_encrypt_key,
+ * r rounds for every schedule of the batch), so many single-block requests under different keys
+ * run as independent lanes instead of one latency-bound block after another. in and out may alias.
+ */
+void aes_encrypt_batch(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r);
+
+/* Implementations of aes_encrypt_batch. */
+typedef enum {
+    AES_BATCH_BACKEND_C = 0,        // T-table rounds of AES_INTERLEAVE lanes (always available)
+    AES_BATCH_BACKEND_BITSLICED,    // Constant-time bitsliced rounds of 4 lanes in 64-bit words
+    AES_BATCH_BACKEND_AESNI,        // AESENC on AES_NI_BATCH_LANES lanes
+} aes_batch_backend_t;
+
+#define AES_BITSLICED_LANES 4       /* Blocks per 64-bit bitsliced state */
+#define AES_NI_BATCH_LANES  8       /* Blocks in flight per AES-NI group */
+
+/* Select the fastest backend the CPU supports; called by cryptomodule_init (optional). */
+void aes_batch_init_dispatch(void);
+
+/* Force a backend; false, leaving the selection unchanged, if the CPU does not support it. */
+bool aes_batch_set_backend(aes_batch_backend_t backend);
+aes_batch_backend_t aes_batch_get_backend(void);
+
+/* The backends; only call the AES-NI one if the CPU has AES-NI and SSSE3. */
+void aes_encrypt_batch_c(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r);
+void aes_encrypt_batch_bitsliced(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r);
+#if AES_HAVE_X86
+void aes_encrypt_batch_aesni(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r);
+#endif
+
 #define GETU32(pt) (((u32)(pt)[0] << 24) ^ ((u32)(pt)[1] << 16) ^ ((u32)(pt)[2] <<  8) ^ ((u32)(pt)[3]))
 #define PUTU32(ct, st) { (ct)[0] = (u8)((st) >> 24); (ct)[1] = (u8)((st) >> 16); (ct)[2] = (u8)((st) >>  8); (ct)[3] = (u8)(st); }
 
@@ -0,0 +1,81 @@
+/* File: include/cryptomodule_alloc.h */
+
+#ifndef CRYPTOMODULE_ALLOC_H
+#define CRYPTOMODULE_ALLOC_H
+
+#include "api_cryptomodule.h"
+
+/**
+ * @file cryptomodule_alloc.h
+ * @brief Pooled allocation of cipher contexts, mode contexts and GHASH/POLYVAL tables.
+ * @details The modes allocate their contexts and tables with cryptomodule_alloc() instead of
+ *          malloc(). Requests of up to CRYPTOMODULE_POOL_MAX_SIZE bytes are served from power-of-two
+ *          size classes of 64 to 4096 bytes. The blocks are carved out of cache-line aligned slabs
+ *          and kept on per-thread free lists, so creating and destroying a context per connection
+ *          takes no lock and makes no system call once the pool is warm. Every block is wiped when
+ *          it is released, and handed out zeroed. Larger requests go to the system allocator.
+ *
+ *          An application can route every allocation of the module to its own allocator (an
+ *          arena, a locked region, ...) with cryptomodule_set_allocator().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRYPTOMODULE_CACHE_LINE     64      /* Alignment of every block returned by cryptomodule_alloc */
+#define CRYPTOMODULE_POOL_MAX_SIZE  4096    /* Largest request served from the size classes */
+
+/** An allocator supplied by the application. */
+typedef struct {
+    /** Return size bytes aligned to CRYPTOMODULE_CACHE_LINE, or NULL. They need not be zeroed. */
+    void *(*alloc)(void *opaque, size_t size);
+    /** Take back a block of alloc; the module has already wiped its size bytes. */
+    void (*release)(void *opaque, void *ptr, size_t size);
+    void *opaque;       // Passed to both functions
+} cryptomodule_allocator;
+
+/**
+ * @brief Allocate size zeroed bytes aligned to CRYPTOMODULE_CACHE_LINE.
+ * @return The block, or NULL if size is 0 or memory is exhausted.
+ */
+void *cryptomodule_alloc(size_t size);
+
+/**
+ * @brief Wipe and release a block of cryptomodule_alloc.
+ * @param ptr The block (NULL is ignored).
+ * @param size The size passed to cryptomodule_alloc; it selects the size class.
+ */
+void cryptomodule_free(void *ptr, size_t size);
+
+/**
+ * @brief Route the allocations of the module to an application allocator.
+ * @param allocator The allocator (copied), or NULL for the built-in pool.
+ * @return CRYPTOMODULE_OK, or CRYPTOMODULE_ERR_INVALID_INPUT if a function is missing or blocks of
+ *         the current allocator are still in use (they must be released to the allocator that made them).
+ * @details Like the backend selection, it must not run while other threads use the module.
+ */
+cryptomodule_status_t cryptomodule_set_allocator(const cryptomodule_allocator *allocator);
+
+/**
+ * @brief Zero len bytes in a way the compiler does not optimize away.
+ * @details For key schedules, tables and buffers that are freed or go out of scope right after:
+ *          a plain memset of memory that is not read again may be removed as a dead store.
+ */
+void cryptomodule_wipe(void *p, size_t len);
+
+/** @brief The number of blocks allocated and not yet released. */
+size_t cryptomodule_alloc_live(void);
+
+/**
+ * @brief Release the calling thread's cached blocks to the shared lists of the pool.
+ * @details Threads do this when they exit; a thread that goes idle for a long time may call it
+ *          so that other threads can reuse its blocks. The slabs themselves stay with the process.
+ */
+void cryptomodule_pool_flush_thread(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRYPTOMODULE_ALLOC_H */
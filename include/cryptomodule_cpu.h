@@ -0,0 +1,122 @@
+/* File: include/cryptomodule_cpu.h */
+
+#ifndef CRYPTOMODULE_CPU_H
+#define CRYPTOMODULE_CPU_H
+
+#include "api_cryptomodule.h"
+
+/**
+ * @file cryptomodule_cpu.h
+ * @brief CPU feature detection and the registry of accelerated backends.
+ * @details CPUID (and XGETBV for the register state the OS saves) is executed once per process;
+ *          every backend check of the module reads the cached feature word. Features can be
+ *          masked, as if the CPU lacked them, with the CRYPTOMODULE_CPU_DISABLE environment
+ *          variable (a comma-separated list of feature names, e.g. "avx512f,sha_ni") or with
+ *          cryptomodule_cpu_disable().
+ *
+ *          The registry lists each primitive that has more than one implementation together with
+ *          its backends and the features they need. cryptomodule_init() lets every primitive pick
+ *          its best backend and then applies the CRYPTOMODULE_BACKEND environment variable, a
+ *          comma-separated list of primitive=backend pairs (e.g. "sha256=c,lsh=sse2"), so that a
+ *          benchmark can be rerun against another backend without rebuilding. The same selection
+ *          is available at run time through cryptomodule_set_backend().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* CPU features (bits of cryptomodule_cpu_features()) */
+#define CRYPTOMODULE_CPU_SSE2           (1u << 0)
+#define CRYPTOMODULE_CPU_SSSE3          (1u << 1)
+#define CRYPTOMODULE_CPU_SSE41          (1u << 2)
+#define CRYPTOMODULE_CPU_AVX            (1u << 3)   /* With YMM state enabled by the OS */
+#define CRYPTOMODULE_CPU_AVX2           (1u << 4)
+#define CRYPTOMODULE_CPU_AVX512F        (1u << 5)   /* With opmask and ZMM state enabled by the OS */
+#define CRYPTOMODULE_CPU_AVX512BW       (1u << 6)
+#define CRYPTOMODULE_CPU_AESNI          (1u << 7)
+#define CRYPTOMODULE_CPU_PCLMUL         (1u << 8)
+#define CRYPTOMODULE_CPU_VAES           (1u << 9)   /* 256/512-bit AESENC (needs AVX) */
+#define CRYPTOMODULE_CPU_VPCLMULQDQ     (1u << 10)  /* 256/512-bit PCLMULQDQ (needs AVX) */
+#define CRYPTOMODULE_CPU_SHA_NI         (1u << 11)
+#define CRYPTOMODULE_CPU_GFNI           (1u << 12)
+
+#define CRYPTOMODULE_CPU_FEATURE_COUNT  13
+
+/**
+ * @brief The features of the CPU that are not masked.
+ * @details The first call runs CPUID and reads CRYPTOMODULE_CPU_DISABLE; later calls return the
+ *          cached value. It is safe to call from several threads.
+ */
+u32 cryptomodule_cpu_features(void);
+
+/** @brief Whether all the features in the mask are available (and not masked). */
+bool cryptomodule_cpu_has(u32 features);
+
+/** @brief The features reported by the CPU and the OS, before masking. */
+u32 cryptomodule_cpu_features_detected(void);
+
+/**
+ * @brief Mask features as if the CPU lacked them (replacing CRYPTOMODULE_CPU_DISABLE), then let
+ *        every registered primitive select its best backend again.
+ * @details Pass 0 to unmask everything. Like the set_backend functions, it must not run while
+ *          other threads use the module.
+ */
+void cryptomodule_cpu_disable(u32 features);
+
+/** @brief The lowercase name of a single feature bit (e.g. "avx2"), or NULL. */
+const char *cryptomodule_cpu_feature_name(u32 feature);
+
+/* ----------------------------------- Backend registry ---------------------------------- */
+
+/** One implementation of a primitive. */
+typedef struct {
+    const char *name;       // Name used by the overrides (e.g. "c", "sha_ni", "avx2")
+    int id;                 // Value of the primitive's backend enum
+    u32 features;           // CPU features the backend needs
+} cryptomodule_backend_desc;
+
+/** A primitive with several implementations and the functions that select between them. */
+typedef struct {
+    const char *name;                           // e.g. "sha256", "lsh"
+    const cryptomodule_backend_desc *backends;  // Portable C first
+    size_t num_backends;
+    bool (*set_backend)(int id);                // false if the backend is not available
+    int (*get_backend)(void);
+    void (*init_dispatch)(void);                // Select the best available backend
+} cryptomodule_dispatch_entry;
+
+/** @brief The registered primitives; *count receives their number. */
+const cryptomodule_dispatch_entry *cryptomodule_dispatch_table(size_t *count);
+
+/**
+ * @brief Force the backend of a primitive by name.
+ * @param primitive The primitive (e.g. "sha256"), or "all" for every primitive
+ * @param backend The backend (e.g. "c"), or "auto" for the best available one
+ * @return CRYPTOMODULE_OK, or CRYPTOMODULE_ERR_INVALID_INPUT, leaving the selection unchanged, if
+ *         a name is unknown or the backend is not available on this CPU. With "all", the
+ *         primitives that do not have the backend keep theirs and the call fails.
+ */
+cryptomodule_status_t cryptomodule_set_backend(const char *primitive, const char *backend);
+
+/** @brief The name of the backend a primitive currently uses, or NULL for an unknown primitive. */
+const char *cryptomodule_get_backend(const char *primitive);
+
+/**
+ * @brief Apply a list of primitive=backend pairs separated by commas (CRYPTOMODULE_BACKEND syntax).
+ * @return CRYPTOMODULE_OK, or CRYPTOMODULE_ERR_INVALID_INPUT if an entry is malformed or cannot
+ *         be applied; the other entries are applied regardless.
+ */
+cryptomodule_status_t cryptomodule_apply_backends(const char *spec);
+
+/**
+ * @brief Print the detected features (masked ones marked) and the backend of every primitive.
+ * @details Each primitive lists its backends after the current one; unavailable ones end in '*'.
+ */
+void cryptomodule_print_dispatch(FILE *fp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRYPTOMODULE_CPU_H */
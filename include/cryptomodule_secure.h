@@ -0,0 +1,82 @@
+/* File: include/cryptomodule_secure.h */
+
+#ifndef CRYPTOMODULE_SECURE_H
+#define CRYPTOMODULE_SECURE_H
+
+#include "api_cryptomodule.h"
+#include "cryptomodule_alloc.h"
+
+/**
+ * @file cryptomodule_secure.h
+ * @brief Locked arena for key schedules, GHASH/POLYVAL tables and other key-derived state.
+ * @details An arena is one anonymous mapping, locked into RAM with mlock() (so it is never written
+ *          to swap) and excluded from core dumps (MADV_DONTDUMP), with an inaccessible guard page on
+ *          each side. Blocks are carved from it in the size classes of cryptomodule_alloc (64 to
+ *          CRYPTOMODULE_POOL_MAX_SIZE bytes): a released block goes on the free list of its class
+ *          and is the next one handed out, so allocating and releasing are O(1) and never touch the
+ *          system once the arena exists. Blocks are wiped with cryptomodule_wipe() when released.
+ *
+ *          To keep every cipher context, mode context and table of the module in the arena, install
+ *          it as the module allocator:
+ *
+ *              cryptomodule_secure_arena *arena;
+ *              cryptomodule_secure_arena_create(&arena, 256 * 1024, true);
+ *              cryptomodule_allocator allocator = cryptomodule_secure_arena_allocator(arena);
+ *              cryptomodule_set_allocator(&allocator);
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct cryptomodule_secure_arena cryptomodule_secure_arena;
+
+/**
+ * @brief Map and lock a new arena.
+ * @param arena Receives the arena.
+ * @param size Usable bytes (rounded up to whole pages).
+ * @param require_lock If true, fail when the pages cannot be locked (RLIMIT_MEMLOCK); if false,
+ *                     fall back to an unlocked arena, see cryptomodule_secure_arena_locked().
+ * @return CRYPTOMODULE_OK, CRYPTOMODULE_ERR_INVALID_INPUT for a NULL arena or a zero size, or
+ *         CRYPTOMODULE_ERR_OUT_OF_MEMORY if the mapping (or, with require_lock, the lock) fails.
+ */
+cryptomodule_status_t cryptomodule_secure_arena_create(cryptomodule_secure_arena **arena, size_t size,
+                                                       bool require_lock);
+
+/**
+ * @brief Wipe, unlock and unmap an arena.
+ * @return CRYPTOMODULE_OK, or CRYPTOMODULE_ERR_INVALID_INPUT if blocks of the arena are still in use
+ *         (the arena is left intact).
+ */
+cryptomodule_status_t cryptomodule_secure_arena_destroy(cryptomodule_secure_arena *arena);
+
+/**
+ * @brief Allocate size zeroed bytes aligned to CRYPTOMODULE_CACHE_LINE from the arena.
+ * @return The block, or NULL if size is 0 or above CRYPTOMODULE_POOL_MAX_SIZE, or the arena is full.
+ */
+void *cryptomodule_secure_arena_alloc(cryptomodule_secure_arena *arena, size_t size);
+
+/**
+ * @brief Wipe a block of the arena and put it back on its free list.
+ * @param ptr The block (NULL is ignored).
+ * @param size The size passed to cryptomodule_secure_arena_alloc.
+ */
+void cryptomodule_secure_arena_free(cryptomodule_secure_arena *arena, void *ptr, size_t size);
+
+/** @brief True if the pages of the arena are locked into RAM. */
+bool cryptomodule_secure_arena_locked(const cryptomodule_secure_arena *arena);
+
+/** @brief True if ptr points into the usable region of the arena. */
+bool cryptomodule_secure_arena_contains(const cryptomodule_secure_arena *arena, const void *ptr);
+
+/**
+ * @brief An allocator for cryptomodule_set_allocator() that serves the module from the arena.
+ * @details The arena must outlive its use as the module allocator.
+ */
+cryptomodule_allocator cryptomodule_secure_arena_allocator(cryptomodule_secure_arena *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CRYPTOMODULE_SECURE_H */
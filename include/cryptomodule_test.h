@@ -105,6 +105,208 @@ void create_BlockCipher_KAT_RspFile(BlockCipherType type, const char *filename_r
  */
 void KAT_TEST_BLOCKCIPHER(BlockCipherType type);
 
+/**
+ * @brief Performs KAT verification of the ECB mode of operation.
+ * @param type Type of the block cipher (e.g., AES128/192/256, ARIA128/192/256, LEA128/192/256).
+ * @details This function runs every KEY/PT/CT vector of the ECB KAT (and MMT, when available)
+ *          files through the ECB mode API in both directions, so that the multi-block path of
+ *          the cipher is exercised as well. It prints the results to the console.
+ */
+void KAT_TEST_MODE_ECB(BlockCipherType type);
+
+/**
+ * @brief Performs KAT verification of the key-agile batch AES encryption.
+ * @details This function encrypts batches of 1 to 37 blocks, each under its own AES-128/192/256 key,
+ *          with every backend the CPU supports (T-table, bitsliced and AES-NI). It checks the FIPS 197
+ *          vectors, every block against single-block encryption under its key, and in-place batches.
+ *          It prints the results to the console.
+ */
+void KAT_TEST_AES_BATCH(void);
+
+/**
+ * @brief Performs KAT verification of the CCM mode of operation with AES-128.
+ * @details This function runs the NIST SP 800-38C Appendix C examples (including the one with
+ *          2^16 bytes of associated data) through the CCM mode API in both directions, and checks
+ *          that a flipped bit in the tag, the ciphertext or the associated data is rejected with
+ *          tag_ok cleared and the output zeroed. It prints the results to the console.
+ */
+void KAT_TEST_MODE_CCM(void);
+
+/**
+ * @brief Performs KAT verification of AES-GCM-SIV and of the POLYVAL and GHASH functions.
+ * @details This function runs the RFC 8452 Appendix C vectors for AES-128 and AES-256 (with and
+ *          without AAD, and the counter-wrap cases) through the GCM-SIV mode API in both directions,
+ *          checks that a tampered tag clears tag_ok and zeroes the output, and checks the POLYVAL
+ *          example of Appendix A and the GHASH value of the GCM specification's test case 2.
+ *          It prints the results to the console.
+ */
+void KAT_TEST_MODE_GCM_SIV(void);
+
+/**
+ * @brief Performs KAT verification of AES key wrapping (KW and KWP).
+ * @details This function wraps and unwraps the RFC 3394 Section 4 and RFC 5649 Section 6 vectors,
+ *          checks that a corrupted wrapped key is rejected with CRYPTOMODULE_ERR_CRYPTO_FAILURE and a
+ *          cleared output, and runs kw_unwrap_batch on a mix of valid, corrupted and malformed
+ *          entries, checking every entry through results[]. It prints the results to the console.
+ */
+void KAT_TEST_KW(void);
+
+/**
+ * @brief Performs KAT verification of the CBC and CTR modes of operation with AES-128/192/256.
+ * @details This function runs the NIST SP 800-38A vectors through the mode API in both directions,
+ *          in one call and in two calls, once with the fused kernels of the cipher type and once with
+ *          the generic kernels, checks ctr_seek into the middle of a block, and compares the two
+ *          kinds of kernels on a longer message. It prints the results to the console.
+ */
+void KAT_TEST_MODE_CBC_CTR(void);
+
+/**
+ * @brief Checks ctr_seek() against a sequential CTR keystream with AES-128/192/256.
+ * @details This function starts the counter just below a 2^64 boundary, checks the sequential
+ *          keystream against AES of the expected counter blocks, and then seeks the same context
+ *          forwards and backwards to aligned and unaligned offsets around the carry, into the carry
+ *          block followed by uneven pieces, and to a far offset that also carries. It prints the
+ *          results to the console.
+ */
+void TEST_CTR_SEEK(void);
+
+/**
+ * @brief Performs KAT verification of the XTS mode of operation with AES-128/256.
+ * @details This function runs IEEE 1619 vectors with full-block data units and with a stolen tail
+ *          through the XTS mode API in both directions, in and out of place, and checks that
+ *          xts_process_sectors over several sectors matches xts_process one sector at a time and
+ *          decrypts in place. It prints the results to the console.
+ */
+void KAT_TEST_MODE_XTS(void);
+
+/**
+ * @brief Checks the pooled allocator and the application allocator hook.
+ * @details This function checks that blocks of every size class (and larger ones) are cache-line
+ *          aligned and zeroed on reuse, that setting up and tearing down a context of every mode
+ *          releases everything it allocated, that blocks may be released by another thread, and
+ *          that an application allocator serves the modes and gets its blocks back wiped. It prints
+ *          the results to the console.
+ */
+void TEST_ALLOCATOR(void);
+
+/**
+ * @brief Checks the locked key arena and cryptomodule_wipe().
+ * @details This function checks that arena blocks are aligned, zeroed and reused in O(1) from their
+ *          free list, that the arena refuses oversized requests and reports when it is full or still
+ *          in use, that an installed arena holds the cipher context and POLYVAL table of GCM-SIV, and
+ *          that a write past the arena hits its guard page. It prints the results to the console.
+ */
+void TEST_SECURE_ARENA(void);
+
+/**
+ * @brief Compares every accelerated SHA-2 backend with the portable C one.
+ * @details This function hashes messages of every length up to four SHA-512 blocks and random
+ *          lengths up to 16 KiB with each backend the CPU supports (SHA-NI for SHA-224/256, the
+ *          AVX2 schedule for SHA-384/512) and with the C backend, and checks that the digests
+ *          agree. The multi-buffer SHA-256 backends are checked on batches of 1 to 100 messages
+ *          of mixed lengths against one-at-a-time hashing. Unsupported backends are skipped.
+ *          It prints the results to the console.
+ */
+void DIFF_TEST_SHA2_BACKENDS(void);
+
+/**
+ * @brief Performs KAT verification of SHA-3.
+ * @param bits Digest size of the SHA-3 function (224, 256, 384 or 512).
+ * @details This function runs the ShortMsg and LongMsg files from ./testvectors/hash_tv/sha3
+ *          through the one-shot and the incremental API, and runs the Monte Carlo test of the
+ *          Monte file. A Monte file whose first checkpoint does not follow the Monte Carlo
+ *          procedure is reported and skipped. It prints the results to the console.
+ */
+void KAT_TEST_SHA3(int bits);
+
+/**
+ * @brief Compares the four-way SHA-3/SHAKE functions with the single-stream ones.
+ * @details This function hashes four different messages of every length up to four SHAKE128
+ *          blocks with SHA3-256, SHA3-512, SHAKE128 and incremental SHAKE256, once with each
+ *          four-way backend the CPU supports (portable and AVX2), and checks every output against
+ *          the single-stream functions. It prints the results to the console.
+ */
+void DIFF_TEST_SHA3_X4(void);
+
+/**
+ * @brief Performs KAT verification of LSH-256-224/256 and LSH-512-224/256/384/512.
+ * @details This function hashes the empty message, "abc" and a 300-byte message through the
+ *          one-shot and the incremental API (fed in pieces of growing length), once with each
+ *          backend the CPU supports (C, SSE2 and AVX2). It prints the results to the console.
+ */
+void KAT_TEST_LSH(void);
+
+/**
+ * @brief Checks the CPU feature probe and the backend registry.
+ * @details This function forces every registered backend by name (which must succeed exactly when
+ *          the CPU has the features it needs), compares digests between forced and automatically
+ *          selected backends, checks that malformed override lists are reported, and masks
+ *          features to check that every primitive falls back to its portable backend. It prints
+ *          the results to the console.
+ */
+void TEST_CPU_DISPATCH(void);
+
+/**
+ * @brief Performs KAT verification of HMAC-SHA-224/256/384/512.
+ * @details This function runs the RFC 4231 test cases through the one-shot call and through a
+ *          keyed context, which is reused for a second MAC after hmac_final and cloned in the
+ *          middle of a message. It prints the results to the console.
+ */
+void KAT_TEST_HMAC(void);
+
+/**
+ * @brief Performs KAT verification of CMAC with AES-128/192/256.
+ * @details This function runs the RFC 4493 / NIST SP 800-38B examples (messages of 0, 16, 40 and
+ *          64 bytes) through the one-shot call and through a context fed in pieces that end inside,
+ *          at and across block boundaries, and checks cmac_multi on messages of mixed lengths
+ *          against the one-shot call. It prints the results to the console.
+ */
+void KAT_TEST_CMAC(void);
+
+/**
+ * @brief Performs KAT verification of PBKDF2-HMAC-SHA256.
+ * @details This function runs the RFC 7914 (and RFC 6070-style) vectors once with each
+ *          multi-buffer SHA-256 backend the CPU supports, and checks that a batch derivation of
+ *          different passwords and salts matches one derivation at a time. It prints the results
+ *          to the console.
+ */
+void KAT_TEST_PBKDF2(void);
+
+/**
+ * @brief Performs KAT verification of HKDF-SHA256 and HKDF-SHA384.
+ * @details This function runs the RFC 5869 test cases (and the same inputs with SHA-384) through
+ *          extract, expand and the streaming reader once with each multi-buffer SHA-256 backend the
+ *          CPU supports, and checks that deriving a batch of labels matches one label at a time.
+ *          It prints the results to the console.
+ */
+void KAT_TEST_HKDF(void);
+
+/**
+ * @brief Performs KAT verification of CTR_DRBG with AES-128/192/256, with and without df.
+ * @details This function checks instantiate, generate with additional input, reseed and generate
+ *          against fixed entropy, then checks that the per-thread instance serves small reads
+ *          without repeating itself and that a forked child does not return the parent's output.
+ *          It prints the results to the console.
+ */
+void KAT_TEST_CTR_DRBG(void);
+
+/**
+ * @brief Performs KAT verification of HMAC_DRBG with SHA-224/256/384/512.
+ * @details This function checks instantiate, generate with additional input, reseed and generate
+ *          against fixed entropy, then checks the per-thread instance and its behaviour across a
+ *          fork. It prints the results to the console.
+ */
+void KAT_TEST_HMAC_DRBG(void);
+
+/**
+ * @brief Performs KAT verification of Hash_DRBG with SHA-224/256/384/512.
+ * @details This function runs the same sequence as KAT_TEST_HMAC_DRBG for every supported
+ *          multi-buffer SHA-256 backend, compares long SHA-224/256 requests with the serial
+ *          backend, and checks the per-thread instance and its behaviour across a fork. It prints
+ *          the results to the console.
+ */
+void KAT_TEST_HASH_DRBG(void);
+
 
 #ifdef __cplusplus
 }
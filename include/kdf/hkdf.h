@@ -0,0 +1,115 @@
+/* File: include/kdf/hkdf.h */
+
+#ifndef KDF_HKDF_H
+#define KDF_HKDF_H
+
+#include "../api_cryptomodule.h"
+#include "../mac/hmac.h"
+
+/**
+ * @file hkdf.h
+ * @brief HKDF (RFC 5869) with HMAC-SHA-256 and HMAC-SHA-384.
+ * @details An HkdfContext is an HMAC context keyed with the pseudorandom key (PRK), so the PRK's
+ *          ipad/opad midstates are computed once, by hkdf_init or hkdf_init_extract, and reused
+ *          by every expand block of every label derived from it. Expanding never modifies the
+ *          context, so one context can serve several threads. Output can be produced all at once
+ *          (hkdf_expand), piece by piece (HkdfExpandStream), or for many labels in one call
+ *          (hkdf_expand_multi), which runs the labels side by side in the multi-buffer SHA-256
+ *          lanes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HKDF_MAX_PRK_SIZE   HMAC_MAX_MAC_SIZE
+
+typedef struct __HkdfContext__ {
+    HmacContext prk;            // HMAC keyed with the PRK
+} HkdfContext;
+
+/** State of one expand operation whose output is read in pieces. */
+typedef struct __HkdfExpandStream__ {
+    HmacContext mac;            // Copy of the keyed PRK context
+    const u8 *info;             // Context information (must stay valid while reading)
+    size_t info_len;
+    u8 t[HMAC_MAX_MAC_SIZE];    // Current block T(counter)
+    size_t t_pos;               // Bytes of t already returned
+    u32 counter;                // Number of blocks produced (at most 255)
+} HkdfExpandStream;
+
+/**
+ * @brief HKDF-Extract: PRK = HMAC(salt, IKM).
+ * @param hash HMAC_SHA256 or HMAC_SHA384.
+ * @param salt Salt (NULL/0 for the default all-zero salt).
+ * @param ikm Input keying material.
+ * @param prk Output buffer of hmac_mac_size(hash) bytes.
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t hkdf_extract(
+    HmacHashType hash,
+    const u8 *salt, size_t salt_len,
+    const u8 *ikm, size_t ikm_len,
+    u8 *prk);
+
+/**
+ * @brief Key the context with a PRK (computes its HMAC midstates).
+ * @param prk PRK of at least hmac_mac_size(hash) bytes (RFC 5869 section 2.3).
+ */
+cryptomodule_status_t hkdf_init(HkdfContext *ctx, HmacHashType hash, const u8 *prk, size_t prk_len);
+
+/**
+ * @brief Extract a PRK from salt and IKM and key the context with it.
+ */
+cryptomodule_status_t hkdf_init_extract(
+    HkdfContext *ctx, HmacHashType hash,
+    const u8 *salt, size_t salt_len,
+    const u8 *ikm, size_t ikm_len);
+
+/**
+ * @brief HKDF-Expand: okm_len bytes of output keying material for the context information info.
+ * @param okm_len At most 255 * hmac_mac_size bytes.
+ */
+cryptomodule_status_t hkdf_expand(const HkdfContext *ctx, const u8 *info, size_t info_len, u8 *okm, size_t okm_len);
+
+/**
+ * @brief Derive one okm_len-byte subkey per label: subkey i = HKDF-Expand(PRK, infos[i], okm_len).
+ * @param okm Output buffer of num * okm_len bytes; subkey i is written at okm + i * okm_len.
+ * @details With HKDF-SHA256, labels are processed in groups of SHA2_sha256_multi_lanes(): each
+ *          expand block of all labels in a group costs one multi-lane compression per inner block
+ *          and one for the outer hash. Labels too long for the lanes, and HKDF-SHA384, go through
+ *          hkdf_expand one label at a time (still without rekeying).
+ */
+cryptomodule_status_t hkdf_expand_multi(
+    const HkdfContext *ctx,
+    const u8 *const *infos, const size_t *info_lens, size_t num,
+    u8 *okm, size_t okm_len);
+
+/**
+ * @brief Start an expand operation whose output is read with hkdf_expand_read.
+ * @details Reading a and then b bytes gives the same a + b bytes as hkdf_expand with a + b.
+ */
+cryptomodule_status_t hkdf_expand_stream_init(HkdfExpandStream *stream, const HkdfContext *ctx,
+                                              const u8 *info, size_t info_len);
+
+/**
+ * @brief Read the next len bytes of output keying material.
+ * @return CRYPTOMODULE_ERR_INVALID_INPUT once the 255-block limit would be exceeded.
+ */
+cryptomodule_status_t hkdf_expand_read(HkdfExpandStream *stream, u8 *out, size_t len);
+
+/**
+ * @brief Clear the stream state.
+ */
+void hkdf_expand_stream_dispose(HkdfExpandStream *stream);
+
+/**
+ * @brief Clear all key material.
+ */
+void hkdf_dispose(HkdfContext *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KDF_HKDF_H */
@@ -0,0 +1,64 @@
+/* File: include/kdf/pbkdf.h */
+
+#ifndef KDF_PBKDF_H
+#define KDF_PBKDF_H
+
+#include "../api_cryptomodule.h"
+#include "../mac/hmac.h"
+
+/**
+ * @file pbkdf.h
+ * @brief PBKDF2 (NIST SP 800-132 / RFC 8018) with HMAC-SHA-256.
+ * @details Each output block T_i = U_1 ^ ... ^ U_c is a chain of c HMACs. The password's ipad and
+ *          opad midstates are computed once, and every U_j after the first costs exactly two
+ *          SHA-256 compressions on pre-padded blocks, without going through the generic HMAC or
+ *          hash padding code. Chains are independent of each other, both the output blocks of one
+ *          derivation and the derivations of different passwords, so they are run side by side
+ *          in the lanes of the multi-buffer SHA-256 kernel (8 with AVX2, 16 with AVX-512).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Derive out_len bytes from a password with PBKDF2-HMAC-SHA256.
+ * @param password Password (any length).
+ * @param password_len Password length in bytes.
+ * @param salt Salt (any length).
+ * @param salt_len Salt length in bytes.
+ * @param iterations Iteration count c (at least 1).
+ * @param out Output buffer of out_len bytes.
+ * @param out_len Derived key length in bytes (at least 1).
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t pbkdf2_hmac_sha256(
+    const u8 *password, size_t password_len,
+    const u8 *salt, size_t salt_len,
+    u32 iterations,
+    u8 *out, size_t out_len);
+
+/**
+ * @brief PBKDF2-HMAC-SHA256 of num independent passwords, e.g. concurrent login checks.
+ * @param passwords Array of num password pointers.
+ * @param password_lens Array of num password lengths in bytes.
+ * @param salts Array of num salt pointers.
+ * @param salt_lens Array of num salt lengths in bytes.
+ * @param iterations Iteration count, shared by all derivations.
+ * @param out Output buffer of num * out_len bytes; key i is written at out + i * out_len.
+ * @param out_len Derived key length in bytes, shared by all derivations.
+ * @param num Number of derivations.
+ * @details The output blocks of all derivations are spread over the SIMD lanes together, so a
+ *          batch of short keys fills the lanes as well as one long key does.
+ */
+cryptomodule_status_t pbkdf2_hmac_sha256_multi(
+    const u8 *const *passwords, const size_t *password_lens,
+    const u8 *const *salts, const size_t *salt_lens,
+    u32 iterations,
+    u8 *out, size_t out_len, size_t num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* KDF_PBKDF_H */
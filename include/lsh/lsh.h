@@ -0,0 +1,205 @@
+/* FILE: include/lsh/lsh.h*/
+/** LSH API
+ * References: KS X 3262, "LSH: A New Fast Secure Hash Function Family" (ICISC 2014)
+ */
+
+
+#ifndef LSH_H
+#define LSH_H
+
+#include "../api_cryptomodule.h"
+
+/**
+ * @file lsh.h
+ * @brief LSH-256-n and LSH-512-n (KS X 3262), one-shot and incremental.
+ * @details The chaining value of sixteen words is two halves of eight: every step XORs one
+ *          expanded message block into the state, mixes word l of the left half with word l of
+ *          the right half for all l at once and permutes the words. The eight mixes of a step are
+ *          independent, so a step is the same handful of vector instructions on one or two
+ *          registers per half; the SSE2 and AVX2 backends keep the state in registers for all the
+ *          blocks of a call. The contexts live on the caller's stack, like the SHA-2 contexts.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LSH_LSH256_224_DIGEST_SIZE  28
+#define LSH_LSH256_256_DIGEST_SIZE  32
+#define LSH_LSH512_224_DIGEST_SIZE  28
+#define LSH_LSH512_256_DIGEST_SIZE  32
+#define LSH_LSH512_384_DIGEST_SIZE  48
+#define LSH_LSH512_512_DIGEST_SIZE  64
+
+#define LSH_LSH256_BLOCK_SIZE       128     /* 32 words of 32 bits */
+#define LSH_LSH512_BLOCK_SIZE       256     /* 32 words of 64 bits */
+
+#define LSH_LSH256_STEPS            26
+#define LSH_LSH512_STEPS            28
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LSH_HAVE_X86                1       /* x86 backends (built with per-function target attributes) */
+#else
+#define LSH_HAVE_X86                0
+#endif
+
+/** Incremental LSH-256-n state. */
+typedef struct __LSH_lsh256_ctx__ {
+    u32 cv[16];                         // Chaining value (left half, then right half)
+    u8 data[LSH_LSH256_BLOCK_SIZE];     // Pending partial block
+    size_t data_len;                    // Number of bytes in data (always less than a block)
+    size_t outlen;                      // Digest size in bytes (1 to 32)
+} LSH_lsh256_ctx;
+
+/** Incremental LSH-512-n state. */
+typedef struct __LSH_lsh512_ctx__ {
+    u64 cv[16];                         // Chaining value (left half, then right half)
+    u8 data[LSH_LSH512_BLOCK_SIZE];     // Pending partial block
+    size_t data_len;                    // Number of bytes in data (always less than a block)
+    size_t outlen;                      // Digest size in bytes (1 to 64)
+} LSH_lsh512_ctx;
+
+/** Step constants SC_j (eight words per step), shared by the vector backends. */
+extern const u32 lsh256_step_constants[8 * LSH_LSH256_STEPS];
+extern const u64 lsh512_step_constants[8 * LSH_LSH512_STEPS];
+
+/**
+ * @brief Process a message with LSH-256-224 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 28 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void LSH_lsh256_224(u8 *output, const u8 *input, size_t inplen);
+
+/** @brief LSH-256-256 counterpart of LSH_lsh256_224; the output array must hold 32 bytes. */
+void LSH_lsh256_256(u8 *output, const u8 *input, size_t inplen);
+
+/** @brief LSH-512-224 counterpart of LSH_lsh256_224; the output array must hold 28 bytes. */
+void LSH_lsh512_224(u8 *output, const u8 *input, size_t inplen);
+
+/** @brief LSH-512-256 counterpart of LSH_lsh256_224; the output array must hold 32 bytes. */
+void LSH_lsh512_256(u8 *output, const u8 *input, size_t inplen);
+
+/** @brief LSH-512-384 counterpart of LSH_lsh256_224; the output array must hold 48 bytes. */
+void LSH_lsh512_384(u8 *output, const u8 *input, size_t inplen);
+
+/** @brief LSH-512-512 counterpart of LSH_lsh256_224; the output array must hold 64 bytes. */
+void LSH_lsh512_512(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with LSH-256-n for any whole number of output bytes.
+ *
+ * @param output The output byte array of outlen bytes
+ * @param outlen The digest size n / 8 in bytes (1 to 32)
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ * @return CRYPTOMODULE_OK or CRYPTOMODULE_ERR_INVALID_INPUT for an unsupported digest size.
+ */
+cryptomodule_status_t LSH_lsh256(u8 *output, size_t outlen, const u8 *input, size_t inplen);
+
+/** @brief LSH-512-n counterpart of LSH_lsh256 (outlen 1 to 64). */
+cryptomodule_status_t LSH_lsh512(u8 *output, size_t outlen, const u8 *input, size_t inplen);
+
+/**
+ * @brief Initialize the context for an incremental LSH-256-n computation.
+ * @details The initialization vectors of LSH-256-224 and LSH-256-256 are tables; other digest
+ *          sizes derive theirs from the size with one compression, as the standard specifies.
+ *
+ * @param state The context to initialize
+ * @param outlen The digest size in bytes (1 to 32)
+ * @return CRYPTOMODULE_OK or CRYPTOMODULE_ERR_INVALID_INPUT for an unsupported digest size.
+ */
+cryptomodule_status_t LSH_lsh256_inc_init(LSH_lsh256_ctx *state, size_t outlen);
+
+/**
+ * @brief Absorb message bytes into the context; may be called repeatedly before finalize.
+ *
+ * @param state The context, initialized by LSH_lsh256_inc_init or LSH_lsh256_inc_ctx_clone
+ * @param in The message input byte array
+ * @param inlen The number of message bytes to process
+ */
+void LSH_lsh256_inc(LSH_lsh256_ctx *state, const u8 *in, size_t inlen);
+
+/**
+ * @brief Pad the message and write the digest; the context is released afterwards.
+ *
+ * @param out The output byte array of state->outlen bytes
+ * @param state The LSH-256 context
+ */
+void LSH_lsh256_inc_finalize(u8 *out, LSH_lsh256_ctx *state);
+
+/** @brief Clone an incremental context (e.g., to hash several messages with a common prefix). */
+void LSH_lsh256_inc_ctx_clone(LSH_lsh256_ctx *dest, const LSH_lsh256_ctx *src);
+
+/** @brief Wipe an incremental context. */
+void LSH_lsh256_inc_ctx_release(LSH_lsh256_ctx *state);
+
+/** @brief LSH-512 counterpart of LSH_lsh256_inc_init (outlen 1 to 64). */
+cryptomodule_status_t LSH_lsh512_inc_init(LSH_lsh512_ctx *state, size_t outlen);
+
+/** @brief LSH-512 counterpart of LSH_lsh256_inc. */
+void LSH_lsh512_inc(LSH_lsh512_ctx *state, const u8 *in, size_t inlen);
+
+/** @brief LSH-512 counterpart of LSH_lsh256_inc_finalize. */
+void LSH_lsh512_inc_finalize(u8 *out, LSH_lsh512_ctx *state);
+
+/** @brief LSH-512 counterpart of LSH_lsh256_inc_ctx_clone. */
+void LSH_lsh512_inc_ctx_clone(LSH_lsh512_ctx *dest, const LSH_lsh512_ctx *src);
+
+/** @brief LSH-512 counterpart of LSH_lsh256_inc_ctx_release. */
+void LSH_lsh512_inc_ctx_release(LSH_lsh512_ctx *state);
+
+/* ----------------------------- Compression and backends ---------------------------- */
+
+/**
+ * @brief Run the LSH-256 compression function over nblocks consecutive 128-byte blocks.
+ * @param cv The chaining value (sixteen words), updated in place.
+ */
+void LSH_lsh256_compress(u32 *cv, const u8 *in, size_t nblocks);
+
+/**
+ * @brief Run the LSH-512 compression function over nblocks consecutive 256-byte blocks.
+ * @param cv The chaining value (sixteen words), updated in place.
+ */
+void LSH_lsh512_compress(u64 *cv, const u8 *in, size_t nblocks);
+
+/** Implementations of the compression functions. */
+typedef enum {
+    LSH_BACKEND_C = 0,      // Portable C (always available)
+    LSH_BACKEND_SSE2,       // Two (LSH-256) or four (LSH-512) 128-bit registers per half
+    LSH_BACKEND_AVX2,       // One (LSH-256) or two (LSH-512) 256-bit registers per half
+} LSH_backend_t;
+
+/**
+ * @brief Select the widest backend the CPU supports (CPUID); called by cryptomodule_init.
+ * @details Calling it is optional: the first compression selects the backend on its own.
+ */
+void LSH_init_dispatch(void);
+
+/**
+ * @brief Force the backend of both compression functions (e.g., to compare backends).
+ * @return false, leaving the selection unchanged, if the backend is not supported on this CPU.
+ */
+bool LSH_set_backend(LSH_backend_t backend);
+
+/** @brief The backend currently in use. */
+LSH_backend_t LSH_get_backend(void);
+
+#if LSH_HAVE_X86
+/** @brief SSE2 versions of the compression functions; only call them if the CPU has SSE2. */
+void lsh256_compress_sse2(u32 *cv, const u8 *in, size_t nblocks);
+void lsh512_compress_sse2(u64 *cv, const u8 *in, size_t nblocks);
+
+/** @brief AVX2 versions of the compression functions; only call them if the CPU has AVX2. */
+void lsh256_compress_avx2(u32 *cv, const u8 *in, size_t nblocks);
+void lsh512_compress_avx2(u64 *cv, const u8 *in, size_t nblocks);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LSH_H */
@@ -0,0 +1,90 @@
+/* File: include/mac/cmac.h */
+
+#ifndef MAC_CMAC_H
+#define MAC_CMAC_H
+
+#include "../api_cryptomodule.h"
+#include "../block_cipher/api_block_cipher.h"
+
+/**
+ * @file cmac.h
+ * @brief CMAC (OMAC1, NIST SP 800-38B / RFC 4493) over any registered block cipher.
+ * @details A CmacContext holds the cipher key schedule, the subkeys K1/K2 and the streaming state.
+ *          cmac_init/cmac_update/cmac_final compute one MAC over data given in pieces;
+ *          cmac_multi computes MACs of several independent messages under the same key, running up
+ *          to CMAC_MAX_LANES chains side by side so each cipher call handles one block per chain.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CMAC_MAC_SIZE   BLOCK_SIZE  /* Full CMAC output size in bytes */
+#define CMAC_MAX_LANES  8           /* Independent chains interleaved by cmac_multi */
+
+typedef struct __CmacContext__ {
+    BlockCipherContext cipher_ctx;  // Cipher keyed for encryption
+    u8 k1[BLOCK_SIZE];              // Subkey for a complete final block
+    u8 k2[BLOCK_SIZE];              // Subkey for a padded final block
+    u8 state[BLOCK_SIZE];           // CBC-MAC chaining value
+    u8 buf[BLOCK_SIZE];             // Pending input; the last block is held back until final
+    size_t buf_len;                 // Number of bytes in buf
+} CmacContext;
+
+/**
+ * @brief Key the context and derive the subkeys.
+ * @param ctx CMAC context.
+ * @param type Block cipher (e.g., BLOCK_CIPHER_AES128, BLOCK_CIPHER_ARIA256).
+ * @param key Cipher key.
+ * @param key_len Key length in bytes (16, 24 or 32).
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t cmac_init(CmacContext *ctx, BlockCipherType type, const u8 *key, size_t key_len);
+
+/**
+ * @brief Absorb msg_len bytes of the message.
+ */
+cryptomodule_status_t cmac_update(CmacContext *ctx, const u8 *msg, size_t msg_len);
+
+/**
+ * @brief Finish the MAC and reset the streaming state (the key stays loaded).
+ * @param mac Output buffer for mac_len bytes.
+ * @param mac_len MAC length in bytes (1..16; the MAC is truncated to its leftmost bytes).
+ */
+cryptomodule_status_t cmac_final(CmacContext *ctx, u8 *mac, size_t mac_len);
+
+/**
+ * @brief MACs of num_msgs independent messages under the key of ctx.
+ * @param ctx Keyed CMAC context (its streaming state is not used or modified).
+ * @param msgs Array of num_msgs message pointers.
+ * @param msg_lens Array of num_msgs message lengths in bytes.
+ * @param num_msgs Number of messages (any count; processed CMAC_MAX_LANES at a time).
+ * @param macs Output buffer of num_msgs * mac_len bytes.
+ * @param mac_len MAC length in bytes (1..16).
+ * @details A single CMAC chain is latency-bound, so the chains of up to CMAC_MAX_LANES messages
+ *          advance together: each step gathers the next block of every active chain and runs
+ *          them through the cipher's multi-block entry in one call.
+ */
+cryptomodule_status_t cmac_multi(
+    CmacContext *ctx,
+    const u8 *const *msgs, const size_t *msg_lens, size_t num_msgs,
+    u8 *macs, size_t mac_len);
+
+/**
+ * @brief One-shot CMAC.
+ */
+cryptomodule_status_t cmac(
+    BlockCipherType type, const u8 *key, size_t key_len,
+    const u8 *msg, size_t msg_len,
+    u8 *mac, size_t mac_len);
+
+/**
+ * @brief Dispose of the cipher context and clear all key material.
+ */
+void cmac_dispose(CmacContext *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAC_CMAC_H */
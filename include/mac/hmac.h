@@ -0,0 +1,100 @@
+/* File: include/mac/hmac.h */
+
+#ifndef MAC_HMAC_H
+#define MAC_HMAC_H
+
+#include "../api_cryptomodule.h"
+#include "../sha/sha2.h"
+
+/**
+ * @file hmac.h
+ * @brief HMAC (FIPS 198-1 / RFC 2104) with SHA-224, SHA-256, SHA-384 and SHA-512.
+ * @details hmac_init hashes the padded key blocks K ^ ipad and K ^ opad once and keeps the two
+ *          resulting SHA-2 midstates in the context. Every MAC after that starts from a copy of
+ *          the inner midstate, so it costs the message blocks plus one outer block, however many
+ *          messages are authenticated under the key. A keyed context is never modified by
+ *          hmac_final beyond its streaming state, and hmac_ctx_clone gives each thread its own
+ *          copy without rehashing the key.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HMAC_MAX_MAC_SIZE   SHA2_SHA512_DIGEST_SIZE     /* Largest MAC (HMAC-SHA-512) */
+#define HMAC_MAX_BLOCK_SIZE SHA2_SHA512_BLOCK_SIZE      /* Largest hash block */
+
+typedef enum {
+    HMAC_SHA224 = 0,
+    HMAC_SHA256,
+    HMAC_SHA384,
+    HMAC_SHA512,
+} HmacHashType;
+
+/** SHA-2 state of either family (SHA-224/256 or SHA-384/512). */
+typedef union {
+    SHA2_sha256_ctx sha256;
+    SHA2_sha512_ctx sha512;
+} HmacHashState;
+
+typedef struct __HmacContext__ {
+    HmacHashType hash;          // Underlying hash function
+    size_t mac_size;            // Full MAC size in bytes
+    size_t block_size;          // Hash block size in bytes
+    HmacHashState inner_key;    // Midstate after the K ^ ipad block
+    HmacHashState outer_key;    // Midstate after the K ^ opad block
+    HmacHashState inner;        // Streaming state of the current message
+    bool keyed;                 // Set by hmac_init
+} HmacContext;
+
+/**
+ * @brief Full MAC size in bytes of an HMAC hash type (0 for an unknown type).
+ */
+size_t hmac_mac_size(HmacHashType hash);
+
+/**
+ * @brief Key the context: hash the ipad and opad blocks and keep their midstates.
+ * @param ctx HMAC context.
+ * @param hash Underlying hash (HMAC_SHA224/256/384/512).
+ * @param key Key of any length (keys longer than a block are hashed first).
+ * @param key_len Key length in bytes.
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t hmac_init(HmacContext *ctx, HmacHashType hash, const u8 *key, size_t key_len);
+
+/**
+ * @brief Absorb msg_len bytes of the message.
+ */
+cryptomodule_status_t hmac_update(HmacContext *ctx, const u8 *msg, size_t msg_len);
+
+/**
+ * @brief Finish the MAC and reset the streaming state to the inner midstate (the key stays loaded).
+ * @param mac Output buffer for mac_len bytes.
+ * @param mac_len MAC length in bytes (1..hmac_mac_size; the MAC is truncated to its leftmost bytes).
+ */
+cryptomodule_status_t hmac_final(HmacContext *ctx, u8 *mac, size_t mac_len);
+
+/**
+ * @brief Copy a keyed context, including any message absorbed so far.
+ * @details The copy is independent of the source, e.g. one per thread under a shared key.
+ */
+cryptomodule_status_t hmac_ctx_clone(HmacContext *dest, const HmacContext *src);
+
+/**
+ * @brief One-shot HMAC.
+ */
+cryptomodule_status_t hmac(
+    HmacHashType hash, const u8 *key, size_t key_len,
+    const u8 *msg, size_t msg_len,
+    u8 *mac, size_t mac_len);
+
+/**
+ * @brief Clear all key material.
+ */
+void hmac_dispose(HmacContext *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MAC_HMAC_H */
@@ -14,6 +14,8 @@ extern "C" {
 
 #define GCM_BLOCK_LEN   16  // Standard GCM block length
 #define GCM_IV_LEN      12  // Standard GCM IV length
+#define CCM_MIN_NONCE_LEN  7  // CCM nonce length range (SP 800-38C)
+#define CCM_MAX_NONCE_LEN 13
 
 
 // Enumeration for supported block cipher modes
@@ -22,6 +24,9 @@ typedef enum {
     MODE_CBC = 0xCBC,
     MODE_CTR = 0xC12,
     MODE_GCM = 0xFC1,
+    MODE_XTS = 0x775,
+    MODE_CCM = 0xCC1,
+    MODE_GCM_SIV = 0xFC5,
     MODE_UNKNOWN = 0x000
 } ModeOfOperationType;
 
@@ -31,10 +36,37 @@ static inline const char* mode_type_to_string(ModeOfOperationType mode) {
         case MODE_CBC: return "CBC";
         case MODE_CTR: return "CTR";
         case MODE_GCM: return "GCM";
+        case MODE_XTS: return "XTS";
+        case MODE_CCM: return "CCM";
+        case MODE_GCM_SIV: return "GCM-SIV";
         default: return "Unknown Mode";
     }
 }
 
+#define MODE_TYPE_COUNT 7    // Number of known ModeOfOperationType values (UNKNOWN excluded)
+
+/* Dense index (0 .. MODE_TYPE_COUNT - 1) of a ModeOfOperationType for lookup tables, or -1 */
+static inline int mode_type_index(ModeOfOperationType mode) {
+    switch (mode) {
+        case MODE_ECB: return 0;
+        case MODE_CBC: return 1;
+        case MODE_CTR: return 2;
+        case MODE_GCM: return 3;
+        case MODE_XTS: return 4;
+        case MODE_CCM: return 5;
+        case MODE_GCM_SIV: return 6;
+        default: return -1;
+    }
+}
+
+// Enumeration for the padding applied by modes that accept it (e.g., ECB)
+typedef enum {
+    MODE_PADDING_NONE = 0x00,       // No padding: input must be a multiple of the block size
+    MODE_PADDING_PKCS7 = 0x07,      // PKCS#7
+    MODE_PADDING_ANSI923 = 0x923,   // ANSI X9.23
+    MODE_PADDING_ISO7816_4 = 0x7816 // ISO/IEC 7816-4
+} ModePaddingType;
+
 typedef struct __ModeOfOperationContext__ ModeOfOperationContext;
 
 typedef struct __ModeOfOperationApi__ {
@@ -55,11 +87,16 @@ typedef struct __ModeOfOperationApi__ {
         const u8 *in, u8 *out, size_t padded_len,
         BlockCipherDirection dir);
 
+    /**
+     * @brief Authenticated encryption/decryption (AEAD modes).
+     * @details On encryption the tag is written to `tag`; on decryption `tag` is the expected
+     *          tag, and on mismatch the output is cleared and the mode's tag_ok flag is false.
+     */
     void (*mode_process_with_tag)(
         ModeOfOperationContext *mode_ctx,
         const u8 *in, u8 *out, size_t pt_len,
         const u8 *aad, size_t aad_len,
-        const u8 *tag, size_t tag_len,
+        u8 *tag, size_t tag_len,
         BlockCipherDirection dir);
 
     /**
@@ -73,12 +110,17 @@ typedef struct __ModeInternal__ {
     struct __cbc_internal__ { 
         // Note: The IV is not used in the encryption process, but it is needed for decryption. 
         u8 iv[BLOCK_SIZE];   // Current IV (for CBC chaining).
+        block_cipher_cbc_kernel kernel; // Fused (or generic) kernel of the direction given to cbc_init
     } cbc_internal;
 
     /* CTR Mode State */
     struct __ctr_internal__ {
-        // Note: The IV is not used in the encryption process, but it is needed for decryption.
-        u8 counter[BLOCK_SIZE];   // Current counter
+        // Note: The keystream is always produced with the cipher's encryption direction.
+        u8 iv[BLOCK_SIZE];          // Initial counter block (byte offset 0), kept for ctr_seek
+        u8 counter[BLOCK_SIZE];     // Counter block of the next keystream block
+        u8 keystream[BLOCK_SIZE];   // Keystream of the current, partially consumed block
+        size_t ks_used;             // Bytes of `keystream` already used (BLOCK_SIZE: none left)
+        block_cipher_ctr_kernel kernel; // Fused (or generic) kernel selected by ctr_init
     } ctr_internal;
 
     /* GCM Mode State (Authenticated Encryption with Associated Data) */
@@ -91,11 +133,31 @@ typedef struct __ModeInternal__ {
 
     /* ECB Mode State */
     struct __ecb_internal__ {
-        // Note: ECB does not require any internal state.
-        // This is a placeholder for future use or extensions.
-        int dummy;  // Placeholder for future use
+        // Note: ECB has no chaining state; only the padding choice is kept.
+        ModePaddingType padding;    // Padding applied by ecb_init (set by the caller before init)
+        size_t total_len;           // Length of the (padded) input prepared by ecb_init
     } ecb_internal;
 
+    /* XTS Mode State (data key in cipher_ctx, tweak key here) */
+    struct __xts_internal__ {
+        BlockCipherContext *tweak_ctx;  // Tweak cipher keyed with the second key half (encryption only)
+        u8 tweak[BLOCK_SIZE];           // Data unit tweak value (IV) used by mode_process
+    } xts_internal;
+
+    /* CCM Mode State (Authenticated Encryption with Associated Data) */
+    struct __ccm_internal__ {
+        u8 nonce[CCM_MAX_NONCE_LEN];    // Nonce N (7..13 bytes)
+        size_t nonce_len;               // Length of N; the length field uses 15 - nonce_len bytes
+        bool tag_ok;                    // Result of the last decryption's tag check
+    } ccm_internal;
+
+    /* GCM-SIV Mode State (nonce-misuse-resistant AEAD, RFC 8452) */
+    struct __gcm_siv_internal__ {
+        u8 nonce[GCM_IV_LEN];       // Nonce the per-message keys were derived from
+        u8 *polyval_table;          // 256x16 POLYVAL table for the derived authentication key
+        bool tag_ok;                // Result of the last decryption's tag check
+    } gcm_siv_internal;
+
 } ModeInternal;
 
 struct __ModeOfOperationContext__ {
@@ -106,10 +168,40 @@ struct __ModeOfOperationContext__ {
     ModeInternal mode_state;            // Internal state for the mode of operation
 };
 
-// static inline void clear_mode_ctx(ModeOfOperationContext *ctx) {
-//     if (ctx) memset(ctx, 0, sizeof(*ctx));
-// }
+static inline void clear_mode_ctx(ModeOfOperationContext *ctx) {
+    if (ctx) memset(ctx, 0, sizeof(*ctx));
+}
+
+/**
+ * @brief Allocate a cleared mode context with cryptomodule_alloc().
+ * @return The context, or NULL if memory is exhausted.
+ * @details For callers that create a context per connection: together with the pooled cipher
+ *          contexts and tables of the modes, setting up and tearing down a context does not reach
+ *          malloc once the pool is warm.
+ */
+ModeOfOperationContext *mode_ctx_new(void);
+
+/**
+ * @brief Dispose of a context of mode_ctx_new() (mode_dispose of its mode, if set) and release it.
+ * @param ctx The context; NULL is ignored.
+ */
+void mode_ctx_free(ModeOfOperationContext *ctx);
+
+/**
+ * @brief Get the API of a mode of operation.
+ * @param mode The mode (e.g., MODE_GCM).
+ * @return Pointer to the ModeOfOperationApi of the mode, or NULL if unknown.
+ * @details A lookup in a table indexed by mode_type_index(); resolve the mode once and keep the
+ *          pointer instead of looking it up by name per context.
+ */
+const ModeOfOperationApi *mode_get_api(ModeOfOperationType mode);
 
+/**
+ * @brief Get the API of a mode of operation by name ("ECB", "CBC", ..., "GCM-SIV").
+ * @return Pointer to the ModeOfOperationApi of the mode, or NULL if unknown.
+ * @details Kept for compatibility; the name is mapped to its ModeOfOperationType and looked up
+ *          with mode_get_api().
+ */
 const ModeOfOperationApi *mode_factory(const char *name);
 
 void print_mode_internal(const ModeOfOperationContext* ctx, const char* mode_type);
@@ -187,6 +279,27 @@ size_t iso7816_4_pad(u8 *buf, size_t data_len, size_t block_size);
  */
 size_t iso7816_4_unpad(u8 *buf, size_t buf_len, size_t block_size);
 
+/**
+ * @brief Pad the input buffer with the selected padding scheme.
+ * @param type Padding scheme (MODE_PADDING_NONE leaves the buffer untouched).
+ * @param buf Pointer to the buffer to be padded (room for data_len + block_size).
+ * @param data_len Length of the data in the buffer.
+ * @param block_size Block size for padding (e.g., 16 bytes for AES).
+ * @return Length of the padded buffer, or 0 on error
+ *         (MODE_PADDING_NONE with data_len not a multiple of block_size).
+ */
+size_t mode_pad(ModePaddingType type, u8 *buf, size_t data_len, size_t block_size);
+
+/**
+ * @brief Remove the selected padding scheme from the buffer.
+ * @param type Padding scheme (MODE_PADDING_NONE returns buf_len).
+ * @param buf Pointer to the buffer to be unpadded.
+ * @param buf_len Length of the padded buffer.
+ * @param block_size Block size for unpadding (e.g., 16 bytes for AES).
+ * @return Length of the unpadded buffer, or 0 on invalid padding.
+ */
+size_t mode_unpad(ModePaddingType type, u8 *buf, size_t buf_len, size_t block_size);
+
 // typedef enum {
 //     BLOCK_CIPHER_MODE_OK = 0,
 //     BLOCK_CIPHER_MODE_ERR_INVALID_INPUT,
@@ -15,6 +15,17 @@ extern "C" {
 
 const ModeOfOperationApi* get_ctr_api(void);
 
+/**
+ * @brief Position an initialized CTR context at an arbitrary byte offset of the stream.
+ * @param mode_ctx CTR mode context (after mode_init).
+ * @param byte_offset Offset in bytes from the start of the stream (the IV's first keystream byte).
+ * @details The counter is set to IV + floor(byte_offset / 16) with 128-bit arithmetic. For a
+ *          mid-block offset the keystream of that block is generated and the leading bytes are
+ *          skipped, so the next mode_process call starts exactly at byte_offset. This allows a
+ *          byte range of a large object to be decrypted without processing its prefix.
+ */
+void ctr_seek(ModeOfOperationContext *mode_ctx, u64 byte_offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,22 +1,22 @@
-// /* File: include/mode/mode_ecb.h */
+/* File: include/mode/mode_ecb.h */
 
-// #ifndef MODE_ECB_H
-// #define MODE_ECB_H
-// #include "api_mode.h"
-// #include "../block_cipher/api_block_cipher.h"
-// #include "../block_cipher/block_cipher_aes.h"
-// #include "../block_cipher/block_cipher_aria.h"
-// #include "../block_cipher/block_cipher_lea.h"
-// #include "../cryptomodule_utils.h"
+#ifndef MODE_ECB_H
+#define MODE_ECB_H
+#include "api_mode.h"
+#include "../block_cipher/api_block_cipher.h"
+#include "../block_cipher/block_cipher_aes.h"
+#include "../block_cipher/block_cipher_aria.h"
+#include "../block_cipher/block_cipher_lea.h"
+#include "../cryptomodule_utils.h"
 
-// #ifdef __cplusplus
-// extern "C" {
-// #endif
+#ifdef __cplusplus
+extern "C" {
+#endif
 
-// const ModeOfOperationApi* get_ecb_api(void);
+const ModeOfOperationApi* get_ecb_api(void);
 
 
-// #ifdef __cplusplus
-// }
-// #endif
-// #endif /* MODE_ECB_H */
\ No newline at end of file
+#ifdef __cplusplus
+}
+#endif
+#endif /* MODE_ECB_H */
@@ -12,6 +12,8 @@
 extern "C" {
 #endif
 
+#define GCM_TABLE_SIZE (256 * 16)   // Bytes of a GHASH/POLYVAL multiplication table
+
 /**
  * @brief R0 table for GCM mode.
  * @details This table is used in the GCM mode of operation for block ciphers.
@@ -62,9 +64,36 @@ static const u8 R1[256] = {
 };
 
 
+const ModeOfOperationApi* get_gcm_api(void);
+
+/**
+ * @brief Build the 256x16 multiplication table for H used by gf128_Hmul/ghash.
+ * @param HT Output table (4096 bytes).
+ * @param H Hash key (GHASH bit order).
+ */
+void gcm_init_table(u8 HT[256 * 16], const u8 H[16]);
 
+/**
+ * @brief Multiply state by H in GF(2^128) using the table from gcm_init_table.
+ */
+void gf128_Hmul(u8 state[16], const u8 HT[256 * 16], const u8 R0[256], const u8 R1[256]);
 
-const ModeOfOperationApi* get_gcm_api(void);
+/**
+ * @brief GHASH over msg_len 16-byte blocks, continuing from the state in tag (zero to start).
+ */
+void ghash(const u8* msg, size_t msg_len, const u8 HT[256 * 16], const u8 R0[256], const u8 R1[256], u8 tag[16]);
+
+/**
+ * @brief Build the table for POLYVAL with key H (RFC 8452), i.e. the GHASH table of
+ *        mulX_GHASH(ByteReverse(H)).
+ */
+void polyval_init_table(u8 HT[256 * 16], const u8 H[16]);
+
+/**
+ * @brief POLYVAL over msg_len 16-byte blocks, continuing from S (zero to start).
+ * @details Runs on the GHASH table code with every block byte-reversed (RFC 8452, Appendix A).
+ */
+void polyval(const u8* msg, size_t msg_len, const u8 HT[256 * 16], u8 S[16]);
 
 #ifdef __cplusplus
 }
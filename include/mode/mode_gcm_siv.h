@@ -0,0 +1,23 @@
+/* File: include/mode/mode_gcm_siv.h */
+
+#ifndef MODE_GCM_SIV_H
+#define MODE_GCM_SIV_H
+
+#include "api_mode.h"
+#include "../block_cipher/api_block_cipher.h"
+#include "../block_cipher/block_cipher_aes.h"
+#include "../block_cipher/block_cipher_aria.h"
+#include "../block_cipher/block_cipher_lea.h"
+#include "../cryptomodule_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const ModeOfOperationApi* get_gcm_siv_api(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MODE_GCM_SIV_H */
@@ -0,0 +1,73 @@
+/* File: include/mode/mode_kw.h */
+
+#ifndef MODE_KW_H
+#define MODE_KW_H
+
+#include "api_mode.h"
+#include "../block_cipher/api_block_cipher.h"
+
+/**
+ * @file mode_kw.h
+ * @brief Key Wrap KW (RFC 3394) and KWP (RFC 5649, with padding) per NIST SP 800-38F.
+ * @details Wrapping and unwrapping change the data length (8 bytes of integrity check value are
+ *          added), and unwrapping can fail, so these are plain functions with a status code rather
+ *          than a ModeOfOperationApi. The KEK cipher is selected by BlockCipherType.
+ *          kw_unwrap_batch unwraps many keys under one KEK and interleaves the 6n cipher calls of
+ *          up to KW_MAX_LANES wrapped keys, one block per key in every multi-block cipher call.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define KW_SEMIBLOCK_SIZE   8   /* KW works on 64-bit semiblocks */
+#define KW_MAX_LANES        8   /* Wrapped keys interleaved by kw_unwrap_batch */
+
+/**
+ * @brief Wrap in_len bytes with KW (in_len >= 16, multiple of 8) or KWP (padded, in_len >= 1).
+ * @param type Block cipher of the KEK (e.g., BLOCK_CIPHER_AES256).
+ * @param kek Key-encryption key; kek_len is 16, 24 or 32.
+ * @param in Key data to wrap.
+ * @param in_len Length of the key data in bytes.
+ * @param out Output buffer (KW: in_len + 8 bytes; KWP: in_len rounded up to 8, plus 8 bytes).
+ * @param out_len Receives the wrapped length.
+ * @param padded false for KW (RFC 3394), true for KWP (RFC 5649).
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t kw_wrap(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *in, size_t in_len, u8 *out, size_t *out_len, bool padded);
+
+/**
+ * @brief Unwrap and verify one wrapped key.
+ * @param out Output buffer of in_len - 8 bytes.
+ * @param out_len Receives the key length (for KWP the original, unpadded length).
+ * @return CRYPTOMODULE_OK, or CRYPTOMODULE_ERR_CRYPTO_FAILURE if the integrity check fails
+ *         (the output is cleared).
+ */
+cryptomodule_status_t kw_unwrap(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *in, size_t in_len, u8 *out, size_t *out_len, bool padded);
+
+/**
+ * @brief Unwrap num_keys independent wrapped keys under the same KEK.
+ * @param in Array of num_keys wrapped keys; in_lens their lengths.
+ * @param out Array of num_keys output buffers (each in_lens[i] - 8 bytes); out_lens receives
+ *            the key lengths.
+ * @param results Optional array of num_keys per-key statuses (may be NULL).
+ * @return CRYPTOMODULE_OK if every key unwrapped and verified, otherwise the first error
+ *         (failed keys are cleared and reported in results).
+ * @details The key schedule is built once. Keys are processed KW_MAX_LANES at a time, and the
+ *          unwrap steps of all keys in a group advance together, so each cipher call carries
+ *          one block per key instead of one block in total.
+ */
+cryptomodule_status_t kw_unwrap_batch(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *const *in, const size_t *in_lens, size_t num_keys,
+    u8 *const *out, size_t *out_lens,
+    cryptomodule_status_t *results, bool padded);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MODE_KW_H */
@@ -0,0 +1,41 @@
+/* File: include/mode/mode_xts.h */
+
+#ifndef MODE_XTS_H
+#define MODE_XTS_H
+
+#include "api_mode.h"
+#include "../block_cipher/api_block_cipher.h"
+#include "../block_cipher/block_cipher_aes.h"
+#include "../block_cipher/block_cipher_aria.h"
+#include "../block_cipher/block_cipher_lea.h"
+#include "../cryptomodule_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const ModeOfOperationApi* get_xts_api(void);
+
+/**
+ * @brief Encrypt or decrypt consecutive sectors (data units) in one call.
+ * @param mode_ctx XTS mode context (after mode_init).
+ * @param in Input data, num_sectors * sector_size bytes.
+ * @param out Output data, num_sectors * sector_size bytes (may equal in).
+ * @param sector_size Size of one data unit in bytes (at least 16; need not be a multiple of 16).
+ * @param num_sectors Number of sectors to process.
+ * @param first_sector Sector number of the first sector; sector i uses first_sector + i.
+ * @param dir Must match the direction given to mode_init.
+ * @details The tweak of each sector is E_K2(sector number) with the sector number encoded as a
+ *          128-bit little-endian value (IEEE 1619). Sector tweaks are encrypted in batches with
+ *          the multi-block cipher entry; each sector is then processed like mode_process.
+ */
+void xts_process_sectors(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out,
+    size_t sector_size, size_t num_sectors, u64 first_sector,
+    BlockCipherDirection dir);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* MODE_XTS_H */
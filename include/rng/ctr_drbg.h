@@ -0,0 +1,97 @@
+/* File: include/rng/ctr_drbg.h */
+
+#ifndef RNG_CTR_DRBG_H
+#define RNG_CTR_DRBG_H
+
+#include "../api_cryptomodule.h"
+#include "../block_cipher/api_block_cipher.h"
+#include "drbg.h"
+
+/**
+ * @file ctr_drbg.h
+ * @brief CTR_DRBG (NIST SP 800-90A Rev. 1, section 10.2.1) with AES-128/192/256.
+ * @details The output of a generate call is the AES encryption of V+1, V+2, ...; all counter
+ *          blocks of a request are laid out first and encrypted with one multi-block call, so the
+ *          four-way interleaved AES kernel runs over the whole request instead of one block at a
+ *          time. The Update step that follows every request costs a fixed three or four blocks,
+ *          which ctr_drbg_random_bytes amortizes by generating DRBG_THREAD_BUFFER_SIZE bytes at
+ *          once into a per-thread buffer. Each thread owns its instance, so nothing on that path
+ *          takes a lock; small requests such as GCM IVs are served with a copy from the buffer.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CTR_DRBG_BLOCK_SIZE     AES_BLOCK_SIZE
+#define CTR_DRBG_MAX_KEY_SIZE   AES256_KEY_SIZE
+#define CTR_DRBG_MAX_SEED_SIZE  (CTR_DRBG_MAX_KEY_SIZE + CTR_DRBG_BLOCK_SIZE)
+
+typedef struct __CtrDrbgContext__ {
+    BlockCipherContext cipher;  // AES keyed with Key
+    u8 v[CTR_DRBG_BLOCK_SIZE];  // Counter block V
+    size_t key_len;             // 16, 24 or 32
+    size_t seed_len;            // key_len + 16
+    bool use_df;                // Block_Cipher_df on the seed material and additional input
+    u64 reseed_counter;         // Generate calls since the last (re)seed, plus one
+    u64 reseed_interval;        // Reseed when reseed_counter exceeds this (may be lowered by the caller)
+    u64 fork_generation;        // drbg_fork_generation() at the last (re)seed
+    drbg_entropy_fn entropy;    // Entropy source
+    void *entropy_arg;
+    bool instantiated;
+} CtrDrbgContext;
+
+/**
+ * @brief Instantiate a CTR_DRBG.
+ * @param ctx DRBG context.
+ * @param key_len AES key length: 16, 24 or 32 bytes (security strength 128, 192 or 256).
+ * @param use_df Use the derivation function. Without it the entropy source must deliver full
+ *               entropy and seed_len bytes are requested; with it key_len entropy bytes and a
+ *               key_len / 2 byte nonce are requested in one call.
+ * @param entropy Entropy source (NULL for drbg_system_entropy).
+ * @param entropy_arg Argument passed to the entropy source.
+ * @param pers Personalization string (without df, at most seed_len bytes).
+ * @param pers_len Personalization string length in bytes.
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t ctr_drbg_instantiate(
+    CtrDrbgContext *ctx, size_t key_len, bool use_df,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len);
+
+/**
+ * @brief Reseed with fresh entropy and optional additional input.
+ */
+cryptomodule_status_t ctr_drbg_reseed(CtrDrbgContext *ctx, const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Generate out_len bytes (at most DRBG_MAX_REQUEST_SIZE).
+ * @details Reseeds first if the reseed interval is reached or the process has forked since the
+ *          last (re)seed.
+ */
+cryptomodule_status_t ctr_drbg_generate(
+    CtrDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Clear the DRBG state.
+ */
+void ctr_drbg_dispose(CtrDrbgContext *ctx);
+
+/**
+ * @brief Fill out with random bytes from the calling thread's AES-256 CTR_DRBG.
+ * @details The instance is created and seeded from the system entropy source on first use in
+ *          each thread, and reseeded after a fork. Requests of any length are accepted.
+ */
+cryptomodule_status_t ctr_drbg_random_bytes(u8 *out, size_t len);
+
+/**
+ * @brief Wipe the calling thread's DRBG state and buffered output (e.g. before the thread exits).
+ */
+void ctr_drbg_thread_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNG_CTR_DRBG_H */
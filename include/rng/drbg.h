@@ -0,0 +1,97 @@
+/* File: include/rng/drbg.h */
+
+#ifndef RNG_DRBG_H
+#define RNG_DRBG_H
+
+#include "../api_cryptomodule.h"
+
+/**
+ * @file drbg.h
+ * @brief Definitions shared by the SP 800-90A DRBGs: entropy sources, limits and fork detection.
+ * @details Each DRBG instance draws its entropy input (and nonce) from a drbg_entropy_fn, by
+ *          default drbg_system_entropy. An instance remembers the drbg_fork_generation() it was
+ *          seeded in; the counter is bumped in the child after every fork(), so a DRBG state
+ *          copied into a child process is reseeded before it produces any output, and the parent
+ *          and child never return the same bytes. The per-thread readers of all DRBGs serve small
+ *          requests from a DrbgThreadBuffer through drbg_buffered_read.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DRBG_MAX_REQUEST_SIZE           65536       /* Bytes per generate call (2^19 bits) */
+#define DRBG_MAX_INPUT_SIZE             (1 << 16)   /* Personalization / additional input bytes */
+#define DRBG_DEFAULT_RESEED_INTERVAL    (1ULL << 16)/* Generate calls between reseeds */
+#define DRBG_MAX_RESEED_INTERVAL        (1ULL << 48)
+#define DRBG_THREAD_BUFFER_SIZE         4096        /* Output buffered per thread */
+
+/** Hash function of HMAC_DRBG and Hash_DRBG (same order as HmacHashType). */
+typedef enum {
+    DRBG_SHA224 = 0,
+    DRBG_SHA256,
+    DRBG_SHA384,
+    DRBG_SHA512,
+} DrbgHashType;
+
+/**
+ * @brief Entropy source callback: fill out with len bytes of entropy input.
+ * @param arg Opaque argument given when the DRBG was instantiated.
+ * @return CRYPTOMODULE_OK or an error code (the DRBG operation then fails).
+ */
+typedef cryptomodule_status_t (*drbg_entropy_fn)(void *arg, u8 *out, size_t len);
+
+/**
+ * @brief Default entropy source: the operating system's random device.
+ * @param arg Unused.
+ */
+cryptomodule_status_t drbg_system_entropy(void *arg, u8 *out, size_t len);
+
+/**
+ * @brief Number of fork() calls this process descends from (0 in the original process).
+ * @details The first call registers the fork handler; it is a plain load afterwards.
+ */
+u64 drbg_fork_generation(void);
+
+/**
+ * @brief Output size in bytes of a DRBG hash (0 for an unknown type).
+ */
+size_t drbg_hash_size(DrbgHashType hash);
+
+/**
+ * @brief Highest security strength in bytes a DRBG hash supports (24 for SHA-224, 32 otherwise).
+ */
+size_t drbg_hash_strength(DrbgHashType hash);
+
+/**
+ * @brief Generate callback of a DRBG instance without additional input (len <= DRBG_MAX_REQUEST_SIZE).
+ */
+typedef cryptomodule_status_t (*drbg_generate_fn)(void *drbg, u8 *out, size_t len);
+
+/** Output generated ahead for one thread. */
+typedef struct __DrbgThreadBuffer__ {
+    u8 buf[DRBG_THREAD_BUFFER_SIZE];
+    size_t avail;               // Unread bytes at the end of buf
+} DrbgThreadBuffer;
+
+/**
+ * @brief Serve len bytes from the buffer, refilling it with one generate call of the whole buffer.
+ * @param seeded_generation The instance's fork generation; if it is stale the buffered bytes
+ *                          (generated before a fork) are dropped first.
+ * @details Requests of at least the buffer size are generated straight into out. Bytes are wiped
+ *          from the buffer as they are returned.
+ */
+cryptomodule_status_t drbg_buffered_read(DrbgThreadBuffer *tb, u64 seeded_generation,
+                                         drbg_generate_fn generate, void *drbg,
+                                         u8 *out, size_t len);
+
+/**
+ * @brief Zero len bytes in a way the compiler does not optimize away.
+ */
+void drbg_wipe(void *p, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNG_DRBG_H */
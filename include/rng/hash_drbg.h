@@ -0,0 +1,94 @@
+/* File: include/rng/hash_drbg.h */
+
+#ifndef RNG_HASH_DRBG_H
+#define RNG_HASH_DRBG_H
+
+#include "../api_cryptomodule.h"
+#include "../sha/sha2.h"
+#include "drbg.h"
+
+/**
+ * @file hash_drbg.h
+ * @brief Hash_DRBG (NIST SP 800-90A Rev. 1, section 10.1.1) with SHA-224/256/384/512.
+ * @details Hashgen hashes V, V + 1, V + 2, ... and seedlen (55 bytes for SHA-224/256, 111 for
+ *          SHA-384/512) is exactly one block less the padding, so every output block is a single
+ *          compression of a pre-padded block in which only the counter bytes change. For SHA-224/256
+ *          those blocks are independent of each other and run in the lanes of the multi-buffer
+ *          SHA-256 kernel. The state update at the end of a request (one hash and a few additions)
+ *          is paid once per request, and hash_drbg_random_bytes spreads it over a per-thread buffer
+ *          of DRBG_THREAD_BUFFER_SIZE bytes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HASH_DRBG_MAX_SEED_SIZE     111     /* seedlen of SHA-384/512 in bytes */
+
+typedef struct __HashDrbgContext__ {
+    u8 v[HASH_DRBG_MAX_SEED_SIZE];  // V (seed_len bytes)
+    u8 c[HASH_DRBG_MAX_SEED_SIZE];  // C (seed_len bytes)
+    DrbgHashType hash;
+    size_t out_len;                 // Digest size
+    size_t seed_len;                // 55 or 111
+    size_t strength;                // Security strength in bytes
+    u64 reseed_counter;             // Generate calls since the last (re)seed, plus one
+    u64 reseed_interval;            // Reseed when reseed_counter exceeds this (may be lowered by the caller)
+    u64 fork_generation;            // drbg_fork_generation() at the last (re)seed
+    drbg_entropy_fn entropy;        // Entropy source
+    void *entropy_arg;
+    bool instantiated;
+} HashDrbgContext;
+
+/**
+ * @brief Instantiate a Hash_DRBG.
+ * @param ctx DRBG context.
+ * @param hash DRBG_SHA224, DRBG_SHA256, DRBG_SHA384 or DRBG_SHA512.
+ * @param entropy Entropy source (NULL for drbg_system_entropy); it is asked for the entropy input
+ *                and the nonce in one call (1.5 times the security strength).
+ * @param entropy_arg Argument passed to the entropy source.
+ * @param pers Personalization string (may be NULL).
+ * @param pers_len Personalization string length in bytes.
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t hash_drbg_instantiate(
+    HashDrbgContext *ctx, DrbgHashType hash,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len);
+
+/**
+ * @brief Reseed with fresh entropy and optional additional input.
+ */
+cryptomodule_status_t hash_drbg_reseed(HashDrbgContext *ctx, const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Generate out_len bytes (at most DRBG_MAX_REQUEST_SIZE).
+ * @details Reseeds first if the reseed interval is reached or the process has forked since the
+ *          last (re)seed.
+ */
+cryptomodule_status_t hash_drbg_generate(
+    HashDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Clear the DRBG state.
+ */
+void hash_drbg_dispose(HashDrbgContext *ctx);
+
+/**
+ * @brief Fill out with random bytes from the calling thread's Hash_DRBG (SHA-256).
+ * @details The instance is created and seeded from the system entropy source on first use in
+ *          each thread, and reseeded after a fork. Requests of any length are accepted.
+ */
+cryptomodule_status_t hash_drbg_random_bytes(u8 *out, size_t len);
+
+/**
+ * @brief Wipe the calling thread's Hash_DRBG state and buffered output.
+ */
+void hash_drbg_thread_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNG_HASH_DRBG_H */
@@ -0,0 +1,90 @@
+/* File: include/rng/hmac_drbg.h */
+
+#ifndef RNG_HMAC_DRBG_H
+#define RNG_HMAC_DRBG_H
+
+#include "../api_cryptomodule.h"
+#include "../mac/hmac.h"
+#include "drbg.h"
+
+/**
+ * @file hmac_drbg.h
+ * @brief HMAC_DRBG (NIST SP 800-90A Rev. 1, section 10.1.2) with SHA-224/256/384/512.
+ * @details The key K only changes in the Update step, so the context keeps an HMAC context keyed
+ *          with K, and the ipad/opad midstates serve every V = HMAC(K, V) of a request. V is one
+ *          digest long, so each of those HMACs is two compressions on blocks whose padding is laid
+ *          out once per request. The Update step (two or four HMACs plus two key setups) is paid
+ *          once per request, and hmac_drbg_random_bytes spreads it over a per-thread buffer of
+ *          DRBG_THREAD_BUFFER_SIZE bytes.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct __HmacDrbgContext__ {
+    HmacContext key;            // HMAC keyed with K
+    u8 v[HMAC_MAX_MAC_SIZE];    // V (out_len bytes)
+    DrbgHashType hash;
+    size_t out_len;             // Digest size
+    size_t strength;            // Security strength in bytes
+    u64 reseed_counter;         // Generate calls since the last (re)seed, plus one
+    u64 reseed_interval;        // Reseed when reseed_counter exceeds this (may be lowered by the caller)
+    u64 fork_generation;        // drbg_fork_generation() at the last (re)seed
+    drbg_entropy_fn entropy;    // Entropy source
+    void *entropy_arg;
+    bool instantiated;
+} HmacDrbgContext;
+
+/**
+ * @brief Instantiate an HMAC_DRBG.
+ * @param ctx DRBG context.
+ * @param hash DRBG_SHA224, DRBG_SHA256, DRBG_SHA384 or DRBG_SHA512.
+ * @param entropy Entropy source (NULL for drbg_system_entropy); it is asked for the entropy input
+ *                and the nonce in one call (1.5 times the security strength).
+ * @param entropy_arg Argument passed to the entropy source.
+ * @param pers Personalization string (may be NULL).
+ * @param pers_len Personalization string length in bytes.
+ * @return CRYPTOMODULE_OK or an error code.
+ */
+cryptomodule_status_t hmac_drbg_instantiate(
+    HmacDrbgContext *ctx, DrbgHashType hash,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len);
+
+/**
+ * @brief Reseed with fresh entropy and optional additional input.
+ */
+cryptomodule_status_t hmac_drbg_reseed(HmacDrbgContext *ctx, const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Generate out_len bytes (at most DRBG_MAX_REQUEST_SIZE).
+ * @details Reseeds first if the reseed interval is reached or the process has forked since the
+ *          last (re)seed.
+ */
+cryptomodule_status_t hmac_drbg_generate(
+    HmacDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len);
+
+/**
+ * @brief Clear the DRBG state.
+ */
+void hmac_drbg_dispose(HmacDrbgContext *ctx);
+
+/**
+ * @brief Fill out with random bytes from the calling thread's HMAC_DRBG (SHA-256).
+ * @details The instance is created and seeded from the system entropy source on first use in
+ *          each thread, and reseeded after a fork. Requests of any length are accepted.
+ */
+cryptomodule_status_t hmac_drbg_random_bytes(u8 *out, size_t len);
+
+/**
+ * @brief Wipe the calling thread's HMAC_DRBG state and buffered output.
+ */
+void hmac_drbg_thread_cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RNG_HMAC_DRBG_H */
@@ -9,10 +9,209 @@
 
 #include "../api_cryptomodule.h"
 
+/**
+ * @file sha2.h
+ * @brief SHA-224/256/384/512 (FIPS 180-4), one-shot and incremental.
+ * @details The incremental API follows liboqs, except that every context is a plain struct the
+ *          caller places on the stack: init, update and finalize never allocate, and clone is a
+ *          copy. The chaining value is kept as big-endian bytes followed by a 64-bit byte counter,
+ *          the layout the block functions crypto_hashblocks_sha256/512 work on directly.
+ */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define SHA2_SHA224_DIGEST_SIZE     28
+#define SHA2_SHA256_DIGEST_SIZE     32
+#define SHA2_SHA384_DIGEST_SIZE     48
+#define SHA2_SHA512_DIGEST_SIZE     64
+
+#define SHA2_SHA256_BLOCK_SIZE      64
+#define SHA2_SHA512_BLOCK_SIZE      128
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SHA2_HAVE_X86               1   /* x86 backends (built with per-function target attributes) */
+#else
+#define SHA2_HAVE_X86               0
+#endif
+
+#define SHA2_SHA256_STATE_BYTES     40  /* 8 x 32-bit chaining value || 64-bit byte count */
+#define SHA2_SHA512_STATE_BYTES     72  /* 8 x 64-bit chaining value || 64-bit byte count */
+
+/** Incremental SHA-256 state; also used by SHA-224. */
+typedef struct __SHA2_sha256_ctx__ {
+    u8 ctx[SHA2_SHA256_STATE_BYTES];    // Chaining value and processed byte count
+    u8 data[SHA2_SHA256_BLOCK_SIZE];    // Pending partial block
+    size_t data_len;                    // Number of bytes in data
+} SHA2_sha256_ctx;
+
+/** Incremental SHA-512 state; also used by SHA-384. */
+typedef struct __SHA2_sha512_ctx__ {
+    u8 ctx[SHA2_SHA512_STATE_BYTES];    // Chaining value and processed byte count
+    u8 data[SHA2_SHA512_BLOCK_SIZE];    // Pending partial block
+    size_t data_len;                    // Number of bytes in data
+} SHA2_sha512_ctx;
+
+typedef SHA2_sha256_ctx SHA2_sha224_ctx;
+typedef SHA2_sha512_ctx SHA2_sha384_ctx;
+
+/**
+ * @brief Run the SHA-256 compression function over the whole 64-byte blocks of in.
+ * @param statebytes 32-byte big-endian chaining value, updated in place (the byte count is not touched).
+ * @return The number of trailing bytes that did not form a whole block.
+ */
+size_t crypto_hashblocks_sha256(u8 *statebytes, const u8 *in, size_t inlen);
+
+/**
+ * @brief Run the SHA-512 compression function over the whole 128-byte blocks of in.
+ * @param statebytes 64-byte big-endian chaining value, updated in place (the byte count is not touched).
+ * @return The number of trailing bytes that did not form a whole block.
+ */
+size_t crypto_hashblocks_sha512(u8 *statebytes, const u8 *in, size_t inlen);
+
+/**
+ * @brief Build the final block(s) of a message: trailing bytes, 0x80, zeros and the bit length.
+ * @param padded Output buffer of 128 bytes.
+ * @param in The trailing inlen bytes of the message (inlen < 64).
+ * @param bytes Total message length in bytes.
+ * @return The number of padded bytes (64 or 128).
+ */
+size_t SHA2_sha256_pad(u8 *padded, const u8 *in, size_t inlen, u64 bytes);
+
+/**
+ * @brief SHA-512 counterpart of SHA2_sha256_pad (inlen < 128; output buffer of 256 bytes).
+ * @return The number of padded bytes (128 or 256).
+ */
+size_t SHA2_sha512_pad(u8 *padded, const u8 *in, size_t inlen, u64 bytes);
+
+/** SHA-256 round constants K[0..63], shared by the vector backends. */
+extern const u32 sha2_sha256_k[64];
+
+/** SHA-512 round constants K[0..79], shared by the vector backends. */
+extern const u64 sha2_sha512_k[80];
+
+/** Implementations of the block functions. */
+typedef enum {
+    SHA2_BACKEND_C = 0,     // Portable C (always available)
+    SHA2_BACKEND_SHA_NI,    // x86 SHA extensions (SHA-256 only)
+    SHA2_BACKEND_AVX2,      // Multi-buffer SHA-256 (8 lanes); SHA-512 message schedule
+    SHA2_BACKEND_AVX512,    // 16 lanes of 32-bit words (multi-buffer SHA-256)
+} SHA2_backend_t;
+
+/**
+ * @brief Select the fastest backend the CPU supports (CPUID); called by cryptomodule_init.
+ * @details Calling it is optional: the first hash selects the backend on its own.
+ */
+void SHA2_init_dispatch(void);
+
+/**
+ * @brief Force the SHA-256 backend (e.g., to compare backends against each other).
+ * @return false, leaving the selection unchanged, if the backend is not supported on this CPU.
+ */
+bool SHA2_sha256_set_backend(SHA2_backend_t backend);
+
+/** @brief The SHA-256 backend currently in use. */
+SHA2_backend_t SHA2_sha256_get_backend(void);
+
+/** @brief Select the SHA-256 backend from CPUID, leaving SHA-512 and the multi-buffer path alone. */
+void SHA2_sha256_init_dispatch(void);
+
+/**
+ * @brief Force the SHA-512/384 backend (SHA2_BACKEND_C or SHA2_BACKEND_AVX2).
+ * @return false, leaving the selection unchanged, if the backend is not supported on this CPU.
+ */
+bool SHA2_sha512_set_backend(SHA2_backend_t backend);
+
+/** @brief The SHA-512/384 backend currently in use. */
+SHA2_backend_t SHA2_sha512_get_backend(void);
+
+/** @brief Select the SHA-512/384 backend from CPUID, leaving the SHA-256 backends alone. */
+void SHA2_sha512_init_dispatch(void);
+
+/**
+ * @brief Whether the CPU supports the SHA extensions (and the SSSE3/SSE4.1 they are used with).
+ * @details The sha2_cpu_has functions read the features cached by cryptomodule_cpu_features(), so
+ *          they are cheap enough to call per operation and honour masked features.
+ */
+bool sha2_cpu_has_sha_ni(void);
+
+/** @brief Whether the CPU and OS support AVX2. */
+bool sha2_cpu_has_avx2(void);
+
+/** @brief Whether the CPU and OS support AVX-512F and AVX-512BW. */
+bool sha2_cpu_has_avx512(void);
+
+#if SHA2_HAVE_X86
+/** @brief SHA-NI version of crypto_hashblocks_sha256; only call it if sha2_cpu_has_sha_ni(). */
+size_t crypto_hashblocks_sha256_ni(u8 *statebytes, const u8 *in, size_t inlen);
+
+/**
+ * @brief SHA-512 compression of pairs of blocks with the AVX2 schedule; only call it if sha2_cpu_has_avx2().
+ * @return The number of trailing bytes that did not form a pair of blocks (a single block is left
+ *         for the caller, since scheduling it alone is slower than the C path).
+ */
+size_t crypto_hashblocks_sha512_avx2_x2(u8 *statebytes, const u8 *in, size_t inlen);
+#endif
+
+#define SHA2_SHA256_MB_MAX_LANES    16  /* Widest multi-buffer backend (AVX-512) */
+
+/**
+ * @brief Hash num independent messages with SHA-256 (multi-buffer).
+ *
+ * @details The messages are spread over SIMD lanes (8 with AVX2, 16 with AVX-512) that each
+ * hash a different message; a lane whose message is done takes the next one, so lengths may
+ * differ freely. Without a suitable backend the messages are hashed one after another.
+ *
+ * @param out Output array of num * 32 bytes; digest i is written at out + 32 * i
+ * @param in Array of num message pointers
+ * @param inlen Array of num message lengths in bytes
+ * @param num The number of messages
+ */
+void SHA2_sha256_multi(u8 *out, const u8 *const *in, const size_t *inlen, size_t num);
+
+/**
+ * @brief Select the multi-buffer backend from CPUID; called by SHA2_init_dispatch.
+ */
+void SHA2_sha256_multi_init_dispatch(void);
+
+/**
+ * @brief Force the multi-buffer backend (SHA2_BACKEND_C, SHA2_BACKEND_AVX2 or SHA2_BACKEND_AVX512).
+ * @return false, leaving the selection unchanged, if the backend is not supported on this CPU.
+ */
+bool SHA2_sha256_multi_set_backend(SHA2_backend_t backend);
+
+/** @brief The multi-buffer backend currently in use. */
+SHA2_backend_t SHA2_sha256_multi_get_backend(void);
+
+/** @brief Number of lanes of the multi-buffer backend in use (16, 8, or 1 without one). */
+size_t SHA2_sha256_multi_lanes(void);
+
+/**
+ * @brief One SHA-256 compression in each of lanes independent states, on transposed words.
+ *
+ * @details This is the multi-buffer kernel without the message gathering, for callers that
+ * build their blocks as words (e.g. PBKDF2, where each digest is the next message). With lanes
+ * equal to SHA2_sha256_multi_lanes() the SIMD kernel runs; any other count is processed one lane
+ * at a time.
+ *
+ * @param state Chaining values, word j of lane l at state[j * lanes + l]; updated in place
+ * @param words Message words (already converted from big-endian), word t of lane l at words[t * lanes + l]
+ * @param lanes The number of lanes
+ */
+void SHA2_sha256_multi_compress(u32 *state, const u32 *words, size_t lanes);
+
+/**
+ * @brief Process a message with SHA-224 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 28 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA2_sha224(u8 *output, const u8 *input, size_t inplen);
+
 /**
  * @brief Process a message with SHA-256 and return the hash code in the output byte array.
  *
@@ -24,209 +223,182 @@ extern "C" {
  */
 void SHA2_sha256(u8 *output, const u8 *input, size_t inplen);
 
-// /**
-//  * \brief Allocate and initialize the state for the SHA-256 incremental hashing API.
-//  *
-//  * \warning The state must be released by OQS_SHA2_sha256_inc_finalize
-//  * or OQS_SHA2_sha256_inc_ctx_release.
-//  *
-//  * \param state Pointer to the state
-//  */
-// void OQS_SHA2_sha256_inc_init(OQS_SHA2_sha256_ctx *state);
-
-// /**
-//  * \brief Duplicate state for the SHA-256 incremental hashing API.
-//  *
-//  * \warning dest must be allocated by the caller. Caller is responsible
-//  * for releasing dest by calling either OQS_SHA2_sha256_inc_finalize or
-//  * OQS_SHA2_sha256_inc_ctx_release.
-//  *
-//  * \param dest The function state to copy into; must be initialized
-//  * \param src The function state to copy; must be initialized
-//  */
-// void OQS_SHA2_sha256_inc_ctx_clone(OQS_SHA2_sha256_ctx *dest, const OQS_SHA2_sha256_ctx *src);
-
-// /**
-//  * \brief Process blocks with SHA-256 and update the state.
-//  *
-//  * \warning The state must be initialized by OQS_SHA2_sha256_inc_init or OQS_SHA2_sha256_inc_ctx_clone.
-//  *
-//  * \param state The state to update
-//  * \param in Message input byte array
-//  * \param inblocks The number of 64-byte blocks of message bytes to process
-//  */
-// void OQS_SHA2_sha256_inc_blocks(OQS_SHA2_sha256_ctx *state, const u8 *in, size_t inblocks);
-
-// /**
-//  * \brief Process message bytes with SHA-256 and update the state.
-//  *
-//  * \warning The state must be initialized by OQS_SHA2_sha256_inc_init or OQS_SHA2_sha256_inc_ctx_clone.
-//  *
-//  * \param state The state to update
-//  * \param in Message input byte array
-//  * \param len The number of bytes of message to process
-//  */
-// void OQS_SHA2_sha256_inc(OQS_SHA2_sha256_ctx *state, const u8 *in, size_t len);
-
-// /**
-//  * \brief Process more message bytes with SHA-256 and return the hash code in the output byte array.
-//  *
-//  * \warning The output array must be at least 32 bytes in length. The state is
-//  * deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha256_inc_init again.
-//  *
-//  * \param out The output byte array
-//  * \param state The state
-//  * \param in Additional message input byte array
-//  * \param inlen The number of additional message bytes to process
-//  */
-// void OQS_SHA2_sha256_inc_finalize(u8 *out, OQS_SHA2_sha256_ctx *state, const u8 *in, size_t inlen);
-
-// /**
-//  * \brief Destroy state.
-//  *
-//  * \warning The state is deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha256_inc_init again.
-//  *
-//  * \param state The state
-//  */
-// void OQS_SHA2_sha256_inc_ctx_release(OQS_SHA2_sha256_ctx *state);
-
-// /**
-//  * \brief Process a message with SHA-384 and return the hash code in the output byte array.
-//  *
-//  * \warning The output array must be at least 48 bytes in length.
-//  *
-//  * \param output The output byte array
-//  * \param input The message input byte array
-//  * \param inplen The number of message bytes to process
-//  */
-// void OQS_SHA2_sha384(u8 *output, const u8 *input, size_t inplen);
-
-// /**
-//  * \brief Allocate and initialize the state for the SHA-384 incremental hashing API.
-//  *
-//  * \warning The state must be released by OQS_SHA2_sha384_inc_finalize
-//  * or OQS_SHA2_sha384_inc_ctx_release.
-//  *
-//  * \param state Pointer to the state
-//  */
-// void OQS_SHA2_sha384_inc_init(OQS_SHA2_sha384_ctx *state);
-
-// /**
-//  * \brief Duplicate state for the SHA-384 incremental hashing API.
-//  *
-//  * \warning dest must be allocated by the caller. Caller is responsible
-//  * for releasing dest by calling either OQS_SHA2_sha384_inc_finalize or
-//  * OQS_SHA2_sha384_inc_ctx_release.
-//  *
-//  * \param dest The function state to copy into; must be initialized
-//  * \param src The function state to copy; must be initialized
-//  */
-// void OQS_SHA2_sha384_inc_ctx_clone(OQS_SHA2_sha384_ctx *dest, const OQS_SHA2_sha384_ctx *src);
-
-// /**
-//  * \brief Process blocks with SHA-384 and update the state.
-//  *
-//  * \warning The state must be initialized by OQS_SHA2_sha384_inc_init or OQS_SHA2_sha384_inc_ctx_clone.
-//  *
-//  * \param state The state to update
-//  * \param in Message input byte array
-//  * \param inblocks The number of 128-byte blocks of message bytes to process
-//  */
-// void OQS_SHA2_sha384_inc_blocks(OQS_SHA2_sha384_ctx *state, const u8 *in, size_t inblocks);
-
-// /**
-//  * \brief Process more message bytes with SHA-384 and return the hash code in the output byte array.
-//  *
-//  * \warning The output array must be at least 48 bytes in length. The state is
-//  * deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha384_inc_init again.
-//  *
-//  * \param out The output byte array
-//  * \param state The state
-//  * \param in Additional message input byte array
-//  * \param inlen The number of additional message bytes to process
-//  */
-// void OQS_SHA2_sha384_inc_finalize(u8 *out, OQS_SHA2_sha384_ctx *state, const u8 *in, size_t inlen);
-
-// /**
-//  * \brief Destroy state.
-//  *
-//  * \warning The state is deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha384_inc_init again.
-//  *
-//  * \param state The state
-//  */
-// void OQS_SHA2_sha384_inc_ctx_release(OQS_SHA2_sha384_ctx *state);
-
-// /**
-//  * \brief Process a message with SHA-512 and return the hash code in the output byte array.
-//  *
-//  * \warning The output array must be at least 64 bytes in length.
-//  *
-//  * \param output The output byte array
-//  * \param input The message input byte array
-//  * \param inplen The number of message bytes to process
-//  */
-// void OQS_SHA2_sha512(u8 *output, const u8 *input, size_t inplen);
-
-// /**
-//  * \brief Allocate and initialize the state for the SHA-512 incremental hashing API.
-//  *
-//  * \warning The state must be released by OQS_SHA2_sha512_inc_finalize
-//  * or OQS_SHA2_sha512_inc_ctx_release.
-//  *
-//  * \param state Pointer to the state
-//  */
-// void OQS_SHA2_sha512_inc_init(OQS_SHA2_sha512_ctx *state);
-
-// /**
-//  * \brief Duplicate state for the SHA-512 incremental hashing API.
-//  *
-//  * \warning dest must be allocated by the caller. Caller is responsible
-//  * for releasing dest by calling either OQS_SHA2_sha512_inc_finalize or
-//  * OQS_SHA2_sha512_inc_ctx_release.
-//  *
-//  * \param dest The function state to copy into; must be initialized
-//  * \param src The function state to copy; must be initialized
-//  */
-// void OQS_SHA2_sha512_inc_ctx_clone(OQS_SHA2_sha512_ctx *dest, const OQS_SHA2_sha512_ctx *src);
-
-// /**
-//  * \brief Process blocks with SHA-512 and update the state.
-//  *
-//  * \warning The state must be initialized by OQS_SHA2_sha512_inc_init or OQS_SHA2_sha512_inc_ctx_clone.
-//  *
-//  * \param state The state to update
-//  * \param in Message input byte array
-//  * \param inblocks The number of 128-byte blocks of message bytes to process
-//  */
-// void OQS_SHA2_sha512_inc_blocks(OQS_SHA2_sha512_ctx *state, const u8 *in, size_t inblocks);
-
-// /**
-//  * \brief Process more message bytes with SHA-512 and return the hash code in the output byte array.
-//  *
-//  * \warning The output array must be at least 64 bytes in length. The state is
-//  * deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha512_inc_init again.
-//  *
-//  * \param out The output byte array
-//  * \param state The state
-//  * \param in Additional message input byte array
-//  * \param inlen The number of additional message bytes to process
-//  */
-// void OQS_SHA2_sha512_inc_finalize(u8 *out, OQS_SHA2_sha512_ctx *state, const u8 *in, size_t inlen);
-
-// /**
-//  * \brief Destroy state.
-//  *
-//  * \warning The state is deallocated by this function and can not be used again after calling
-//  * this function without calling OQS_SHA2_sha512_inc_init again.
-//  *
-//  * \param state The state
-//  */
-// void OQS_SHA2_sha512_inc_ctx_release(OQS_SHA2_sha512_ctx *state);
+/**
+ * @brief Process a message with SHA-384 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 48 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA2_sha384(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHA-512 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 64 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA2_sha512(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Initialize the state for the SHA-256 incremental hashing API.
+ *
+ * @param state Pointer to the caller-provided state
+ */
+void SHA2_sha256_inc_init(SHA2_sha256_ctx *state);
+
+/**
+ * @brief Duplicate state for the SHA-256 incremental hashing API.
+ *
+ * @details Both states can be continued independently afterwards, e.g. to finish several
+ * messages that share a common prefix.
+ *
+ * @param dest The state to copy into
+ * @param src The state to copy; must be initialized
+ */
+void SHA2_sha256_inc_ctx_clone(SHA2_sha256_ctx *dest, const SHA2_sha256_ctx *src);
+
+/**
+ * @brief Process blocks with SHA-256 and update the state.
+ *
+ * @warning The state must be initialized by SHA2_sha256_inc_init or SHA2_sha256_inc_ctx_clone.
+ *
+ * @param state The state to update
+ * @param in Message input byte array
+ * @param inblocks The number of 64-byte blocks of message bytes to process
+ */
+void SHA2_sha256_inc_blocks(SHA2_sha256_ctx *state, const u8 *in, size_t inblocks);
+
+/**
+ * @brief Process message bytes with SHA-256 and update the state.
+ *
+ * @warning The state must be initialized by SHA2_sha256_inc_init or SHA2_sha256_inc_ctx_clone.
+ *
+ * @param state The state to update
+ * @param in Message input byte array
+ * @param len The number of bytes of message to process
+ */
+void SHA2_sha256_inc(SHA2_sha256_ctx *state, const u8 *in, size_t len);
+
+/**
+ * @brief Process more message bytes with SHA-256 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 32 bytes in length. The state is wiped by this
+ * function and can not be used again without calling SHA2_sha256_inc_init again.
+ *
+ * @param out The output byte array
+ * @param state The state
+ * @param in Additional message input byte array (may be NULL if inlen is 0)
+ * @param inlen The number of additional message bytes to process
+ */
+void SHA2_sha256_inc_finalize(u8 *out, SHA2_sha256_ctx *state, const u8 *in, size_t inlen);
+
+/**
+ * @brief Destroy state.
+ *
+ * @details Wipes the state; needed only for states that are abandoned without being finalized.
+ *
+ * @param state The state
+ */
+void SHA2_sha256_inc_ctx_release(SHA2_sha256_ctx *state);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc_init. */
+void SHA2_sha224_inc_init(SHA2_sha224_ctx *state);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc_ctx_clone. */
+void SHA2_sha224_inc_ctx_clone(SHA2_sha224_ctx *dest, const SHA2_sha224_ctx *src);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc_blocks (64-byte blocks). */
+void SHA2_sha224_inc_blocks(SHA2_sha224_ctx *state, const u8 *in, size_t inblocks);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc. */
+void SHA2_sha224_inc(SHA2_sha224_ctx *state, const u8 *in, size_t len);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc_finalize; out must hold 28 bytes. */
+void SHA2_sha224_inc_finalize(u8 *out, SHA2_sha224_ctx *state, const u8 *in, size_t inlen);
+
+/** @brief SHA-224 counterpart of SHA2_sha256_inc_ctx_release. */
+void SHA2_sha224_inc_ctx_release(SHA2_sha224_ctx *state);
+
+/**
+ * @brief Initialize the state for the SHA-512 incremental hashing API.
+ *
+ * @param state Pointer to the caller-provided state
+ */
+void SHA2_sha512_inc_init(SHA2_sha512_ctx *state);
+
+/**
+ * @brief Duplicate state for the SHA-512 incremental hashing API.
+ *
+ * @param dest The state to copy into
+ * @param src The state to copy; must be initialized
+ */
+void SHA2_sha512_inc_ctx_clone(SHA2_sha512_ctx *dest, const SHA2_sha512_ctx *src);
+
+/**
+ * @brief Process blocks with SHA-512 and update the state.
+ *
+ * @warning The state must be initialized by SHA2_sha512_inc_init or SHA2_sha512_inc_ctx_clone.
+ *
+ * @param state The state to update
+ * @param in Message input byte array
+ * @param inblocks The number of 128-byte blocks of message bytes to process
+ */
+void SHA2_sha512_inc_blocks(SHA2_sha512_ctx *state, const u8 *in, size_t inblocks);
+
+/**
+ * @brief Process message bytes with SHA-512 and update the state.
+ *
+ * @warning The state must be initialized by SHA2_sha512_inc_init or SHA2_sha512_inc_ctx_clone.
+ *
+ * @param state The state to update
+ * @param in Message input byte array
+ * @param len The number of bytes of message to process
+ */
+void SHA2_sha512_inc(SHA2_sha512_ctx *state, const u8 *in, size_t len);
+
+/**
+ * @brief Process more message bytes with SHA-512 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 64 bytes in length. The state is wiped by this
+ * function and can not be used again without calling SHA2_sha512_inc_init again.
+ *
+ * @param out The output byte array
+ * @param state The state
+ * @param in Additional message input byte array (may be NULL if inlen is 0)
+ * @param inlen The number of additional message bytes to process
+ */
+void SHA2_sha512_inc_finalize(u8 *out, SHA2_sha512_ctx *state, const u8 *in, size_t inlen);
+
+/**
+ * @brief Destroy state.
+ *
+ * @param state The state
+ */
+void SHA2_sha512_inc_ctx_release(SHA2_sha512_ctx *state);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc_init. */
+void SHA2_sha384_inc_init(SHA2_sha384_ctx *state);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc_ctx_clone. */
+void SHA2_sha384_inc_ctx_clone(SHA2_sha384_ctx *dest, const SHA2_sha384_ctx *src);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc_blocks (128-byte blocks). */
+void SHA2_sha384_inc_blocks(SHA2_sha384_ctx *state, const u8 *in, size_t inblocks);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc. */
+void SHA2_sha384_inc(SHA2_sha384_ctx *state, const u8 *in, size_t len);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc_finalize; out must hold 48 bytes. */
+void SHA2_sha384_inc_finalize(u8 *out, SHA2_sha384_ctx *state, const u8 *in, size_t inlen);
+
+/** @brief SHA-384 counterpart of SHA2_sha512_inc_ctx_release. */
+void SHA2_sha384_inc_ctx_release(SHA2_sha384_ctx *state);
 
 #ifdef __cplusplus
 } // extern "C"
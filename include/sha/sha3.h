@@ -0,0 +1,342 @@
+/* FILE: include/sha/sha3.h*/
+/** SHA3 API
+ * References: https://github.com/open-quantum-safe/liboqs
+ */
+
+
+#ifndef SHA3_H
+#define SHA3_H
+
+#include "../api_cryptomodule.h"
+
+/**
+ * @file sha3.h
+ * @brief SHA3-224/256/384/512 and the SHAKE128/256 extendable-output functions (FIPS 202),
+ *        single-stream and four messages at once.
+ * @details All functions share one sponge context: init selects the rate and the domain
+ *          separation byte, absorb may be called any number of times, and finalize pads the
+ *          message. SHA-3 finalize writes the fixed-length digest; SHAKE finalize switches the
+ *          context to squeezing, after which squeeze may be called any number of times with any
+ *          output length. Like the SHA-2 contexts, the context lives on the caller's stack.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHA3_SHA3_224_DIGEST_SIZE   28
+#define SHA3_SHA3_256_DIGEST_SIZE   32
+#define SHA3_SHA3_384_DIGEST_SIZE   48
+#define SHA3_SHA3_512_DIGEST_SIZE   64
+
+#define SHA3_SHA3_224_RATE          144     /* Rate in bytes: 200 - 2 * digest size */
+#define SHA3_SHA3_256_RATE          136
+#define SHA3_SHA3_384_RATE          104
+#define SHA3_SHA3_512_RATE          72
+#define SHA3_SHAKE128_RATE          168
+#define SHA3_SHAKE256_RATE          136
+
+#define SHA3_KECCAK_LANES           25      /* 5 x 5 lanes of 64 bits */
+
+/** Incremental SHA-3 / SHAKE state. */
+typedef struct __SHA3_ctx__ {
+    u64 s[SHA3_KECCAK_LANES];   // Keccak state, lane (x, y) at s[x + 5y]
+    u32 rate;                   // Rate in bytes
+    u32 pos;                    // Bytes absorbed into the current block, or squeezed from it
+    u32 outlen;                 // Digest size (SHA-3), 0 for SHAKE
+    u8 dsbyte;                  // Domain separation bits and the first padding bit
+    bool squeezing;             // Set by SHAKE finalize
+} SHA3_ctx;
+
+/** Keccak-f[1600] round constants, shared by the vector backends. */
+extern const u64 sha3_keccak_rc[24];
+
+/**
+ * @brief Apply the Keccak-f[1600] permutation to a state (lane (x, y) at s[x + 5y]).
+ */
+void SHA3_keccakf1600(u64 *s);
+
+/**
+ * @brief Process a message with SHA3-224 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 28 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_sha3_224(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHA3-256 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 32 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_sha3_256(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHA3-384 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 48 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_sha3_384(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHA3-512 and return the hash code in the output byte array.
+ *
+ * @warning The output array must be at least 64 bytes in length.
+ *
+ * @param output The output byte array
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_sha3_512(u8 *output, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHAKE128 and write outlen bytes of output.
+ *
+ * @param output The output byte array of outlen bytes
+ * @param outlen The number of output bytes
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_shake128(u8 *output, size_t outlen, const u8 *input, size_t inplen);
+
+/**
+ * @brief Process a message with SHAKE256 and write outlen bytes of output.
+ *
+ * @param output The output byte array of outlen bytes
+ * @param outlen The number of output bytes
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_shake256(u8 *output, size_t outlen, const u8 *input, size_t inplen);
+
+/** @brief Initialize the context for an incremental SHA3-224 computation. */
+void SHA3_sha3_224_inc_init(SHA3_ctx *state);
+
+/** @brief Initialize the context for an incremental SHA3-256 computation. */
+void SHA3_sha3_256_inc_init(SHA3_ctx *state);
+
+/** @brief Initialize the context for an incremental SHA3-384 computation. */
+void SHA3_sha3_384_inc_init(SHA3_ctx *state);
+
+/** @brief Initialize the context for an incremental SHA3-512 computation. */
+void SHA3_sha3_512_inc_init(SHA3_ctx *state);
+
+/** @brief Initialize the context for an incremental SHAKE128 computation. */
+void SHA3_shake128_inc_init(SHA3_ctx *state);
+
+/** @brief Initialize the context for an incremental SHAKE256 computation. */
+void SHA3_shake256_inc_init(SHA3_ctx *state);
+
+/**
+ * @brief Absorb message bytes into the context; may be called repeatedly before finalize.
+ *
+ * @param state The context, initialized by one of the *_inc_init functions
+ * @param input The message input byte array
+ * @param inplen The number of message bytes to process
+ */
+void SHA3_inc_absorb(SHA3_ctx *state, const u8 *input, size_t inplen);
+
+/**
+ * @brief Pad the message and write the SHA-3 digest; the context is released afterwards.
+ *
+ * @warning The output array must be at least as long as the digest of the initialized function.
+ *
+ * @param output The output byte array
+ * @param state The SHA-3 context
+ */
+void SHA3_sha3_inc_finalize(u8 *output, SHA3_ctx *state);
+
+/**
+ * @brief Pad the message of a SHAKE context and switch it to squeezing.
+ *
+ * @param state The SHAKE context
+ */
+void SHA3_shake_inc_finalize(SHA3_ctx *state);
+
+/**
+ * @brief Write the next outlen bytes of SHAKE output; may be called repeatedly.
+ * @details Squeezing a and then b bytes gives the same a + b bytes as squeezing them at once.
+ *
+ * @param output The output byte array of outlen bytes
+ * @param outlen The number of output bytes
+ * @param state The finalized SHAKE context
+ */
+void SHA3_shake_inc_squeeze(u8 *output, size_t outlen, SHA3_ctx *state);
+
+/**
+ * @brief Clone an incremental context (e.g., to hash several messages with a common prefix).
+ *
+ * @param dest The destination context
+ * @param src The source context
+ */
+void SHA3_inc_ctx_clone(SHA3_ctx *dest, const SHA3_ctx *src);
+
+/**
+ * @brief Wipe an incremental context.
+ *
+ * @param state The context to wipe
+ */
+void SHA3_inc_ctx_release(SHA3_ctx *state);
+
+/* -------------------------- Four messages at once (x4) --------------------------- */
+
+/*
+ * SHA-3 and SHAKE on four independent messages of equal length. The four sponges are kept
+ * interleaved, lane i of instance j at s[4i + j], which is the layout of one 256-bit register per
+ * lane: the AVX2 backend permutes all four states with the same instructions a single permutation
+ * needs. Without AVX2 the portable backend runs SHA3_keccakf1600 on each instance in turn, behind
+ * the same interface, so callers never need a second code path.
+ */
+
+/** Incremental state of four SHA-3 / SHAKE instances of the same function. */
+typedef struct __SHA3_ctx_x4__ {
+    u64 s[4 * SHA3_KECCAK_LANES];   // Lane i of instance j at s[4i + j]
+    u32 rate;                       // Rate in bytes
+    u32 pos;                        // Bytes absorbed into the current block, or squeezed from it
+    u32 outlen;                     // Digest size (SHA-3), 0 for SHAKE
+    u8 dsbyte;                      // Domain separation bits and the first padding bit
+    bool squeezing;                 // Set by SHAKE finalize
+} SHA3_ctx_x4;
+
+/** Implementations of the four-way permutation. */
+typedef enum {
+    SHA3_BACKEND_C = 0,     // Four calls of the single-state permutation (always available)
+    SHA3_BACKEND_AVX2,      // One 64-bit lane of each state per 256-bit register
+} SHA3_backend_t;
+
+/**
+ * @brief Select the four-way backend from CPUID; called by cryptomodule_init.
+ * @details Calling it is optional: the first four-way permutation selects the backend on its own.
+ */
+void SHA3_x4_init_dispatch(void);
+
+/**
+ * @brief Force the four-way backend (e.g., to compare backends against each other).
+ * @return false, leaving the selection unchanged, if the backend is not supported on this CPU.
+ */
+bool SHA3_x4_set_backend(SHA3_backend_t backend);
+
+/** @brief The four-way backend currently in use. */
+SHA3_backend_t SHA3_x4_get_backend(void);
+
+/**
+ * @brief Apply Keccak-f[1600] to four interleaved states (lane i of state j at s[4i + j]).
+ */
+void SHA3_keccakf1600_x4(u64 *s);
+
+/**
+ * @brief Hash four messages of inplen bytes each with SHA3-224/256/384/512.
+ *
+ * @warning Each output array must be at least as long as the digest.
+ *
+ * @param out0 .. out3 The output byte arrays
+ * @param in0 .. in3 The message input byte arrays
+ * @param inplen The number of bytes of every message
+ */
+void SHA3_sha3_224_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+void SHA3_sha3_256_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+void SHA3_sha3_384_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+void SHA3_sha3_512_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+
+/**
+ * @brief Process four messages of inplen bytes each with SHAKE128 and write outlen bytes for each.
+ *
+ * @param out0 .. out3 The output byte arrays of outlen bytes
+ * @param outlen The number of output bytes per message
+ * @param in0 .. in3 The message input byte arrays
+ * @param inplen The number of bytes of every message
+ */
+void SHA3_shake128_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+
+/** @brief SHAKE256 counterpart of SHA3_shake128_x4. */
+void SHA3_shake256_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen);
+
+/** @brief Initialize the context for four incremental SHA3-224 computations. */
+void SHA3_sha3_224_x4_inc_init(SHA3_ctx_x4 *state);
+
+/** @brief Initialize the context for four incremental SHA3-256 computations. */
+void SHA3_sha3_256_x4_inc_init(SHA3_ctx_x4 *state);
+
+/** @brief Initialize the context for four incremental SHA3-384 computations. */
+void SHA3_sha3_384_x4_inc_init(SHA3_ctx_x4 *state);
+
+/** @brief Initialize the context for four incremental SHA3-512 computations. */
+void SHA3_sha3_512_x4_inc_init(SHA3_ctx_x4 *state);
+
+/** @brief Initialize the context for four incremental SHAKE128 computations. */
+void SHA3_shake128_x4_inc_init(SHA3_ctx_x4 *state);
+
+/** @brief Initialize the context for four incremental SHAKE256 computations. */
+void SHA3_shake256_x4_inc_init(SHA3_ctx_x4 *state);
+
+/**
+ * @brief Absorb inplen bytes into each of the four instances; may be called repeatedly.
+ *
+ * @param state The context, initialized by one of the *_x4_inc_init functions
+ * @param in0 .. in3 The message input byte arrays
+ * @param inplen The number of bytes to absorb into every instance
+ */
+void SHA3_x4_inc_absorb(SHA3_ctx_x4 *state, const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3,
+                        size_t inplen);
+
+/**
+ * @brief Pad the messages and write the four SHA-3 digests; the context is released afterwards.
+ *
+ * @param out0 .. out3 The output byte arrays
+ * @param state The SHA-3 context
+ */
+void SHA3_sha3_x4_inc_finalize(u8 *out0, u8 *out1, u8 *out2, u8 *out3, SHA3_ctx_x4 *state);
+
+/**
+ * @brief Pad the messages of a SHAKE context and switch it to squeezing.
+ *
+ * @param state The SHAKE context
+ */
+void SHA3_shake_x4_inc_finalize(SHA3_ctx_x4 *state);
+
+/**
+ * @brief Write the next outlen bytes of each of the four SHAKE outputs; may be called repeatedly.
+ *
+ * @param out0 .. out3 The output byte arrays of outlen bytes
+ * @param outlen The number of output bytes per instance
+ * @param state The finalized SHAKE context
+ */
+void SHA3_shake_x4_inc_squeeze(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen, SHA3_ctx_x4 *state);
+
+/**
+ * @brief Clone a four-way incremental context.
+ *
+ * @param dest The destination context
+ * @param src The source context
+ */
+void SHA3_x4_inc_ctx_clone(SHA3_ctx_x4 *dest, const SHA3_ctx_x4 *src);
+
+/**
+ * @brief Wipe a four-way incremental context.
+ *
+ * @param state The context to wipe
+ */
+void SHA3_x4_inc_ctx_release(SHA3_ctx_x4 *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA3_H */
@@ -12,6 +12,7 @@
 /* Forward declarations of static functions. */
 static block_cipher_status_t aes_init(BlockCipherContext *ctx, const u8 *key, size_t key_len, size_t block_len, BlockCipherDirection dir);
 static block_cipher_status_t aes_process(BlockCipherContext *ctx, const u8 *in, u8 *out, BlockCipherDirection dir);
+static block_cipher_status_t aes_process_blocks(BlockCipherContext *ctx, const u8 *in, u8 *out, size_t num_blocks, BlockCipherDirection dir);
 static void aes_dispose(BlockCipherContext *ctx);
 
 /**
@@ -23,6 +24,7 @@ static const BlockCipherApi AES_API = {
     .cipher_name          = "AES",
     .cipher_init          = aes_init,
     .cipher_process       = aes_process,
+    .cipher_process_blocks = aes_process_blocks,
     .cipher_dispose       = aes_dispose
 };
 
@@ -237,12 +239,9 @@ block_cipher_status_t aes_init(BlockCipherContext *cipher_ctx, const u8 *key, si
     return BLOCK_CIPHER_OK;
 }
 
-void aes_encrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
-    if (!in || !out || !rk) {
-        fprintf(stderr, "Invalid input, output, or round key pointer\n");
-        return;
-    }
-    
+/* One block; always inlined, so that a constant r drops the branches on the key size */
+static inline __attribute__((always_inline))
+void aes_encrypt_block(const u8 *in, u8 *out, const u32 *rk, int r) {
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
 
     // for (int i = 0; i < AES128_NUM_ROUNDS + 1; i++) {
@@ -376,12 +375,17 @@ void aes_encrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
     // }
 }
 
-void aes_decrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
+void aes_encrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
     if (!in || !out || !rk) {
         fprintf(stderr, "Invalid input, output, or round key pointer\n");
         return;
     }
-    
+    aes_encrypt_block(in, out, rk, r);
+}
+
+/* One block, inlined like aes_encrypt_block */
+static inline __attribute__((always_inline))
+void aes_decrypt_block(const u8 *in, u8 *out, const u32 *rk, int r) {
     u32 s0, s1, s2, s3, t0, t1, t2, t3;
     /* map byte array block to cipher state and add initial round key: */
     s0 = GETU32(in +  0) ^ rk[0];
@@ -500,6 +504,286 @@ void aes_decrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
     // }
 }
 
+void aes_decrypt(const u8 *in, u8 *out, const u32 *rk, int r) {
+    if (!in || !out || !rk) {
+        fprintf(stderr, "Invalid input, output, or round key pointer\n");
+        return;
+    }
+    aes_decrypt_block(in, out, rk, r);
+}
+
+/*
+ * Interleaved multi-block AES.
+ * A single T-table round is a chain of dependent table loads, so one block leaves most of
+ * the load ports idle. Running the same round on AES_INTERLEAVE independent states back to
+ * back lets the loads of the different blocks overlap.
+ */
+#define AES_ENC_ROUND(t, s, k) {                                                                          \
+    (t)[0] = Te0[(s)[0] >> 24] ^ Te1[((s)[1] >> 16) & 0xff] ^ Te2[((s)[2] >> 8) & 0xff] ^ Te3[(s)[3] & 0xff] ^ (k)[0]; \
+    (t)[1] = Te0[(s)[1] >> 24] ^ Te1[((s)[2] >> 16) & 0xff] ^ Te2[((s)[3] >> 8) & 0xff] ^ Te3[(s)[0] & 0xff] ^ (k)[1]; \
+    (t)[2] = Te0[(s)[2] >> 24] ^ Te1[((s)[3] >> 16) & 0xff] ^ Te2[((s)[0] >> 8) & 0xff] ^ Te3[(s)[1] & 0xff] ^ (k)[2]; \
+    (t)[3] = Te0[(s)[3] >> 24] ^ Te1[((s)[0] >> 16) & 0xff] ^ Te2[((s)[1] >> 8) & 0xff] ^ Te3[(s)[2] & 0xff] ^ (k)[3]; }
+
+#define AES_ENC_FINAL(o, t, k) {                                                                          \
+    PUTU32((o)     , (Te2[(t)[0] >> 24] & 0xff000000) ^ (Te3[((t)[1] >> 16) & 0xff] & 0x00ff0000) ^      \
+                     (Te0[((t)[2] >> 8) & 0xff] & 0x0000ff00) ^ (Te1[(t)[3] & 0xff] & 0x000000ff) ^ (k)[0]); \
+    PUTU32((o) +  4, (Te2[(t)[1] >> 24] & 0xff000000) ^ (Te3[((t)[2] >> 16) & 0xff] & 0x00ff0000) ^      \
+                     (Te0[((t)[3] >> 8) & 0xff] & 0x0000ff00) ^ (Te1[(t)[0] & 0xff] & 0x000000ff) ^ (k)[1]); \
+    PUTU32((o) +  8, (Te2[(t)[2] >> 24] & 0xff000000) ^ (Te3[((t)[3] >> 16) & 0xff] & 0x00ff0000) ^      \
+                     (Te0[((t)[0] >> 8) & 0xff] & 0x0000ff00) ^ (Te1[(t)[1] & 0xff] & 0x000000ff) ^ (k)[2]); \
+    PUTU32((o) + 12, (Te2[(t)[3] >> 24] & 0xff000000) ^ (Te3[((t)[0] >> 16) & 0xff] & 0x00ff0000) ^      \
+                     (Te0[((t)[1] >> 8) & 0xff] & 0x0000ff00) ^ (Te1[(t)[2] & 0xff] & 0x000000ff) ^ (k)[3]); }
+
+#define AES_DEC_ROUND(t, s, k) {                                                                          \
+    (t)[0] = Td0[(s)[0] >> 24] ^ Td1[((s)[3] >> 16) & 0xff] ^ Td2[((s)[2] >> 8) & 0xff] ^ Td3[(s)[1] & 0xff] ^ (k)[0]; \
+    (t)[1] = Td0[(s)[1] >> 24] ^ Td1[((s)[0] >> 16) & 0xff] ^ Td2[((s)[3] >> 8) & 0xff] ^ Td3[(s)[2] & 0xff] ^ (k)[1]; \
+    (t)[2] = Td0[(s)[2] >> 24] ^ Td1[((s)[1] >> 16) & 0xff] ^ Td2[((s)[0] >> 8) & 0xff] ^ Td3[(s)[3] & 0xff] ^ (k)[2]; \
+    (t)[3] = Td0[(s)[3] >> 24] ^ Td1[((s)[2] >> 16) & 0xff] ^ Td2[((s)[1] >> 8) & 0xff] ^ Td3[(s)[0] & 0xff] ^ (k)[3]; }
+
+#define AES_DEC_FINAL(o, t, k) {                                                                          \
+    PUTU32((o)     , ((u32)Td4[(t)[0] >> 24] << 24) ^ ((u32)Td4[((t)[3] >> 16) & 0xff] << 16) ^          \
+                     ((u32)Td4[((t)[2] >> 8) & 0xff] << 8) ^ ((u32)Td4[(t)[1] & 0xff]) ^ (k)[0]);         \
+    PUTU32((o) +  4, ((u32)Td4[(t)[1] >> 24] << 24) ^ ((u32)Td4[((t)[0] >> 16) & 0xff] << 16) ^          \
+                     ((u32)Td4[((t)[3] >> 8) & 0xff] << 8) ^ ((u32)Td4[(t)[2] & 0xff]) ^ (k)[1]);         \
+    PUTU32((o) +  8, ((u32)Td4[(t)[2] >> 24] << 24) ^ ((u32)Td4[((t)[1] >> 16) & 0xff] << 16) ^          \
+                     ((u32)Td4[((t)[0] >> 8) & 0xff] << 8) ^ ((u32)Td4[(t)[3] & 0xff]) ^ (k)[2]);         \
+    PUTU32((o) + 12, ((u32)Td4[(t)[3] >> 24] << 24) ^ ((u32)Td4[((t)[2] >> 16) & 0xff] << 16) ^          \
+                     ((u32)Td4[((t)[1] >> 8) & 0xff] << 8) ^ ((u32)Td4[(t)[0] & 0xff]) ^ (k)[3]); }
+
+#define AES_LOAD_STATE(s, in, k) {                                                                        \
+    (s)[0] = GETU32((in)     ) ^ (k)[0];                                                                  \
+    (s)[1] = GETU32((in) +  4) ^ (k)[1];                                                                  \
+    (s)[2] = GETU32((in) +  8) ^ (k)[2];                                                                  \
+    (s)[3] = GETU32((in) + 12) ^ (k)[3]; }
+
+/* Encrypt AES_INTERLEAVE (4) blocks with their rounds interleaved. */
+static inline __attribute__((always_inline))
+void aes_encrypt_x4(const u8 *in, u8 *out, const u32 *rk, int r) {
+    u32 s0[4], s1[4], s2[4], s3[4], t0[4], t1[4], t2[4], t3[4];
+    const u32 *k = rk + 4;
+    int round;
+
+    AES_LOAD_STATE(s0, in     , rk);
+    AES_LOAD_STATE(s1, in + 16, rk);
+    AES_LOAD_STATE(s2, in + 32, rk);
+    AES_LOAD_STATE(s3, in + 48, rk);
+    /* rounds 1 .. r-2, two at a time (r - 1 is odd for every key size) */
+    for (round = 1; round < r - 1; round += 2, k += 8) {
+        AES_ENC_ROUND(t0, s0, k); AES_ENC_ROUND(t1, s1, k); AES_ENC_ROUND(t2, s2, k); AES_ENC_ROUND(t3, s3, k);
+        AES_ENC_ROUND(s0, t0, k + 4); AES_ENC_ROUND(s1, t1, k + 4); AES_ENC_ROUND(s2, t2, k + 4); AES_ENC_ROUND(s3, t3, k + 4);
+    }
+    /* round r-1 */
+    AES_ENC_ROUND(t0, s0, k); AES_ENC_ROUND(t1, s1, k); AES_ENC_ROUND(t2, s2, k); AES_ENC_ROUND(t3, s3, k);
+    k += 4;
+    /* last round */
+    AES_ENC_FINAL(out     , t0, k);
+    AES_ENC_FINAL(out + 16, t1, k);
+    AES_ENC_FINAL(out + 32, t2, k);
+    AES_ENC_FINAL(out + 48, t3, k);
+}
+
+/* Encrypt 2 blocks with their rounds interleaved (tail of a bulk call, or MAC + keystream pairs). */
+static inline __attribute__((always_inline))
+void aes_encrypt_x2(const u8 *in, u8 *out, const u32 *rk, int r) {
+    u32 s0[4], s1[4], t0[4], t1[4];
+    const u32 *k = rk + 4;
+    int round;
+
+    AES_LOAD_STATE(s0, in     , rk);
+    AES_LOAD_STATE(s1, in + 16, rk);
+    for (round = 1; round < r - 1; round += 2, k += 8) {
+        AES_ENC_ROUND(t0, s0, k); AES_ENC_ROUND(t1, s1, k);
+        AES_ENC_ROUND(s0, t0, k + 4); AES_ENC_ROUND(s1, t1, k + 4);
+    }
+    AES_ENC_ROUND(t0, s0, k); AES_ENC_ROUND(t1, s1, k);
+    k += 4;
+    AES_ENC_FINAL(out     , t0, k);
+    AES_ENC_FINAL(out + 16, t1, k);
+}
+
+/* Decrypt AES_INTERLEAVE (4) blocks with their rounds interleaved. */
+static inline __attribute__((always_inline))
+void aes_decrypt_x4(const u8 *in, u8 *out, const u32 *rk, int r) {
+    u32 s0[4], s1[4], s2[4], s3[4], t0[4], t1[4], t2[4], t3[4];
+    const u32 *k = rk + 4;
+    int round;
+
+    AES_LOAD_STATE(s0, in     , rk);
+    AES_LOAD_STATE(s1, in + 16, rk);
+    AES_LOAD_STATE(s2, in + 32, rk);
+    AES_LOAD_STATE(s3, in + 48, rk);
+    for (round = 1; round < r - 1; round += 2, k += 8) {
+        AES_DEC_ROUND(t0, s0, k); AES_DEC_ROUND(t1, s1, k); AES_DEC_ROUND(t2, s2, k); AES_DEC_ROUND(t3, s3, k);
+        AES_DEC_ROUND(s0, t0, k + 4); AES_DEC_ROUND(s1, t1, k + 4); AES_DEC_ROUND(s2, t2, k + 4); AES_DEC_ROUND(s3, t3, k + 4);
+    }
+    AES_DEC_ROUND(t0, s0, k); AES_DEC_ROUND(t1, s1, k); AES_DEC_ROUND(t2, s2, k); AES_DEC_ROUND(t3, s3, k);
+    k += 4;
+    AES_DEC_FINAL(out     , t0, k);
+    AES_DEC_FINAL(out + 16, t1, k);
+    AES_DEC_FINAL(out + 32, t2, k);
+    AES_DEC_FINAL(out + 48, t3, k);
+}
+
+/* Decrypt 2 blocks with their rounds interleaved. */
+static inline __attribute__((always_inline))
+void aes_decrypt_x2(const u8 *in, u8 *out, const u32 *rk, int r) {
+    u32 s0[4], s1[4], t0[4], t1[4];
+    const u32 *k = rk + 4;
+    int round;
+
+    AES_LOAD_STATE(s0, in     , rk);
+    AES_LOAD_STATE(s1, in + 16, rk);
+    for (round = 1; round < r - 1; round += 2, k += 8) {
+        AES_DEC_ROUND(t0, s0, k); AES_DEC_ROUND(t1, s1, k);
+        AES_DEC_ROUND(s0, t0, k + 4); AES_DEC_ROUND(s1, t1, k + 4);
+    }
+    AES_DEC_ROUND(t0, s0, k); AES_DEC_ROUND(t1, s1, k);
+    k += 4;
+    AES_DEC_FINAL(out     , t0, k);
+    AES_DEC_FINAL(out + 16, t1, k);
+}
+
+/* Bulk loop of aes_encrypt_blocks; always inlined for the same reason as aes_encrypt_block */
+static inline __attribute__((always_inline))
+void aes_encrypt_blocks_rounds(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r) {
+    for (; num_blocks >= AES_INTERLEAVE; num_blocks -= AES_INTERLEAVE) {
+        aes_encrypt_x4(in, out, rk, r);
+        in  += AES_INTERLEAVE * AES_BLOCK_SIZE;
+        out += AES_INTERLEAVE * AES_BLOCK_SIZE;
+    }
+    if (num_blocks >= 2) {
+        aes_encrypt_x2(in, out, rk, r);
+        in  += 2 * AES_BLOCK_SIZE;
+        out += 2 * AES_BLOCK_SIZE;
+        num_blocks -= 2;
+    }
+    if (num_blocks) {
+        aes_encrypt_block(in, out, rk, r);
+    }
+}
+
+void aes_encrypt_blocks(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r) {
+    if (!in || !out || !rk) {
+        fprintf(stderr, "Invalid input, output, or round key pointer\n");
+        return;
+    }
+    aes_encrypt_blocks_rounds(in, out, num_blocks, rk, r);
+}
+
+static inline __attribute__((always_inline))
+void aes_decrypt_blocks_rounds(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r) {
+    for (; num_blocks >= AES_INTERLEAVE; num_blocks -= AES_INTERLEAVE) {
+        aes_decrypt_x4(in, out, rk, r);
+        in  += AES_INTERLEAVE * AES_BLOCK_SIZE;
+        out += AES_INTERLEAVE * AES_BLOCK_SIZE;
+    }
+    if (num_blocks >= 2) {
+        aes_decrypt_x2(in, out, rk, r);
+        in  += 2 * AES_BLOCK_SIZE;
+        out += 2 * AES_BLOCK_SIZE;
+        num_blocks -= 2;
+    }
+    if (num_blocks) {
+        aes_decrypt_block(in, out, rk, r);
+    }
+}
+
+void aes_decrypt_blocks(const u8 *in, u8 *out, size_t num_blocks, const u32 *rk, int r) {
+    if (!in || !out || !rk) {
+        fprintf(stderr, "Invalid input, output, or round key pointer\n");
+        return;
+    }
+    aes_decrypt_blocks_rounds(in, out, num_blocks, rk, r);
+}
+
+/*
+ * Key-agile batch, T-table backend: the rounds of AES_INTERLEAVE blocks are interleaved as in
+ * aes_encrypt_x4, with each block reading its own round keys.
+ */
+void aes_encrypt_batch_c(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r) {
+    for (; num_blocks >= AES_INTERLEAVE; num_blocks -= AES_INTERLEAVE) {
+        u32 s0[4], s1[4], s2[4], s3[4], t0[4], t1[4], t2[4], t3[4];
+        const u32 *k0 = rks[0], *k1 = rks[1], *k2 = rks[2], *k3 = rks[3];
+        int round;
+
+        AES_LOAD_STATE(s0, in     , k0);
+        AES_LOAD_STATE(s1, in + 16, k1);
+        AES_LOAD_STATE(s2, in + 32, k2);
+        AES_LOAD_STATE(s3, in + 48, k3);
+        k0 += 4; k1 += 4; k2 += 4; k3 += 4;
+        for (round = 1; round < r - 1; round += 2, k0 += 8, k1 += 8, k2 += 8, k3 += 8) {
+            AES_ENC_ROUND(t0, s0, k0); AES_ENC_ROUND(t1, s1, k1); AES_ENC_ROUND(t2, s2, k2); AES_ENC_ROUND(t3, s3, k3);
+            AES_ENC_ROUND(s0, t0, k0 + 4); AES_ENC_ROUND(s1, t1, k1 + 4); AES_ENC_ROUND(s2, t2, k2 + 4); AES_ENC_ROUND(s3, t3, k3 + 4);
+        }
+        AES_ENC_ROUND(t0, s0, k0); AES_ENC_ROUND(t1, s1, k1); AES_ENC_ROUND(t2, s2, k2); AES_ENC_ROUND(t3, s3, k3);
+        AES_ENC_FINAL(out     , t0, k0 + 4);
+        AES_ENC_FINAL(out + 16, t1, k1 + 4);
+        AES_ENC_FINAL(out + 32, t2, k2 + 4);
+        AES_ENC_FINAL(out + 48, t3, k3 + 4);
+
+        rks += AES_INTERLEAVE;
+        in  += AES_INTERLEAVE * AES_BLOCK_SIZE;
+        out += AES_INTERLEAVE * AES_BLOCK_SIZE;
+    }
+    for (; num_blocks; num_blocks--, rks++, in += AES_BLOCK_SIZE, out += AES_BLOCK_SIZE) {
+        aes_encrypt_block(in, out, *rks, r);
+    }
+}
+
+static void aes_encrypt_batch_resolve(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r);
+
+static void (*aes_encrypt_batch_fn)(const u32 *const *, const u8 *, u8 *, size_t, int) = aes_encrypt_batch_resolve;
+static aes_batch_backend_t aes_batch_backend = AES_BATCH_BACKEND_C;
+
+bool aes_batch_set_backend(aes_batch_backend_t backend) {
+    switch (backend) {
+    case AES_BATCH_BACKEND_C:
+        aes_encrypt_batch_fn = aes_encrypt_batch_c;
+        break;
+    case AES_BATCH_BACKEND_BITSLICED:
+        aes_encrypt_batch_fn = aes_encrypt_batch_bitsliced;
+        break;
+#if AES_HAVE_X86
+    case AES_BATCH_BACKEND_AESNI:
+        if (!cryptomodule_cpu_has(CRYPTOMODULE_CPU_AESNI | CRYPTOMODULE_CPU_SSSE3)) return false;
+        aes_encrypt_batch_fn = aes_encrypt_batch_aesni;
+        break;
+#endif
+    default:
+        return false;
+    }
+    aes_batch_backend = backend;
+    return true;
+}
+
+aes_batch_backend_t aes_batch_get_backend(void) {
+    return aes_batch_backend;
+}
+
+/* The T-table backend outruns the bitsliced one, which is selected by name where timing matters */
+void aes_batch_init_dispatch(void) {
+    if (!aes_batch_set_backend(AES_BATCH_BACKEND_AESNI)) {
+        aes_batch_set_backend(AES_BATCH_BACKEND_C);
+    }
+}
+
+static void aes_encrypt_batch_resolve(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r) {
+    aes_batch_init_dispatch();
+    aes_encrypt_batch_fn(rks, in, out, num_blocks, r);
+}
+
+void aes_encrypt_batch(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r) {
+    if (!rks || !in || !out) {
+        fprintf(stderr, "Invalid input, output, or round key pointer\n");
+        return;
+    }
+    if (r != AES128_NUM_ROUNDS && r != AES192_NUM_ROUNDS && r != AES256_NUM_ROUNDS) {
+        fprintf(stderr, "Invalid number of AES rounds: %d\n", r);
+        return;
+    }
+    aes_encrypt_batch_fn(rks, in, out, num_blocks, r);
+}
+
 block_cipher_status_t aes_process(BlockCipherContext *cipher_ctx, const u8 *in, u8 *out, BlockCipherDirection dir) {
     if (!cipher_ctx || !in || !out) {
         fprintf(stderr, "Invalid context, input, or output pointer\n");
@@ -520,9 +804,183 @@ block_cipher_status_t aes_process(BlockCipherContext *cipher_ctx, const u8 *in,
     return BLOCK_CIPHER_OK;
 }
 
+block_cipher_status_t aes_process_blocks(BlockCipherContext *cipher_ctx, const u8 *in, u8 *out, size_t num_blocks, BlockCipherDirection dir) {
+    if (!cipher_ctx || !in || !out) {
+        fprintf(stderr, "Invalid context, input, or output pointer\n");
+        return BLOCK_CIPHER_ERR_UNKNOWN;
+    }
+
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {
+        aes_encrypt_blocks(in, out, num_blocks, cipher_ctx->cipher_state.aes_internal.round_keys, cipher_ctx->cipher_state.aes_internal.nr);
+    } else if (dir == BLOCK_CIPHER_DECRYPTION) {
+        aes_decrypt_blocks(in, out, num_blocks, cipher_ctx->cipher_state.aes_internal.round_keys, cipher_ctx->cipher_state.aes_internal.nr);
+    } else {
+        fprintf(stderr, "Invalid block cipher direction\n");
+        return BLOCK_CIPHER_ERR_UNSUPPORTED_DIRECTION;
+    }
+
+    return BLOCK_CIPHER_OK;
+}
+
 void aes_dispose(BlockCipherContext *cipher_ctx) {
     if (!cipher_ctx) return;
     /* Clear out the AES portion of the union. */
-    memset(&cipher_ctx->cipher_state.aes_internal, 0,
-           sizeof(cipher_ctx->cipher_state.aes_internal));
-}
\ No newline at end of file
+    cryptomodule_wipe(&cipher_ctx->cipher_state.aes_internal,
+                      sizeof(cipher_ctx->cipher_state.aes_internal));
+}
+/*
+ * Key-size-specialized APIs (block_cipher_get_api). Each is fixed to one key size, so the round
+ * count is a constant: the inlined block functions lose their branches on the key size and the
+ * bulk loops their variable trip count. Key expansion and disposal are shared with AES_API.
+ */
+#define AES_SPECIALIZED_API(bits)                                                                       \
+static block_cipher_status_t aes##bits##_init(BlockCipherContext *cipher_ctx, const u8 *key, size_t key_len, \
+                                              size_t block_len, BlockCipherDirection dir) {            \
+    if (key_len != AES##bits##_KEY_SIZE) {                                                              \
+        fprintf(stderr, "Invalid key length for AES-" #bits ": %zu\n", key_len);                        \
+        return BLOCK_CIPHER_ERR_INVALID_KEY;                                                            \
+    }                                                                                                   \
+    return aes_init(cipher_ctx, key, key_len, block_len, dir);                                          \
+}                                                                                                       \
+                                                                                                        \
+static block_cipher_status_t aes##bits##_process(BlockCipherContext *cipher_ctx, const u8 *in, u8 *out, \
+                                                 BlockCipherDirection dir) {                            \
+    const u32 *rk = cipher_ctx->cipher_state.aes_internal.round_keys;                                   \
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {                                                               \
+        aes_encrypt_block(in, out, rk, AES##bits##_NUM_ROUNDS);                                         \
+    } else if (dir == BLOCK_CIPHER_DECRYPTION) {                                                        \
+        aes_decrypt_block(in, out, rk, AES##bits##_NUM_ROUNDS);                                         \
+    } else {                                                                                            \
+        return BLOCK_CIPHER_ERR_UNSUPPORTED_DIRECTION;                                                  \
+    }                                                                                                   \
+    return BLOCK_CIPHER_OK;                                                                             \
+}                                                                                                       \
+                                                                                                        \
+static block_cipher_status_t aes##bits##_process_blocks(BlockCipherContext *cipher_ctx, const u8 *in,  \
+                                                        u8 *out, size_t num_blocks, BlockCipherDirection dir) { \
+    const u32 *rk = cipher_ctx->cipher_state.aes_internal.round_keys;                                   \
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {                                                               \
+        aes_encrypt_blocks_rounds(in, out, num_blocks, rk, AES##bits##_NUM_ROUNDS);                     \
+    } else if (dir == BLOCK_CIPHER_DECRYPTION) {                                                        \
+        aes_decrypt_blocks_rounds(in, out, num_blocks, rk, AES##bits##_NUM_ROUNDS);                     \
+    } else {                                                                                            \
+        return BLOCK_CIPHER_ERR_UNSUPPORTED_DIRECTION;                                                  \
+    }                                                                                                   \
+    return BLOCK_CIPHER_OK;                                                                             \
+}                                                                                                       \
+                                                                                                        \
+static const BlockCipherApi AES##bits##_API = {                                                         \
+    .cipher_name          = "AES-" #bits,                                                               \
+    .cipher_init          = aes##bits##_init,                                                           \
+    .cipher_process       = aes##bits##_process,                                                        \
+    .cipher_process_blocks = aes##bits##_process_blocks,                                                \
+    .cipher_dispose       = aes_dispose                                                                 \
+};                                                                                                      \
+                                                                                                        \
+const BlockCipherApi *get_aes##bits##_api(void) { return &AES##bits##_API; }
+
+AES_SPECIALIZED_API(128)
+AES_SPECIALIZED_API(192)
+AES_SPECIALIZED_API(256)
+
+/* Add 1 to a 128-bit big-endian counter block (mod 2^128) */
+static inline void aes_ctr_increment(u8 counter[AES_BLOCK_SIZE]) {
+    for (int j = AES_BLOCK_SIZE - 1; j >= 0; j--) {
+        if (++counter[j] != 0) break;
+    }
+}
+
+/*
+ * Fused CTR/CBC kernels (block_cipher_get_mode_kernels). The mode keeps one of them per context and
+ * calls it for a whole buffer: the rounds are inlined with the constant round count of the key size,
+ * counter blocks and CBC decryption run AES_INTERLEAVE blocks at a time, and nothing per block goes
+ * through the vtable. CBC encryption is a chain, so it stays one block at a time.
+ */
+#define AES_MODE_KERNELS(bits)                                                                          \
+static void aes##bits##_ctr(BlockCipherContext *cipher_ctx, u8 counter[AES_BLOCK_SIZE], const u8 *in,  \
+                            u8 *out, size_t num_blocks) {                                               \
+    const u32 *rk = cipher_ctx->cipher_state.aes_internal.round_keys;                                   \
+    u8 ks[AES_INTERLEAVE * AES_BLOCK_SIZE];                                                             \
+                                                                                                        \
+    for (; num_blocks >= AES_INTERLEAVE; num_blocks -= AES_INTERLEAVE) {                                \
+        for (int i = 0; i < AES_INTERLEAVE; i++) {                                                      \
+            memcpy(ks + i * AES_BLOCK_SIZE, counter, AES_BLOCK_SIZE);                                   \
+            aes_ctr_increment(counter);                                                                 \
+        }                                                                                               \
+        aes_encrypt_x4(ks, ks, rk, AES##bits##_NUM_ROUNDS);                                             \
+        for (int k = 0; k < AES_INTERLEAVE * AES_BLOCK_SIZE; k++) {                                     \
+            out[k] = in[k] ^ ks[k];                                                                     \
+        }                                                                                               \
+        in  += AES_INTERLEAVE * AES_BLOCK_SIZE;                                                         \
+        out += AES_INTERLEAVE * AES_BLOCK_SIZE;                                                         \
+    }                                                                                                   \
+    for (; num_blocks; num_blocks--) {                                                                  \
+        aes_encrypt_block(counter, ks, rk, AES##bits##_NUM_ROUNDS);                                     \
+        aes_ctr_increment(counter);                                                                     \
+        for (int k = 0; k < AES_BLOCK_SIZE; k++) {                                                      \
+            out[k] = in[k] ^ ks[k];                                                                     \
+        }                                                                                               \
+        in  += AES_BLOCK_SIZE;                                                                          \
+        out += AES_BLOCK_SIZE;                                                                          \
+    }                                                                                                   \
+    memset(ks, 0, sizeof(ks));                                                                          \
+}                                                                                                       \
+                                                                                                        \
+static void aes##bits##_cbc_encrypt(BlockCipherContext *cipher_ctx, u8 iv[AES_BLOCK_SIZE], const u8 *in, \
+                                    u8 *out, size_t num_blocks) {                                       \
+    const u32 *rk = cipher_ctx->cipher_state.aes_internal.round_keys;                                   \
+                                                                                                        \
+    for (; num_blocks; num_blocks--) {                                                                  \
+        for (int k = 0; k < AES_BLOCK_SIZE; k++) {                                                      \
+            iv[k] ^= in[k];                                                                             \
+        }                                                                                               \
+        aes_encrypt_block(iv, iv, rk, AES##bits##_NUM_ROUNDS);                                          \
+        memcpy(out, iv, AES_BLOCK_SIZE);                                                                \
+        in  += AES_BLOCK_SIZE;                                                                          \
+        out += AES_BLOCK_SIZE;                                                                          \
+    }                                                                                                   \
+}                                                                                                       \
+                                                                                                        \
+static void aes##bits##_cbc_decrypt(BlockCipherContext *cipher_ctx, u8 iv[AES_BLOCK_SIZE], const u8 *in, \
+                                    u8 *out, size_t num_blocks) {                                       \
+    const u32 *rk = cipher_ctx->cipher_state.aes_internal.round_keys;                                   \
+    u8 ct[AES_INTERLEAVE * AES_BLOCK_SIZE], pt[AES_INTERLEAVE * AES_BLOCK_SIZE];                        \
+                                                                                                        \
+    /* The ciphertext is copied first, so that out may alias in */                                      \
+    for (; num_blocks >= AES_INTERLEAVE; num_blocks -= AES_INTERLEAVE) {                                \
+        memcpy(ct, in, sizeof(ct));                                                                     \
+        aes_decrypt_x4(ct, pt, rk, AES##bits##_NUM_ROUNDS);                                             \
+        for (int k = 0; k < AES_BLOCK_SIZE; k++) {                                                      \
+            out[k] = pt[k] ^ iv[k];                                                                     \
+        }                                                                                               \
+        for (int k = AES_BLOCK_SIZE; k < AES_INTERLEAVE * AES_BLOCK_SIZE; k++) {                        \
+            out[k] = pt[k] ^ ct[k - AES_BLOCK_SIZE];                                                    \
+        }                                                                                               \
+        memcpy(iv, ct + (AES_INTERLEAVE - 1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE);                         \
+        in  += AES_INTERLEAVE * AES_BLOCK_SIZE;                                                         \
+        out += AES_INTERLEAVE * AES_BLOCK_SIZE;                                                         \
+    }                                                                                                   \
+    for (; num_blocks; num_blocks--) {                                                                  \
+        memcpy(ct, in, AES_BLOCK_SIZE);                                                                 \
+        aes_decrypt_block(ct, pt, rk, AES##bits##_NUM_ROUNDS);                                          \
+        for (int k = 0; k < AES_BLOCK_SIZE; k++) {                                                      \
+            out[k] = pt[k] ^ iv[k];                                                                     \
+        }                                                                                               \
+        memcpy(iv, ct, AES_BLOCK_SIZE);                                                                 \
+        in  += AES_BLOCK_SIZE;                                                                          \
+        out += AES_BLOCK_SIZE;                                                                          \
+    }                                                                                                   \
+    memset(pt, 0, sizeof(pt));                                                                          \
+}                                                                                                       \
+                                                                                                        \
+static const BlockCipherModeKernels AES##bits##_MODE_KERNELS = {                                        \
+    .ctr         = aes##bits##_ctr,                                                                     \
+    .cbc_encrypt = aes##bits##_cbc_encrypt,                                                             \
+    .cbc_decrypt = aes##bits##_cbc_decrypt                                                              \
+};                                                                                                      \
+                                                                                                        \
+const BlockCipherModeKernels *get_aes##bits##_mode_kernels(void) { return &AES##bits##_MODE_KERNELS; }
+
+AES_MODE_KERNELS(128)
+AES_MODE_KERNELS(192)
+AES_MODE_KERNELS(256)
@@ -0,0 +1,329 @@
+/* File: src/block_cipher/block_cipher_aes_bitsliced.c */
+
+/**
+ * @file block_cipher_aes_bitsliced.c
+ * @brief Key-agile AES encryption of AES_BITSLICED_LANES blocks in bitsliced 64-bit words.
+ * @details Four blocks are held in eight 64-bit words, word i carrying bit i of every byte of the
+ *          four states (the layout of the "ct64" implementation in BearSSL). SubBytes is the
+ *          Boyar-Peralta circuit of 113 gates, and ShiftRows and MixColumns are shifts and rotations
+ *          of the words, so there are no table lookups and no data-dependent memory accesses.
+ *
+ *          Every lane has its own key, so the round keys are transposed the same way as the states:
+ *          for each round, the four lanes' round keys become eight words (a structure of arrays, one
+ *          array per bit plane) and AddRoundKey stays eight XORs. The transposed schedule lives on
+ *          the stack for one group of blocks and is wiped afterwards.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/block_cipher/block_cipher_aes.h"
+
+/* The bytes of a schedule word of aes_set_encrypt_key (big-endian) as a little-endian word */
+static inline u32 aes_bs_swap32(u32 x) {
+    return (x >> 24) | ((x >> 8) & 0x0000ff00) | ((x << 8) & 0x00ff0000) | (x << 24);
+}
+
+static inline u32 aes_bs_load32le(const u8 *p) {
+    return (u32)p[0] | ((u32)p[1] << 8) | ((u32)p[2] << 16) | ((u32)p[3] << 24);
+}
+
+static inline void aes_bs_store32le(u8 *p, u32 x) {
+    p[0] = (u8)x; p[1] = (u8)(x >> 8); p[2] = (u8)(x >> 16); p[3] = (u8)(x >> 24);
+}
+
+/* Spread the four little-endian words of one block over two words, 16 bits of each per byte lane */
+static inline void aes_bs_interleave_in(u64 *q0, u64 *q1, const u32 *w) {
+    u64 x0 = w[0], x1 = w[1], x2 = w[2], x3 = w[3];
+
+    x0 |= (x0 << 16); x1 |= (x1 << 16); x2 |= (x2 << 16); x3 |= (x3 << 16);
+    x0 &= 0x0000FFFF0000FFFFULL; x1 &= 0x0000FFFF0000FFFFULL;
+    x2 &= 0x0000FFFF0000FFFFULL; x3 &= 0x0000FFFF0000FFFFULL;
+    x0 |= (x0 << 8); x1 |= (x1 << 8); x2 |= (x2 << 8); x3 |= (x3 << 8);
+    x0 &= 0x00FF00FF00FF00FFULL; x1 &= 0x00FF00FF00FF00FFULL;
+    x2 &= 0x00FF00FF00FF00FFULL; x3 &= 0x00FF00FF00FF00FFULL;
+    *q0 = x0 | (x2 << 8);
+    *q1 = x1 | (x3 << 8);
+}
+
+static inline void aes_bs_interleave_out(u32 *w, u64 q0, u64 q1) {
+    u64 x0 = q0 & 0x00FF00FF00FF00FFULL;
+    u64 x1 = q1 & 0x00FF00FF00FF00FFULL;
+    u64 x2 = (q0 >> 8) & 0x00FF00FF00FF00FFULL;
+    u64 x3 = (q1 >> 8) & 0x00FF00FF00FF00FFULL;
+
+    x0 |= (x0 >> 8); x1 |= (x1 >> 8); x2 |= (x2 >> 8); x3 |= (x3 >> 8);
+    x0 &= 0x0000FFFF0000FFFFULL; x1 &= 0x0000FFFF0000FFFFULL;
+    x2 &= 0x0000FFFF0000FFFFULL; x3 &= 0x0000FFFF0000FFFFULL;
+    w[0] = (u32)x0 | (u32)(x0 >> 16);
+    w[1] = (u32)x1 | (u32)(x1 >> 16);
+    w[2] = (u32)x2 | (u32)(x2 >> 16);
+    w[3] = (u32)x3 | (u32)(x3 >> 16);
+}
+
+#define AES_BS_SWAPN(cl, ch, s, x, y) {                             \
+    u64 a_ = (x), b_ = (y);                                         \
+    (x) = (a_ & (u64)(cl)) | ((b_ & (u64)(cl)) << (s));             \
+    (y) = ((a_ & (u64)(ch)) >> (s)) | (b_ & (u64)(ch)); }
+
+#define AES_BS_SWAP2(x, y)  AES_BS_SWAPN(0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1, x, y)
+#define AES_BS_SWAP4(x, y)  AES_BS_SWAPN(0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2, x, y)
+#define AES_BS_SWAP8(x, y)  AES_BS_SWAPN(0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4, x, y)
+
+/* Transpose between byte-interleaved and bitsliced words (its own inverse) */
+static inline void aes_bs_ortho(u64 *q) {
+    AES_BS_SWAP2(q[0], q[1]); AES_BS_SWAP2(q[2], q[3]); AES_BS_SWAP2(q[4], q[5]); AES_BS_SWAP2(q[6], q[7]);
+    AES_BS_SWAP4(q[0], q[2]); AES_BS_SWAP4(q[1], q[3]); AES_BS_SWAP4(q[4], q[6]); AES_BS_SWAP4(q[5], q[7]);
+    AES_BS_SWAP8(q[0], q[4]); AES_BS_SWAP8(q[1], q[5]); AES_BS_SWAP8(q[2], q[6]); AES_BS_SWAP8(q[3], q[7]);
+}
+
+/* SubBytes on all 64 bytes: the Boyar-Peralta circuit (top linear, 32 ANDs, bottom linear) */
+static inline void aes_bs_sbox(u64 *q) {
+    u64 x0, x1, x2, x3, x4, x5, x6, x7;
+    u64 y1, y2, y3, y4, y5, y6, y7, y8, y9, y10, y11, y12, y13, y14, y15, y16, y17, y18, y19, y20, y21;
+    u64 z0, z1, z2, z3, z4, z5, z6, z7, z8, z9, z10, z11, z12, z13, z14, z15, z16, z17;
+    u64 t0, t1, t2, t3, t4, t5, t6, t7, t8, t9, t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    u64 t20, t21, t22, t23, t24, t25, t26, t27, t28, t29, t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    u64 t40, t41, t42, t43, t44, t45, t46, t47, t48, t49, t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    u64 t60, t61, t62, t63, t64, t65, t66, t67;
+    u64 s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7]; x1 = q[6]; x2 = q[5]; x3 = q[4];
+    x4 = q[3]; x5 = q[2]; x6 = q[1]; x7 = q[0];
+
+    /* Top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* Non-linear section */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* Bottom linear transformation */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+static inline void aes_bs_shift_rows(u64 *q) {
+    for (int i = 0; i < 8; i++) {
+        u64 x = q[i];
+        q[i] = (x & 0x000000000000FFFFULL)
+             | ((x & 0x00000000FFF00000ULL) >> 4)
+             | ((x & 0x00000000000F0000ULL) << 12)
+             | ((x & 0x0000FF0000000000ULL) >> 8)
+             | ((x & 0x000000FF00000000ULL) << 8)
+             | ((x & 0xF000000000000000ULL) >> 12)
+             | ((x & 0x0FFF000000000000ULL) << 4);
+    }
+}
+
+static inline u64 aes_bs_rotr32(u64 x) {
+    return (x << 32) | (x >> 32);
+}
+
+static inline void aes_bs_mix_columns(u64 *q) {
+    u64 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3], q4 = q[4], q5 = q[5], q6 = q[6], q7 = q[7];
+    u64 r0 = (q0 >> 16) | (q0 << 48);
+    u64 r1 = (q1 >> 16) | (q1 << 48);
+    u64 r2 = (q2 >> 16) | (q2 << 48);
+    u64 r3 = (q3 >> 16) | (q3 << 48);
+    u64 r4 = (q4 >> 16) | (q4 << 48);
+    u64 r5 = (q5 >> 16) | (q5 << 48);
+    u64 r6 = (q6 >> 16) | (q6 << 48);
+    u64 r7 = (q7 >> 16) | (q7 << 48);
+
+    q[0] = q7 ^ r7 ^ r0 ^ aes_bs_rotr32(q0 ^ r0);
+    q[1] = q0 ^ r0 ^ q7 ^ r7 ^ r1 ^ aes_bs_rotr32(q1 ^ r1);
+    q[2] = q1 ^ r1 ^ r2 ^ aes_bs_rotr32(q2 ^ r2);
+    q[3] = q2 ^ r2 ^ q7 ^ r7 ^ r3 ^ aes_bs_rotr32(q3 ^ r3);
+    q[4] = q3 ^ r3 ^ q7 ^ r7 ^ r4 ^ aes_bs_rotr32(q4 ^ r4);
+    q[5] = q4 ^ r4 ^ r5 ^ aes_bs_rotr32(q5 ^ r5);
+    q[6] = q5 ^ r5 ^ r6 ^ aes_bs_rotr32(q6 ^ r6);
+    q[7] = q6 ^ r6 ^ r7 ^ aes_bs_rotr32(q7 ^ r7);
+}
+
+static inline void aes_bs_add_round_key(u64 *q, const u64 *sk) {
+    for (int i = 0; i < 8; i++) q[i] ^= sk[i];
+}
+
+/* Round keys 0..r of four lanes, transposed into sk[8 * i .. 8 * i + 7] for round i */
+static void aes_bs_schedule(u64 *sk, const u32 *const *rks, int r) {
+    for (int i = 0; i <= r; i++) {
+        u64 *q = sk + 8 * i;
+        for (int l = 0; l < AES_BITSLICED_LANES; l++) {
+            u32 w[4];
+            for (int j = 0; j < 4; j++) w[j] = aes_bs_swap32(rks[l][4 * i + j]);
+            aes_bs_interleave_in(&q[l], &q[l + 4], w);
+        }
+        aes_bs_ortho(q);
+    }
+}
+
+/* Encrypt four blocks (64 bytes) under the transposed schedule sk */
+static void aes_bs_encrypt4(const u64 *sk, const u8 *in, u8 *out, int r) {
+    u64 q[8];
+
+    for (int l = 0; l < AES_BITSLICED_LANES; l++) {
+        u32 w[4];
+        for (int j = 0; j < 4; j++) w[j] = aes_bs_load32le(in + 16 * l + 4 * j);
+        aes_bs_interleave_in(&q[l], &q[l + 4], w);
+    }
+    aes_bs_ortho(q);
+
+    aes_bs_add_round_key(q, sk);
+    for (int i = 1; i < r; i++) {
+        aes_bs_sbox(q);
+        aes_bs_shift_rows(q);
+        aes_bs_mix_columns(q);
+        aes_bs_add_round_key(q, sk + 8 * i);
+    }
+    aes_bs_sbox(q);
+    aes_bs_shift_rows(q);
+    aes_bs_add_round_key(q, sk + 8 * r);
+
+    aes_bs_ortho(q);
+    for (int l = 0; l < AES_BITSLICED_LANES; l++) {
+        u32 w[4];
+        aes_bs_interleave_out(w, q[l], q[l + 4]);
+        for (int j = 0; j < 4; j++) aes_bs_store32le(out + 16 * l + 4 * j, w[j]);
+    }
+}
+
+void aes_encrypt_batch_bitsliced(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r) {
+    u64 sk[8 * (AES256_NUM_ROUNDS + 1)];
+
+    for (; num_blocks >= AES_BITSLICED_LANES; num_blocks -= AES_BITSLICED_LANES) {
+        aes_bs_schedule(sk, rks, r);
+        aes_bs_encrypt4(sk, in, out, r);
+        rks += AES_BITSLICED_LANES;
+        in  += AES_BITSLICED_LANES * AES_BLOCK_SIZE;
+        out += AES_BITSLICED_LANES * AES_BLOCK_SIZE;
+    }
+    if (num_blocks) {
+        // Fill the unused lanes with copies of the first block and key
+        const u32 *tail_rks[AES_BITSLICED_LANES];
+        u8 buf[AES_BITSLICED_LANES * AES_BLOCK_SIZE];
+        for (size_t l = 0; l < AES_BITSLICED_LANES; l++) {
+            const size_t src = l < num_blocks ? l : 0;
+            tail_rks[l] = rks[src];
+            memcpy(buf + l * AES_BLOCK_SIZE, in + src * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+        aes_bs_schedule(sk, tail_rks, r);
+        aes_bs_encrypt4(sk, buf, buf, r);
+        memcpy(out, buf, num_blocks * AES_BLOCK_SIZE);
+        cryptomodule_wipe(buf, sizeof(buf));
+    }
+    cryptomodule_wipe(sk, sizeof(sk));
+}
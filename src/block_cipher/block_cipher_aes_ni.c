@@ -0,0 +1,77 @@
+/* File: src/block_cipher/block_cipher_aes_ni.c */
+
+/**
+ * @file block_cipher_aes_ni.c
+ * @brief Key-agile AES encryption of AES_NI_BATCH_LANES blocks with AESENC/AESENCLAST.
+ * @details AESENC has a latency of several cycles but issues every cycle, so one block leaves the
+ *          unit mostly idle. Here eight blocks, each under its own key, go through the rounds side by
+ *          side. The schedules of aes_set_encrypt_key hold big-endian words; PSHUFB turns each round
+ *          key back into byte order as it is loaded. The functions carry target attributes, so the
+ *          file builds with the project's generic CFLAGS and the code is only reached when
+ *          cryptomodule_cpu_has() reports AES-NI and SSSE3.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/block_cipher/block_cipher_aes.h"
+
+#if AES_HAVE_X86
+
+#include <immintrin.h>
+
+#define AES_NI_LOADU(p)         _mm_loadu_si128((const __m128i *)(p))
+#define AES_NI_STOREU(p, v)     _mm_storeu_si128((__m128i *)(p), (v))
+
+/* Round key i of a schedule, in the byte order of the instructions */
+#define AES_NI_KEY(rk, i)       _mm_shuffle_epi8(AES_NI_LOADU((rk) + 4 * (i)), bswap)
+
+/* One operation on the eight lanes, lane l with round key i of rks[l] */
+#define AES_NI_LANES8(op, i) {                                                          \
+    s0 = op(s0, AES_NI_KEY(rks[0], i)); s1 = op(s1, AES_NI_KEY(rks[1], i));             \
+    s2 = op(s2, AES_NI_KEY(rks[2], i)); s3 = op(s3, AES_NI_KEY(rks[3], i));             \
+    s4 = op(s4, AES_NI_KEY(rks[4], i)); s5 = op(s5, AES_NI_KEY(rks[5], i));             \
+    s6 = op(s6, AES_NI_KEY(rks[6], i)); s7 = op(s7, AES_NI_KEY(rks[7], i)); }
+
+__attribute__((target("aes,ssse3")))
+static void aes_ni_encrypt8(const u32 *const *rks, const u8 *in, u8 *out, int r) {
+    const __m128i bswap = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+    __m128i s0 = AES_NI_LOADU(in      ), s1 = AES_NI_LOADU(in +  16);
+    __m128i s2 = AES_NI_LOADU(in +  32), s3 = AES_NI_LOADU(in +  48);
+    __m128i s4 = AES_NI_LOADU(in +  64), s5 = AES_NI_LOADU(in +  80);
+    __m128i s6 = AES_NI_LOADU(in +  96), s7 = AES_NI_LOADU(in + 112);
+
+    AES_NI_LANES8(_mm_xor_si128, 0);
+    for (int i = 1; i < r; i++) {
+        AES_NI_LANES8(_mm_aesenc_si128, i);
+    }
+    AES_NI_LANES8(_mm_aesenclast_si128, r);
+
+    AES_NI_STOREU(out      , s0); AES_NI_STOREU(out +  16, s1);
+    AES_NI_STOREU(out +  32, s2); AES_NI_STOREU(out +  48, s3);
+    AES_NI_STOREU(out +  64, s4); AES_NI_STOREU(out +  80, s5);
+    AES_NI_STOREU(out +  96, s6); AES_NI_STOREU(out + 112, s7);
+}
+
+__attribute__((target("aes,ssse3")))
+void aes_encrypt_batch_aesni(const u32 *const *rks, const u8 *in, u8 *out, size_t num_blocks, int r) {
+    for (; num_blocks >= AES_NI_BATCH_LANES; num_blocks -= AES_NI_BATCH_LANES) {
+        aes_ni_encrypt8(rks, in, out, r);
+        rks += AES_NI_BATCH_LANES;
+        in  += AES_NI_BATCH_LANES * AES_BLOCK_SIZE;
+        out += AES_NI_BATCH_LANES * AES_BLOCK_SIZE;
+    }
+    if (num_blocks) {
+        // Fill the unused lanes with copies of the first block and key
+        const u32 *tail_rks[AES_NI_BATCH_LANES];
+        u8 buf[AES_NI_BATCH_LANES * AES_BLOCK_SIZE];
+        for (size_t l = 0; l < AES_NI_BATCH_LANES; l++) {
+            const size_t src = l < num_blocks ? l : 0;
+            tail_rks[l] = rks[src];
+            memcpy(buf + l * AES_BLOCK_SIZE, in + src * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+        aes_ni_encrypt8(tail_rks, buf, buf, r);
+        memcpy(out, buf, num_blocks * AES_BLOCK_SIZE);
+        cryptomodule_wipe(buf, sizeof(buf));
+    }
+}
+
+#endif /* AES_HAVE_X86 */
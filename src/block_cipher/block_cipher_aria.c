@@ -64,7 +64,7 @@
      if (!ctx) return;
 
      // Clear sensitive data
-     memset(ctx->cipher_state.aria_internal.round_keys, 0, sizeof(ctx->cipher_state.aria_internal.round_keys));
+     cryptomodule_wipe(&ctx->cipher_state.aria_internal, sizeof(ctx->cipher_state.aria_internal));
      ctx->cipher_api = NULL;
  }
 
@@ -1,27 +1,90 @@
 /* File: src/block_cipher/block_cipher_factory.c */
 #include "../../include/block_cipher/api_block_cipher.h"
 
-/* 
-   If you had block_cipher_aria.h, block_cipher_lea.h, you'd include them too.
-   e.g. #include "block_cipher_aria.h"
-*/
+/*
+ * Lookup tables indexed by block_cipher_type_index(): the API specialized for each type and the
+ * API of its family. ARIA and LEA have one implementation for all key sizes, so both tables hold
+ * their family API.
+ */
+typedef const BlockCipherApi *(*block_cipher_api_getter)(void);
 
-// #include <string.h>
+static const block_cipher_api_getter block_cipher_type_apis[BLOCK_CIPHER_TYPE_COUNT] = {
+    get_aes128_api, get_aes192_api, get_aes256_api,
+    get_aria_api,   get_aria_api,   get_aria_api,
+    get_lea_api,    get_lea_api,    get_lea_api,
+};
+
+static const block_cipher_api_getter block_cipher_family_apis[BLOCK_CIPHER_TYPE_COUNT] = {
+    get_aes_api,    get_aes_api,    get_aes_api,
+    get_aria_api,   get_aria_api,   get_aria_api,
+    get_lea_api,    get_lea_api,    get_lea_api,
+};
+
+static const BlockCipherType block_cipher_types[BLOCK_CIPHER_TYPE_COUNT] = {
+    BLOCK_CIPHER_AES128,  BLOCK_CIPHER_AES192,  BLOCK_CIPHER_AES256,
+    BLOCK_CIPHER_ARIA128, BLOCK_CIPHER_ARIA192, BLOCK_CIPHER_ARIA256,
+    BLOCK_CIPHER_LEA128,  BLOCK_CIPHER_LEA192,  BLOCK_CIPHER_LEA256,
+};
+
+const BlockCipherApi *block_cipher_get_api(BlockCipherType type) {
+    int index = block_cipher_type_index(type);
+    return index < 0 ? NULL : block_cipher_type_apis[index]();
+}
+
+const BlockCipherApi *block_cipher_factory_by_type(BlockCipherType type) {
+    int index = block_cipher_type_index(type);
+    return index < 0 ? NULL : block_cipher_family_apis[index]();
+}
+
+const BlockCipherApi *block_cipher_resolve(BlockCipherType type, size_t key_len) {
+    return key_len == block_cipher_key_size(type) ? block_cipher_get_api(type) : block_cipher_factory_by_type(type);
+}
+
+/* Fused mode kernels by type index; NULL where the cipher has none */
+typedef const BlockCipherModeKernels *(*block_cipher_kernels_getter)(void);
+
+static const block_cipher_kernels_getter block_cipher_mode_kernels[BLOCK_CIPHER_TYPE_COUNT] = {
+    get_aes128_mode_kernels, get_aes192_mode_kernels, get_aes256_mode_kernels,
+    NULL, NULL, NULL,
+    NULL, NULL, NULL,
+};
+
+const BlockCipherModeKernels *block_cipher_get_mode_kernels(BlockCipherType type, size_t key_len) {
+    int index = block_cipher_type_index(type);
+    if (index < 0 || key_len != block_cipher_key_size(type) || !block_cipher_mode_kernels[index]) return NULL;
+    return block_cipher_mode_kernels[index]();
+}
+
+BlockCipherContext *block_cipher_ctx_new(const BlockCipherApi *cipher_api) {
+    BlockCipherContext *cipher_ctx = cryptomodule_alloc(sizeof(BlockCipherContext));
+    if (cipher_ctx) cipher_ctx->cipher_api = cipher_api;
+    return cipher_ctx;
+}
+
+void block_cipher_ctx_free(BlockCipherContext *cipher_ctx) {
+    if (!cipher_ctx) return;
+    if (cipher_ctx->cipher_api && cipher_ctx->cipher_api->cipher_dispose) {
+        cipher_ctx->cipher_api->cipher_dispose(cipher_ctx);
+    }
+    cryptomodule_free(cipher_ctx, sizeof(BlockCipherContext));
+}
 
 const BlockCipherApi* block_cipher_factory(const char *name) {
     if (!name) return NULL;
 
-    if (strcmp(name, "AES") == 0) {
-        return get_aes_api();
-    } else if   (strcmp(name, "ARIA") == 0) {
-        return get_aria_api();
-    } else if (strcmp(name, "LEA") == 0) {
-        return get_lea_api();
-    } else {
-        return NULL; // unknown
+    /* "AES", "ARIA", "LEA": the family API (any key size) */
+    for (int i = 0; i < BLOCK_CIPHER_TYPE_COUNT; i += 3) {
+        if (strcmp(name, block_cipher_family_name(block_cipher_types[i])) == 0) {
+            return block_cipher_family_apis[i]();
+        }
+    }
+    /* "AES-128", ..., "LEA-256": the API of the type */
+    for (int i = 0; i < BLOCK_CIPHER_TYPE_COUNT; i++) {
+        if (strcmp(name, block_cipher_type_to_string(block_cipher_types[i])) == 0) {
+            return block_cipher_type_apis[i]();
+        }
     }
-    
-    return NULL;
+    return NULL; // unknown
 }
 
 void print_cipher_internal(const BlockCipherContext* cipher_ctx, const char* cipher_type) {
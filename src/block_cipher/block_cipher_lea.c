@@ -62,7 +62,7 @@ block_cipher_status_t lea_process(BlockCipherContext *ctx, const u8 *in, u8 *out
 }
 void lea_dispose(BlockCipherContext *ctx) {
     if (!ctx) return;
-    memset(ctx, 0, sizeof(*ctx));
+    cryptomodule_wipe(ctx, sizeof(*ctx));
 }
 
 void lea_set_encrypt_key(const u8 *key, size_t bytes, u32 *rk) {
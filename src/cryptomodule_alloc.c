@@ -0,0 +1,232 @@
+/* File: src/cryptomodule_alloc.c */
+
+/**
+ * @file cryptomodule_alloc.c
+ * @brief Size-class pool with per-thread free lists, and the application allocator hook.
+ * @details A free block holds only the link to the next free block in its first word, and is
+ *          otherwise zero: blocks are wiped over their whole class size when released, and slabs
+ *          are zeroed when carved. Allocating is therefore an unlink and one store.
+ *
+ *          A thread takes blocks from its own lists. When a list is empty it takes a batch from the
+ *          shared list of the class, or else carves a new slab; when a list grows past
+ *          POOL_THREAD_MAX it returns a batch to the shared list. Blocks may be released by
+ *          another thread than the one that allocated them. Slabs are never returned to the system.
+ */
+
+#define _POSIX_C_SOURCE 200112L    // posix_memalign
+
+#include "../include/api_cryptomodule.h"
+#include "../include/cryptomodule_alloc.h"
+
+#include <pthread.h>
+
+#define POOL_MIN_SHIFT      6                   // Smallest class: 64 bytes (one cache line)
+#define POOL_NUM_CLASSES    7                   // 64, 128, ..., 4096 bytes
+#define POOL_SLAB_SIZE      (64 * 1024)         // Bytes carved from the system per refill
+#define POOL_BATCH          16                  // Blocks moved between a thread and the shared lists
+#define POOL_THREAD_MAX     (4 * POOL_BATCH)    // Blocks of a class a thread keeps
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block;
+
+typedef struct {
+    pool_block *head[POOL_NUM_CLASSES];
+    size_t count[POOL_NUM_CLASSES];
+    bool registered;                    // The exit destructor is armed for this thread
+} pool_thread_cache;
+
+static __thread pool_thread_cache thread_cache;
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pool_block *pool_shared[POOL_NUM_CLASSES];   // Guarded by pool_lock
+
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_key;
+
+static cryptomodule_allocator pool_custom;          // Application allocator (alloc == NULL: none)
+static size_t pool_live = 0;                        // Blocks handed out and not released
+
+/*
+ * memset at full speed (blocks are up to 4 KiB), then a compiler barrier that treats the memory as
+ * read, so the stores cannot be dropped as dead even though the block is freed right after.
+ */
+void cryptomodule_wipe(void *p, size_t len) {
+    if (!p || !len) return;
+    memset(p, 0, len);
+    __asm__ __volatile__("" : : "r"(p) : "memory");
+}
+
+/* Size class of a request, or -1 above CRYPTOMODULE_POOL_MAX_SIZE */
+static int pool_class(size_t size) {
+    int c = 0;
+    while (c < POOL_NUM_CLASSES && ((size_t)1 << (POOL_MIN_SHIFT + c)) < size) c++;
+    return c < POOL_NUM_CLASSES ? c : -1;
+}
+
+static size_t pool_round_up(size_t size) {
+    return (size + CRYPTOMODULE_CACHE_LINE - 1) & ~(size_t)(CRYPTOMODULE_CACHE_LINE - 1);
+}
+
+/* Move every cached block of the thread to the shared lists */
+static void pool_flush(pool_thread_cache *tc) {
+    pthread_mutex_lock(&pool_lock);
+    for (int c = 0; c < POOL_NUM_CLASSES; c++) {
+        while (tc->head[c]) {
+            pool_block *b = tc->head[c];
+            tc->head[c] = b->next;
+            b->next = pool_shared[c];
+            pool_shared[c] = b;
+        }
+        tc->count[c] = 0;
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+static void pool_thread_exit(void *arg) {
+    pool_flush((pool_thread_cache *)arg);
+}
+
+/* The shared lists stay consistent across fork(): the lock is held while the process is copied */
+static void pool_fork_prepare(void) { pthread_mutex_lock(&pool_lock); }
+static void pool_fork_release(void) { pthread_mutex_unlock(&pool_lock); }
+
+static void pool_create_key(void) {
+    pthread_key_create(&pool_key, pool_thread_exit);
+    pthread_atfork(pool_fork_prepare, pool_fork_release, pool_fork_release);
+}
+
+/* Arm the destructor that hands the thread's blocks back when it exits */
+static void pool_register_thread(pool_thread_cache *tc) {
+    pthread_once(&pool_key_once, pool_create_key);
+    pthread_setspecific(pool_key, tc);
+    tc->registered = true;
+}
+
+/* Fill an empty thread list of class c from the shared list, or from a new slab */
+static bool pool_refill(pool_thread_cache *tc, int c) {
+    const size_t block_size = (size_t)1 << (POOL_MIN_SHIFT + c);
+
+    if (!tc->registered) pool_register_thread(tc);
+
+    pthread_mutex_lock(&pool_lock);
+    while (pool_shared[c] && tc->count[c] < POOL_BATCH) {
+        pool_block *b = pool_shared[c];
+        pool_shared[c] = b->next;
+        b->next = tc->head[c];
+        tc->head[c] = b;
+        tc->count[c]++;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    if (tc->head[c]) return true;
+
+    // New slab: the thread keeps the first batch and the shared list gets the rest
+    void *slab = NULL;
+    if (posix_memalign(&slab, CRYPTOMODULE_CACHE_LINE, POOL_SLAB_SIZE) != 0) return false;
+    memset(slab, 0, POOL_SLAB_SIZE);
+
+    const size_t num_blocks = POOL_SLAB_SIZE / block_size;
+    size_t i = 0;
+    for (; i < num_blocks && i < POOL_BATCH; i++) {
+        pool_block *b = (pool_block *)((u8 *)slab + i * block_size);
+        b->next = tc->head[c];
+        tc->head[c] = b;
+        tc->count[c]++;
+    }
+    pthread_mutex_lock(&pool_lock);
+    for (; i < num_blocks; i++) {
+        pool_block *b = (pool_block *)((u8 *)slab + i * block_size);
+        b->next = pool_shared[c];
+        pool_shared[c] = b;
+    }
+    pthread_mutex_unlock(&pool_lock);
+    return true;
+}
+
+void *cryptomodule_alloc(size_t size) {
+    void *p = NULL;
+
+    if (size == 0) return NULL;
+
+    if (pool_custom.alloc) {
+        p = pool_custom.alloc(pool_custom.opaque, size);
+        if (p) memset(p, 0, size);
+    } else {
+        int c = pool_class(size);
+        if (c < 0) {
+            if (posix_memalign(&p, CRYPTOMODULE_CACHE_LINE, pool_round_up(size)) != 0) p = NULL;
+            if (p) memset(p, 0, size);
+        } else {
+            pool_thread_cache *tc = &thread_cache;
+            if (tc->head[c] || pool_refill(tc, c)) {
+                pool_block *b = tc->head[c];
+                tc->head[c] = b->next;
+                tc->count[c]--;
+                b->next = NULL;     // The rest of a free block is already zero
+                p = b;
+            }
+        }
+    }
+
+    if (p) __atomic_fetch_add(&pool_live, 1, __ATOMIC_RELAXED);
+    return p;
+}
+
+void cryptomodule_free(void *ptr, size_t size) {
+    if (!ptr) return;
+    __atomic_fetch_sub(&pool_live, 1, __ATOMIC_RELAXED);
+
+    if (pool_custom.alloc) {
+        cryptomodule_wipe(ptr, size);
+        pool_custom.release(pool_custom.opaque, ptr, size);
+        return;
+    }
+
+    int c = pool_class(size);
+    if (c < 0) {
+        cryptomodule_wipe(ptr, size);
+        free(ptr);
+        return;
+    }
+
+    // Wipe the whole block, so that free blocks stay zero past the link word
+    pool_thread_cache *tc = &thread_cache;
+    pool_block *b = (pool_block *)ptr;
+    cryptomodule_wipe(b, (size_t)1 << (POOL_MIN_SHIFT + c));
+    if (!tc->registered) pool_register_thread(tc);
+    b->next = tc->head[c];
+    tc->head[c] = b;
+    tc->count[c]++;
+
+    if (tc->count[c] > POOL_THREAD_MAX) {
+        pthread_mutex_lock(&pool_lock);
+        for (int i = 0; i < POOL_BATCH; i++) {
+            b = tc->head[c];
+            tc->head[c] = b->next;
+            b->next = pool_shared[c];
+            pool_shared[c] = b;
+        }
+        pthread_mutex_unlock(&pool_lock);
+        tc->count[c] -= POOL_BATCH;
+    }
+}
+
+cryptomodule_status_t cryptomodule_set_allocator(const cryptomodule_allocator *allocator) {
+    if (allocator && (!allocator->alloc || !allocator->release)) return CRYPTOMODULE_ERR_INVALID_INPUT;
+    if (cryptomodule_alloc_live() != 0) return CRYPTOMODULE_ERR_INVALID_INPUT;
+
+    if (allocator) {
+        pool_custom = *allocator;
+    } else {
+        memset(&pool_custom, 0, sizeof(pool_custom));
+    }
+    return CRYPTOMODULE_OK;
+}
+
+size_t cryptomodule_alloc_live(void) {
+    return __atomic_load_n(&pool_live, __ATOMIC_RELAXED);
+}
+
+void cryptomodule_pool_flush_thread(void) {
+    pool_flush(&thread_cache);
+}
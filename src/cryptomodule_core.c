@@ -4,7 +4,14 @@
 cryptomodule_status_t cryptomodule_init(void)
 {
     /* Possibly do library-wide init, e.g. RNG seed. */
-    return CRYPTOMODULE_OK;
+    cryptomodule_cpu_features();
+    SHA2_init_dispatch();
+    SHA3_x4_init_dispatch();
+    LSH_init_dispatch();
+    aes_batch_init_dispatch();
+
+    /* Forced backends (e.g. CRYPTOMODULE_BACKEND="sha256=c,lsh=sse2") for benchmarks */
+    return cryptomodule_apply_backends(getenv("CRYPTOMODULE_BACKEND"));
 }
 
 cryptomodule_status_t cryptomodule_cleanup(void)
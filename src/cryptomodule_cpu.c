@@ -0,0 +1,312 @@
+/* File: src/cryptomodule_cpu.c */
+
+/**
+ * @file cryptomodule_cpu.c
+ * @brief CPU feature probe (CPUID/XGETBV, once per process) and the backend registry.
+ */
+
+#include "../include/api_cryptomodule.h"
+#include "../include/cryptomodule_cpu.h"
+
+#include <ctype.h>
+#include <pthread.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_HAVE_X86    1
+#include <cpuid.h>
+#else
+#define CPU_HAVE_X86    0
+#endif
+
+static const char *const cpu_feature_names[CRYPTOMODULE_CPU_FEATURE_COUNT] = {
+    "sse2", "ssse3", "sse4_1", "avx", "avx2", "avx512f", "avx512bw",
+    "aesni", "pclmul", "vaes", "vpclmulqdq", "sha_ni", "gfni",
+};
+
+static pthread_once_t cpu_probe_once = PTHREAD_ONCE_INIT;
+static u32 cpu_detected = 0;
+static u32 cpu_disabled = 0;
+static u32 cpu_features = 0;
+
+/* ASCII case-insensitive comparison of s[0..len) with the NUL-terminated name */
+static bool cpu_name_equals(const char *s, size_t len, const char *name) {
+    size_t i;
+
+    for (i = 0; i < len && name[i]; i++) {
+        if (tolower((unsigned char)s[i]) != name[i]) return false;
+    }
+    return i == len && name[i] == '\0';
+}
+
+/* s[0..len) without leading and trailing blanks */
+static const char *cpu_trim(const char *s, size_t *len) {
+    while (*len && isspace((unsigned char)s[0])) { s++; (*len)--; }
+    while (*len && isspace((unsigned char)s[*len - 1])) (*len)--;
+    return s;
+}
+
+#if CPU_HAVE_X86
+static u64 cpu_xgetbv(void) {
+    u32 lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((u64)hi << 32) | lo;
+}
+
+static u32 cpu_probe_x86(void) {
+    unsigned int eax, ebx, ecx, edx, ecx1;
+    u64 xcr0 = 0;
+    u32 f = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx1, &edx)) {
+        return 0;
+    }
+    if (edx & bit_SSE2)     f |= CRYPTOMODULE_CPU_SSE2;
+    if (ecx1 & bit_SSSE3)   f |= CRYPTOMODULE_CPU_SSSE3;
+    if (ecx1 & bit_SSE4_1)  f |= CRYPTOMODULE_CPU_SSE41;
+    if (ecx1 & bit_AES)     f |= CRYPTOMODULE_CPU_AESNI;
+    if (ecx1 & bit_PCLMUL)  f |= CRYPTOMODULE_CPU_PCLMUL;
+    if (ecx1 & bit_OSXSAVE) xcr0 = cpu_xgetbv();
+
+    // AVX needs the XMM and YMM state saved by the OS, AVX-512 the opmask and ZMM state as well
+    const bool ymm = (xcr0 & 0x06) == 0x06;
+    const bool zmm = (xcr0 & 0xE6) == 0xE6;
+    if (ymm && (ecx1 & bit_AVX)) f |= CRYPTOMODULE_CPU_AVX;
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return f;
+    }
+    if (ebx & bit_SHA)      f |= CRYPTOMODULE_CPU_SHA_NI;
+    if (ecx & bit_GFNI)     f |= CRYPTOMODULE_CPU_GFNI;
+    if (f & CRYPTOMODULE_CPU_AVX) {
+        if (ebx & bit_AVX2)         f |= CRYPTOMODULE_CPU_AVX2;
+        if (ecx & bit_VAES)         f |= CRYPTOMODULE_CPU_VAES;
+        if (ecx & bit_VPCLMULQDQ)   f |= CRYPTOMODULE_CPU_VPCLMULQDQ;
+        if (zmm && (ebx & bit_AVX512F)) {
+            f |= CRYPTOMODULE_CPU_AVX512F;
+            if (ebx & bit_AVX512BW) f |= CRYPTOMODULE_CPU_AVX512BW;
+        }
+    }
+    return f;
+}
+#endif
+
+/* Feature bits named in a comma-separated list; unknown names are ignored */
+static u32 cpu_parse_features(const char *list) {
+    u32 mask = 0;
+
+    while (list && *list) {
+        size_t len = strcspn(list, ",");
+        size_t tlen = len;
+        const char *name = cpu_trim(list, &tlen);
+
+        for (int i = 0; i < CRYPTOMODULE_CPU_FEATURE_COUNT; i++) {
+            if (cpu_name_equals(name, tlen, cpu_feature_names[i])) mask |= 1u << i;
+        }
+        list += len + (list[len] == ',');
+    }
+    return mask;
+}
+
+static void cpu_probe(void) {
+#if CPU_HAVE_X86
+    cpu_detected = cpu_probe_x86();
+#endif
+    cpu_disabled = cpu_parse_features(getenv("CRYPTOMODULE_CPU_DISABLE"));
+    cpu_features = cpu_detected & ~cpu_disabled;
+}
+
+u32 cryptomodule_cpu_features(void) {
+    pthread_once(&cpu_probe_once, cpu_probe);
+    return cpu_features;
+}
+
+bool cryptomodule_cpu_has(u32 features) {
+    return (cryptomodule_cpu_features() & features) == features;
+}
+
+u32 cryptomodule_cpu_features_detected(void) {
+    pthread_once(&cpu_probe_once, cpu_probe);
+    return cpu_detected;
+}
+
+const char *cryptomodule_cpu_feature_name(u32 feature) {
+    for (int i = 0; i < CRYPTOMODULE_CPU_FEATURE_COUNT; i++) {
+        if (feature == 1u << i) return cpu_feature_names[i];
+    }
+    return NULL;
+}
+
+/* ----------------------------------- Backend registry ---------------------------------- */
+
+static bool sha256_set(int id)          { return SHA2_sha256_set_backend((SHA2_backend_t)id); }
+static int sha256_get(void)             { return (int)SHA2_sha256_get_backend(); }
+
+static bool sha512_set(int id)          { return SHA2_sha512_set_backend((SHA2_backend_t)id); }
+static int sha512_get(void)             { return (int)SHA2_sha512_get_backend(); }
+
+static bool sha256_multi_set(int id)    { return SHA2_sha256_multi_set_backend((SHA2_backend_t)id); }
+static int sha256_multi_get(void)       { return (int)SHA2_sha256_multi_get_backend(); }
+
+static bool sha3_x4_set(int id)         { return SHA3_x4_set_backend((SHA3_backend_t)id); }
+static int sha3_x4_get(void)            { return (int)SHA3_x4_get_backend(); }
+
+static bool lsh_set(int id)             { return LSH_set_backend((LSH_backend_t)id); }
+static int lsh_get(void)                { return (int)LSH_get_backend(); }
+
+static bool aes_batch_set(int id)       { return aes_batch_set_backend((aes_batch_backend_t)id); }
+static int aes_batch_get(void)          { return (int)aes_batch_get_backend(); }
+
+static const cryptomodule_backend_desc sha256_backends[] = {
+    { "c",      SHA2_BACKEND_C,         0 },
+    { "sha_ni", SHA2_BACKEND_SHA_NI,    CRYPTOMODULE_CPU_SHA_NI | CRYPTOMODULE_CPU_SSSE3 | CRYPTOMODULE_CPU_SSE41 },
+};
+
+static const cryptomodule_backend_desc sha512_backends[] = {
+    { "c",      SHA2_BACKEND_C,         0 },
+    { "avx2",   SHA2_BACKEND_AVX2,      CRYPTOMODULE_CPU_AVX2 },
+};
+
+static const cryptomodule_backend_desc sha256_multi_backends[] = {
+    { "c",      SHA2_BACKEND_C,         0 },
+    { "avx2",   SHA2_BACKEND_AVX2,      CRYPTOMODULE_CPU_AVX2 },
+    { "avx512", SHA2_BACKEND_AVX512,    CRYPTOMODULE_CPU_AVX2 | CRYPTOMODULE_CPU_AVX512F | CRYPTOMODULE_CPU_AVX512BW },
+};
+
+static const cryptomodule_backend_desc sha3_x4_backends[] = {
+    { "c",      SHA3_BACKEND_C,         0 },
+    { "avx2",   SHA3_BACKEND_AVX2,      CRYPTOMODULE_CPU_AVX2 },
+};
+
+static const cryptomodule_backend_desc lsh_backends[] = {
+    { "c",      LSH_BACKEND_C,          0 },
+    { "sse2",   LSH_BACKEND_SSE2,       CRYPTOMODULE_CPU_SSE2 },
+    { "avx2",   LSH_BACKEND_AVX2,       CRYPTOMODULE_CPU_AVX2 },
+};
+
+static const cryptomodule_backend_desc aes_batch_backends[] = {
+    { "c",          AES_BATCH_BACKEND_C,            0 },
+    { "bitsliced",  AES_BATCH_BACKEND_BITSLICED,    0 },
+    { "aesni",      AES_BATCH_BACKEND_AESNI,        CRYPTOMODULE_CPU_AESNI | CRYPTOMODULE_CPU_SSSE3 },
+};
+
+#define DISPATCH_ENTRY(name, prefix, init)  \
+    { name, prefix##_backends, sizeof(prefix##_backends) / sizeof(prefix##_backends[0]), \
+      prefix##_set, prefix##_get, init }
+
+static const cryptomodule_dispatch_entry dispatch_table[] = {
+    DISPATCH_ENTRY("sha256",        sha256,         SHA2_sha256_init_dispatch),
+    DISPATCH_ENTRY("sha512",        sha512,         SHA2_sha512_init_dispatch),
+    DISPATCH_ENTRY("sha256_multi",  sha256_multi,   SHA2_sha256_multi_init_dispatch),
+    DISPATCH_ENTRY("sha3_x4",       sha3_x4,        SHA3_x4_init_dispatch),
+    DISPATCH_ENTRY("lsh",           lsh,            LSH_init_dispatch),
+    DISPATCH_ENTRY("aes_batch",     aes_batch,      aes_batch_init_dispatch),
+};
+
+#define DISPATCH_COUNT  (sizeof(dispatch_table) / sizeof(dispatch_table[0]))
+
+const cryptomodule_dispatch_entry *cryptomodule_dispatch_table(size_t *count) {
+    if (count) *count = DISPATCH_COUNT;
+    return dispatch_table;
+}
+
+void cryptomodule_cpu_disable(u32 features) {
+    pthread_once(&cpu_probe_once, cpu_probe);
+    cpu_disabled = features;
+    cpu_features = cpu_detected & ~features;
+    for (size_t i = 0; i < DISPATCH_COUNT; i++) {
+        dispatch_table[i].init_dispatch();
+    }
+}
+
+/* Set the backend of one entry; the name is s[0..len) */
+static bool dispatch_select(const cryptomodule_dispatch_entry *e, const char *s, size_t len) {
+    if (cpu_name_equals(s, len, "auto")) {
+        e->init_dispatch();
+        return true;
+    }
+    for (size_t j = 0; j < e->num_backends; j++) {
+        if (cpu_name_equals(s, len, e->backends[j].name)) {
+            return e->set_backend(e->backends[j].id);
+        }
+    }
+    return false;
+}
+
+static cryptomodule_status_t dispatch_apply(const char *prim, size_t plen, const char *back, size_t blen) {
+    bool all = cpu_name_equals(prim, plen, "all"), found = false, ok = true;
+
+    for (size_t i = 0; i < DISPATCH_COUNT; i++) {
+        if (all || cpu_name_equals(prim, plen, dispatch_table[i].name)) {
+            found = true;
+            ok &= dispatch_select(&dispatch_table[i], back, blen);
+        }
+    }
+    return found && ok ? CRYPTOMODULE_OK : CRYPTOMODULE_ERR_INVALID_INPUT;
+}
+
+cryptomodule_status_t cryptomodule_set_backend(const char *primitive, const char *backend) {
+    if (!primitive || !backend) return CRYPTOMODULE_ERR_INVALID_INPUT;
+    return dispatch_apply(primitive, strlen(primitive), backend, strlen(backend));
+}
+
+const char *cryptomodule_get_backend(const char *primitive) {
+    if (!primitive) return NULL;
+    for (size_t i = 0; i < DISPATCH_COUNT; i++) {
+        const cryptomodule_dispatch_entry *e = &dispatch_table[i];
+        if (!cpu_name_equals(primitive, strlen(primitive), e->name)) continue;
+
+        int id = e->get_backend();
+        for (size_t j = 0; j < e->num_backends; j++) {
+            if (e->backends[j].id == id) return e->backends[j].name;
+        }
+        return NULL;
+    }
+    return NULL;
+}
+
+cryptomodule_status_t cryptomodule_apply_backends(const char *spec) {
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+
+    while (spec && *spec) {
+        size_t len = strcspn(spec, ",");
+        const char *eq = memchr(spec, '=', len);
+
+        if (eq) {
+            size_t plen = (size_t)(eq - spec), blen = len - plen - 1;
+            const char *prim = cpu_trim(spec, &plen), *back = cpu_trim(eq + 1, &blen);
+            if (dispatch_apply(prim, plen, back, blen) != CRYPTOMODULE_OK) {
+                status = CRYPTOMODULE_ERR_INVALID_INPUT;
+            }
+        } else {
+            size_t tlen = len;
+            cpu_trim(spec, &tlen);
+            if (tlen) status = CRYPTOMODULE_ERR_INVALID_INPUT;     // Blank entries are allowed
+        }
+        spec += len + (spec[len] == ',');
+    }
+    return status;
+}
+
+void cryptomodule_print_dispatch(FILE *fp) {
+    u32 detected = cryptomodule_cpu_features_detected(), features = cryptomodule_cpu_features();
+
+    fprintf(fp, "CPU features:");
+    for (int i = 0; i < CRYPTOMODULE_CPU_FEATURE_COUNT; i++) {
+        if (detected & (1u << i)) {
+            fprintf(fp, " %s%s", cpu_feature_names[i], (features & (1u << i)) ? "" : "(masked)");
+        }
+    }
+    fprintf(fp, "\n");
+
+    for (size_t i = 0; i < DISPATCH_COUNT; i++) {
+        const cryptomodule_dispatch_entry *e = &dispatch_table[i];
+        const char *current = cryptomodule_get_backend(e->name);
+
+        fprintf(fp, "  %-14s %-8s (", e->name, current ? current : "?");
+        for (size_t j = 0; j < e->num_backends; j++) {
+            bool avail = (features & e->backends[j].features) == e->backends[j].features;
+            fprintf(fp, "%s%s%s", j ? " " : "", e->backends[j].name, avail ? "" : "*");
+        }
+        fprintf(fp, ")\n");
+    }
+}
@@ -0,0 +1,163 @@
+/* File: src/cryptomodule_secure.c */
+
+/**
+ * @file cryptomodule_secure.c
+ * @brief Locked arena with O(1) size-class free lists.
+ * @details Layout of the mapping: [guard page][usable pages][guard page]. The usable region is
+ *          carved from the bottom with a bump offset; released blocks are kept on per-class free
+ *          lists, wiped except for the link word in their first bytes, and handed out before the
+ *          bump offset advances. Blocks never move between classes.
+ */
+
+#define _DEFAULT_SOURCE     // MAP_ANONYMOUS, madvise, sysconf
+
+#include "../include/api_cryptomodule.h"
+#include "../include/cryptomodule_secure.h"
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define ARENA_MIN_SHIFT     6       // Smallest class: 64 bytes, as in the pool
+#define ARENA_NUM_CLASSES   7       // 64, 128, ..., 4096 bytes
+
+typedef struct arena_block {
+    struct arena_block *next;
+} arena_block;
+
+struct cryptomodule_secure_arena {
+    u8 *map;                        // Whole mapping, guard pages included
+    size_t map_len;
+    u8 *base;                       // Usable region
+    size_t size;
+    size_t used;                    // Bump offset into the usable region
+    arena_block *free_list[ARENA_NUM_CLASSES];
+    size_t live;                    // Blocks handed out and not released
+    bool locked;
+    pthread_mutex_t lock;
+};
+
+static int arena_class(size_t size) {
+    int c = 0;
+    while (c < ARENA_NUM_CLASSES && ((size_t)1 << (ARENA_MIN_SHIFT + c)) < size) c++;
+    return c < ARENA_NUM_CLASSES ? c : -1;
+}
+
+cryptomodule_status_t cryptomodule_secure_arena_create(cryptomodule_secure_arena **arena, size_t size,
+                                                       bool require_lock) {
+    if (!arena || size == 0) return CRYPTOMODULE_ERR_INVALID_INPUT;
+    *arena = NULL;
+
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t usable = (size + page - 1) / page * page;
+    if (usable < size) return CRYPTOMODULE_ERR_INVALID_INPUT;
+
+    cryptomodule_secure_arena *a = calloc(1, sizeof(*a));
+    if (!a) return CRYPTOMODULE_ERR_OUT_OF_MEMORY;
+
+    a->map_len = usable + 2 * page;
+    a->map = mmap(NULL, a->map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (a->map == MAP_FAILED) {
+        free(a);
+        return CRYPTOMODULE_ERR_OUT_OF_MEMORY;
+    }
+    a->base = a->map + page;
+    a->size = usable;
+
+    // Guard pages: a linear overrun off either end of the arena faults instead of reading keys
+    if (mprotect(a->map, page, PROT_NONE) != 0 ||
+        mprotect(a->base + usable, page, PROT_NONE) != 0) {
+        munmap(a->map, a->map_len);
+        free(a);
+        return CRYPTOMODULE_ERR_OUT_OF_MEMORY;
+    }
+
+    // Locking also faults every page in, so blocks never page-fault when first used
+    a->locked = (mlock(a->base, usable) == 0);
+    if (!a->locked && require_lock) {
+        munmap(a->map, a->map_len);
+        free(a);
+        return CRYPTOMODULE_ERR_OUT_OF_MEMORY;
+    }
+#ifdef MADV_DONTDUMP
+    madvise(a->base, usable, MADV_DONTDUMP);
+#endif
+
+    pthread_mutex_init(&a->lock, NULL);
+    *arena = a;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t cryptomodule_secure_arena_destroy(cryptomodule_secure_arena *arena) {
+    if (!arena) return CRYPTOMODULE_ERR_INVALID_INPUT;
+
+    pthread_mutex_lock(&arena->lock);
+    const size_t live = arena->live;
+    pthread_mutex_unlock(&arena->lock);
+    if (live != 0) return CRYPTOMODULE_ERR_INVALID_INPUT;
+
+    // Free blocks keep their link words; wipe the carved part before the pages go back
+    cryptomodule_wipe(arena->base, arena->used);
+    if (arena->locked) munlock(arena->base, arena->size);
+    munmap(arena->map, arena->map_len);
+    pthread_mutex_destroy(&arena->lock);
+    free(arena);
+    return CRYPTOMODULE_OK;
+}
+
+void *cryptomodule_secure_arena_alloc(cryptomodule_secure_arena *arena, size_t size) {
+    if (!arena || size == 0) return NULL;
+    const int c = arena_class(size);
+    if (c < 0) return NULL;
+    const size_t block_size = (size_t)1 << (ARENA_MIN_SHIFT + c);
+
+    arena_block *b = NULL;
+    pthread_mutex_lock(&arena->lock);
+    if (arena->free_list[c]) {
+        b = arena->free_list[c];
+        arena->free_list[c] = b->next;
+        b->next = NULL;     // The rest of a free block is already zero
+    } else if (arena->size - arena->used >= block_size) {
+        b = (arena_block *)(arena->base + arena->used);     // Untouched pages are zero
+        arena->used += block_size;
+    }
+    if (b) arena->live++;
+    pthread_mutex_unlock(&arena->lock);
+    return b;
+}
+
+void cryptomodule_secure_arena_free(cryptomodule_secure_arena *arena, void *ptr, size_t size) {
+    if (!arena || !ptr) return;
+    const int c = arena_class(size);
+    if (c < 0) return;
+
+    arena_block *b = (arena_block *)ptr;
+    cryptomodule_wipe(b, (size_t)1 << (ARENA_MIN_SHIFT + c));
+    pthread_mutex_lock(&arena->lock);
+    b->next = arena->free_list[c];
+    arena->free_list[c] = b;
+    arena->live--;
+    pthread_mutex_unlock(&arena->lock);
+}
+
+bool cryptomodule_secure_arena_locked(const cryptomodule_secure_arena *arena) {
+    return arena && arena->locked;
+}
+
+bool cryptomodule_secure_arena_contains(const cryptomodule_secure_arena *arena, const void *ptr) {
+    const u8 *p = (const u8 *)ptr;
+    return arena && p >= arena->base && p < arena->base + arena->size;
+}
+
+static void *arena_allocator_alloc(void *opaque, size_t size) {
+    return cryptomodule_secure_arena_alloc((cryptomodule_secure_arena *)opaque, size);
+}
+
+static void arena_allocator_release(void *opaque, void *ptr, size_t size) {
+    cryptomodule_secure_arena_free((cryptomodule_secure_arena *)opaque, ptr, size);
+}
+
+cryptomodule_allocator cryptomodule_secure_arena_allocator(cryptomodule_secure_arena *arena) {
+    cryptomodule_allocator allocator = { arena_allocator_alloc, arena_allocator_release, arena };
+    return allocator;
+}
@@ -4,8 +4,13 @@
 #include "../include/cryptomodule_utils.h"
 #include "../include/block_cipher/api_block_cipher.h"
 #include "../include/block_cipher/block_cipher_aes.h"
+#include "../include/mode/api_mode.h"
 #include "../include/ansi_code.h"
 
+#include <unistd.h>      // For fork, pipe (DRBG fork test)
+#include <sys/wait.h>    // For waitpid
+#include <pthread.h>     // For the cross-thread allocator test
+
 void progress_bar(int current, int total) {
     int width = 50; // Width of the progress bar
     float progress = (float)current / total;
@@ -146,33 +151,16 @@ void create_BlockCipher_KAT_RspFile(BlockCipherType type, const char *filename_r
     BlockCipherContext cipher_ctx;
     clear_block_cipher_ctx(&cipher_ctx);
 
-    char cipher_name[5];
-    sscanf(block_cipher_type_to_string(type), "%[^-]", cipher_name);
-    // printf("[RSP] Cipher name: %s\n", cipher_name);
-    cipher_ctx.cipher_api = block_cipher_factory(cipher_name);
+    cipher_ctx.cipher_api = block_cipher_get_api(type);
     if (cipher_ctx.cipher_api == NULL) {
-        fprintf(stderr, "[RSP] No AES API available.\n");
+        fprintf(stderr, "[RSP] No %s API available.\n", block_cipher_type_to_string(type));
         free(line);
         fclose(fp_req);
         fclose(fp_rsp);
         return;
     }
 
-    int key_size = 0;
-    switch (type) {
-        case BLOCK_CIPHER_AES128:
-            key_size = AES128_KEY_SIZE;
-            break;
-        case BLOCK_CIPHER_AES192:
-            key_size = AES192_KEY_SIZE;
-            break;
-        case BLOCK_CIPHER_AES256:
-            key_size = AES256_KEY_SIZE;
-            break;
-        default:
-            key_size = AES128_KEY_SIZE;
-            break;
-    }
+    int key_size = (int)block_cipher_key_size(type);
 
     u32 *key_u32 = (u32 *)calloc(key_size / 4, sizeof(u32));
     if (key_u32 == NULL) {
@@ -464,4 +452,3082 @@ void KAT_TEST_BLOCKCIPHER(BlockCipherType type) {
         ANSI_BG_MAGENTA, ANSI_BOLD,
         ANSI_BG_DEFAULT, ANSI_RESET);
     printf("\n\n");
-}
\ No newline at end of file
+}
+
+/*
+ * Runs one ECB vector through the mode API in both directions.
+ * Returns true if E(pt) == ct and D(ct) == pt.
+ */
+static bool verify_ECB_vector(BlockCipherType type, const u8 *key, size_t key_len,
+                              const u8 *pt, const u8 *ct, size_t data_len) {
+    ModeOfOperationContext mode_ctx;
+    u8 *buf = (u8*)calloc(data_len + BLOCK_SIZE, sizeof(u8));
+    bool ok = true;
+
+    if (buf == NULL) {
+        fprintf(stderr, "[ECB] Memory allocation error\n");
+        return false;
+    }
+
+    // Encryption
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = type;
+    mode_ctx.mode_api = mode_factory("ECB");
+    mode_ctx.mode_api->mode_init(&mode_ctx, key, key_len, NULL, 0, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+    mode_ctx.mode_api->mode_process(&mode_ctx, pt, buf, data_len, BLOCK_CIPHER_ENCRYPTION);
+    ok = ok && (memcmp(buf, ct, data_len) == 0);
+    mode_ctx.mode_api->mode_dispose(&mode_ctx);
+
+    // Decryption
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = type;
+    mode_ctx.mode_api = mode_factory("ECB");
+    mode_ctx.mode_api->mode_init(&mode_ctx, key, key_len, NULL, 0, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+    mode_ctx.mode_api->mode_process(&mode_ctx, ct, buf, data_len, BLOCK_CIPHER_DECRYPTION);
+    ok = ok && (memcmp(buf, pt, data_len) == 0);
+    mode_ctx.mode_api->mode_dispose(&mode_ctx);
+
+    free(buf);
+    return ok;
+}
+
+/*
+ * Parses a NIST (.fax) or KISA (.txt) ECB vector file and verifies every vector.
+ * Both formats consist of KEY/PT/CT triplets (in either PT/CT order).
+ */
+static bool verify_ECB_file(BlockCipherType type, const char *filename, int *total, int *passed) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "[VERIFY] Error opening file: %s\n", filename);
+        return false;
+    }
+
+    printf("%s[PATH] Test vector file : %s%s\n", ANSI_FG_BMAGENTA, filename, ANSI_RESET);
+
+    char *line = (char*)calloc(MAX_TXT_SIZE, sizeof(char));
+    u8 *key = (u8*)calloc(MAX_TXT_SIZE / 2, sizeof(u8));
+    u8 *pt = (u8*)calloc(MAX_TXT_SIZE / 2, sizeof(u8));
+    u8 *ct = (u8*)calloc(MAX_TXT_SIZE / 2, sizeof(u8));
+    if (!line || !key || !pt || !ct) {
+        fprintf(stderr, "[VERIFY] Memory allocation error\n");
+        free(line); free(key); free(pt); free(ct);
+        fclose(fp);
+        return false;
+    }
+
+    size_t key_len = 0, pt_len = 0, ct_len = 0;
+    bool result = true;
+    while (fgets(line, MAX_TXT_SIZE, fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (strncmp(line, "KEY =", 5) == 0) {
+            key_len = byte_length(line + 6);
+            stringToByteArray(line + 6, key);
+            pt_len = ct_len = 0;
+        } else if (strncmp(line, "PT =", 4) == 0) {
+            pt_len = byte_length(line + 5);
+            stringToByteArray(line + 5, pt);
+        } else if (strncmp(line, "CT =", 4) == 0) {
+            ct_len = byte_length(line + 5);
+            stringToByteArray(line + 5, ct);
+        } else {
+            continue;
+        }
+
+        if (key_len && pt_len && ct_len) {
+            (*total)++;
+            if (pt_len == ct_len && verify_ECB_vector(type, key, key_len, pt, ct, pt_len)) {
+                (*passed)++;
+            } else if (result) {
+                fprintf(stderr, "\n%s%s[Vector %4d] Mismatch found%s\n",
+                    ANSI_BOLD, ANSI_BG_RED, *total, ANSI_RESET);
+                result = false;
+            }
+            pt_len = ct_len = 0;
+            progress_bar(*passed, *total);
+            fflush(stdout);
+        }
+    }
+    printf("\n");
+
+    free(line); free(key); free(pt); free(ct);
+    fclose(fp);
+    return result;
+}
+
+void KAT_TEST_MODE_ECB(BlockCipherType type) {
+    char filename[2][100];
+    int num_files = 0;
+    const char *cipher_name = block_cipher_family_name(type);
+    const int key_bits = (int)block_cipher_key_size(type) * 8;
+
+    if (key_bits == 0) {
+        fprintf(stderr, "[VERIFY] Unknown BlockCipherType: %d\n", type);
+        return;
+    }
+
+    if (type == BLOCK_CIPHER_AES128 || type == BLOCK_CIPHER_AES192 || type == BLOCK_CIPHER_AES256) {
+        snprintf(filename[num_files++], sizeof(filename[0]),
+            "./testvectors/block_cipher_tv/nist_aes/ECB_AES%d_KAT.fax", key_bits);
+    } else {
+        const char *dir = (strcmp(cipher_name, "ARIA") == 0) ? "kisa_aria" : "kisa_lea";
+        snprintf(filename[num_files++], sizeof(filename[0]),
+            "./testvectors/block_cipher_tv/%s/%s%d(ECB)KAT.txt", dir, cipher_name, key_bits);
+        snprintf(filename[num_files++], sizeof(filename[0]),
+            "./testvectors/block_cipher_tv/%s/%s%d(ECB)MMT.txt", dir, cipher_name, key_bits);
+    }
+
+    printf("%s%s----------------------------- ECB KAT TEST for %s -----------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        block_cipher_type_to_string(type),
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_files; i++) {
+        result = verify_ECB_file(type, filename[i], &total_tests, &passed_tests) && result;
+    }
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Runs one CCM vector through the mode API.
+ * ct holds C || T. If expect_pass, E(payload) must give ct and D(ct) must verify and give payload;
+ * otherwise D(ct) must be rejected and leave the output zeroed.
+ */
+static bool verify_CCM_vector(BlockCipherType type, const u8 *key, size_t key_len,
+                              const u8 *nonce, size_t nonce_len,
+                              const u8 *adata, size_t alen,
+                              const u8 *payload, size_t plen,
+                              const u8 *ct, size_t tlen, bool expect_pass) {
+    ModeOfOperationContext mode_ctx;
+    u8 *buf = (u8*)calloc(plen + 1, sizeof(u8));
+    u8 tag[16] = { 0x00, };
+    bool ok = true;
+
+    if (buf == NULL) {
+        fprintf(stderr, "[CCM] Memory allocation error\n");
+        return false;
+    }
+
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = type;
+    mode_ctx.mode_api = mode_factory("CCM");
+    mode_ctx.mode_api->mode_init(&mode_ctx, key, key_len, nonce, nonce_len, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+
+    // Encryption (only for valid vectors)
+    if (expect_pass) {
+        mode_ctx.mode_api->mode_process_with_tag(
+            &mode_ctx, payload, buf, plen, adata, alen, tag, tlen, BLOCK_CIPHER_ENCRYPTION);
+        ok = ok && (memcmp(buf, ct, plen) == 0) && (memcmp(tag, ct + plen, tlen) == 0);
+    }
+
+    // Decryption-verification
+    memcpy(tag, ct + plen, tlen);
+    memset(buf, 0xa5, plen);
+    mode_ctx.mode_api->mode_process_with_tag(
+        &mode_ctx, ct, buf, plen, adata, alen, tag, tlen, BLOCK_CIPHER_DECRYPTION);
+    ok = ok && (mode_ctx.mode_state.ccm_internal.tag_ok == expect_pass);
+    if (expect_pass) {
+        ok = ok && (memcmp(buf, payload, plen) == 0);
+    } else {
+        // A rejected message releases no plaintext
+        for (size_t k = 0; k < plen; k++) {
+            if (buf[k] != 0) ok = false;
+        }
+    }
+    mode_ctx.mode_api->mode_dispose(&mode_ctx);
+
+    free(buf);
+    return ok;
+}
+
+void KAT_TEST_MODE_CCM(void) {
+    // NIST SP 800-38C, Appendix C: Examples 1-4 with AES-128. Example 4 has 2^16 bytes of associated
+    // data, the bytes 00 01 02 ... (mod 256), written here as NULL.
+    static const char *key_hex = "404142434445464748494a4b4c4d4e4f";
+    static const struct {
+        const char *nonce;
+        const char *adata;
+        const char *payload;
+        const char *ct;     // C || T
+    } tv[] = {
+        { "10111213141516", "0001020304050607", "20212223", "7162015b" "4dac255d" },
+        { "1011121314151617", "000102030405060708090a0b0c0d0e0f",
+          "202122232425262728292a2b2c2d2e2f",
+          "d2a1f0e051ea5f62081a7792073d593d" "1fc64fbfaccd" },
+        { "101112131415161718191a1b", "000102030405060708090a0b0c0d0e0f10111213",
+          "202122232425262728292a2b2c2d2e2f3031323334353637",
+          "e3b201a9f5b71a7a9b1ceaeccd97e70b6176aad9a4428aa5" "484392fbc1b09951" },
+        { "101112131415161718191a1b1c", NULL,
+          "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f",
+          "69915dad1e84c6376a68c2967e4dab615ae0fd1faec44cc484828529463ccf72" "b4ac6bec93e8598e7f0dadbcea5b" },
+    };
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_tests = num_tv * 4;
+
+    printf("%s%s------------------------------- CCM KAT TEST for AES --------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    static u8 adata[1 << 16];
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        u8 key[16], nonce[16], payload[32], ct[48];
+        size_t alen;
+        const size_t nonce_len = byte_length(tv[i].nonce);
+        const size_t plen = byte_length(tv[i].payload);
+        const size_t tlen = byte_length(tv[i].ct) - plen;
+        bool ok[4];
+
+        stringToByteArray(key_hex, key);
+        stringToByteArray(tv[i].nonce, nonce);
+        stringToByteArray(tv[i].payload, payload);
+        stringToByteArray(tv[i].ct, ct);
+        if (tv[i].adata) {
+            alen = byte_length(tv[i].adata);
+            stringToByteArray(tv[i].adata, adata);
+        } else {
+            alen = sizeof(adata);
+            for (size_t k = 0; k < alen; k++) adata[k] = (u8)k;
+        }
+
+        ok[0] = verify_CCM_vector(BLOCK_CIPHER_AES128, key, sizeof(key), nonce, nonce_len, adata, alen,
+                                  payload, plen, ct, tlen, true);
+
+        // A flipped bit in the tag, the ciphertext or the associated data must be rejected
+        ct[plen + tlen - 1] ^= 0x01;
+        ok[1] = verify_CCM_vector(BLOCK_CIPHER_AES128, key, sizeof(key), nonce, nonce_len, adata, alen,
+                                  payload, plen, ct, tlen, false);
+        ct[plen + tlen - 1] ^= 0x01;
+        ct[0] ^= 0x80;
+        ok[2] = verify_CCM_vector(BLOCK_CIPHER_AES128, key, sizeof(key), nonce, nonce_len, adata, alen,
+                                  payload, plen, ct, tlen, false);
+        ct[0] ^= 0x80;
+        adata[alen - 1] ^= 0x01;
+        ok[3] = verify_CCM_vector(BLOCK_CIPHER_AES128, key, sizeof(key), nonce, nonce_len, adata, alen,
+                                  payload, plen, ct, tlen, false);
+        adata[alen - 1] ^= 0x01;
+
+        for (int t = 0; t < 4; t++) {
+            static const char *labels[] = { "", " with a bad tag", " with a modified ciphertext",
+                                            " with modified associated data" };
+            total_tests++;
+            if (ok[t]) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] AES-128 SP 800-38C Example %d%s\n", i + 1, labels[t]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Runs a CBC or CTR vector through the mode API in two calls (split bytes, then the rest), encrypting
+ * out of place and decrypting in place. Returns true if E(pt) == ct and D(ct) == pt.
+ */
+static bool verify_CBC_CTR_vector(ModeOfOperationType mode, BlockCipherType type, const u8 *key, size_t key_len,
+                                  const u8 *iv, const u8 *pt, const u8 *ct, size_t len, size_t split) {
+    const ModeOfOperationApi *mode_api = mode_get_api(mode);
+    ModeOfOperationContext mode_ctx;
+    u8 buf[1024];
+    bool ok = true;
+
+    if (!mode_api || len > sizeof(buf) || split > len) return false;
+
+    // Encryption
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = type;
+    mode_api->mode_init(&mode_ctx, key, key_len, iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+    mode_api->mode_process(&mode_ctx, pt, buf, split, BLOCK_CIPHER_ENCRYPTION);
+    mode_api->mode_process(&mode_ctx, pt + split, buf + split, len - split, BLOCK_CIPHER_ENCRYPTION);
+    ok = ok && (memcmp(buf, ct, len) == 0);
+    mode_api->mode_dispose(&mode_ctx);
+
+    // Decryption (in place)
+    memcpy(buf, ct, len);
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = type;
+    mode_api->mode_init(&mode_ctx, key, key_len, iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+    mode_api->mode_process(&mode_ctx, buf, buf, split, BLOCK_CIPHER_DECRYPTION);
+    mode_api->mode_process(&mode_ctx, buf + split, buf + split, len - split, BLOCK_CIPHER_DECRYPTION);
+    ok = ok && (memcmp(buf, pt, len) == 0);
+    mode_api->mode_dispose(&mode_ctx);
+
+    return ok;
+}
+
+void KAT_TEST_MODE_CBC_CTR(void) {
+    // NIST SP 800-38A, F.2 (CBC) and F.5 (CTR)
+    static const char *plaintext =
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+    static const struct {
+        BlockCipherType type;
+        const char *key;
+        const char *cbc;
+        const char *ctr;
+    } tv[] = {
+        { BLOCK_CIPHER_AES128, "2b7e151628aed2a6abf7158809cf4f3c",
+          "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+          "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7",
+          "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+          "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee" },
+        { BLOCK_CIPHER_AES192, "8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b",
+          "4f021db243bc633d7178183a9fa071e8b4d9ada9ad7dedf4e5e738763f69145a"
+          "571b242012fb7ae07fa9baac3df102e008b0e27988598881d920a9e64f5615cd",
+          "1abc932417521ca24f2b0459fe7e6e0b090339ec0aa6faefd5ccc2c6f4ce8e94"
+          "1e36b26bd1ebc670d1bd1d665620abf74f78a7f6d29809585a97daec58c6b050" },
+        { BLOCK_CIPHER_AES256, "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4",
+          "f58c4c04d6e5f1ba779eabfb5f7bfbd69cfc4e967edb808d679f777bc6702c7d"
+          "39f23369a9d9bacfa530e26304231461b2eb05e2c39be9fcda6c19078c6a9d1b",
+          "601ec313775789a5b7a7f504bbf3d228f443e3ca4d62b59aca84e990cacaf5c5"
+          "2b0930daa23de94ce87017ba2d84988ddfc9c58db67aada613c2dd08457941a6" },
+    };
+    static const u8 cbc_iv[BLOCK_SIZE] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f };
+    static const u8 ctr_iv[BLOCK_SIZE] = {
+        0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff };
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_tests = num_tv * 11;
+
+    printf("%s%s------------------------------ CBC/CTR KAT TEST for AES ------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        u8 key[32], pt[64], cbc_ct[64], ctr_ct[64];
+        const size_t key_len = block_cipher_key_size(tv[i].type);
+        // A type of another key size resolves to the family API, whose contexts get the generic kernels
+        const BlockCipherType other = tv[(i + 1) % num_tv].type;
+        const char *name = block_cipher_type_to_string(tv[i].type);
+        bool ok[11];
+
+        stringToByteArray(tv[i].key, key);
+        stringToByteArray(plaintext, pt);
+        stringToByteArray(tv[i].cbc, cbc_ct);
+        stringToByteArray(tv[i].ctr, ctr_ct);
+
+        ok[0] = verify_CBC_CTR_vector(MODE_CBC, tv[i].type, key, key_len, cbc_iv, pt, cbc_ct, 64, 64);
+        ok[1] = verify_CBC_CTR_vector(MODE_CBC, tv[i].type, key, key_len, cbc_iv, pt, cbc_ct, 64, 16);
+        ok[2] = verify_CBC_CTR_vector(MODE_CBC, other, key, key_len, cbc_iv, pt, cbc_ct, 64, 64);
+        ok[3] = verify_CBC_CTR_vector(MODE_CBC, other, key, key_len, cbc_iv, pt, cbc_ct, 64, 48);
+        ok[4] = verify_CBC_CTR_vector(MODE_CTR, tv[i].type, key, key_len, ctr_iv, pt, ctr_ct, 64, 64);
+        ok[5] = verify_CBC_CTR_vector(MODE_CTR, tv[i].type, key, key_len, ctr_iv, pt, ctr_ct, 64, 5);
+        ok[6] = verify_CBC_CTR_vector(MODE_CTR, other, key, key_len, ctr_iv, pt, ctr_ct, 64, 64);
+        ok[7] = verify_CBC_CTR_vector(MODE_CTR, other, key, key_len, ctr_iv, pt, ctr_ct, 64, 37);
+
+        // CTR seek into the middle of a block
+        {
+            ModeOfOperationContext mode_ctx;
+            u8 buf[64];
+            clear_mode_ctx(&mode_ctx);
+            mode_ctx.cipher_type = tv[i].type;
+            get_ctr_api()->mode_init(&mode_ctx, key, key_len, ctr_iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+            ctr_seek(&mode_ctx, 21);
+            get_ctr_api()->mode_process(&mode_ctx, ctr_ct + 21, buf, 64 - 21, BLOCK_CIPHER_DECRYPTION);
+            ok[8] = (memcmp(buf, pt + 21, 64 - 21) == 0);
+            get_ctr_api()->mode_dispose(&mode_ctx);
+        }
+
+        // Longer messages: the fused kernels agree with the generic ones (odd block counts, long tails)
+        {
+            u8 msg[1000], fused[1000], generic[1000], iv[BLOCK_SIZE];
+            for (size_t k = 0; k < sizeof(msg); k++) msg[k] = (u8)(k * 7 + i);
+            memset(iv, 0xff, sizeof(iv));   // The counter wraps after the first block
+            for (int m = 0; m < 2; m++) {
+                const ModeOfOperationApi *api = m ? get_ctr_api() : get_cbc_api();
+                const size_t len = m ? sizeof(msg) : sizeof(msg) / BLOCK_SIZE * BLOCK_SIZE;
+                ModeOfOperationContext mode_ctx;
+
+                clear_mode_ctx(&mode_ctx);
+                mode_ctx.cipher_type = tv[i].type;
+                api->mode_init(&mode_ctx, key, key_len, iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+                api->mode_process(&mode_ctx, msg, fused, len, BLOCK_CIPHER_ENCRYPTION);
+                api->mode_dispose(&mode_ctx);
+
+                clear_mode_ctx(&mode_ctx);
+                mode_ctx.cipher_type = other;
+                api->mode_init(&mode_ctx, key, key_len, iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+                api->mode_process(&mode_ctx, msg, generic, len, BLOCK_CIPHER_ENCRYPTION);
+                api->mode_dispose(&mode_ctx);
+
+                ok[9 + m] = (memcmp(fused, generic, len) == 0);
+            }
+        }
+
+        for (int t = 0; t < 11; t++) {
+            static const char *labels[] = {
+                "CBC", "CBC in two calls", "CBC (generic)", "CBC in two calls (generic)",
+                "CTR", "CTR in two calls", "CTR (generic)", "CTR in two calls (generic)",
+                "CTR seek", "CBC fused/generic", "CTR fused/generic" };
+            total_tests++;
+            if (ok[t]) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s %s\n", name, labels[t]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Runs one data unit through the XTS mode API with the tweak given as IV: encrypts out of place and
+ * decrypts in place, then encrypts in place and decrypts out of place.
+ */
+static bool verify_XTS_vector(BlockCipherType type, const u8 *key, size_t key_len, const u8 *tweak,
+                              const u8 *pt, const u8 *ct, size_t len) {
+    const ModeOfOperationApi *xts_api = get_xts_api();
+    ModeOfOperationContext mode_ctx;
+    u8 buf[512], out[512];
+    bool ok = true;
+
+    if (len > sizeof(buf)) return false;
+
+    for (int in_place = 0; in_place < 2; in_place++) {
+        // Encryption
+        memcpy(buf, pt, len);
+        memset(out, 0, sizeof(out));
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = type;
+        xts_api->mode_init(&mode_ctx, key, key_len, tweak, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+        xts_api->mode_process(&mode_ctx, buf, in_place ? buf : out, len, BLOCK_CIPHER_ENCRYPTION);
+        ok = ok && (memcmp(in_place ? buf : out, ct, len) == 0);
+        xts_api->mode_dispose(&mode_ctx);
+
+        // Decryption (in the other placement)
+        memcpy(buf, ct, len);
+        memset(out, 0, sizeof(out));
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = type;
+        xts_api->mode_init(&mode_ctx, key, key_len, tweak, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+        xts_api->mode_process(&mode_ctx, buf, in_place ? out : buf, len, BLOCK_CIPHER_DECRYPTION);
+        ok = ok && (memcmp(in_place ? out : buf, pt, len) == 0);
+        xts_api->mode_dispose(&mode_ctx);
+    }
+    return ok;
+}
+
+/*
+ * Encrypts num_sectors sectors with one xts_process_sectors call and compares every sector with
+ * xts_process under the tweak of its sector number, then decrypts the result in place in one call.
+ */
+static bool verify_XTS_sectors(BlockCipherType type, const u8 *key, size_t key_len,
+                               size_t sector_size, size_t num_sectors, u64 first_sector) {
+    const ModeOfOperationApi *xts_api = get_xts_api();
+    ModeOfOperationContext mode_ctx;
+    const size_t len = sector_size * num_sectors;
+    u8 *pt = (u8*)malloc(len), *ct = (u8*)malloc(len), *one = (u8*)malloc(sector_size);
+    bool ok = (pt && ct && one);
+
+    for (size_t k = 0; ok && k < len; k++) pt[k] = (u8)(k * 7 + (k >> 8));
+
+    if (ok) {
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = type;
+        xts_api->mode_init(&mode_ctx, key, key_len, NULL, 0, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+        xts_process_sectors(&mode_ctx, pt, ct, sector_size, num_sectors, first_sector, BLOCK_CIPHER_ENCRYPTION);
+        xts_api->mode_dispose(&mode_ctx);
+    }
+
+    // Sector by sector: the tweak is the sector number as a 128-bit little-endian value
+    for (size_t s = 0; ok && s < num_sectors; s++) {
+        const u64 sector = first_sector + s;
+        u8 tweak[BLOCK_SIZE] = { 0x00, };
+        for (int b = 0; b < 8; b++) tweak[b] = (u8)(sector >> (8 * b));
+
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = type;
+        xts_api->mode_init(&mode_ctx, key, key_len, tweak, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+        xts_api->mode_process(&mode_ctx, pt + s * sector_size, one, sector_size, BLOCK_CIPHER_ENCRYPTION);
+        xts_api->mode_dispose(&mode_ctx);
+        ok = (memcmp(one, ct + s * sector_size, sector_size) == 0);
+    }
+
+    if (ok) {
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = type;
+        xts_api->mode_init(&mode_ctx, key, key_len, NULL, 0, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+        xts_process_sectors(&mode_ctx, ct, ct, sector_size, num_sectors, first_sector, BLOCK_CIPHER_DECRYPTION);
+        xts_api->mode_dispose(&mode_ctx);
+        ok = (memcmp(ct, pt, len) == 0);
+    }
+
+    free(pt); free(ct); free(one);
+    return ok;
+}
+
+void KAT_TEST_MODE_XTS(void) {
+    // IEEE 1619-2007, Annex B: vectors 2, 3, 4 and 10 (full blocks) and 15-18 (ciphertext stealing).
+    // A NULL plaintext stands for the bytes 00 01 02 ... (mod 256).
+    static const struct {
+        int vector;
+        BlockCipherType type;
+        const char *key;    // Key1 || Key2
+        u64 dusn;           // Data unit sequence number
+        const char *pt;
+        const char *ct;
+    } tv[] = {
+        { 2, BLOCK_CIPHER_AES128,
+          "11111111111111111111111111111111" "22222222222222222222222222222222", 0x3333333333ULL,
+          "4444444444444444444444444444444444444444444444444444444444444444",
+          "c454185e6a16936e39334038acef838bfb186fff7480adc4289382ecd6d394f0" },
+        { 3, BLOCK_CIPHER_AES128,
+          "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0" "22222222222222222222222222222222", 0x3333333333ULL,
+          "4444444444444444444444444444444444444444444444444444444444444444",
+          "af85336b597afc1a900b2eb21ec949d292df4c047e0b21532186a5971a227a89" },
+        { 4, BLOCK_CIPHER_AES128,
+          "27182818284590452353602874713526" "31415926535897932384626433832795", 0x00ULL, NULL,
+          "27a7479befa1d476489f308cd4cfa6e2a96e4bbe3208ff25287dd3819616e89cc78cf7f5e543445f8333d8fa7f560000"
+          "05279fa5d8b5e4ad40e736ddb4d35412328063fd2aab53e5ea1e0a9f332500a5df9487d07a5c92cc512c8866c7e860ce"
+          "93fdf166a24912b422976146ae20ce846bb7dc9ba94a767aaef20c0d61ad02655ea92dc4c4e41a8952c651d33174be51"
+          "a10c421110e6d81588ede82103a252d8a750e8768defffed9122810aaeb99f9172af82b604dc4b8e51bcb08235a6f434"
+          "1332e4ca60482a4ba1a03b3e65008fc5da76b70bf1690db4eae29c5f1badd03c5ccf2a55d705ddcd86d449511ceb7ec3"
+          "0bf12b1fa35b913f9f747a8afd1b130e94bff94effd01a91735ca1726acd0b197c4e5b03393697e126826fb6bbde8ecc"
+          "1e08298516e2c9ed03ff3c1b7860f6de76d4cecd94c8119855ef5297ca67e9f3e7ff72b1e99785ca0a7e7720c5b36dc6"
+          "d72cac9574c8cbbc2f801e23e56fd344b07f22154beba0f08ce8891e643ed995c94d9a69c9f1b5f499027a78572aeebd"
+          "74d20cc39881c213ee770b1010e4bea718846977ae119f7a023ab58cca0ad752afe656bb3c17256a9f6e9bf19fdd5a38"
+          "fc82bbe872c5539edb609ef4f79c203ebb140f2e583cb2ad15b4aa5b655016a8449277dbd477ef2c8d6c017db738b18d"
+          "eb4a427d1923ce3ff262735779a418f20a282df920147beabe421ee5319d0568" },
+        { 10, BLOCK_CIPHER_AES256,
+          "2718281828459045235360287471352662497757247093699959574966967627"
+          "3141592653589793238462643383279502884197169399375105820974944592", 0xffULL, NULL,
+          "1c3b3a102f770386e4836c99e370cf9bea00803f5e482357a4ae12d414a3e63b5d31e276f8fe4a8d66b317f9ac683f44"
+          "680a86ac35adfc3345befecb4bb188fd5776926c49a3095eb108fd1098baec70aaa66999a72a82f27d848b21d4a741b0"
+          "c5cd4d5fff9dac89aeba122961d03a757123e9870f8acf1000020887891429ca2a3e7a7d7df7b10355165c8b9a6d0a7d"
+          "e8b062c4500dc4cd120c0f7418dae3d0b5781c34803fa75421c790dfe1de1834f280d7667b327f6c8cd7557e12ac3a0f"
+          "93ec05c52e0493ef31a12d3d9260f79a289d6a379bc70c50841473d1a8cc81ec583e9645e07b8d9670655ba5bbcfecc6"
+          "dc3966380ad8fecb17b6ba02469a020a84e18e8f84252070c13e9f1f289be54fbc481457778f616015e1327a02b140f1"
+          "505eb309326d68378f8374595c849d84f4c333ec4423885143cb47bd71c5edae9be69a2ffeceb1bec9de244fbe15992b"
+          "11b77c040f12bd8f6a975a44a0f90c29a9abc3d4d893927284c58754cce294529f8614dcd2aba991925fedc4ae74ffac"
+          "6e333b93eb4aff0479da9a410e4450e0dd7ae4c6e2910900575da401fc07059f645e8b7e9bfdef33943054ff84011493"
+          "c27b3429eaedb4ed5376441a77ed43851ad77f16f541dfd269d50d6a5f14fb0aab1cbb4c1550be97f7ab4066193c4caa"
+          "773dad38014bd2092fa755c824bb5e54c4f36ffda9fcea70b9c6e693e148c151" },
+        { 15, BLOCK_CIPHER_AES128,
+          "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0" "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0", 0x123456789aULL, NULL,
+          "6c1625db4671522d3d7599601de7ca09ed" },
+        { 16, BLOCK_CIPHER_AES128,
+          "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0" "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0", 0x123456789aULL, NULL,
+          "d069444b7a7e0cab09e24447d24deb1fedbf" },
+        { 17, BLOCK_CIPHER_AES128,
+          "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0" "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0", 0x123456789aULL, NULL,
+          "e5df1351c0544ba1350b3363cd8ef4beedbf9d" },
+        { 18, BLOCK_CIPHER_AES128,
+          "fffefdfcfbfaf9f8f7f6f5f4f3f2f1f0" "bfbebdbcbbbab9b8b7b6b5b4b3b2b1b0", 0x123456789aULL, NULL,
+          "9d84c813f719aa2c7be3f66171c7c5c2edbf9dac" },
+    };
+    // Multi-sector calls: more sectors than one tweak batch, sector sizes with and without stealing,
+    // and sector numbers that carry into the second byte and the fifth byte of the tweak
+    static const struct {
+        size_t sector_size;
+        size_t num_sectors;
+        u64 first_sector;
+    } sectors[] = {
+        { 512, 11, 0 },
+        { 520, 9, 0xfaULL },
+        { 16, 17, 0xfffffffcULL },
+        { 4096, 3, 0x123456789aULL },
+    };
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_sectors = (int)(sizeof(sectors) / sizeof(sectors[0]));
+    const int num_tests = num_tv + 2 * num_sectors;
+
+    printf("%s%s------------------------------- XTS KAT TEST for AES --------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        u8 key[64], tweak[BLOCK_SIZE] = { 0x00, }, pt[512], ct[512];
+        const size_t key_len = byte_length(tv[i].key);
+        const size_t len = byte_length(tv[i].ct);
+
+        stringToByteArray(tv[i].key, key);
+        stringToByteArray(tv[i].ct, ct);
+        if (tv[i].pt) {
+            stringToByteArray(tv[i].pt, pt);
+        } else {
+            for (size_t k = 0; k < len; k++) pt[k] = (u8)k;
+        }
+        for (int b = 0; b < 8; b++) tweak[b] = (u8)(tv[i].dusn >> (8 * b));
+
+        total_tests++;
+        if (verify_XTS_vector(tv[i].type, key, key_len, tweak, pt, ct, len)) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] %s IEEE 1619 vector %d (%zu bytes)\n",
+                block_cipher_type_to_string(tv[i].type), tv[i].vector, len);
+        }
+        progress_bar(total_tests, num_tests);
+    }
+
+    for (int i = 0; i < num_sectors; i++) {
+        static const BlockCipherType types[] = { BLOCK_CIPHER_AES128, BLOCK_CIPHER_AES256 };
+        for (int t = 0; t < 2; t++) {
+            u8 key[64];
+            const size_t key_len = 2 * block_cipher_key_size(types[t]);
+            for (size_t k = 0; k < key_len; k++) key[k] = (u8)(k * 29 + i);
+
+            total_tests++;
+            if (verify_XTS_sectors(types[t], key, key_len,
+                    sectors[i].sector_size, sectors[i].num_sectors, sectors[i].first_sector)) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s %zu sectors of %zu bytes from sector %llu\n",
+                    block_cipher_type_to_string(types[t]), sectors[i].num_sectors, sectors[i].sector_size,
+                    (unsigned long long)sectors[i].first_sector);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/* Counter block IV + n with 128-bit big-endian arithmetic, written out independently of mode_ctr.c */
+static void ctr_seek_test_counter(u8 out[BLOCK_SIZE], const u8 iv[BLOCK_SIZE], u64 n) {
+    unsigned carry = 0;
+    for (int j = BLOCK_SIZE - 1; j >= 0; j--) {
+        const unsigned sum = iv[j] + carry + (j >= 8 ? (unsigned)((n >> (8 * (15 - j))) & 0xff) : 0);
+        out[j] = (u8)sum;
+        carry = sum >> 8;
+    }
+}
+
+void TEST_CTR_SEEK(void) {
+    static const struct { BlockCipherType type; int nr; } tv[] = {
+        { BLOCK_CIPHER_AES128, AES128_NUM_ROUNDS },
+        { BLOCK_CIPHER_AES192, AES192_NUM_ROUNDS },
+        { BLOCK_CIPHER_AES256, AES256_NUM_ROUNDS },
+    };
+    // Aligned and unaligned offsets before, at and after the 2^64 carry of the counter (block 5)
+    static const size_t offsets[] = { 0, 1, 15, 16, 17, 63, 79, 80, 81, 95, 333, 639 };
+    // The low 64 bits of the IV overflow five blocks in
+    static const u8 iv[BLOCK_SIZE] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfb };
+    enum { STREAM_BLOCKS = 40, STREAM_LEN = STREAM_BLOCKS * BLOCK_SIZE };
+    const u64 far_block = 0x0123456789abcdeULL;   // IV + far_block carries out of the low 64 bits as well
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_offsets = (int)(sizeof(offsets) / sizeof(offsets[0]));
+    const int num_tests = num_tv * (num_offsets + 3);
+
+    printf("%s%s--------------------------------- CTR SEEK TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        const ModeOfOperationApi *ctr_api = get_ctr_api();
+        const size_t key_len = block_cipher_key_size(tv[i].type);
+        const char *name = block_cipher_type_to_string(tv[i].type);
+        ModeOfOperationContext mode_ctx;
+        u32 rk[4 * (AES256_NUM_ROUNDS + 1)];
+        u8 key[32], zero[STREAM_LEN], stream[STREAM_LEN], expected[STREAM_LEN], buf[STREAM_LEN];
+        u8 counter[BLOCK_SIZE];
+        bool ok;
+
+        for (size_t k = 0; k < key_len; k++) key[k] = (u8)(0x5a ^ (k * 13 + i));
+        memset(zero, 0, sizeof(zero));
+        aes_set_encrypt_key(key, key_len, rk);
+
+        // Reference keystream: E_K(IV + j) for every block j
+        for (u64 j = 0; j < STREAM_BLOCKS; j++) {
+            ctr_seek_test_counter(counter, iv, j);
+            aes_encrypt(counter, expected + j * BLOCK_SIZE, rk, tv[i].nr);
+        }
+
+        // Sequential keystream in one pass from offset 0
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = tv[i].type;
+        ctr_api->mode_init(&mode_ctx, key, key_len, iv, BLOCK_SIZE, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+        ctr_api->mode_process(&mode_ctx, zero, stream, STREAM_LEN, BLOCK_CIPHER_ENCRYPTION);
+        ok = (memcmp(stream, expected, STREAM_LEN) == 0);
+        total_tests++;
+        if (ok) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] %s sequential keystream across the 2^64 carry\n", name);
+        }
+        progress_bar(total_tests, num_tests);
+
+        // Seek on the same context (forwards and backwards) and read to the end of the stream
+        for (int o = 0; o < num_offsets; o++) {
+            const size_t off = offsets[num_offsets - 1 - ((o * 5) % num_offsets)];
+            memset(buf, 0, sizeof(buf));
+            ctr_seek(&mode_ctx, off);
+            ctr_api->mode_process(&mode_ctx, zero, buf, STREAM_LEN - off, BLOCK_CIPHER_ENCRYPTION);
+            ok = (memcmp(buf, stream + off, STREAM_LEN - off) == 0);
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s seek to offset %zu\n", name, off);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+
+        // Seek into the middle of the carry block, then decrypt in uneven pieces
+        {
+            const size_t off = 5 * BLOCK_SIZE - 3;
+            u8 ct[STREAM_LEN];
+            for (size_t k = 0; k < STREAM_LEN; k++) {
+                buf[k] = (u8)(k * 31);
+                ct[k] = buf[k] ^ stream[k];
+            }
+            ctr_seek(&mode_ctx, off);
+            ctr_api->mode_process(&mode_ctx, ct + off, ct + off, 2, BLOCK_CIPHER_DECRYPTION);
+            ctr_api->mode_process(&mode_ctx, ct + off + 2, ct + off + 2, 37, BLOCK_CIPHER_DECRYPTION);
+            ctr_api->mode_process(&mode_ctx, ct + off + 39, ct + off + 39, STREAM_LEN - off - 39,
+                BLOCK_CIPHER_DECRYPTION);
+            ok = (memcmp(ct + off, buf + off, STREAM_LEN - off) == 0);
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s seek into the carry block, decrypted in pieces\n", name);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+
+        // A far, unaligned offset: IV + far_block also carries into the high 64 bits
+        {
+            const u64 far_off = far_block * BLOCK_SIZE + 9;
+            for (u64 j = 0; j < 4; j++) {
+                ctr_seek_test_counter(counter, iv, far_block + j);
+                aes_encrypt(counter, expected + j * BLOCK_SIZE, rk, tv[i].nr);
+            }
+            memset(buf, 0, sizeof(buf));
+            ctr_seek(&mode_ctx, far_off);
+            ctr_api->mode_process(&mode_ctx, zero, buf, 4 * BLOCK_SIZE - 9, BLOCK_CIPHER_ENCRYPTION);
+            ok = (memcmp(buf, expected + 9, 4 * BLOCK_SIZE - 9) == 0);
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s seek to a far offset\n", name);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+        ctr_api->mode_dispose(&mode_ctx);
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total checks : %3d\n", total_tests);
+    printf("- Passed checks: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_MODE_GCM_SIV(void) {
+    // RFC 8452, Appendix C.1 (AEAD_AES_128_GCM_SIV), C.2 (AEAD_AES_256_GCM_SIV) and C.3 (counter wrap)
+#define K128  "01000000000000000000000000000000"
+#define K256  "0100000000000000000000000000000000000000000000000000000000000000"
+#define KZERO "0000000000000000000000000000000000000000000000000000000000000000"
+#define N3    "030000000000000000000000"
+    static const struct {
+        BlockCipherType type;
+        const char *key;
+        const char *nonce;
+        const char *aad;
+        const char *pt;
+        const char *ct;     // C || T
+    } tv[] = {
+        { BLOCK_CIPHER_AES128, K128, N3, "", "", "dc20e2d83f25705bb49e439eca56de25" },
+        { BLOCK_CIPHER_AES128, K128, N3, "", "0100000000000000",
+          "b5d839330ac7b786" "578782fff6013b815b287c22493a364c" },
+        { BLOCK_CIPHER_AES128, K128, N3, "", "010000000000000000000000",
+          "7323ea61d05932260047d942" "a4978db357391a0bc4fdec8b0d106639" },
+        { BLOCK_CIPHER_AES128, K128, N3, "", "01000000000000000000000000000000",
+          "743f7c8077ab25f8624e2e948579cf77" "303aaf90f6fe21199c6068577437a0c4" },
+        { BLOCK_CIPHER_AES128, K128, N3, "", "0100000000000000000000000000000002000000000000000000000000000000",
+          "84e07e62ba83a6585417245d7ec413a9fe427d6315c09b57ce45f2e3936a9445" "1a8e45dcd4578c667cd86847bf6155ff" },
+        { BLOCK_CIPHER_AES128, K128, N3, "01", "0200000000000000",
+          "1e6daba35669f427" "3b0a1a2560969cdf790d99759abd1508" },
+        { BLOCK_CIPHER_AES128, K128, N3, "01", "020000000000000000000000",
+          "296c7889fd99f41917f44620" "08299c5102745aaa3a0c469fad9e075a" },
+        { BLOCK_CIPHER_AES128, K128, N3, "010000000000000000000000", "02000000",
+          "a8fe3e87" "07eb1f84fb28f8cb73de8e99e2f48a14" },
+        { BLOCK_CIPHER_AES128, K128, N3, "010000000000000000000000000000000200",
+          "0300000000000000000000000000000004000000",
+          "6bb0fecf5ded9b77f902c7d5da236a4391dd0297" "24afc9805e976f451e6d87f6fe106514" },
+        { BLOCK_CIPHER_AES256, K256, N3, "", "", "07f5f4169bbf55a8400cd47ea6fd400f" },
+        { BLOCK_CIPHER_AES256, K256, N3, "", "0100000000000000",
+          "c2ef328e5c71c83b" "843122130f7364b761e0b97427e3df28" },
+        { BLOCK_CIPHER_AES256, K256, N3, "", "010000000000000000000000",
+          "9aab2aeb3faa0a34aea8e2b1" "8ca50da9ae6559e48fd10f6e5c9ca17e" },
+        { BLOCK_CIPHER_AES256, K256, N3, "", "01000000000000000000000000000000",
+          "85a01b63025ba19b7fd3ddfc033b3e76" "c9eac6fa700942702e90862383c6c366" },
+        { BLOCK_CIPHER_AES256, K256, N3, "01", "0200000000000000",
+          "1de22967237a8132" "91213f267e3b452f02d01ae33e4ec854" },
+        { BLOCK_CIPHER_AES256, K256, N3, "01", "020000000000000000000000",
+          "163d6f9cc1b346cd453a2e4c" "c1a4a19ae800941ccdc57cc8413c277f" },
+        { BLOCK_CIPHER_AES256, K256, N3, "010000000000000000000000", "02000000",
+          "22b3f4cd" "1835e517741dfddccfa07fa4661b74cf" },
+        { BLOCK_CIPHER_AES256, KZERO, "000000000000000000000000", "",
+          "000000000000000000000000000000004db923dc793ee6497c76dcc03a98e108",
+          "f3f80f2cf0cb2dd9c5984fcda908456cc537703b5ba70324a6793a7bf218d3ea" "ffffffff000000000000000000000000" },
+        { BLOCK_CIPHER_AES256, KZERO, "000000000000000000000000", "",
+          "eb3640277c7ffd1303c7a542d02d3e4c0000000000000000",
+          "18ce4f0b8cb4d0cac65fea8f79257b20888e53e72299e56d" "ffffffff000000000000000000000000" },
+    };
+#undef K128
+#undef K256
+#undef KZERO
+#undef N3
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_tests = num_tv * 3 + 2;
+
+    printf("%s%s----------------------------- GCM-SIV KAT TEST for AES ------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const ModeOfOperationApi *siv_api = get_gcm_siv_api();
+    for (int i = 0; i < num_tv; i++) {
+        u8 key[32], nonce[GCM_IV_LEN], aad[32], pt[32], expected[48], ct[32], dt[32], tag[16];
+        const size_t key_len = byte_length(tv[i].key);
+        const size_t aad_len = byte_length(tv[i].aad);
+        const size_t pt_len = byte_length(tv[i].pt);
+        ModeOfOperationContext mode_ctx;
+        bool ok[3];
+
+        stringToByteArray(tv[i].key, key);
+        stringToByteArray(tv[i].nonce, nonce);
+        stringToByteArray(tv[i].aad, aad);
+        stringToByteArray(tv[i].pt, pt);
+        stringToByteArray(tv[i].ct, expected);
+
+        clear_mode_ctx(&mode_ctx);
+        mode_ctx.cipher_type = tv[i].type;
+        siv_api->mode_init(&mode_ctx, key, key_len, nonce, GCM_IV_LEN, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+
+        // Encryption
+        memset(tag, 0, sizeof(tag));
+        siv_api->mode_process_with_tag(&mode_ctx, pt, ct, pt_len, aad, aad_len, tag, sizeof(tag),
+            BLOCK_CIPHER_ENCRYPTION);
+        ok[0] = (memcmp(ct, expected, pt_len) == 0) && (memcmp(tag, expected + pt_len, sizeof(tag)) == 0);
+
+        // Decryption with the published tag
+        memcpy(tag, expected + pt_len, sizeof(tag));
+        memset(dt, 0xa5, sizeof(dt));
+        siv_api->mode_process_with_tag(&mode_ctx, expected, dt, pt_len, aad, aad_len, tag, sizeof(tag),
+            BLOCK_CIPHER_DECRYPTION);
+        ok[1] = mode_ctx.mode_state.gcm_siv_internal.tag_ok && (memcmp(dt, pt, pt_len) == 0);
+
+        // A tampered tag is rejected and no plaintext is released
+        tag[0] ^= 0x01;
+        memset(dt, 0xa5, sizeof(dt));
+        siv_api->mode_process_with_tag(&mode_ctx, expected, dt, pt_len, aad, aad_len, tag, sizeof(tag),
+            BLOCK_CIPHER_DECRYPTION);
+        ok[2] = !mode_ctx.mode_state.gcm_siv_internal.tag_ok;
+        for (size_t k = 0; k < pt_len; k++) {
+            if (dt[k] != 0) ok[2] = false;
+        }
+        siv_api->mode_dispose(&mode_ctx);
+
+        for (int t = 0; t < 3; t++) {
+            static const char *labels[] = { "encryption", "decryption", "tampered tag" };
+            total_tests++;
+            if (ok[t]) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s vector %d (AAD %zu, PT %zu bytes) %s\n",
+                    block_cipher_type_to_string(tv[i].type), i, aad_len, pt_len, labels[t]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+
+    // POLYVAL example of RFC 8452, Appendix A, and GHASH of the GCM specification's test case 2
+    // (H = E_0(0^128), C = 0388dace60b6a392f328c2b971b2fe78, one block of lengths)
+    {
+        u8 *HT = (u8*)malloc(GCM_TABLE_SIZE);
+        u8 H[16], X[32], S[16] = { 0x00, }, expected[16];
+        bool ok[2] = { false, false };
+
+        if (HT) {
+            stringToByteArray("25629347589242761d31f826ba4b757b", H);
+            stringToByteArray("4f4f95668c83dfb6401762bb2d01a262" "d1a24ddd2721d006bbe45f20d3c9f362", X);
+            stringToByteArray("f7a3b47b846119fae5b7866cf5e5b77e", expected);
+            polyval_init_table(HT, H);
+            polyval(X, 2, HT, S);
+            ok[0] = (memcmp(S, expected, sizeof(S)) == 0);
+
+            memset(S, 0, sizeof(S));
+            stringToByteArray("66e94bd4ef8a2c3b884cfa59ca342b2e", H);
+            stringToByteArray("0388dace60b6a392f328c2b971b2fe78" "00000000000000000000000000000080", X);
+            stringToByteArray("f38cbb1ad69223dcc3457ae5b6b0f885", expected);
+            gcm_init_table(HT, H);
+            ghash(X, 2, HT, R0, R1, S);
+            ok[1] = (memcmp(S, expected, sizeof(S)) == 0);
+            free(HT);
+        }
+
+        for (int t = 0; t < 2; t++) {
+            static const char *labels[] = { "POLYVAL (RFC 8452, Appendix A)", "GHASH (GCM test case 2)" };
+            total_tests++;
+            if (ok[t]) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s\n", labels[t]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_KW(void) {
+    // RFC 3394, Section 4 (KW) and RFC 5649, Section 6 (KWP)
+    static const struct {
+        BlockCipherType type;
+        const char *kek;
+        const char *key;
+        const char *wrapped;
+        bool padded;
+        const char *label;
+    } tv[] = {
+        { BLOCK_CIPHER_AES128, "000102030405060708090a0b0c0d0e0f",
+          "00112233445566778899aabbccddeeff",
+          "1fa68b0a8112b447aef34bd8fb5a7b829d3e862371d2cfe5", false, "RFC 3394 4.1" },
+        { BLOCK_CIPHER_AES192, "000102030405060708090a0b0c0d0e0f1011121314151617",
+          "00112233445566778899aabbccddeeff",
+          "96778b25ae6ca435f92b5b97c050aed2468ab8a17ad84e5d", false, "RFC 3394 4.2" },
+        { BLOCK_CIPHER_AES256, "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+          "00112233445566778899aabbccddeeff",
+          "64e8c3f9ce0f5ba263e9777905818a2a93c8191e7d6e8ae7", false, "RFC 3394 4.3" },
+        { BLOCK_CIPHER_AES192, "000102030405060708090a0b0c0d0e0f1011121314151617",
+          "00112233445566778899aabbccddeeff0001020304050607",
+          "031d33264e15d33268f24ec260743edce1c6c7ddee725a936ba814915c6762d2", false, "RFC 3394 4.4" },
+        { BLOCK_CIPHER_AES256, "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+          "00112233445566778899aabbccddeeff0001020304050607",
+          "a8f9bc1612c68b3ff6e6f4fbe30e71e4769c8b80a32cb8958cd5d17d6b254da1", false, "RFC 3394 4.5" },
+        { BLOCK_CIPHER_AES256, "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f",
+          "00112233445566778899aabbccddeeff000102030405060708090a0b0c0d0e0f",
+          "28c9f404c4b810f4cbccb35cfb87f8263f5786e2d80ed326cbc7f0e71a99f43bfb988b9b7a02dd21", false, "RFC 3394 4.6" },
+        { BLOCK_CIPHER_AES192, "5840df6e29b02af1ab493b705bf16ea1ae8338f4dcc176a8",
+          "c37b7e6492584340bed12207808941155068f738",
+          "138bdeaa9b8fa7fc61f97742e72248ee5ae6ae5360d1ae6a5f54f373fa543b6a", true, "RFC 5649 (20 bytes)" },
+        { BLOCK_CIPHER_AES192, "5840df6e29b02af1ab493b705bf16ea1ae8338f4dcc176a8",
+          "466f7250617369",
+          "afbeb0f07dfbf5419200f2ccb50bb24f", true, "RFC 5649 (7 bytes)" },
+    };
+    enum { NUM_BATCH = 11 };    // More keys than KW_MAX_LANES
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_tests = num_tv * 3 + 2;
+
+    printf("%s%s---------------------------------- KW/KWP KAT TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        u8 kek[32], key[32], wrapped[40], buf[40];
+        const size_t kek_len = byte_length(tv[i].kek);
+        const size_t key_len = byte_length(tv[i].key);
+        const size_t wrapped_len = byte_length(tv[i].wrapped);
+        size_t out_len = 0;
+        bool ok[3];
+
+        stringToByteArray(tv[i].kek, kek);
+        stringToByteArray(tv[i].key, key);
+        stringToByteArray(tv[i].wrapped, wrapped);
+
+        // Wrap
+        ok[0] = (kw_wrap(tv[i].type, kek, kek_len, key, key_len, buf, &out_len, tv[i].padded) == CRYPTOMODULE_OK) &&
+                (out_len == wrapped_len) && (memcmp(buf, wrapped, wrapped_len) == 0);
+
+        // Unwrap
+        out_len = 0;
+        ok[1] = (kw_unwrap(tv[i].type, kek, kek_len, wrapped, wrapped_len, buf, &out_len, tv[i].padded) == CRYPTOMODULE_OK) &&
+                (out_len == key_len) && (memcmp(buf, key, key_len) == 0);
+
+        // A corrupted wrapped key fails the integrity check and leaves the output cleared
+        wrapped[wrapped_len - 1] ^= 0x01;
+        memset(buf, 0xa5, sizeof(buf));
+        ok[2] = (kw_unwrap(tv[i].type, kek, kek_len, wrapped, wrapped_len, buf, &out_len, tv[i].padded) ==
+                 CRYPTOMODULE_ERR_CRYPTO_FAILURE) && (out_len == 0);
+        for (size_t k = 0; k < wrapped_len - KW_SEMIBLOCK_SIZE; k++) {
+            if (buf[k] != 0) ok[2] = false;
+        }
+
+        for (int t = 0; t < 3; t++) {
+            static const char *labels[] = { "wrap", "unwrap", "corrupted unwrap" };
+            total_tests++;
+            if (ok[t]) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s %s\n", tv[i].label, labels[t]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+
+    // kw_unwrap_batch under the AES-256 KEK of 4.3/4.5/4.6 (KW) and the KEK of RFC 5649 (KWP): valid,
+    // corrupted and malformed entries mixed, each checked through results[]
+    for (int padded = 0; padded < 2; padded++) {
+        static u8 in_buf[NUM_BATCH][40], out_buf[NUM_BATCH][40];
+        const u8 *in[NUM_BATCH];
+        u8 *out[NUM_BATCH];
+        size_t in_lens[NUM_BATCH], out_lens[NUM_BATCH];
+        cryptomodule_status_t results[NUM_BATCH], expected[NUM_BATCH];
+        const int *src;
+        static const int kw_src[] = { 2, 4, 5 }, kwp_src[] = { 6, 7 };
+        const int num_src = padded ? 2 : 3;
+        u8 kek[32];
+        cryptomodule_status_t status;
+        bool ok = true;
+
+        src = padded ? kwp_src : kw_src;
+        stringToByteArray(tv[src[0]].kek, kek);
+        for (int k = 0; k < NUM_BATCH; k++) {
+            const int v = src[k % num_src];
+            in_lens[k] = byte_length(tv[v].wrapped);
+            stringToByteArray(tv[v].wrapped, in_buf[k]);
+            expected[k] = CRYPTOMODULE_OK;
+            if (k % 4 == 1) {
+                in_buf[k][k % in_lens[k]] ^= 0x10;     // Corrupted
+                expected[k] = CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+            } else if (k == 6) {
+                in_lens[k] -= 1;                        // Not a multiple of the semiblock size
+                expected[k] = CRYPTOMODULE_ERR_INVALID_INPUT;
+            }
+            memset(out_buf[k], 0xa5, sizeof(out_buf[k]));
+            in[k] = in_buf[k];
+            out[k] = out_buf[k];
+        }
+
+        status = kw_unwrap_batch(tv[src[0]].type, kek, byte_length(tv[src[0]].kek),
+                                 in, in_lens, NUM_BATCH, out, out_lens, results, padded != 0);
+        ok = (status != CRYPTOMODULE_OK);    // The per-key outcome is in results[]
+        for (int k = 0; k < NUM_BATCH; k++) {
+            const int v = src[k % num_src];
+            u8 key[32];
+            const size_t key_len = byte_length(tv[v].key);
+            stringToByteArray(tv[v].key, key);
+
+            ok = ok && (results[k] == expected[k]);
+            if (expected[k] == CRYPTOMODULE_OK) {
+                ok = ok && (out_lens[k] == key_len) && (memcmp(out_buf[k], key, key_len) == 0);
+            } else if (expected[k] == CRYPTOMODULE_ERR_CRYPTO_FAILURE) {
+                ok = ok && (out_lens[k] == 0);
+                for (size_t j = 0; j < in_lens[k] - KW_SEMIBLOCK_SIZE; j++) {
+                    if (out_buf[k][j] != 0) ok = false;
+                }
+            } else {
+                ok = ok && (out_lens[k] == 0);
+            }
+        }
+
+        total_tests++;
+        if (ok) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] kw_unwrap_batch (%s) with mixed valid and invalid entries\n", padded ? "KWP" : "KW");
+        }
+        progress_bar(total_tests, num_tests);
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/* Application allocator of TEST_ALLOCATOR: a bump arena that counts its blocks and checks they come back wiped */
+typedef struct {
+    u8 *base;
+    size_t size, used;
+    int allocs, releases;
+    bool wiped;
+} test_arena;
+
+static void *test_arena_alloc(void *opaque, size_t size) {
+    test_arena *a = (test_arena *)opaque;
+    size_t len = (size + CRYPTOMODULE_CACHE_LINE - 1) & ~(size_t)(CRYPTOMODULE_CACHE_LINE - 1);
+    if (a->used + len > a->size) return NULL;
+    void *p = a->base + a->used;
+    memset(p, 0xa5, size);      // Dirty, the module must zero it
+    a->used += len;
+    a->allocs++;
+    return p;
+}
+
+static void test_arena_release(void *opaque, void *ptr, size_t size) {
+    test_arena *a = (test_arena *)opaque;
+    for (size_t i = 0; i < size; i++) {
+        if (((u8 *)ptr)[i] != 0) a->wiped = false;
+    }
+    a->releases++;
+}
+
+/* Set up and tear down a context of every mode; true if each one got its cipher context */
+static bool test_allocator_modes(void) {
+    static const ModeOfOperationType modes[] = { MODE_ECB, MODE_CBC, MODE_CTR, MODE_CCM, MODE_XTS, MODE_GCM_SIV };
+    u8 key[32], iv[BLOCK_SIZE];
+    bool ok = true;
+
+    for (size_t i = 0; i < sizeof(key); i++) key[i] = (u8)i;
+    memset(iv, 0x3c, sizeof(iv));
+    for (size_t m = 0; m < sizeof(modes) / sizeof(modes[0]); m++) {
+        const size_t iv_len = (modes[m] == MODE_CCM || modes[m] == MODE_GCM_SIV) ? 12 : BLOCK_SIZE;
+        const size_t key_len = (modes[m] == MODE_XTS) ? 32 : 16;
+        ModeOfOperationContext *mode_ctx = mode_ctx_new();
+        if (!mode_ctx) return false;
+        mode_ctx->cipher_type = BLOCK_CIPHER_AES128;
+        mode_get_api(modes[m])->mode_init(mode_ctx, key, key_len, (modes[m] == MODE_ECB) ? NULL : iv,
+            (modes[m] == MODE_ECB) ? 0 : iv_len, NULL, 0, BLOCK_CIPHER_ENCRYPTION);
+        if (!mode_ctx->cipher_ctx) ok = false;
+        mode_ctx_free(mode_ctx);
+    }
+    return ok;
+}
+
+static void *test_allocator_thread(void *arg) {
+    void **blocks = (void **)arg;
+    // Allocate blocks that the main thread releases, and churn blocks of our own
+    for (int i = 0; i < 200; i++) blocks[i] = cryptomodule_alloc((size_t)64 << (i % 7));
+    for (int i = 0; i < 1000; i++) {
+        void *p = cryptomodule_alloc(sizeof(BlockCipherContext));
+        memset(p, 0xff, sizeof(BlockCipherContext));
+        cryptomodule_free(p, sizeof(BlockCipherContext));
+    }
+    return NULL;
+}
+
+void TEST_ALLOCATOR(void) {
+    static const size_t sizes[] = { 1, 64, 65, 200, sizeof(BlockCipherContext), sizeof(ModeOfOperationContext),
+                                    GCM_TABLE_SIZE, CRYPTOMODULE_POOL_MAX_SIZE + 1, 20000 };
+    const int num_sizes = (int)(sizeof(sizes) / sizeof(sizes[0]));
+    const int num_tests = 2 * num_sizes + 6;
+
+    printf("%s%s--------------------------------- ALLOCATOR TEST ---------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const size_t live = cryptomodule_alloc_live();
+
+#define ALLOC_CHECK(cond, ...) do {                 \
+        total_tests++;                              \
+        if (cond) {                                 \
+            passed_tests++;                         \
+        } else {                                    \
+            result = false;                         \
+            printf("[FAIL] " __VA_ARGS__);          \
+            printf("\n");                           \
+        }                                           \
+        progress_bar(total_tests, num_tests);       \
+    } while (0)
+
+    // Alignment, and zeroed blocks even after a dirty block of the same size was released
+    for (int i = 0; i < num_sizes; i++) {
+        u8 *p = cryptomodule_alloc(sizes[i]);
+        ALLOC_CHECK(p && ((uintptr_t)p % CRYPTOMODULE_CACHE_LINE) == 0, "%zu-byte block is not aligned", sizes[i]);
+        if (!p) continue;
+        memset(p, 0xee, sizes[i]);
+        cryptomodule_free(p, sizes[i]);
+
+        bool zero = true;
+        p = cryptomodule_alloc(sizes[i]);
+        for (size_t j = 0; p && j < sizes[i]; j++) {
+            if (p[j] != 0) zero = false;
+        }
+        ALLOC_CHECK(p && zero, "%zu-byte block is not zeroed on reuse", sizes[i]);
+        cryptomodule_free(p, sizes[i]);
+    }
+
+    // Every mode releases what it allocated
+    bool modes_ok = test_allocator_modes();
+    ALLOC_CHECK(modes_ok && cryptomodule_alloc_live() == live, "mode contexts leak pool blocks");
+
+    // Blocks allocated on one thread and released on another; the thread's cache is flushed at exit
+    {
+        void *blocks[200] = { NULL, };
+        pthread_t thread;
+        bool ok = (pthread_create(&thread, NULL, test_allocator_thread, blocks) == 0);
+        if (ok) pthread_join(thread, NULL);
+        for (int i = 0; i < 200; i++) {
+            if (!blocks[i]) ok = false;
+            cryptomodule_free(blocks[i], (size_t)64 << (i % 7));
+        }
+        ALLOC_CHECK(ok && cryptomodule_alloc_live() == live, "cross-thread release");
+    }
+
+    // An application allocator serves every mode, gets its blocks back wiped, and cannot be
+    // swapped while blocks are in use
+    {
+        static u8 arena_mem[64 * 1024] __attribute__((aligned(CRYPTOMODULE_CACHE_LINE)));
+        test_arena arena = { arena_mem, sizeof(arena_mem), 0, 0, 0, true };
+        const cryptomodule_allocator allocator = { test_arena_alloc, test_arena_release, &arena };
+        const cryptomodule_allocator incomplete = { test_arena_alloc, NULL, &arena };
+
+        ALLOC_CHECK(cryptomodule_set_allocator(&incomplete) == CRYPTOMODULE_ERR_INVALID_INPUT,
+            "allocator without release accepted");
+
+        bool ok = (live == 0 && cryptomodule_set_allocator(&allocator) == CRYPTOMODULE_OK);
+        if (ok) {
+            ok = test_allocator_modes();
+            u8 *p = cryptomodule_alloc(100);
+            ok = ok && p && p[0] == 0 && p[99] == 0;
+            ok = ok && cryptomodule_set_allocator(NULL) == CRYPTOMODULE_ERR_INVALID_INPUT;
+            cryptomodule_free(p, 100);
+            ok = ok && cryptomodule_set_allocator(NULL) == CRYPTOMODULE_OK;
+        }
+        ALLOC_CHECK(ok && arena.allocs > 6 && arena.allocs == arena.releases, "application allocator");
+        ALLOC_CHECK(arena.wiped, "blocks returned to the application allocator are not wiped");
+        ALLOC_CHECK(cryptomodule_alloc_live() == live, "live count after the application allocator");
+    }
+#undef ALLOC_CHECK
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total checks : %3d\n", total_tests);
+    printf("- Passed checks: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/* In a child: write one byte past a one-page arena; true if the guard page stopped the child */
+static bool test_secure_guard_page(void) {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    cryptomodule_secure_arena *arena;
+    if (cryptomodule_secure_arena_create(&arena, page, false) != CRYPTOMODULE_OK) return false;
+    volatile u8 *p = cryptomodule_secure_arena_alloc(arena, CRYPTOMODULE_POOL_MAX_SIZE);
+    bool faulted = false;
+
+    fflush(stdout);
+    pid_t pid = p ? fork() : -1;
+    if (pid == 0) {
+        p[page] = 1;
+        _exit(0);
+    }
+    if (pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        faulted = !(WIFEXITED(status) && WEXITSTATUS(status) == 0);     // SIGSEGV, or a sanitizer's exit
+    }
+    cryptomodule_secure_arena_free(arena, (void *)p, CRYPTOMODULE_POOL_MAX_SIZE);
+    cryptomodule_secure_arena_destroy(arena);
+    return faulted;
+}
+
+void TEST_SECURE_ARENA(void) {
+    const int num_tests = 9;
+
+    printf("%s%s------------------------------- SECURE ARENA TEST -------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+#define ARENA_CHECK(cond, ...) do {                 \
+        total_tests++;                              \
+        if (cond) {                                 \
+            passed_tests++;                         \
+        } else {                                    \
+            result = false;                         \
+            printf("[FAIL] " __VA_ARGS__);          \
+            printf("\n");                           \
+        }                                           \
+        progress_bar(total_tests, num_tests);       \
+    } while (0)
+
+    // cryptomodule_wipe
+    {
+        u8 buf[100];
+        bool zero = true;
+        memset(buf, 0x5a, sizeof(buf));
+        cryptomodule_wipe(buf + 1, sizeof(buf) - 2);
+        for (size_t i = 1; i < sizeof(buf) - 1; i++) {
+            if (buf[i] != 0) zero = false;
+        }
+        ARENA_CHECK(zero && buf[0] == 0x5a && buf[sizeof(buf) - 1] == 0x5a, "cryptomodule_wipe");
+    }
+
+    cryptomodule_secure_arena *arena = NULL;
+    cryptomodule_status_t status = cryptomodule_secure_arena_create(&arena, 64 * 1024, false);
+    ARENA_CHECK(status == CRYPTOMODULE_OK, "arena creation");
+    if (status != CRYPTOMODULE_OK) arena = NULL;
+    if (arena && !cryptomodule_secure_arena_locked(arena)) {
+        printf("[SKIP] the arena could not be locked (RLIMIT_MEMLOCK)\n");
+    }
+
+    // A released block is the next one of its class, and comes back zeroed and aligned
+    {
+        u8 *p = cryptomodule_secure_arena_alloc(arena, sizeof(BlockCipherContext));
+        bool ok = p && ((uintptr_t)p % CRYPTOMODULE_CACHE_LINE) == 0 && cryptomodule_secure_arena_contains(arena, p);
+        if (p) {
+            memset(p, 0xc3, sizeof(BlockCipherContext));
+            cryptomodule_secure_arena_free(arena, p, sizeof(BlockCipherContext));
+        }
+        u8 *q = cryptomodule_secure_arena_alloc(arena, sizeof(BlockCipherContext));
+        ok = ok && q == p;
+        for (size_t i = 0; q && i < sizeof(BlockCipherContext); i++) {
+            if (q[i] != 0) ok = false;
+        }
+        ARENA_CHECK(ok, "block reuse");
+        ARENA_CHECK(cryptomodule_secure_arena_destroy(arena) == CRYPTOMODULE_ERR_INVALID_INPUT,
+            "arena destroyed with a block in use");
+        cryptomodule_secure_arena_free(arena, q, sizeof(BlockCipherContext));
+    }
+
+    // Blocks above the largest class are refused, and a full arena returns NULL
+    {
+        void *blocks[16];
+        int n = 0;
+        bool ok = (cryptomodule_secure_arena_alloc(arena, CRYPTOMODULE_POOL_MAX_SIZE + 1) == NULL);
+        while (n < 16 && (blocks[n] = cryptomodule_secure_arena_alloc(arena, CRYPTOMODULE_POOL_MAX_SIZE)) != NULL) n++;
+        ok = ok && n == 15;     // 64 KiB, less the one 1024-byte block carved above
+        for (int i = 0; i < n; i++) cryptomodule_secure_arena_free(arena, blocks[i], CRYPTOMODULE_POOL_MAX_SIZE);
+        ARENA_CHECK(ok, "arena limits");
+    }
+
+    // Installed as the module allocator, the arena holds the round keys and the POLYVAL table
+    {
+        static const u8 key[16] = { 0x01, };
+        static const u8 nonce[12] = { 0x03, };
+        const cryptomodule_allocator allocator = cryptomodule_secure_arena_allocator(arena);
+        bool ok = (arena && cryptomodule_set_allocator(&allocator) == CRYPTOMODULE_OK);
+        if (ok) {
+            ModeOfOperationContext *mode_ctx = mode_ctx_new();
+            if (mode_ctx) {
+                mode_ctx->cipher_type = BLOCK_CIPHER_AES128;
+                get_gcm_siv_api()->mode_init(mode_ctx, key, sizeof(key), nonce, sizeof(nonce), NULL, 0,
+                    BLOCK_CIPHER_ENCRYPTION);
+            }
+            ok = mode_ctx && cryptomodule_secure_arena_contains(arena, mode_ctx) &&
+                 cryptomodule_secure_arena_contains(arena, mode_ctx->cipher_ctx) &&
+                 cryptomodule_secure_arena_contains(arena, mode_ctx->mode_state.gcm_siv_internal.polyval_table);
+            mode_ctx_free(mode_ctx);
+            ok = (cryptomodule_set_allocator(NULL) == CRYPTOMODULE_OK) && ok;
+        }
+        ARENA_CHECK(ok, "module allocator");
+    }
+
+    ARENA_CHECK(arena && cryptomodule_secure_arena_destroy(arena) == CRYPTOMODULE_OK, "arena destroy");
+    ARENA_CHECK(test_secure_guard_page(), "write past the arena did not fault");
+    ARENA_CHECK(cryptomodule_secure_arena_create(NULL, 4096, false) == CRYPTOMODULE_ERR_INVALID_INPUT,
+        "NULL arena accepted");
+#undef ARENA_CHECK
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total checks : %3d\n", total_tests);
+    printf("- Passed checks: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_AES_BATCH(void) {
+    // FIPS 197, Appendix C: the key is 00 01 02 ..., the plaintext 00 11 22 ... ff
+    static const struct {
+        size_t key_len;
+        int nr;
+        const char *ct;
+    } tv[] = {
+        { AES128_KEY_SIZE, AES128_NUM_ROUNDS, "69c4e0d86a7b0430d8cdb78070b4c55a" },
+        { AES192_KEY_SIZE, AES192_NUM_ROUNDS, "dda97ca4864cdfe06eaf70a0ec0d7191" },
+        { AES256_KEY_SIZE, AES256_NUM_ROUNDS, "8ea2b7ca516745bfeafc49904b496089" },
+    };
+    static const struct { aes_batch_backend_t backend; const char *name; } backends[] = {
+        { AES_BATCH_BACKEND_C,         "C" },
+        { AES_BATCH_BACKEND_BITSLICED, "bitsliced" },
+        { AES_BATCH_BACKEND_AESNI,     "AES-NI" },
+    };
+    enum { MAX_BATCH = 37 };    // Full groups of every backend plus a tail
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_backends = (int)(sizeof(backends) / sizeof(backends[0]));
+    int num_tests = 0;
+
+    printf("%s%s---------------------------- KEY-AGILE BATCH AES TEST -----------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    static u32 rk[MAX_BATCH][4 * (AES256_NUM_ROUNDS + 1)];
+    const u32 *rks[MAX_BATCH];
+    u8 pt[MAX_BATCH * AES_BLOCK_SIZE], expected[MAX_BATCH * AES_BLOCK_SIZE], ct[MAX_BATCH * AES_BLOCK_SIZE];
+    const aes_batch_backend_t saved = aes_batch_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+    for (int b = 0; b < num_backends; b++) {
+        if (aes_batch_set_backend(backends[b].backend)) num_tests += num_tv * 3;
+    }
+    for (int b = 0; b < num_backends; b++) {
+        if (!aes_batch_set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+        for (int t = 0; t < num_tv; t++) {
+            bool ok[3];
+
+            // Block 0 is the FIPS 197 vector; block i uses the key and plaintext shifted by i
+            for (int i = 0; i < MAX_BATCH; i++) {
+                u8 key[AES256_KEY_SIZE];
+                for (size_t j = 0; j < tv[t].key_len; j++) key[j] = (u8)(j + 7 * i);
+                for (size_t j = 0; j < AES_BLOCK_SIZE; j++) pt[i * AES_BLOCK_SIZE + j] = (u8)(0x11 * j + 3 * i);
+                aes_set_encrypt_key(key, tv[t].key_len, rk[i]);
+                rks[i] = rk[i];
+                aes_encrypt(pt + i * AES_BLOCK_SIZE, expected + i * AES_BLOCK_SIZE, rk[i], tv[t].nr);
+            }
+
+            u8 kat[AES_BLOCK_SIZE];
+            stringToByteArray(tv[t].ct, kat);
+            aes_encrypt_batch(rks, pt, ct, MAX_BATCH, tv[t].nr);
+            ok[0] = (memcmp(ct, kat, AES_BLOCK_SIZE) == 0);
+
+            // Every batch size: each block matches single-block encryption under its own key
+            ok[1] = true;
+            for (size_t n = 1; n <= MAX_BATCH; n++) {
+                memset(ct, 0, sizeof(ct));
+                aes_encrypt_batch(rks + (MAX_BATCH - n), pt + (MAX_BATCH - n) * AES_BLOCK_SIZE, ct, n, tv[t].nr);
+                if (memcmp(ct, expected + (MAX_BATCH - n) * AES_BLOCK_SIZE, n * AES_BLOCK_SIZE) != 0) ok[1] = false;
+                for (size_t j = n * AES_BLOCK_SIZE; j < sizeof(ct); j++) {
+                    if (ct[j] != 0) ok[1] = false;      // Wrote past the batch
+                }
+            }
+
+            // In place
+            memcpy(ct, pt, sizeof(pt));
+            aes_encrypt_batch(rks, ct, ct, MAX_BATCH, tv[t].nr);
+            ok[2] = (memcmp(ct, expected, sizeof(expected)) == 0);
+
+            for (int c = 0; c < 3; c++) {
+                static const char *labels[] = { "FIPS 197 vector", "batch vs single block", "in place" };
+                total_tests++;
+                if (ok[c]) {
+                    passed_tests++;
+                } else {
+                    result = false;
+                    printf("[FAIL] %s AES-%zu %s\n", backends[b].name, 8 * tv[t].key_len, labels[c]);
+                }
+                progress_bar(total_tests, num_tests);
+            }
+        }
+    }
+    aes_batch_set_backend(saved);
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void DIFF_TEST_SHA2_BACKENDS(void) {
+    static const struct {
+        bool (*set_backend)(SHA2_backend_t);
+        void (*hash)(u8 *, const u8 *, size_t);
+        SHA2_backend_t backend;
+        const char *name;
+    } backends[] = {
+        { SHA2_sha256_set_backend, SHA2_sha256, SHA2_BACKEND_SHA_NI, "SHA-256 SHA-NI" },
+        { SHA2_sha256_set_backend, SHA2_sha224, SHA2_BACKEND_SHA_NI, "SHA-224 SHA-NI" },
+        { SHA2_sha512_set_backend, SHA2_sha512, SHA2_BACKEND_AVX2,   "SHA-512 AVX2" },
+        { SHA2_sha512_set_backend, SHA2_sha384, SHA2_BACKEND_AVX2,   "SHA-384 AVX2" },
+    };
+    const size_t max_len = 4 * SHA2_SHA256_BLOCK_SIZE * 64;    // 16 KiB
+    const int num_msgs = 2000;
+
+    printf("%s%s-------------------------- SHA-2 BACKEND DIFFERENTIAL TEST --------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    u8 *msg = (u8*)malloc(max_len);
+    if (!msg) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return;
+    }
+
+    SHA2_backend_t saved256 = SHA2_sha256_get_backend();
+    SHA2_backend_t saved512 = SHA2_sha512_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    u32 seed = 0x12345678;
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!backends[b].set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+
+        for (int i = 0; i < num_msgs; i++) {
+            // Every length around the block and padding boundaries first, then random ones
+            size_t len = (i < 4 * SHA2_SHA512_BLOCK_SIZE) ? (size_t)i : 0;
+            for (size_t j = 0; j < max_len; j++) {
+                seed = seed * 1103515245u + 12345u;     // LCG, enough to vary the input
+                msg[j] = (u8)(seed >> 24);
+            }
+            if (len == 0 && i != 0) {
+                len = (seed >> 8) % (max_len + 1);
+            }
+
+            u8 expected[SHA2_SHA512_DIGEST_SIZE] = { 0x00, }, actual[SHA2_SHA512_DIGEST_SIZE] = { 0x00, };
+            backends[b].set_backend(SHA2_BACKEND_C);
+            backends[b].hash(expected, msg, len);
+            backends[b].set_backend(backends[b].backend);
+            backends[b].hash(actual, msg, len);
+
+            total_tests++;
+            if (memcmp(expected, actual, sizeof(expected)) == 0) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s differs from C for a %zu-byte message\n", backends[b].name, len);
+            }
+            progress_bar(i + 1, num_msgs);
+        }
+        printf("\n");
+    }
+
+    SHA2_sha256_set_backend(saved256);
+    SHA2_sha512_set_backend(saved512);
+
+    // Multi-buffer: a batch of messages of different lengths against one-at-a-time hashing
+    static const struct { SHA2_backend_t backend; const char *name; } multi_backends[] = {
+        { SHA2_BACKEND_AVX2,   "AVX2 x8" },
+        { SHA2_BACKEND_AVX512, "AVX-512 x16" },
+    };
+    enum { NUM_BATCH = 100 };
+    const u8 *batch[NUM_BATCH];
+    size_t batch_len[NUM_BATCH];
+    u8 expected[NUM_BATCH * SHA2_SHA256_DIGEST_SIZE], actual[NUM_BATCH * SHA2_SHA256_DIGEST_SIZE];
+
+    for (int i = 0; i < NUM_BATCH; i++) {
+        seed = seed * 1103515245u + 12345u;
+        batch_len[i] = (i < SHA2_SHA256_BLOCK_SIZE) ? (size_t)(4 * i) : (seed >> 8) % (max_len / 2);
+        batch[i] = msg + (seed >> 4) % (max_len / 2);
+        SHA2_sha256(expected + i * SHA2_SHA256_DIGEST_SIZE, batch[i], batch_len[i]);
+    }
+
+    SHA2_backend_t saved_multi = SHA2_sha256_multi_get_backend();
+    for (size_t b = 0; b < sizeof(multi_backends) / sizeof(multi_backends[0]); b++) {
+        if (!SHA2_sha256_multi_set_backend(multi_backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", multi_backends[b].name);
+            continue;
+        }
+        // Every batch size up to NUM_BATCH, so partially filled lanes are covered as well
+        for (int n = 1; n <= NUM_BATCH; n++) {
+            SHA2_sha256_multi(actual, batch, batch_len, (size_t)n);
+            total_tests++;
+            if (memcmp(expected, actual, (size_t)n * SHA2_SHA256_DIGEST_SIZE) == 0) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s differs from SHA2_sha256 for a batch of %d messages\n", multi_backends[b].name, n);
+            }
+            progress_bar(n, NUM_BATCH);
+        }
+        printf("\n");
+    }
+    SHA2_sha256_multi_set_backend(saved_multi);
+    free(msg);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+#define SHA3_TV_MAX_LINE_LENGTH 32768   /* LongMsg lines are up to ~29000 characters */
+
+static void sha3_hash(int bits, u8 *out, const u8 *in, size_t inlen) {
+    switch (bits) {
+        case 224: SHA3_sha3_224(out, in, inlen); break;
+        case 256: SHA3_sha3_256(out, in, inlen); break;
+        case 384: SHA3_sha3_384(out, in, inlen); break;
+        default:  SHA3_sha3_512(out, in, inlen); break;
+    }
+}
+
+/*
+ * Hashes one message with the one-shot function and incrementally in three uneven pieces,
+ * and compares both with the expected digest.
+ */
+static bool verify_SHA3_vector(int bits, const u8 *msg, size_t len, const u8 *md) {
+    static void (*const inc_init[])(SHA3_ctx *) = {
+        SHA3_sha3_224_inc_init, SHA3_sha3_256_inc_init, SHA3_sha3_384_inc_init, SHA3_sha3_512_inc_init,
+    };
+    const size_t md_len = (size_t)bits / 8;
+    u8 out[SHA3_SHA3_512_DIGEST_SIZE] = { 0x00, };
+    bool ok;
+
+    sha3_hash(bits, out, msg, len);
+    ok = (memcmp(out, md, md_len) == 0);
+
+    SHA3_ctx state;
+    inc_init[bits == 224 ? 0 : bits == 256 ? 1 : bits == 384 ? 2 : 3](&state);
+    SHA3_inc_absorb(&state, msg, len / 3);
+    SHA3_inc_absorb(&state, msg + len / 3, len / 2 - len / 3);
+    SHA3_inc_absorb(&state, msg + len / 2, len - len / 2);
+    memset(out, 0, sizeof(out));
+    SHA3_sha3_inc_finalize(out, &state);
+    return ok && (memcmp(out, md, md_len) == 0);
+}
+
+/*
+ * Parses a ShortMsg/LongMsg file (Len in bits, Msg, MD) and verifies every vector.
+ * Msg of length 0 is written as "00" and ignored.
+ */
+static bool verify_SHA3_msg_file(int bits, const char *filename, int *total, int *passed) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "[VERIFY] Error opening file: %s\n", filename);
+        return false;
+    }
+
+    printf("%s[PATH] Test vector file : %s%s\n", ANSI_FG_BMAGENTA, filename, ANSI_RESET);
+
+    char *line = (char*)calloc(SHA3_TV_MAX_LINE_LENGTH, sizeof(char));
+    u8 *msg = (u8*)calloc(SHA3_TV_MAX_LINE_LENGTH / 2, sizeof(u8));
+    u8 md[SHA3_SHA3_512_DIGEST_SIZE] = { 0x00, };
+    if (!line || !msg) {
+        fprintf(stderr, "[VERIFY] Memory allocation error\n");
+        free(line); free(msg);
+        fclose(fp);
+        return false;
+    }
+
+    size_t len = 0;
+    bool result = true;
+    while (fgets(line, SHA3_TV_MAX_LINE_LENGTH, fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (strncmp(line, "Len =", 5) == 0) {
+            len = (size_t)atoi(line + 6) / 8;
+        } else if (strncmp(line, "Msg =", 5) == 0) {
+            stringToByteArray(line + 6, msg);
+        } else if (strncmp(line, "MD =", 4) == 0) {
+            stringToByteArray(line + 5, md);
+            (*total)++;
+            if (verify_SHA3_vector(bits, msg, len, md)) {
+                (*passed)++;
+            } else if (result) {
+                fprintf(stderr, "\n%s%s[Vector %4d] Mismatch found%s\n",
+                    ANSI_BOLD, ANSI_BG_RED, *total, ANSI_RESET);
+                result = false;
+            }
+            progress_bar(*passed, *total);
+            fflush(stdout);
+        }
+    }
+    printf("\n");
+
+    free(line); free(msg);
+    fclose(fp);
+    return result;
+}
+
+/*
+ * Runs the Monte Carlo test of a Monte file: with MD[0] = MD[1] = MD[2] = Seed, each checkpoint
+ * is MD[1002] for MD[i] = H(MD[i-3] || MD[i-2] || MD[i-1]), and becomes the next Seed.
+ * Some of the shipped Monte files were produced by a generator that does not follow this (or
+ * any other FIPS 202 MCT) procedure; a file whose very first checkpoint differs is reported and
+ * skipped, while a file that starts matching must match to the end.
+ */
+static bool verify_SHA3_monte_file(int bits, const char *filename, int *total, int *passed) {
+    FILE *fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "[VERIFY] Error opening file: %s\n", filename);
+        return false;
+    }
+
+    printf("%s[PATH] Test vector file : %s%s\n", ANSI_FG_BMAGENTA, filename, ANSI_RESET);
+
+    const size_t md_len = (size_t)bits / 8;
+    char line[MAX_LINE_LENGTH];
+    u8 md[3 * SHA3_SHA3_512_DIGEST_SIZE] = { 0x00, };   // MD[i-3] || MD[i-2] || MD[i-1]
+    u8 seed[SHA3_SHA3_512_DIGEST_SIZE] = { 0x00, }, expected[SHA3_SHA3_512_DIGEST_SIZE] = { 0x00, };
+    int checkpoints = 0, matched = 0;
+    bool result = true;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (strncmp(line, "Seed =", 6) == 0) {
+            stringToByteArray(line + 7, seed);
+        } else if (strncmp(line, "MD =", 4) == 0) {
+            stringToByteArray(line + 5, expected);
+            for (int i = 0; i < 3; i++) {
+                memcpy(md + i * md_len, seed, md_len);
+            }
+            for (int i = 3; i < 1003; i++) {
+                u8 next[SHA3_SHA3_512_DIGEST_SIZE];
+                sha3_hash(bits, next, md, 3 * md_len);
+                memmove(md, md + md_len, 2 * md_len);
+                memcpy(md + 2 * md_len, next, md_len);
+            }
+            memcpy(seed, md + 2 * md_len, md_len);
+            checkpoints++;
+
+            if (memcmp(seed, expected, md_len) == 0) {
+                matched++;
+            } else if (matched == 0) {
+                printf("[SKIP] COUNT = 0 does not follow the SHA-3 Monte Carlo procedure; file not counted\n");
+                fclose(fp);
+                return true;
+            } else if (result) {
+                fprintf(stderr, "\n%s%s[Checkpoint %3d] Mismatch found%s\n",
+                    ANSI_BOLD, ANSI_BG_RED, checkpoints - 1, ANSI_RESET);
+                result = false;
+            }
+            progress_bar(matched, checkpoints);
+            fflush(stdout);
+        }
+    }
+    printf("\n");
+
+    *total += checkpoints;
+    *passed += matched;
+    fclose(fp);
+    return result;
+}
+
+void KAT_TEST_SHA3(int bits) {
+    char filename[100];
+
+    if (bits != 224 && bits != 256 && bits != 384 && bits != 512) {
+        fprintf(stderr, "[VERIFY] Unknown SHA-3 digest size: %d\n", bits);
+        return;
+    }
+
+    printf("%s%s--------------------------- SHA-3 KAT TEST for SHA3-%d ---------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        bits,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    snprintf(filename, sizeof(filename), "./testvectors/hash_tv/sha3/SHA3(%d)ShortMsg.txt", bits);
+    result = verify_SHA3_msg_file(bits, filename, &total_tests, &passed_tests) && result;
+    snprintf(filename, sizeof(filename), "./testvectors/hash_tv/sha3/SHA3(%d)LongMsg.txt", bits);
+    result = verify_SHA3_msg_file(bits, filename, &total_tests, &passed_tests) && result;
+    snprintf(filename, sizeof(filename), "./testvectors/hash_tv/sha3/SHA3(%d)Monte.txt", bits);
+    result = verify_SHA3_monte_file(bits, filename, &total_tests, &passed_tests) && result;
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void DIFF_TEST_SHA3_X4(void) {
+    static const struct { SHA3_backend_t backend; const char *name; } x4_backends[] = {
+        { SHA3_BACKEND_C,    "Keccak x4 C" },
+        { SHA3_BACKEND_AVX2, "Keccak x4 AVX2" },
+    };
+    const size_t max_len = 4 * SHA3_SHAKE128_RATE + 1;
+    const size_t out_len = 2 * SHA3_SHAKE128_RATE + 5;
+
+    printf("%s%s--------------------------- SHA-3 x4 DIFFERENTIAL TEST ----------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    u8 *msg = (u8*)malloc(4 * max_len);
+    u8 *out = (u8*)malloc(4 * out_len);
+    u8 *expected = (u8*)malloc(out_len);
+    if (!msg || !out || !expected) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(msg); free(out); free(expected);
+        return;
+    }
+
+    u32 seed = 0x9e3779b9;
+    for (size_t i = 0; i < 4 * max_len; i++) {
+        seed = seed * 1103515245u + 12345u;
+        msg[i] = (u8)(seed >> 24);
+    }
+    const u8 *in[4] = { msg, msg + max_len, msg + 2 * max_len, msg + 3 * max_len };
+    u8 *o[4] = { out, out + out_len, out + 2 * out_len, out + 3 * out_len };
+
+    SHA3_backend_t saved = SHA3_x4_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+    for (size_t b = 0; b < sizeof(x4_backends) / sizeof(x4_backends[0]); b++) {
+        if (!SHA3_x4_set_backend(x4_backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", x4_backends[b].name);
+            continue;
+        }
+
+        // Every length up to four SHAKE128 blocks, so all rate boundaries are crossed
+        for (size_t len = 0; len <= max_len; len++) {
+            bool ok = true;
+
+            SHA3_sha3_256_x4(o[0], o[1], o[2], o[3], in[0], in[1], in[2], in[3], len);
+            for (int j = 0; j < 4; j++) {
+                SHA3_sha3_256(expected, in[j], len);
+                ok = ok && (memcmp(expected, o[j], SHA3_SHA3_256_DIGEST_SIZE) == 0);
+            }
+            SHA3_sha3_512_x4(o[0], o[1], o[2], o[3], in[0], in[1], in[2], in[3], len);
+            for (int j = 0; j < 4; j++) {
+                SHA3_sha3_512(expected, in[j], len);
+                ok = ok && (memcmp(expected, o[j], SHA3_SHA3_512_DIGEST_SIZE) == 0);
+            }
+            SHA3_shake128_x4(o[0], o[1], o[2], o[3], out_len, in[0], in[1], in[2], in[3], len);
+            for (int j = 0; j < 4; j++) {
+                SHA3_shake128(expected, out_len, in[j], len);
+                ok = ok && (memcmp(expected, o[j], out_len) == 0);
+            }
+
+            // SHAKE256 incrementally: absorb and squeeze in two uneven pieces each
+            SHA3_ctx_x4 state;
+            size_t h = len / 3, q = out_len / 3;
+            SHA3_shake256_x4_inc_init(&state);
+            SHA3_x4_inc_absorb(&state, in[0], in[1], in[2], in[3], h);
+            SHA3_x4_inc_absorb(&state, in[0] + h, in[1] + h, in[2] + h, in[3] + h, len - h);
+            SHA3_shake_x4_inc_finalize(&state);
+            SHA3_shake_x4_inc_squeeze(o[0], o[1], o[2], o[3], q, &state);
+            SHA3_shake_x4_inc_squeeze(o[0] + q, o[1] + q, o[2] + q, o[3] + q, out_len - q, &state);
+            SHA3_x4_inc_ctx_release(&state);
+            for (int j = 0; j < 4; j++) {
+                SHA3_shake256(expected, out_len, in[j], len);
+                ok = ok && (memcmp(expected, o[j], out_len) == 0);
+            }
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s differs from single-stream SHA-3 for %zu-byte messages\n", x4_backends[b].name, len);
+            }
+            progress_bar((int)len + 1, (int)max_len + 1);
+        }
+        printf("\n");
+    }
+    SHA3_x4_set_backend(saved);
+    free(msg); free(out); free(expected);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_LSH(void) {
+    /*
+     * Messages: empty, "abc" and 300 bytes 01 08 0f .. (byte i = 7i + 1), which fills more than
+     * one block of both functions. The "abc" digests are the examples of KS X 3262.
+     */
+    static const struct {
+        int words;          // 256 or 512
+        size_t outlen;
+        const char *md[3];
+    } tv[] = {
+        { 256, 28, { "48a0d55b2b3d91f26e06f7110fe9ce8ea0e2656bbe344cb1c5930653",
+                     "f7c53ba4034e708e74fba42e55997ca5126bb7623688f85342f73732",
+                     "576815edd81235db416029487a0db7743e79a68e5a3e36dd9fcdf2dd" } },
+        { 256, 32, { "f3cd416a03818217726cb47f4e4d2881c9c29fd445c18b66fb19dea1a81007c1",
+                     "5fbf365daea5446a7053c52b57404d77a07a5f48a1f7c1963a0898ba1b714741",
+                     "6a7720e747f864b5b6c8e4a7dfbe2af3cc7085a6dd6d43b39d8f1a54578d8e2b" } },
+        { 512, 28, { "3c124edfe149b45c067965dae681322cdf52aa2c9d738b8f271b9318",
+                     "d1683234513ec5698394571ead128a8cd5373e97661ba20dcf89e489",
+                     "8d10708f497051e8e9aeb6a69b59b71b4297f0b3e17ceaaa1b0586fa" } },
+        { 512, 32, { "706df4ebf100f06d5cc9f6c79be5297c3f6f515801dd10fbc1b665a2d7bdb653",
+                     "cd892310532602332b613f1ec11a6962fca61ea09ecffcd4bcf75858d802edec",
+                     "f76aa110e37bbe6f8959f367e4ae00102255321e1f4603070a5623ca7735cd01" } },
+        { 512, 48, { "dbb259cf22459368ab2c52b3e1c977288b38670adcb91cae6b8b6a2d646e76f8bd53e5cab0e47c856f55249b895c1730",
+                     "5f344efaa0e43ccd2e5e194d6039794b4fb431f10fb4b65fd45e9da4ecde0f27b66e8dbdfa47252e0d0b741bfd91f9fe",
+                     "0aaf24a3fbf48378e557e0cca07973004d4cf8ae8ad12ca79ff2694fc1c7f6c111561d06c1af65808108e1c550ecdd08" } },
+        { 512, 64, { "118a2ff2a99e3b2134125e2baf20ebe3bdd034d5a69b29c22fc4995063340b46697801d7f7fb0070568f78e8ed514215fc70af27d6f27b01aa8a1da72b14ce7c",
+                     "a3d93cfe60dc1aacdd3bd4bef0a6985381a396c7d49d9fd177795697c3535208b5c57224bef21084d42083e95a4bd8eb33e869812b65031c428819a1e7ce596d",
+                     "3ebda330189174b9b096c2fdf33221135c3a843dc7aee2b8aea8b328b34882e658f4980aab11359a5dcc685639ca99f7ab3ec8b3671799222fb39ef33fac680e" } },
+    };
+    static const struct { LSH_backend_t backend; const char *name; } backends[] = {
+        { LSH_BACKEND_C,    "C" },
+        { LSH_BACKEND_SSE2, "SSE2" },
+        { LSH_BACKEND_AVX2, "AVX2" },
+    };
+
+    printf("%s%s----------------------------------- LSH KAT TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    LSH_backend_t saved = LSH_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+    u8 msgs[3][300];
+    const size_t msg_lens[3] = { 0, 3, 300 };
+    memcpy(msgs[1], "abc", 3);
+    for (size_t i = 0; i < sizeof(msgs[2]); i++) msgs[2][i] = (u8)(7 * i + 1);
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!LSH_set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+            for (int m = 0; m < 3; m++) {
+                u8 expected[LSH_LSH512_512_DIGEST_SIZE], md[LSH_LSH512_512_DIGEST_SIZE], inc_md[LSH_LSH512_512_DIGEST_SIZE];
+                stringToByteArray(tv[i].md[m], expected);
+
+                // One-shot, then the same message in pieces of 1, 2, 3, .. bytes
+                bool ok;
+                if (tv[i].words == 256) {
+                    LSH_lsh256_ctx state;
+                    ok = (LSH_lsh256(md, tv[i].outlen, msgs[m], msg_lens[m]) == CRYPTOMODULE_OK) &&
+                         (LSH_lsh256_inc_init(&state, tv[i].outlen) == CRYPTOMODULE_OK);
+                    for (size_t off = 0, n = 1; ok && off < msg_lens[m]; off += n, n++) {
+                        if (n > msg_lens[m] - off) n = msg_lens[m] - off;
+                        LSH_lsh256_inc(&state, msgs[m] + off, n);
+                    }
+                    if (ok) LSH_lsh256_inc_finalize(inc_md, &state);
+                } else {
+                    LSH_lsh512_ctx state;
+                    ok = (LSH_lsh512(md, tv[i].outlen, msgs[m], msg_lens[m]) == CRYPTOMODULE_OK) &&
+                         (LSH_lsh512_inc_init(&state, tv[i].outlen) == CRYPTOMODULE_OK);
+                    for (size_t off = 0, n = 1; ok && off < msg_lens[m]; off += n, n++) {
+                        if (n > msg_lens[m] - off) n = msg_lens[m] - off;
+                        LSH_lsh512_inc(&state, msgs[m] + off, n);
+                    }
+                    if (ok) LSH_lsh512_inc_finalize(inc_md, &state);
+                }
+                ok = ok && memcmp(md, expected, tv[i].outlen) == 0 && memcmp(inc_md, expected, tv[i].outlen) == 0;
+
+                total_tests++;
+                if (ok) {
+                    passed_tests++;
+                } else {
+                    result = false;
+                    printf("[FAIL] %s: LSH-%d-%zu, %zu-byte message\n", backends[b].name, tv[i].words, tv[i].outlen * 8, msg_lens[m]);
+                }
+            }
+        }
+        progress_bar((int)b + 1, (int)(sizeof(backends) / sizeof(backends[0])));
+        printf("\n");
+    }
+    LSH_set_backend(saved);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void TEST_CPU_DISPATCH(void) {
+    printf("%s%s------------------------------- CPU DISPATCH TEST ---------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    cryptomodule_print_dispatch(stdout);
+
+    size_t count;
+    const cryptomodule_dispatch_entry *table = cryptomodule_dispatch_table(&count);
+    const char *saved[16];
+    if (count > sizeof(saved) / sizeof(saved[0])) count = sizeof(saved) / sizeof(saved[0]);
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+#define CHECK(cond, ...)                                    \
+    do {                                                    \
+        total_tests++;                                      \
+        if (cond) {                                         \
+            passed_tests++;                                 \
+        } else {                                            \
+            result = false;                                 \
+            printf("[FAIL] " __VA_ARGS__);                  \
+            printf("\n");                                   \
+        }                                                   \
+    } while (0)
+
+    for (size_t i = 0; i < count; i++) saved[i] = cryptomodule_get_backend(table[i].name);
+
+    // Every backend can be forced by name exactly when the CPU has its features
+    u32 features = cryptomodule_cpu_features();
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < table[i].num_backends; j++) {
+            const cryptomodule_backend_desc *d = &table[i].backends[j];
+            bool avail = (features & d->features) == d->features;
+            cryptomodule_status_t st = cryptomodule_set_backend(table[i].name, d->name);
+
+            CHECK((st == CRYPTOMODULE_OK) == avail, "%s=%s: %s", table[i].name, d->name,
+                  avail ? "rejected" : "accepted without the CPU features");
+            if (avail) {
+                const char *now = cryptomodule_get_backend(table[i].name);
+                CHECK(now && strcmp(now, d->name) == 0, "%s=%s: backend is %s", table[i].name, d->name, now ? now : "?");
+            }
+        }
+        progress_bar((int)i + 1, (int)count);
+    }
+    printf("\n");
+
+    // A forced backend changes the code path but not the result
+    u8 ref[32 + LSH_LSH512_512_DIGEST_SIZE], md[32 + LSH_LSH512_512_DIGEST_SIZE], msg[1000];
+    for (size_t i = 0; i < sizeof(msg); i++) msg[i] = (u8)(i * 13 + 5);
+    CHECK(cryptomodule_apply_backends("sha256=c, sha512=c, lsh=c") == CRYPTOMODULE_OK, "list of pairs rejected");
+    SHA2_sha256(ref, msg, sizeof(msg));
+    LSH_lsh512_512(ref + 32, msg, 200);
+    CHECK(cryptomodule_set_backend("all", "auto") == CRYPTOMODULE_OK, "all=auto rejected");
+    SHA2_sha256(md, msg, sizeof(msg));
+    LSH_lsh512_512(md + 32, msg, 200);
+    CHECK(memcmp(ref, md, sizeof(ref)) == 0, "digests differ between the C and the selected backends");
+
+    // Malformed lists and unknown names are reported; the valid entries still apply
+    CHECK(cryptomodule_apply_backends("lsh=c,sha256") == CRYPTOMODULE_ERR_INVALID_INPUT, "entry without '=' accepted");
+    CHECK(strcmp(cryptomodule_get_backend("lsh"), "c") == 0, "valid entry of a malformed list not applied");
+    CHECK(cryptomodule_apply_backends("md5=c") == CRYPTOMODULE_ERR_INVALID_INPUT, "unknown primitive accepted");
+    CHECK(cryptomodule_set_backend("lsh", "neon") == CRYPTOMODULE_ERR_INVALID_INPUT, "unknown backend accepted");
+    CHECK(cryptomodule_apply_backends(NULL) == CRYPTOMODULE_OK && cryptomodule_apply_backends(" ,") == CRYPTOMODULE_OK,
+          "empty list rejected");
+    CHECK(cryptomodule_get_backend("md5") == NULL, "unknown primitive has a backend");
+
+    // Masked features are gone for every primitive until they are unmasked
+    u32 masked = CRYPTOMODULE_CPU_SSE2 | CRYPTOMODULE_CPU_AVX2 | CRYPTOMODULE_CPU_SHA_NI | CRYPTOMODULE_CPU_AESNI;
+    cryptomodule_cpu_disable(masked);
+    CHECK((cryptomodule_cpu_features() & masked) == 0, "masked features still reported");
+    CHECK(!sha2_cpu_has_sha_ni() && !sha2_cpu_has_avx2() && !sha2_cpu_has_avx512(), "sha2_cpu_has ignores the mask");
+    for (size_t i = 0; i < count; i++) {
+        const char *now = cryptomodule_get_backend(table[i].name);
+        CHECK(now && strcmp(now, "c") == 0, "%s uses %s with SSE2/AVX2/SHA-NI/AES-NI masked", table[i].name, now ? now : "?");
+    }
+    CHECK(cryptomodule_set_backend("lsh", "sse2") == CRYPTOMODULE_ERR_INVALID_INPUT, "masked backend accepted");
+    cryptomodule_cpu_disable(0);
+    CHECK(cryptomodule_cpu_features() == cryptomodule_cpu_features_detected(), "features not unmasked");
+
+#undef CHECK
+
+    for (size_t i = 0; i < count; i++) cryptomodule_set_backend(table[i].name, saved[i]);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Checks one HMAC vector through the one-shot call, and through a keyed context that MACs the
+ * message twice (in two pieces, then after hmac_final has reset it) and once more from a clone.
+ */
+static bool verify_HMAC_vector(HmacHashType hash, const u8 *key, size_t key_len,
+                               const u8 *msg, size_t msg_len, const u8 *expected, size_t mac_len) {
+    HmacContext ctx, clone;
+    u8 mac[HMAC_MAX_MAC_SIZE] = { 0x00, };
+    bool ok;
+
+    ok = (hmac(hash, key, key_len, msg, msg_len, mac, mac_len) == CRYPTOMODULE_OK) &&
+         (memcmp(mac, expected, mac_len) == 0);
+
+    ok = ok && (hmac_init(&ctx, hash, key, key_len) == CRYPTOMODULE_OK);
+    for (int round = 0; round < 2 && ok; round++) {
+        memset(mac, 0, sizeof(mac));
+        ok = (hmac_update(&ctx, msg, msg_len / 2) == CRYPTOMODULE_OK) &&
+             (hmac_update(&ctx, msg + msg_len / 2, msg_len - msg_len / 2) == CRYPTOMODULE_OK) &&
+             (hmac_final(&ctx, mac, mac_len) == CRYPTOMODULE_OK) &&
+             (memcmp(mac, expected, mac_len) == 0);
+    }
+
+    // A clone taken mid-message finishes independently of the original
+    memset(mac, 0, sizeof(mac));
+    ok = ok && (hmac_update(&ctx, msg, msg_len / 2) == CRYPTOMODULE_OK) &&
+         (hmac_ctx_clone(&clone, &ctx) == CRYPTOMODULE_OK) &&
+         (hmac_update(&ctx, (const u8 *)"x", 1) == CRYPTOMODULE_OK) &&
+         (hmac_update(&clone, msg + msg_len / 2, msg_len - msg_len / 2) == CRYPTOMODULE_OK) &&
+         (hmac_final(&clone, mac, mac_len) == CRYPTOMODULE_OK) &&
+         (memcmp(mac, expected, mac_len) == 0);
+
+    hmac_dispose(&ctx);
+    hmac_dispose(&clone);
+    return ok;
+}
+
+void KAT_TEST_HMAC(void) {
+    // RFC 4231 test cases 1-7 (case 5 is truncated to 128 bits)
+    static const struct {
+        u8 key_byte;        // Key is key_len copies of key_byte (case 2 and 4 are special)
+        size_t key_len;
+        const char *data;   // Data as text, or NULL for data_len copies of data_byte
+        u8 data_byte;
+        size_t data_len;
+        size_t mac_len;     // 0: full MAC
+        const char *mac[4]; // HMAC-SHA-224/256/384/512
+    } tv[] = {
+        { 0x0b, 20, "Hi There", 0, 0, 0, {
+            "896fb1128abbdf196832107cd49df33f47b4b1169912ba4f53684b22",
+            "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7",
+            "afd03944d84895626b0825f4ab46907f15f9dadbe4101ec682aa034c7cebc59cfaea9ea9076ede7f4af152e8b2fa9cb6",
+            "87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cdedaa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854" } },
+        { 0x00, 4, "what do ya want for nothing?", 0, 0, 0, {
+            "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44",
+            "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843",
+            "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e8e2240ca5e69e2c78b3239ecfab21649",
+            "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" } },
+        { 0xaa, 20, NULL, 0xdd, 50, 0, {
+            "7fb3cb3588c6c1f6ffa9694d7d6ad2649365b0c1f65d69d1ec8333ea",
+            "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe",
+            "88062608d3e6ad8a0aa2ace014c8a86f0aa635d947ac9febe83ef4e55966144b2a5ab39dc13814b94e3ab6e101a34f27",
+            "fa73b0089d56a284efb0f0756c890be9b1b5dbdd8ee81a3655f83e33b2279d39bf3e848279a722c806b485a47e67c807b946a337bee8942674278859e13292fb" } },
+        { 0x01, 25, NULL, 0xcd, 50, 0, {
+            "6c11506874013cac6a2abc1bb382627cec6a90d86efc012de7afec5a",
+            "82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b",
+            "3e8a69b7783c25851933ab6290af6ca77a9981480850009cc5577c6e1f573b4e6801dd23c4a7d679ccf8a386c674cffb",
+            "b0ba465637458c6990e5a8c5f61d4af7e576d97ff94b872de76f8050361ee3dba91ca5c11aa25eb4d679275cc5788063a5f19741120c4f2de2adebeb10a298dd" } },
+        { 0x0c, 20, "Test With Truncation", 0, 0, 16, {
+            "0e2aea68a90c8d37c988bcdb9fca6fa8",
+            "a3b6167473100ee06e0c796c2955552b",
+            "3abf34c3503b2a23a46efc619baef897",
+            "415fad6271580a531d4179bc891d87a6" } },
+        { 0xaa, 131, "Test Using Larger Than Block-Size Key - Hash Key First", 0, 0, 0, {
+            "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e",
+            "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54",
+            "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c60c2ef6ab4030fe8296248df163f44952",
+            "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598" } },
+        { 0xaa, 131, "This is a test using a larger than block-size key and a larger than block-size data. "
+                     "The key needs to be hashed before being used by the HMAC algorithm.", 0, 0, 0, {
+            "3a854166ac5d9f023f54d517d0b39dbd946770db9c2b95c9f6f565d1",
+            "9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2",
+            "6617178e941f020d351e2f254e8fd32c602420feb0b8fb9adccebb82461e99c5a678cc31e799176d3860e6110c46523e",
+            "e37b6a775dc87dbaa4dfa9f96e5e3ffddebd71f8867289865df5a32d20cdc944b6022cac3c4982b10d5eeb55c3e4de15134676fb6de0446065c97440fa8c6a58" } },
+    };
+    static const char *hash_names[] = { "SHA-224", "SHA-256", "SHA-384", "SHA-512" };
+
+    printf("%s%s---------------------------------- HMAC KAT TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const int num_tests = (int)(sizeof(tv) / sizeof(tv[0])) * 4;
+    for (size_t i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+        u8 key[131], fill[50], expected[HMAC_MAX_MAC_SIZE];
+        const u8 *data;
+        size_t data_len;
+
+        if (i == 1) {
+            memcpy(key, "Jefe", 4);
+        } else {
+            for (size_t j = 0; j < tv[i].key_len; j++) {
+                key[j] = (i == 3) ? (u8)(j + 1) : tv[i].key_byte;     // Case 4: 0x01..0x19
+            }
+        }
+        // Text data is hashed in place; only the repeated-byte cases need a buffer
+        if (tv[i].data) {
+            data = (const u8 *)tv[i].data;
+            data_len = strlen(tv[i].data);
+        } else {
+            data_len = tv[i].data_len;
+            memset(fill, tv[i].data_byte, data_len);
+            data = fill;
+        }
+
+        for (int h = 0; h < 4; h++) {
+            size_t mac_len = tv[i].mac_len ? tv[i].mac_len : hmac_mac_size((HmacHashType)h);
+            stringToByteArray(tv[i].mac[h], expected);
+
+            total_tests++;
+            if (verify_HMAC_vector((HmacHashType)h, key, tv[i].key_len, data, data_len, expected, mac_len)) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] RFC 4231 case %zu with HMAC-%s\n", i + 1, hash_names[h]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Checks one CMAC vector through the one-shot call and through a context fed in pieces of 1, 15, 17,
+ * 3, ... bytes, so that updates end inside, at and across block boundaries.
+ */
+static bool verify_CMAC_vector(BlockCipherType type, const u8 *key, size_t key_len,
+                               const u8 *msg, size_t msg_len, const u8 *expected) {
+    static const size_t pieces[] = { 1, 15, 17, 3, 16, 29 };
+    CmacContext ctx;
+    u8 mac[CMAC_MAC_SIZE];
+    bool ok;
+
+    ok = (cmac(type, key, key_len, msg, msg_len, mac, sizeof(mac)) == CRYPTOMODULE_OK) &&
+         (memcmp(mac, expected, sizeof(mac)) == 0);
+
+    if (cmac_init(&ctx, type, key, key_len) != CRYPTOMODULE_OK) return false;
+    for (size_t off = 0, p = 0; off < msg_len; p++) {
+        size_t n = pieces[p % (sizeof(pieces) / sizeof(pieces[0]))];
+        if (n > msg_len - off) n = msg_len - off;
+        ok = ok && (cmac_update(&ctx, msg + off, n) == CRYPTOMODULE_OK);
+        off += n;
+    }
+    memset(mac, 0, sizeof(mac));
+    ok = ok && (cmac_final(&ctx, mac, sizeof(mac)) == CRYPTOMODULE_OK) &&
+         (memcmp(mac, expected, sizeof(mac)) == 0);
+    cmac_dispose(&ctx);
+    return ok;
+}
+
+void KAT_TEST_CMAC(void) {
+    // RFC 4493 and NIST SP 800-38B, Appendix D.1-D.3: the SP 800-38A plaintext truncated to 0, 16, 40
+    // and 64 bytes
+    static const char *message =
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+    static const size_t msg_lens[4] = { 0, 16, 40, 64 };
+    static const struct {
+        BlockCipherType type;
+        const char *key;
+        const char *mac[4];
+    } tv[] = {
+        { BLOCK_CIPHER_AES128, "2b7e151628aed2a6abf7158809cf4f3c", {
+            "bb1d6929e95937287fa37d129b756746", "070a16b46b4d4144f79bdd9dd04a287c",
+            "dfa66747de9ae63030ca32611497c827", "51f0bebf7e3b9d92fc49741779363cfe" } },
+        { BLOCK_CIPHER_AES192, "8e73b0f7da0e6452c810f32b809079e562f8ead2522c6b7b", {
+            "d17ddf46adaacde531cac483de7a9367", "9e99a7bf31e710900662f65e617c5184",
+            "8a1de5be2eb31aad089a82e6ee908b0e", "a1d5df0eed790f794d77589659f39a11" } },
+        { BLOCK_CIPHER_AES256, "603deb1015ca71be2b73aef0857d77811f352c073b6108d72d9810a30914dff4", {
+            "028962f61b7bf89efc6b551f4667d983", "28a7023f452e8f82bd4bf28d8c37c35c",
+            "aaf3d8f1de5640c232f5b169b9c911e6", "e1992190549f6ed5696a2c056c315410" } },
+    };
+    enum { NUM_MULTI = 19 };    // More messages than CMAC_MAX_LANES, with a partial last group
+    const int num_tv = (int)(sizeof(tv) / sizeof(tv[0]));
+    const int num_tests = num_tv * 5;
+
+    printf("%s%s---------------------------------- CMAC KAT TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    for (int i = 0; i < num_tv; i++) {
+        u8 key[32], msg[64], expected[CMAC_MAC_SIZE];
+        const size_t key_len = byte_length(tv[i].key);
+        const char *name = block_cipher_type_to_string(tv[i].type);
+
+        stringToByteArray(tv[i].key, key);
+        stringToByteArray(message, msg);
+
+        for (int l = 0; l < 4; l++) {
+            stringToByteArray(tv[i].mac[l], expected);
+            total_tests++;
+            if (verify_CMAC_vector(tv[i].type, key, key_len, msg, msg_lens[l], expected)) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s CMAC of %zu bytes\n", name, msg_lens[l]);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+
+        // cmac_multi over messages of mixed lengths (including the empty one) against the one-shot call
+        {
+            static u8 data[NUM_MULTI][200];
+            const u8 *msgs[NUM_MULTI];
+            size_t lens[NUM_MULTI];
+            u8 macs[NUM_MULTI * CMAC_MAC_SIZE], one[CMAC_MAC_SIZE];
+            CmacContext ctx;
+            bool ok = (cmac_init(&ctx, tv[i].type, key, key_len) == CRYPTOMODULE_OK);
+
+            for (int m = 0; m < NUM_MULTI; m++) {
+                lens[m] = (size_t)((m * 37) % 200);    // 0, 37, 74, ..., and two whole-block lengths
+                if (m == 3) lens[m] = 16;
+                if (m == 7) lens[m] = 64;
+                for (size_t k = 0; k < lens[m]; k++) data[m][k] = (u8)(k * 3 + m);
+                msgs[m] = data[m];
+            }
+            ok = ok && (cmac_multi(&ctx, msgs, lens, NUM_MULTI, macs, CMAC_MAC_SIZE) == CRYPTOMODULE_OK);
+            for (int m = 0; ok && m < NUM_MULTI; m++) {
+                ok = (cmac(tv[i].type, key, key_len, msgs[m], lens[m], one, sizeof(one)) == CRYPTOMODULE_OK) &&
+                     (memcmp(one, macs + m * CMAC_MAC_SIZE, CMAC_MAC_SIZE) == 0);
+            }
+            cmac_dispose(&ctx);
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s cmac_multi of %d messages\n", name, NUM_MULTI);
+            }
+            progress_bar(total_tests, num_tests);
+        }
+    }
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_PBKDF2(void) {
+    // RFC 7914 section 11 and the RFC 6070 inputs with SHA-256
+    static const struct {
+        const char *password;
+        size_t password_len;
+        const char *salt;
+        size_t salt_len;
+        u32 iterations;
+        const char *dk;
+    } tv[] = {
+        { "passwd", 6, "salt", 4, 1,
+          "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc49ca9cccf179b645991664b39d77ef317c71b845b1e30bd509112041d3a19783" },
+        { "Password", 8, "NaCl", 4, 80000,
+          "4ddcd8f60b98be21830cee5ef22701f9641a4418d04c0414aeff08876b34ab56a1d425a1225833549adb841b51c9b3176a272bdebba1d078478f62b397f33c8d" },
+        { "password", 8, "salt", 4, 4096,
+          "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a" },
+        { "passwordPASSWORDpassword", 24, "saltSALTsaltSALTsaltSALTsaltSALTsalt", 36, 4096,
+          "348c89dbcbd32b2f32d814b8116e84cf2b17347ebc1800181c4e2a1fb8dd53e1c635518c7dac47e9" },
+        { "pass\0word", 9, "sa\0lt", 5, 4096,
+          "89b69d0516f829893c696226650a8687" },
+    };
+    static const struct { SHA2_backend_t backend; const char *name; } backends[] = {
+        { SHA2_BACKEND_C,      "serial" },
+        { SHA2_BACKEND_AVX2,   "AVX2 x8" },
+        { SHA2_BACKEND_AVX512, "AVX-512 x16" },
+    };
+    enum { NUM_BATCH = 20, BATCH_DK_LEN = 40, BATCH_ITERATIONS = 50 };
+
+    printf("%s%s--------------------------------- PBKDF2 KAT TEST ---------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    SHA2_backend_t saved = SHA2_sha256_multi_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!SHA2_sha256_multi_set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+            u8 expected[64], dk[64] = { 0x00, };
+            size_t dk_len = strlen(tv[i].dk) / 2;
+            stringToByteArray(tv[i].dk, expected);
+
+            total_tests++;
+            if (pbkdf2_hmac_sha256((const u8 *)tv[i].password, tv[i].password_len,
+                                   (const u8 *)tv[i].salt, tv[i].salt_len,
+                                   tv[i].iterations, dk, dk_len) == CRYPTOMODULE_OK &&
+                memcmp(dk, expected, dk_len) == 0) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s: vector %zu\n", backends[b].name, i + 1);
+            }
+        }
+
+        // A batch of different passwords and salts against one derivation at a time
+        u8 pool[NUM_BATCH + 64], batch_dk[NUM_BATCH * BATCH_DK_LEN], single_dk[BATCH_DK_LEN];
+        const u8 *passwords[NUM_BATCH], *salts[NUM_BATCH];
+        size_t password_lens[NUM_BATCH], salt_lens[NUM_BATCH];
+        for (size_t i = 0; i < sizeof(pool); i++) pool[i] = (u8)(i * 29 + 7);
+        for (int i = 0; i < NUM_BATCH; i++) {
+            passwords[i] = pool + i;
+            password_lens[i] = (size_t)(i * 5) % 64;
+            salts[i] = pool + NUM_BATCH - i;
+            salt_lens[i] = (size_t)(i * 3) % 32;
+        }
+
+        bool ok = (pbkdf2_hmac_sha256_multi(passwords, password_lens, salts, salt_lens, BATCH_ITERATIONS,
+                                            batch_dk, BATCH_DK_LEN, NUM_BATCH) == CRYPTOMODULE_OK);
+        for (int i = 0; i < NUM_BATCH && ok; i++) {
+            ok = (pbkdf2_hmac_sha256(passwords[i], password_lens[i], salts[i], salt_lens[i], BATCH_ITERATIONS,
+                                     single_dk, BATCH_DK_LEN) == CRYPTOMODULE_OK) &&
+                 (memcmp(single_dk, batch_dk + i * BATCH_DK_LEN, BATCH_DK_LEN) == 0);
+        }
+        total_tests++;
+        if (ok) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] %s: batch of %d derivations\n", backends[b].name, NUM_BATCH);
+        }
+        progress_bar((int)b + 1, (int)(sizeof(backends) / sizeof(backends[0])));
+        printf("\n");
+    }
+    SHA2_sha256_multi_set_backend(saved);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_HKDF(void) {
+    // RFC 5869 test cases 1-3; the HKDF-SHA384 outputs use the same inputs
+    static const struct {
+        HmacHashType hash;
+        const char *ikm;
+        const char *salt;
+        const char *info;
+        const char *prk;
+        const char *okm;
+    } tv[] = {
+        { HMAC_SHA256, "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "000102030405060708090a0b0c", "f0f1f2f3f4f5f6f7f8f9",
+          "077709362c2e32df0ddc3f0dc47bba6390b6c73bb50f9c3122ec844ad7c2b3e5",
+          "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865" },
+        { HMAC_SHA256,
+          "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f"
+          "303132333435363738393a3b3c3d3e3f404142434445464748494a4b4c4d4e4f",
+          "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f808182838485868788898a8b8c8d8e8f"
+          "909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeaf",
+          "b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+          "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+          "06a6b88c5853361a06104c9ceb35b45cef760014904671014a193f40c15fc244",
+          "b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c59045a99cac7827271cb41c65e590e09"
+          "da3275600c2f09b8367793a9aca3db71cc30c58179ec3e87c14c01d5c1f3434f1d87" },
+        { HMAC_SHA256, "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "", "",
+          "19ef24a32c717b167f33a91d6f648bdf96596776afdb6377ac434c1c293ccb04",
+          "8da4e775a563c18f715f802a063c5a31b8a11f5c5ee1879ec3454e5f3c738d2d9d201395faa4b61a96c8" },
+        { HMAC_SHA384, "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "000102030405060708090a0b0c", "f0f1f2f3f4f5f6f7f8f9",
+          "704b39990779ce1dc548052c7dc39f303570dd13fb39f7acc564680bef80e8dec70ee9a7e1f3e293ef68eceb072a5ade",
+          "9b5097a86038b805309076a44b3a9f38063e25b516dcbf369f394cfab43685f748b6457763e4f0204fc5" },
+        { HMAC_SHA384,
+          "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f202122232425262728292a2b2c2d2e2f"
+          "303132333435363738393a3b3c3d3e3f404142434445464748494a4b4c4d4e4f",
+          "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f808182838485868788898a8b8c8d8e8f"
+          "909192939495969798999a9b9c9d9e9fa0a1a2a3a4a5a6a7a8a9aaabacadaeaf",
+          "b0b1b2b3b4b5b6b7b8b9babbbcbdbebfc0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+          "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff",
+          "b319f6831dff9314efb643baa29263b30e4a8d779fe31e9c901efd7de737c85b62e676d4dc87b0895c6a7dc97b52cebb",
+          "484ca052b8cc724fd1c4ec64d57b4e818c7e25a8e0f4569ed72a6a05fe0649eebf69f8d5c832856bf4e4fbc17967d549"
+          "75324a94987f7f41835817d8994fdbd6f4c09c5500dca24a56222fea53d8967a8b2e" },
+        { HMAC_SHA384, "0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b", "", "",
+          "10e40cf072a4c5626e43dd22c1cf727d4bb140975c9ad0cbc8e45b40068f8f0ba57cdb598af9dfa6963a96899af047e5",
+          "c8c96e710f89b0d7990bca68bcdec8cf854062e54c73a7abc743fade9b242daacc1cea5670415b52849c" },
+    };
+    static const struct { SHA2_backend_t backend; const char *name; } backends[] = {
+        { SHA2_BACKEND_C,      "serial" },
+        { SHA2_BACKEND_AVX2,   "AVX2 x8" },
+        { SHA2_BACKEND_AVX512, "AVX-512 x16" },
+    };
+    enum { NUM_LABELS = 37, LABEL_OKM_LEN = 100 };
+
+    printf("%s%s---------------------------------- HKDF KAT TEST ----------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    SHA2_backend_t saved = SHA2_sha256_multi_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!SHA2_sha256_multi_set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+            u8 ikm[80], salt[80], info[80], prk[HKDF_MAX_PRK_SIZE], expected_prk[HKDF_MAX_PRK_SIZE];
+            u8 okm[82], expected[82], streamed[82];
+            size_t ikm_len = strlen(tv[i].ikm) / 2, salt_len = strlen(tv[i].salt) / 2;
+            size_t info_len = strlen(tv[i].info) / 2, okm_len = strlen(tv[i].okm) / 2;
+            stringToByteArray(tv[i].ikm, ikm);
+            stringToByteArray(tv[i].salt, salt);
+            stringToByteArray(tv[i].info, info);
+            stringToByteArray(tv[i].prk, expected_prk);
+            stringToByteArray(tv[i].okm, expected);
+
+            // Extract, expand in one call, then read the same output in uneven pieces
+            HkdfContext ctx;
+            HkdfExpandStream stream;
+            bool ok = (hkdf_extract(tv[i].hash, salt, salt_len, ikm, ikm_len, prk) == CRYPTOMODULE_OK) &&
+                      (memcmp(prk, expected_prk, hmac_mac_size(tv[i].hash)) == 0) &&
+                      (hkdf_init(&ctx, tv[i].hash, prk, hmac_mac_size(tv[i].hash)) == CRYPTOMODULE_OK) &&
+                      (hkdf_expand(&ctx, info, info_len, okm, okm_len) == CRYPTOMODULE_OK) &&
+                      (memcmp(okm, expected, okm_len) == 0) &&
+                      (hkdf_expand_stream_init(&stream, &ctx, info, info_len) == CRYPTOMODULE_OK) &&
+                      (hkdf_expand_read(&stream, streamed, 1) == CRYPTOMODULE_OK) &&
+                      (hkdf_expand_read(&stream, streamed + 1, 40) == CRYPTOMODULE_OK) &&
+                      (hkdf_expand_read(&stream, streamed + 41, okm_len - 41) == CRYPTOMODULE_OK) &&
+                      (memcmp(streamed, expected, okm_len) == 0);
+            hkdf_expand_stream_dispose(&stream);
+            hkdf_dispose(&ctx);
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s: vector %zu\n", backends[b].name, i + 1);
+            }
+        }
+
+        // Many labels of different lengths in one call against one label at a time
+        for (int h = 0; h < 2; h++) {
+            HmacHashType hash = h ? HMAC_SHA384 : HMAC_SHA256;
+            u8 pool[NUM_LABELS * 7], batch_okm[NUM_LABELS * LABEL_OKM_LEN], single_okm[LABEL_OKM_LEN];
+            const u8 *labels[NUM_LABELS];
+            size_t label_lens[NUM_LABELS];
+            for (size_t i = 0; i < sizeof(pool); i++) pool[i] = (u8)(i * 31 + 3);
+            for (int i = 0; i < NUM_LABELS; i++) {
+                labels[i] = pool + i;
+                label_lens[i] = (size_t)(i * 7);    // Up to 252 bytes: the longest ones leave the lanes
+            }
+
+            HkdfContext ctx;
+            bool ok = (hkdf_init_extract(&ctx, hash, pool, 16, pool + 16, 32) == CRYPTOMODULE_OK) &&
+                      (hkdf_expand_multi(&ctx, labels, label_lens, NUM_LABELS, batch_okm, LABEL_OKM_LEN) == CRYPTOMODULE_OK);
+            for (int i = 0; i < NUM_LABELS && ok; i++) {
+                ok = (hkdf_expand(&ctx, labels[i], label_lens[i], single_okm, LABEL_OKM_LEN) == CRYPTOMODULE_OK) &&
+                     (memcmp(single_okm, batch_okm + i * LABEL_OKM_LEN, LABEL_OKM_LEN) == 0);
+            }
+            hkdf_dispose(&ctx);
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s: batch of %d labels with HKDF-%s\n", backends[b].name, NUM_LABELS, h ? "SHA384" : "SHA256");
+            }
+        }
+        progress_bar((int)b + 1, (int)(sizeof(backends) / sizeof(backends[0])));
+        printf("\n");
+    }
+    SHA2_sha256_multi_set_backend(saved);
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/* Entropy source for the DRBG tests: returns consecutive bytes of a fixed buffer */
+typedef struct {
+    const u8 *data;
+    size_t pos;
+} drbg_test_source;
+
+static cryptomodule_status_t drbg_test_entropy(void *arg, u8 *out, size_t len) {
+    drbg_test_source *src = (drbg_test_source *)arg;
+    memcpy(out, src->data + src->pos, len);
+    src->pos += len;
+    return CRYPTOMODULE_OK;
+}
+
+/* Fill buf with start, start + 1, ... */
+static void drbg_test_pattern(u8 *buf, size_t len, u8 start) {
+    for (size_t i = 0; i < len; i++) buf[i] = (u8)(start + i);
+}
+
+/* Return true if many small reads from the per-thread instance are not repeated by one large read */
+static bool drbg_test_thread_reads(cryptomodule_status_t (*random_bytes)(u8 *, size_t)) {
+    u8 a[DRBG_THREAD_BUFFER_SIZE + 100], b[sizeof(a)];
+    bool ok = true;
+
+    for (size_t off = 0; off < sizeof(a) && ok; off += 12) {
+        size_t n = sizeof(a) - off < 12 ? sizeof(a) - off : 12;     // GCM IV-sized reads
+        ok = (random_bytes(a + off, n) == CRYPTOMODULE_OK);
+    }
+    return ok && (random_bytes(b, sizeof(b)) == CRYPTOMODULE_OK) && memcmp(a, b, sizeof(a)) != 0;
+}
+
+/* Return true if a child process gets different bytes than the parent after a fork */
+static bool drbg_test_fork(cryptomodule_status_t (*random_bytes)(u8 *, size_t)) {
+    u8 parent[32], child[32];
+    int fd[2];
+
+    // Leave output buffered in the parent's instance before forking
+    if (random_bytes(parent, 1) != CRYPTOMODULE_OK || pipe(fd) != 0) return false;
+    pid_t pid = fork();
+    if (pid < 0) return false;
+    if (pid == 0) {
+        close(fd[0]);
+        if (random_bytes(child, sizeof(child)) != CRYPTOMODULE_OK) memset(child, 0, sizeof(child));
+        ssize_t n = write(fd[1], child, sizeof(child));
+        _exit(n == (ssize_t)sizeof(child) ? 0 : 1);
+    }
+    close(fd[1]);
+    bool ok = (read(fd[0], child, sizeof(child)) == (ssize_t)sizeof(child));
+    close(fd[0]);
+    waitpid(pid, NULL, 0);
+    ok = ok && (random_bytes(parent, sizeof(parent)) == CRYPTOMODULE_OK);
+    return ok && memcmp(parent, child, sizeof(parent)) != 0;
+}
+
+void KAT_TEST_CTR_DRBG(void) {
+    /*
+     * Instantiate (entropy 00 01 .., nonce 20 21 .., personalization 40 41 ..), generate 64 bytes
+     * with additional input 60 61 .., reseed (entropy 80 81 .., additional input c0 c1 ..),
+     * generate 64 bytes with additional input a0 a1 .. and then 61 bytes without. Inputs are
+     * seed_len bytes without df; with df the personalization string is 37 bytes and each
+     * additional input 40 bytes. Outputs are from the OpenSSL 3.0 CTR-DRBG.
+     */
+    static const struct {
+        size_t key_len;
+        bool use_df;
+        const char *out2;
+        const char *out3;
+    } tv[] = {
+        { 16, true,
+          "c92323146f3ec37c067fa66de3606d0814e5b3f0d86e0c8438c81e89c331b80d3453f2c224124c2d546afd51a2c019a67f392ea594aeac8995ff80d2d2d683dd",
+          "2d4e96480c2aa71cf33cf9f8f919682a0d803736b57da6c748a0805b75210ae3ff748d3c0b2eb09c5153a6917f40a10f0e3bbc504e2dac920506b1780e" },
+        { 24, true,
+          "8928ed3584a399cb5daa289368d75c9c3bdc788841dcc8229ba17c2ad818301fb6e5ef6e2a9ea97c58271e1175478273aa3e4c335139a21b935be0302e1bb04e",
+          "a8532d659d399d19f95e4ff6f25387697ebb860703b1514687c780060d5d3873e1c04543e44f1f23e069c0eb9487a168c6b167c26b3081ceed98ed6771" },
+        { 32, true,
+          "1ca55f12759ed3e73582c93b2f4e8af4744a5c0f5b16314a804bd25e0a50d4da27a8bb58d01e646bc4bd91d803d0c9013c4cb36235406142e71b3ccdcfe0bf22",
+          "280e7c8d98f4870ef0ffe29f2635a0518f28d7fa8ae5e4d342788757d5c3a0fde881ce6037a41b6e5dc376a4908349fae070cf5d335c4c9d230a6bd7fd" },
+        { 16, false,
+          "562a5cc2ffb83827aa2079b1b315a1c932e1b2775d757f8b98b49b184abe4319e927ff0d1696790b175f634ee8eb3851d2a295145e83fcceaab109d88f877ee9",
+          "f04e6fcb3698f3488c3f0b329ede843e628f2eb2cc032d50ede2e1569145302328d278a5169237c3492f52e0c0792b844eee7399302e5262f63acf996f" },
+        { 24, false,
+          "86e5b7ece3f61d3faa01edd9346c6771ee9219c77574f01cfdcc236229571481d5943f646f66b1bc22959855b5ac9ee07227b7c9c25c75bd47621229e64f0cb5",
+          "495dac5849dcb0b1d3ba8994849981fc20d5e6fd1ba908060924b0cf71b3f2ef34a7b55ad42873dd579c390a752e63a8276b8f77957fd8f0d5beae02a8" },
+        { 32, false,
+          "8f9181ee2c0c2224b3c592eb1dedc9728019a37431f3d4e8b099e26dc8d1e12757b47f07a8df264e9904225c719abf29d7e50b6932a95d82ff85e2fdea63f4b7",
+          "6cef9283cef22b216b6e26a45e31d5bb1a1001757146c26b33cf76425764612069b9d754326b48fa8cdecb136e927283eb14132b87e011709a57ccb2ba" },
+    };
+
+    printf("%s%s-------------------------------- CTR_DRBG KAT TEST --------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const int num_tests = (int)(sizeof(tv) / sizeof(tv[0])) + 2;
+
+    for (size_t i = 0; i < sizeof(tv) / sizeof(tv[0]); i++) {
+        const size_t seed_len = tv[i].key_len + 16;
+        const size_t ent_len = tv[i].use_df ? tv[i].key_len : seed_len;
+        const size_t nonce_len = tv[i].use_df ? tv[i].key_len / 2 : 0;
+        const size_t pers_len = tv[i].use_df ? 37 : seed_len;
+        const size_t add_len = tv[i].use_df ? 40 : seed_len;
+
+        u8 entropy[3 * 48], pers[48], add1[48], add2[48], add_reseed[48];
+        u8 out[64], expected2[64], expected3[61];
+        drbg_test_pattern(entropy, ent_len, 0x00);
+        drbg_test_pattern(entropy + ent_len, nonce_len, 0x20);
+        drbg_test_pattern(entropy + ent_len + nonce_len, ent_len, 0x80);
+        drbg_test_pattern(pers, sizeof(pers), 0x40);
+        drbg_test_pattern(add1, sizeof(add1), 0x60);
+        drbg_test_pattern(add2, sizeof(add2), 0xa0);
+        drbg_test_pattern(add_reseed, sizeof(add_reseed), 0xc0);
+        stringToByteArray(tv[i].out2, expected2);
+        stringToByteArray(tv[i].out3, expected3);
+
+        drbg_test_source src = { entropy, 0 };
+        CtrDrbgContext ctx;
+        bool ok = (ctr_drbg_instantiate(&ctx, tv[i].key_len, tv[i].use_df, drbg_test_entropy, &src, pers, pers_len) == CRYPTOMODULE_OK) &&
+                  (ctr_drbg_generate(&ctx, out, 64, add1, add_len) == CRYPTOMODULE_OK) &&
+                  (ctr_drbg_reseed(&ctx, add_reseed, add_len) == CRYPTOMODULE_OK) &&
+                  (ctr_drbg_generate(&ctx, out, 64, add2, add_len) == CRYPTOMODULE_OK) &&
+                  (memcmp(out, expected2, 64) == 0) &&
+                  (ctr_drbg_generate(&ctx, out, 61, NULL, 0) == CRYPTOMODULE_OK) &&
+                  (memcmp(out, expected3, 61) == 0);
+        ctr_drbg_dispose(&ctx);
+
+        total_tests++;
+        if (ok) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] AES-%zu %s df\n", tv[i].key_len * 8, tv[i].use_df ? "with" : "without");
+        }
+        progress_bar(total_tests, num_tests);
+    }
+
+    // Per-thread instance: the output of many small reads is not repeated
+    total_tests++;
+    if (drbg_test_thread_reads(ctr_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Per-thread instance\n");
+    }
+    progress_bar(total_tests, num_tests);
+
+    // A forked child must not repeat the parent's output
+    total_tests++;
+    if (drbg_test_fork(ctr_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Parent and child output after fork\n");
+    }
+    progress_bar(total_tests, num_tests);
+    ctr_drbg_thread_cleanup();
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+/*
+ * Instantiate (entropy 00 01 .., nonce 20 21 .., personalization 40 41 .. of 37 bytes), generate
+ * 64 bytes with additional input 60 61 .., reseed (entropy 80 81 .., additional input c0 c1 ..),
+ * generate 64 bytes with additional input a0 a1 .. into out2 and then out3_len bytes without
+ * additional input into out3. Additional inputs are 40 bytes.
+ */
+static bool drbg_test_sha2_run(bool hmac, DrbgHashType hash, u8 *out2, u8 *out3, size_t out3_len) {
+    const size_t strength = drbg_hash_strength(hash);
+    u8 entropy[2 * 32 + 16], pers[37], add1[40], add2[40], add_reseed[40], first[64];
+    drbg_test_pattern(entropy, strength, 0x00);
+    drbg_test_pattern(entropy + strength, strength / 2, 0x20);
+    drbg_test_pattern(entropy + strength + strength / 2, strength, 0x80);
+    drbg_test_pattern(pers, sizeof(pers), 0x40);
+    drbg_test_pattern(add1, sizeof(add1), 0x60);
+    drbg_test_pattern(add2, sizeof(add2), 0xa0);
+    drbg_test_pattern(add_reseed, sizeof(add_reseed), 0xc0);
+
+    drbg_test_source src = { entropy, 0 };
+    bool ok;
+    if (hmac) {
+        HmacDrbgContext ctx;
+        ok = (hmac_drbg_instantiate(&ctx, hash, drbg_test_entropy, &src, pers, sizeof(pers)) == CRYPTOMODULE_OK) &&
+             (hmac_drbg_generate(&ctx, first, sizeof(first), add1, sizeof(add1)) == CRYPTOMODULE_OK) &&
+             (hmac_drbg_reseed(&ctx, add_reseed, sizeof(add_reseed)) == CRYPTOMODULE_OK) &&
+             (hmac_drbg_generate(&ctx, out2, 64, add2, sizeof(add2)) == CRYPTOMODULE_OK) &&
+             (hmac_drbg_generate(&ctx, out3, out3_len, NULL, 0) == CRYPTOMODULE_OK);
+        hmac_drbg_dispose(&ctx);
+    } else {
+        HashDrbgContext ctx;
+        ok = (hash_drbg_instantiate(&ctx, hash, drbg_test_entropy, &src, pers, sizeof(pers)) == CRYPTOMODULE_OK) &&
+             (hash_drbg_generate(&ctx, first, sizeof(first), add1, sizeof(add1)) == CRYPTOMODULE_OK) &&
+             (hash_drbg_reseed(&ctx, add_reseed, sizeof(add_reseed)) == CRYPTOMODULE_OK) &&
+             (hash_drbg_generate(&ctx, out2, 64, add2, sizeof(add2)) == CRYPTOMODULE_OK) &&
+             (hash_drbg_generate(&ctx, out3, out3_len, NULL, 0) == CRYPTOMODULE_OK);
+        hash_drbg_dispose(&ctx);
+    }
+    return ok;
+}
+
+/* Outputs of drbg_test_sha2_run with out3_len = 100, from the OpenSSL 3.0 HMAC-DRBG and HASH-DRBG */
+static const struct {
+    DrbgHashType hash;
+    const char *name;
+    const char *out2;
+    const char *out3;
+} drbg_test_hmac_tv[] = {
+    { DRBG_SHA224, "SHA-224",
+      "92caa03b4327ce161cef26d2b2a7995a24244f0f0d79fe2769ba46e224c96781ac88b8c610b14a8023bf20fcfd5193b87a9f74afe9cddd077d316400e0765714",
+      "9f7cad85d4f0e6fe818dcd561e07532ed2dd2f7ba052cf316c7921123a95fccf99c64ce58fd70bb27cfe9f2dde8fec659fd2e0d838ef421f01b4918a5051ff4c9df98f9e1f9aacd7fa2f14d6b9183ec8cc8fffa6804afc6e44fe4198e8ec3615c86a1a9b" },
+    { DRBG_SHA256, "SHA-256",
+      "52be8cdb1aecc492fa298e6680bcf90953502423a590093a9f55a72c5e7300d42cc73a6fd22dc6f9f12fc4a7e2936dc200f709470ffbebef2c68aabcb5ad4fab",
+      "2ae3f29670b09c898d84ef215578bb57c664a047fea2b89e0c792474bbde92aabb04b9ddfdd886c5fb4ecf00d250df8777933302bc6ddb3bede6345df1d624153168cc1b9944c529d1ccaeb111f174008a22bf6eceb46f0aa82fffb9a498decf4f164799" },
+    { DRBG_SHA384, "SHA-384",
+      "5797e297cd5c860982f512f379fa094b7b1eb6d1c2eacd195b3db31295c6107aac7d0c7fbb0056829ace1f3481b0ad91c0d4a0450c4e0abde0bc41df012500d3",
+      "a33ca344768d7b63f1d246f06108282a2f5d6ddcf6c72399b0fb1e9f898dc16097ed5755f7761e71c67b79c1f1a732fdb5802443ff241ee9305bc326af214c4c8c9bc6706a52c473d30c940954e53c5121bf8dc102fa0bb61a90bc755a11577b1566f123" },
+    { DRBG_SHA512, "SHA-512",
+      "0a6cdcd2c1b55a74ab8bf69ff3ecc16f7099bbe0d51a3af8d8100dc3705333c3e960940a3b589a6ebb9bdd67600dea61b668493d12de6a29ef0365b07c631a3b",
+      "1067de660cfcc09616e4184d7c6f04bc7f2aea715a9548864cb53cbafee21529b30a26dd5049f73014913f7275b5e7b4d0f004f35cbfad80e3c35148167a7e4fc912df37c1b61bde775fbdda686865bf652a564260021b305c60bd72d124c2e89bb1c158" },
+}, drbg_test_hash_tv[] = {
+    { DRBG_SHA224, "SHA-224",
+      "ae52d7064f863eba6c71820d91f1cd34c4d854820217e6e77261d0b93c4be3d1a3ab143f16d1334b858a61a8cba1b75ed3ed24b0659f6f8b9e7a8b4a1a6a682a",
+      "8081f53e5c47585039215bf819c44072ae4c7736c7bfc109e0a2e2e06d1266d12b12c8b822850707193082e618d35b6b5eaf91c1f124c6edc20a138571ef52545e53526b3e819784287b14df5580999f7ae57f390bd3a5175a93236e55942c1915d867dc" },
+    { DRBG_SHA256, "SHA-256",
+      "11a8eed0a66863cea83837e1e521b89d310c49f00980fcabc3e50529645d8d8717ac7a7072c7bec3686c62a816a8a89730e293599d8568c1074887ce246b00dd",
+      "7cc7faa959659c5ad614c0016b258c3ab2e0f5090945588931477e799bff953b01d515c36a1f81029c12fc8b89b161d015c976d38e10564f3bce154bd56494706502758ef032a58893707851048bc523aff0294c1d2ec01e9e8864b1eb762a07e9a1d776" },
+    { DRBG_SHA384, "SHA-384",
+      "29d6198b33d7484a93273b82983fa327a652f899fd995c62a325c72e0229e6e647989803961ee670d71ae2ff90a4c7297b3b86c8826e84ae34fd2cc5b21614ac",
+      "5e7dc6daa76e40efc63bfff7d62d21bfb4b49a7aa40c7eae23c452cb4106da1a71e23c5cfe1150ffc01facf8d2b64a080cb7105b9b2fb74b9b4d9dc734b869688aa4ec65d577ad1e91093ea69d3c16751f7b266b6ad037c6af376753eb54eb432b7aa575" },
+    { DRBG_SHA512, "SHA-512",
+      "60219bcf9eef9f3d23fe988350f0f4b12167d618efc9f82cea6a6ff21741b7b4235e8fa3df261c27dbb2f6fb4eb439612ffec3134b112b171a8e38c4d3ed5edd",
+      "ea87bfc7b8536730b6264548c8c470cfd7ea9dea2fe9c6e231fa55f2e367809904e0d384c3cb045e97739323229ba0b262e3d977246843f8cd44a1bd813c486efc2c447e3b03b06aee1183e151ef153be13fd2dc86162384349cc35fa204ce4326b63256" },
+};
+
+void KAT_TEST_HMAC_DRBG(void) {
+    printf("%s%s-------------------------------- HMAC_DRBG KAT TEST -------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const size_t num_tv = sizeof(drbg_test_hmac_tv) / sizeof(drbg_test_hmac_tv[0]);
+    const int num_tests = (int)num_tv + 2;
+
+    for (size_t i = 0; i < num_tv; i++) {
+        u8 out2[64], out3[100], expected2[64], expected3[100];
+        stringToByteArray(drbg_test_hmac_tv[i].out2, expected2);
+        stringToByteArray(drbg_test_hmac_tv[i].out3, expected3);
+
+        bool ok = drbg_test_sha2_run(true, drbg_test_hmac_tv[i].hash, out2, out3, sizeof(out3)) &&
+                  memcmp(out2, expected2, sizeof(out2)) == 0 &&
+                  memcmp(out3, expected3, sizeof(out3)) == 0;
+
+        total_tests++;
+        if (ok) {
+            passed_tests++;
+        } else {
+            result = false;
+            printf("[FAIL] %s\n", drbg_test_hmac_tv[i].name);
+        }
+        progress_bar(total_tests, num_tests);
+    }
+
+    // Per-thread instance: the output of many small reads is not repeated
+    total_tests++;
+    if (drbg_test_thread_reads(hmac_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Per-thread instance\n");
+    }
+    progress_bar(total_tests, num_tests);
+
+    // A forked child must not repeat the parent's output
+    total_tests++;
+    if (drbg_test_fork(hmac_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Parent and child output after fork\n");
+    }
+    progress_bar(total_tests, num_tests);
+    hmac_drbg_thread_cleanup();
+    printf("\n");
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
+
+void KAT_TEST_HASH_DRBG(void) {
+    static const struct { SHA2_backend_t backend; const char *name; } backends[] = {
+        { SHA2_BACKEND_C,      "serial" },
+        { SHA2_BACKEND_AVX2,   "AVX2 x8" },
+        { SHA2_BACKEND_AVX512, "AVX-512 x16" },
+    };
+    enum { LONG_REQUEST = 1000 };
+
+    printf("%s%s-------------------------------- HASH_DRBG KAT TEST -------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+
+    SHA2_backend_t saved = SHA2_sha256_multi_get_backend();
+    bool result = true;
+    int total_tests = 0, passed_tests = 0;
+    const size_t num_tv = sizeof(drbg_test_hash_tv) / sizeof(drbg_test_hash_tv[0]);
+
+    // Long SHA-224/256 requests run groups of lanes; they must match the serial backend
+    u8 reference[2][LONG_REQUEST];
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+        if (!SHA2_sha256_multi_set_backend(backends[b].backend)) {
+            printf("[SKIP] %s is not supported on this CPU\n", backends[b].name);
+            continue;
+        }
+
+        for (size_t i = 0; i < num_tv; i++) {
+            u8 out2[64], out3[100], expected2[64], expected3[100];
+            stringToByteArray(drbg_test_hash_tv[i].out2, expected2);
+            stringToByteArray(drbg_test_hash_tv[i].out3, expected3);
+
+            bool ok = drbg_test_sha2_run(false, drbg_test_hash_tv[i].hash, out2, out3, sizeof(out3)) &&
+                      memcmp(out2, expected2, sizeof(out2)) == 0 &&
+                      memcmp(out3, expected3, sizeof(out3)) == 0;
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s: %s\n", backends[b].name, drbg_test_hash_tv[i].name);
+            }
+        }
+
+        for (int h = 0; h < 2; h++) {
+            u8 out2[64], out3[LONG_REQUEST];
+            bool ok = drbg_test_sha2_run(false, h ? DRBG_SHA256 : DRBG_SHA224, out2, out3, sizeof(out3));
+            if (b == 0) {
+                memcpy(reference[h], out3, sizeof(out3));
+            } else {
+                ok = ok && memcmp(out3, reference[h], sizeof(out3)) == 0;
+            }
+
+            total_tests++;
+            if (ok) {
+                passed_tests++;
+            } else {
+                result = false;
+                printf("[FAIL] %s: %s, %d-byte request\n", backends[b].name, h ? "SHA-256" : "SHA-224", LONG_REQUEST);
+            }
+        }
+        progress_bar((int)b + 1, (int)(sizeof(backends) / sizeof(backends[0])));
+        printf("\n");
+    }
+    SHA2_sha256_multi_set_backend(saved);
+
+    // Per-thread instance: the output of many small reads is not repeated
+    total_tests++;
+    if (drbg_test_thread_reads(hash_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Per-thread instance\n");
+    }
+
+    // A forked child must not repeat the parent's output
+    total_tests++;
+    if (drbg_test_fork(hash_drbg_random_bytes)) {
+        passed_tests++;
+    } else {
+        result = false;
+        printf("[FAIL] Parent and child output after fork\n");
+    }
+    hash_drbg_thread_cleanup();
+
+    printf("\n%s[*] Test Results:\n", ANSI_FG_YELLOW);
+    printf("- Total vectors : %3d\n", total_tests);
+    printf("- Passed vectors: %3d%s\n", passed_tests, ANSI_RESET);
+    printf("%s\n\n", result ? "\x1b[36m[O] Result: PASSED" : "\x1b[31m[X] Result: FAILED");
+    printf("%s", ANSI_RESET);
+    printf("%s%s----------------------------------------- END ------------------------------------------%s%s\n",
+        ANSI_BG_MAGENTA, ANSI_BOLD,
+        ANSI_BG_DEFAULT, ANSI_RESET);
+    printf("\n\n");
+}
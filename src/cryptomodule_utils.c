@@ -3,7 +3,7 @@
 #include "../include/cryptomodule_utils.h"
 
 void stringToByteArray(const char* str, u8* byteArray) {
-    size_t length = strlen(str);
+    size_t length = strlen(str) / 2;
     for (size_t i = 0; i< length; i++) {
         sscanf(str + i * 2, "%2hhx", &byteArray[i]);
     }
@@ -0,0 +1,306 @@
+/* File: src/kdf/hkdf.c */
+
+/**
+ * @file hkdf.c
+ * @brief This file implements HKDF (RFC 5869) with HMAC-SHA-256 and HMAC-SHA-384.
+ * @details T(0) = empty, T(i) = HMAC(PRK, T(i-1) || info || i) and OKM is the first L bytes of
+ *          T(1) || T(2) || .... The PRK is loaded into an HMAC context once; every T(i) then
+ *          starts from the stored ipad/opad midstates. The multi-label path builds the padded inner
+ *          message of each label (the ipad block is already in the midstate, so the length field
+ *          counts one extra block) and runs the labels through SHA2_sha256_multi_compress, word k
+ *          of lane l at w[k * lanes + l], followed by one outer compression for all of them.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/kdf/hkdf.h"
+
+#define HKDF_MAX_BLOCKS             255
+#define HKDF_MULTI_MAX_INNER_BLOCKS 4       /* Longest inner message of a label in the lanes */
+#define HKDF_MULTI_INNER_BYTES      (HKDF_MULTI_MAX_INNER_BLOCKS * SHA2_SHA256_BLOCK_SIZE)
+
+static u32 load_be32(const u8 *x) {
+    return ((u32)x[0] << 24) | ((u32)x[1] << 16) | ((u32)x[2] << 8) | (u32)x[3];
+}
+
+static void store_be32(u8 *x, u32 v) {
+    x[0] = (u8)(v >> 24);
+    x[1] = (u8)(v >> 16);
+    x[2] = (u8)(v >> 8);
+    x[3] = (u8)v;
+}
+
+static bool hkdf_hash_supported(HmacHashType hash) {
+    return hash == HMAC_SHA256 || hash == HMAC_SHA384;
+}
+
+cryptomodule_status_t hkdf_extract(
+    HmacHashType hash,
+    const u8 *salt, size_t salt_len,
+    const u8 *ikm, size_t ikm_len,
+    u8 *prk) {
+
+    if (!hkdf_hash_supported(hash) || !prk) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    // An absent salt is HashLen zeros, which HMAC pads to the same K0 as an empty key
+    return hmac(hash, salt, salt_len, ikm, ikm_len, prk, hmac_mac_size(hash));
+}
+
+cryptomodule_status_t hkdf_init(HkdfContext *ctx, HmacHashType hash, const u8 *prk, size_t prk_len) {
+    if (!ctx || !hkdf_hash_supported(hash) || !prk || prk_len < hmac_mac_size(hash)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    return hmac_init(&ctx->prk, hash, prk, prk_len);
+}
+
+cryptomodule_status_t hkdf_init_extract(
+    HkdfContext *ctx, HmacHashType hash,
+    const u8 *salt, size_t salt_len,
+    const u8 *ikm, size_t ikm_len) {
+
+    if (!ctx) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    u8 prk[HKDF_MAX_PRK_SIZE];
+    cryptomodule_status_t status = hkdf_extract(hash, salt, salt_len, ikm, ikm_len, prk);
+    if (status == CRYPTOMODULE_OK) {
+        status = hkdf_init(ctx, hash, prk, hmac_mac_size(hash));
+    }
+    cryptomodule_wipe(prk, sizeof(prk));
+    return status;
+}
+
+cryptomodule_status_t hkdf_expand_stream_init(HkdfExpandStream *stream, const HkdfContext *ctx,
+                                              const u8 *info, size_t info_len) {
+    if (!stream || !ctx || (info_len && !info)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(stream, 0, sizeof(*stream));
+    cryptomodule_status_t status = hmac_ctx_clone(&stream->mac, &ctx->prk);
+    if (status != CRYPTOMODULE_OK) {
+        return status;
+    }
+    stream->info = info;
+    stream->info_len = info_len;
+    stream->t_pos = stream->mac.mac_size;  // No block yet
+    stream->counter = 0;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hkdf_expand_read(HkdfExpandStream *stream, u8 *out, size_t len) {
+    if (!stream || !stream->mac.keyed || (len && !out)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    const size_t hash_len = stream->mac.mac_size;
+    size_t available = (size_t)(HKDF_MAX_BLOCKS - stream->counter) * hash_len + (hash_len - stream->t_pos);
+    if (len > available) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+    while (len && status == CRYPTOMODULE_OK) {
+        if (stream->t_pos == hash_len) {
+            // T(i) = HMAC(PRK, T(i-1) || info || i); the context is back at the ipad midstate
+            u8 counter = (u8)(stream->counter + 1);
+            if (stream->counter) status = hmac_update(&stream->mac, stream->t, hash_len);
+            if (status == CRYPTOMODULE_OK) status = hmac_update(&stream->mac, stream->info, stream->info_len);
+            if (status == CRYPTOMODULE_OK) status = hmac_update(&stream->mac, &counter, 1);
+            if (status == CRYPTOMODULE_OK) status = hmac_final(&stream->mac, stream->t, hash_len);
+            stream->counter++;
+            stream->t_pos = 0;
+            continue;
+        }
+
+        size_t n = hash_len - stream->t_pos;
+        if (n > len) n = len;
+        memcpy(out, stream->t + stream->t_pos, n);
+        stream->t_pos += n;
+        out += n;
+        len -= n;
+    }
+    return status;
+}
+
+void hkdf_expand_stream_dispose(HkdfExpandStream *stream) {
+    if (stream) {
+        cryptomodule_wipe(stream, sizeof(*stream));
+    }
+}
+
+cryptomodule_status_t hkdf_expand(const HkdfContext *ctx, const u8 *info, size_t info_len, u8 *okm, size_t okm_len) {
+    if (!ctx || !okm || okm_len == 0) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    HkdfExpandStream stream;
+    cryptomodule_status_t status = hkdf_expand_stream_init(&stream, ctx, info, info_len);
+    if (status == CRYPTOMODULE_OK) {
+        status = hkdf_expand_read(&stream, okm, okm_len);
+    }
+    hkdf_expand_stream_dispose(&stream);
+    return status;
+}
+
+/**
+ * @brief Number of inner blocks (after the ipad block) of T(i) for a label: T(i-1), info, the counter
+ *        byte, 0x80 and the 8-byte length.
+ */
+static size_t hkdf_inner_blocks(size_t info_len, bool has_prev) {
+    size_t msg_len = (has_prev ? SHA2_SHA256_DIGEST_SIZE : 0) + info_len + 1;
+    return (msg_len + 1 + 8 + SHA2_SHA256_BLOCK_SIZE - 1) / SHA2_SHA256_BLOCK_SIZE;
+}
+
+/**
+ * @brief n <= lanes labels side by side; idle lanes repeat label 0 and are discarded. Each inner
+ *        message fits in HKDF_MULTI_MAX_INNER_BLOCKS blocks.
+ */
+static void hkdf_expand_lanes(const HkdfContext *ctx,
+                              const u8 *const *infos, const size_t *info_lens, size_t n, size_t lanes,
+                              u8 *const *okms, size_t okm_len) {
+    u32 ist[8], ost[8];                                 // PRK midstates, shared by all lanes
+    u32 st[8 * SHA2_SHA256_MB_MAX_LANES], inner[8 * SHA2_SHA256_MB_MAX_LANES];
+    u32 w[16 * SHA2_SHA256_MB_MAX_LANES];
+    u8 msg[SHA2_SHA256_MB_MAX_LANES][HKDF_MULTI_INNER_BYTES];
+    u8 t[SHA2_SHA256_MB_MAX_LANES][SHA2_SHA256_DIGEST_SIZE];
+    size_t nblocks[SHA2_SHA256_MB_MAX_LANES];
+
+    for (int k = 0; k < 8; k++) {
+        ist[k] = load_be32(ctx->prk.inner_key.sha256.ctx + 4 * k);
+        ost[k] = load_be32(ctx->prk.outer_key.sha256.ctx + 4 * k);
+    }
+
+    const size_t blocks = (okm_len + SHA2_SHA256_DIGEST_SIZE - 1) / SHA2_SHA256_DIGEST_SIZE;
+    for (size_t i = 1; i <= blocks; i++) {
+        // Padded inner message T(i-1) || info || i of every lane
+        size_t max_blocks = 0;
+        for (size_t l = 0; l < lanes; l++) {
+            size_t src = l < n ? l : 0;
+            size_t len = 0;
+            if (i > 1) {
+                memcpy(msg[l], t[src], SHA2_SHA256_DIGEST_SIZE);
+                len = SHA2_SHA256_DIGEST_SIZE;
+            }
+            if (info_lens[src]) memcpy(msg[l] + len, infos[src], info_lens[src]);
+            len += info_lens[src];
+            msg[l][len++] = (u8)i;
+
+            nblocks[l] = hkdf_inner_blocks(info_lens[src], i > 1);
+            size_t padded = nblocks[l] * SHA2_SHA256_BLOCK_SIZE;
+            u64 bits = (u64)(SHA2_SHA256_BLOCK_SIZE + len) * 8;
+            memset(msg[l] + len, 0, padded - len);
+            msg[l][len] = 0x80;
+            store_be32(msg[l] + padded - 8, (u32)(bits >> 32));
+            store_be32(msg[l] + padded - 4, (u32)bits);
+            if (nblocks[l] > max_blocks) max_blocks = nblocks[l];
+        }
+
+        for (int k = 0; k < 8; k++) {
+            for (size_t l = 0; l < lanes; l++) st[k * lanes + l] = ist[k];
+        }
+        for (size_t b = 0; b < max_blocks; b++) {
+            // Lanes with fewer blocks compress stale words; their digest was saved already
+            for (int k = 0; k < 16; k++) {
+                for (size_t l = 0; l < lanes; l++) {
+                    size_t bl = b < nblocks[l] ? b : nblocks[l] - 1;
+                    w[k * lanes + l] = load_be32(msg[l] + bl * SHA2_SHA256_BLOCK_SIZE + 4 * k);
+                }
+            }
+            SHA2_sha256_multi_compress(st, w, lanes);
+            for (size_t l = 0; l < lanes; l++) {
+                if (nblocks[l] == b + 1) {
+                    for (int k = 0; k < 8; k++) inner[k * lanes + l] = st[k * lanes + l];
+                }
+            }
+        }
+
+        // Outer block: inner digest, 0x80, zeros and the length of one block plus a digest
+        memcpy(w, inner, 8 * lanes * sizeof(u32));
+        memset(w + 8 * lanes, 0, 8 * lanes * sizeof(u32));
+        for (size_t l = 0; l < lanes; l++) {
+            w[8 * lanes + l] = 0x80000000;
+            w[15 * lanes + l] = (SHA2_SHA256_BLOCK_SIZE + SHA2_SHA256_DIGEST_SIZE) * 8;
+        }
+        for (int k = 0; k < 8; k++) {
+            for (size_t l = 0; l < lanes; l++) st[k * lanes + l] = ost[k];
+        }
+        SHA2_sha256_multi_compress(st, w, lanes);
+
+        size_t off = (i - 1) * SHA2_SHA256_DIGEST_SIZE;
+        size_t take = okm_len - off < SHA2_SHA256_DIGEST_SIZE ? okm_len - off : SHA2_SHA256_DIGEST_SIZE;
+        for (size_t l = 0; l < n; l++) {
+            for (int k = 0; k < 8; k++) store_be32(t[l] + 4 * k, st[k * lanes + l]);
+            memcpy(okms[l] + off, t[l], take);
+        }
+    }
+
+    cryptomodule_wipe(st, sizeof(st));
+    cryptomodule_wipe(inner, sizeof(inner));
+    cryptomodule_wipe(w, sizeof(w));
+    cryptomodule_wipe(msg, sizeof(msg));
+    cryptomodule_wipe(t, sizeof(t));
+}
+
+cryptomodule_status_t hkdf_expand_multi(
+    const HkdfContext *ctx,
+    const u8 *const *infos, const size_t *info_lens, size_t num,
+    u8 *okm, size_t okm_len) {
+
+    if (!ctx || !ctx->prk.keyed || !infos || !info_lens || (num && !okm) || okm_len == 0 ||
+        okm_len > HKDF_MAX_BLOCKS * ctx->prk.mac_size) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    for (size_t i = 0; i < num; i++) {
+        if (info_lens[i] && !infos[i]) {
+            return CRYPTOMODULE_ERR_INVALID_INPUT;
+        }
+    }
+
+    /*
+     * Labels whose inner message fits the lane buffers are grouped; with SHA-NI only full groups
+     * use the lanes (as in PBKDF2), otherwise any group of two or more does.
+     */
+    const size_t lanes = (ctx->prk.hash == HMAC_SHA256) ? SHA2_sha256_multi_lanes() : 1;
+    const size_t min_group = sha2_cpu_has_sha_ni() ? lanes : 2;
+
+    const u8 *group_infos[SHA2_SHA256_MB_MAX_LANES];
+    size_t group_lens[SHA2_SHA256_MB_MAX_LANES];
+    u8 *group_out[SHA2_SHA256_MB_MAX_LANES];
+    size_t n = 0;
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+
+    for (size_t i = 0; i < num && status == CRYPTOMODULE_OK; i++) {
+        u8 *out = okm + i * okm_len;
+        if (lanes == 1 || hkdf_inner_blocks(info_lens[i], true) > HKDF_MULTI_MAX_INNER_BLOCKS) {
+            status = hkdf_expand(ctx, infos[i], info_lens[i], out, okm_len);
+        } else {
+            group_infos[n] = infos[i];
+            group_lens[n] = info_lens[i];
+            group_out[n] = out;
+            n++;
+        }
+
+        bool last = (i + 1 == num);
+        if (n == 0 || (n < lanes && !last)) continue;
+
+        if (n >= min_group) {
+            hkdf_expand_lanes(ctx, group_infos, group_lens, n, lanes, group_out, okm_len);
+        } else {
+            for (size_t k = 0; k < n && status == CRYPTOMODULE_OK; k++) {
+                status = hkdf_expand(ctx, group_infos[k], group_lens[k], group_out[k], okm_len);
+            }
+        }
+        n = 0;
+    }
+    return status;
+}
+
+void hkdf_dispose(HkdfContext *ctx) {
+    if (ctx) {
+        hmac_dispose(&ctx->prk);
+    }
+}
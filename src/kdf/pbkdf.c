@@ -0,0 +1,212 @@
+/* File: src/kdf/pbkdf.c */
+
+/**
+ * @file pbkdf.c
+ * @brief This file implements PBKDF2-HMAC-SHA256 (SP 800-132) on the SHA-2 block functions.
+ * @details U_1 = HMAC(P, S || INT(i)) goes through the HMAC API, which also yields the ipad/opad
+ *          midstates of P. After that, U_j = H(opad-state, H(ipad-state, U_{j-1})), and both
+ *          blocks have a fixed layout: the previous 32-byte digest, 0x80, zeros and the bit length
+ *          of one block plus a digest (768). The padding is written once and only the digest part
+ *          of each block changes. Independent chains ("jobs": one output block of one derivation)
+ *          run either one at a time through crypto_hashblocks_sha256 (SHA-NI or C) or in groups
+ *          of SHA2_sha256_multi_lanes() through SHA2_sha256_multi_compress, with the words of the
+ *          chaining values and messages kept transposed between iterations.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/kdf/pbkdf.h"
+
+#define PBKDF2_DIGEST_SIZE  SHA2_SHA256_DIGEST_SIZE
+#define PBKDF2_INNER_BITS   ((SHA2_SHA256_BLOCK_SIZE + SHA2_SHA256_DIGEST_SIZE) * 8)   /* ipad block + digest */
+
+typedef struct {
+    const u8 *password;
+    size_t password_len;
+    const u8 *salt;
+    size_t salt_len;
+    u8 *out;                // Output bytes of this block
+    size_t out_len;         // 1..32
+    u32 block;              // Block number i (from 1)
+} pbkdf2_job;
+
+static u32 load_be32(const u8 *x) {
+    return ((u32)x[0] << 24) | ((u32)x[1] << 16) | ((u32)x[2] << 8) | (u32)x[3];
+}
+
+static void store_be32(u8 *x, u32 v) {
+    x[0] = (u8)(v >> 24);
+    x[1] = (u8)(v >> 16);
+    x[2] = (u8)(v >> 8);
+    x[3] = (u8)v;
+}
+
+/**
+ * @brief Key the HMAC context with the job's password and compute U_1 = HMAC(P, S || INT(i)).
+ */
+static cryptomodule_status_t pbkdf2_first(const pbkdf2_job *job, HmacContext *key, u8 *u1) {
+    u8 counter[4];
+    cryptomodule_status_t status;
+
+    store_be32(counter, job->block);
+    status = hmac_init(key, HMAC_SHA256, job->password, job->password_len);
+    if (status == CRYPTOMODULE_OK) status = hmac_update(key, job->salt, job->salt_len);
+    if (status == CRYPTOMODULE_OK) status = hmac_update(key, counter, sizeof(counter));
+    if (status == CRYPTOMODULE_OK) status = hmac_final(key, u1, PBKDF2_DIGEST_SIZE);
+    return status;
+}
+
+/**
+ * @brief One chain, one compression at a time. The two blocks double as chaining values: the
+ *        inner hash is computed in place in the first 32 bytes of the outer block and vice versa.
+ */
+static cryptomodule_status_t pbkdf2_job_serial(const pbkdf2_job *job, u32 iterations) {
+    HmacContext key;
+    u8 inner[SHA2_SHA256_BLOCK_SIZE] = { 0x00, }, outer[SHA2_SHA256_BLOCK_SIZE] = { 0x00, };
+    u8 t[PBKDF2_DIGEST_SIZE];
+
+    cryptomodule_status_t status = pbkdf2_first(job, &key, inner);
+    if (status != CRYPTOMODULE_OK) {
+        hmac_dispose(&key);
+        return status;
+    }
+    memcpy(t, inner, PBKDF2_DIGEST_SIZE);
+
+    inner[PBKDF2_DIGEST_SIZE] = 0x80;
+    store_be32(inner + SHA2_SHA256_BLOCK_SIZE - 4, PBKDF2_INNER_BITS);
+    memcpy(outer + PBKDF2_DIGEST_SIZE, inner + PBKDF2_DIGEST_SIZE, SHA2_SHA256_BLOCK_SIZE - PBKDF2_DIGEST_SIZE);
+
+    for (u32 j = 1; j < iterations; j++) {
+        memcpy(outer, key.inner_key.sha256.ctx, PBKDF2_DIGEST_SIZE);
+        crypto_hashblocks_sha256(outer, inner, SHA2_SHA256_BLOCK_SIZE);
+        memcpy(inner, key.outer_key.sha256.ctx, PBKDF2_DIGEST_SIZE);
+        crypto_hashblocks_sha256(inner, outer, SHA2_SHA256_BLOCK_SIZE);
+        for (int k = 0; k < PBKDF2_DIGEST_SIZE; k++) t[k] ^= inner[k];
+    }
+    memcpy(job->out, t, job->out_len);
+
+    hmac_dispose(&key);
+    cryptomodule_wipe(inner, sizeof(inner));
+    cryptomodule_wipe(outer, sizeof(outer));
+    cryptomodule_wipe(t, sizeof(t));
+    return CRYPTOMODULE_OK;
+}
+
+/**
+ * @brief n <= lanes chains side by side; idle lanes repeat job 0 and are discarded.
+ */
+static cryptomodule_status_t pbkdf2_jobs_lanes(const pbkdf2_job *jobs, size_t n, size_t lanes, u32 iterations) {
+    u32 ist[8 * SHA2_SHA256_MB_MAX_LANES], ost[8 * SHA2_SHA256_MB_MAX_LANES];    // ipad / opad midstates
+    u32 st[8 * SHA2_SHA256_MB_MAX_LANES], t[8 * SHA2_SHA256_MB_MAX_LANES];
+    u32 w[16 * SHA2_SHA256_MB_MAX_LANES] = { 0x00, };   // Word k of lane l at w[k * lanes + l]
+    u8 u1[PBKDF2_DIGEST_SIZE];
+    HmacContext key;
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+
+    for (size_t l = 0; l < lanes && status == CRYPTOMODULE_OK; l++) {
+        status = pbkdf2_first(&jobs[l < n ? l : 0], &key, u1);
+        for (int k = 0; k < 8; k++) {
+            ist[k * lanes + l] = load_be32(key.inner_key.sha256.ctx + 4 * k);
+            ost[k * lanes + l] = load_be32(key.outer_key.sha256.ctx + 4 * k);
+            t[k * lanes + l] = w[k * lanes + l] = load_be32(u1 + 4 * k);
+        }
+        w[8 * lanes + l] = 0x80000000;
+        w[15 * lanes + l] = PBKDF2_INNER_BITS;
+    }
+    hmac_dispose(&key);
+    cryptomodule_wipe(u1, sizeof(u1));
+
+    if (status == CRYPTOMODULE_OK) {
+        const size_t digest_words = 8 * lanes;
+        for (u32 j = 1; j < iterations; j++) {
+            memcpy(st, ist, digest_words * sizeof(u32));
+            SHA2_sha256_multi_compress(st, w, lanes);
+            memcpy(w, st, digest_words * sizeof(u32));
+            memcpy(st, ost, digest_words * sizeof(u32));
+            SHA2_sha256_multi_compress(st, w, lanes);
+            memcpy(w, st, digest_words * sizeof(u32));
+            for (size_t k = 0; k < digest_words; k++) t[k] ^= st[k];
+        }
+
+        for (size_t l = 0; l < n; l++) {
+            u8 block[PBKDF2_DIGEST_SIZE];
+            for (int k = 0; k < 8; k++) store_be32(block + 4 * k, t[k * lanes + l]);
+            memcpy(jobs[l].out, block, jobs[l].out_len);
+            cryptomodule_wipe(block, sizeof(block));
+        }
+    }
+
+    cryptomodule_wipe(ist, sizeof(ist));
+    cryptomodule_wipe(ost, sizeof(ost));
+    cryptomodule_wipe(st, sizeof(st));
+    cryptomodule_wipe(t, sizeof(t));
+    cryptomodule_wipe(w, sizeof(w));
+    return status;
+}
+
+cryptomodule_status_t pbkdf2_hmac_sha256_multi(
+    const u8 *const *passwords, const size_t *password_lens,
+    const u8 *const *salts, const size_t *salt_lens,
+    u32 iterations,
+    u8 *out, size_t out_len, size_t num) {
+
+    if (!passwords || !password_lens || !salts || !salt_lens || (num && !out) ||
+        iterations == 0 || out_len == 0) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    const size_t blocks = (out_len + PBKDF2_DIGEST_SIZE - 1) / PBKDF2_DIGEST_SIZE;
+    if (blocks > 0xFFFFFFFFu) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    for (size_t i = 0; i < num; i++) {
+        if ((password_lens[i] && !passwords[i]) || (salt_lens[i] && !salts[i])) {
+            return CRYPTOMODULE_ERR_INVALID_INPUT;
+        }
+    }
+
+    /*
+     * With SHA-NI a single chain is fast enough that idle lanes do not pay off, so only full
+     * groups use the lanes; otherwise any group of two or more does.
+     */
+    const size_t lanes = SHA2_sha256_multi_lanes();
+    const size_t min_group = sha2_cpu_has_sha_ni() ? lanes : 2;
+
+    pbkdf2_job group[SHA2_SHA256_MB_MAX_LANES];
+    size_t n = 0;
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+
+    for (size_t i = 0; i < num && status == CRYPTOMODULE_OK; i++) {
+        for (size_t b = 0; b < blocks && status == CRYPTOMODULE_OK; b++) {
+            pbkdf2_job *job = &group[n++];
+            job->password = passwords[i];
+            job->password_len = password_lens[i];
+            job->salt = salts[i];
+            job->salt_len = salt_lens[i];
+            job->out = out + i * out_len + b * PBKDF2_DIGEST_SIZE;
+            job->out_len = (b + 1 < blocks) ? PBKDF2_DIGEST_SIZE : out_len - b * PBKDF2_DIGEST_SIZE;
+            job->block = (u32)(b + 1);
+
+            bool last = (i + 1 == num) && (b + 1 == blocks);
+            if (n < lanes && !last) continue;
+
+            if (lanes > 1 && n >= min_group) {
+                status = pbkdf2_jobs_lanes(group, n, lanes, iterations);
+            } else {
+                for (size_t k = 0; k < n && status == CRYPTOMODULE_OK; k++) {
+                    status = pbkdf2_job_serial(&group[k], iterations);
+                }
+            }
+            n = 0;
+        }
+    }
+    return status;
+}
+
+cryptomodule_status_t pbkdf2_hmac_sha256(
+    const u8 *password, size_t password_len,
+    const u8 *salt, size_t salt_len,
+    u32 iterations,
+    u8 *out, size_t out_len) {
+
+    return pbkdf2_hmac_sha256_multi(&password, &password_len, &salt, &salt_len, iterations, out, out_len, 1);
+}
@@ -0,0 +1,260 @@
+/* File: src/lsh/lsh.c */
+
+/**
+ * @file lsh.c
+ * @brief LSH-256-n / LSH-512-n hashing on top of the compression functions in lsh_core.c.
+ * @details The message is padded with a single 1 bit and zeros to a whole block, with no length
+ *          field, so a message that ends on a block boundary gets a block of padding of its own
+ *          and a completed block can be compressed at once: the context never holds a whole block,
+ *          and whole blocks of the input are compressed in place. The digest is the left half of the final chaining value
+ *          XOR its right half, little-endian and truncated to n bits.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/lsh/lsh.h"
+
+/* IV of LSH-256-224 and LSH-256-256 */
+static const u32 lsh256_224_iv[16] = {
+    0x068608d3, 0x62d8f7a7, 0xd76652ab, 0x4c600a43, 0xbdc40aa8, 0x1eca0b68, 0xda1a89be, 0x3147d354,
+    0x707eb4f9, 0xf65b3862, 0x6b0b2abe, 0x56b8ec0a, 0xcf237286, 0xee0d1727, 0x33636595, 0x8bb8d05f,
+};
+
+static const u32 lsh256_256_iv[16] = {
+    0x46a10f1f, 0xfddce486, 0xb41443a8, 0x198e6b9d, 0x3304388d, 0xb0f5a3c7, 0xb36061c4, 0x7adbd553,
+    0x105d5378, 0x2f74de54, 0x5c2f2d95, 0xf2553fbe, 0x8051357a, 0x138668c8, 0x47aa4484, 0xe01afb41,
+};
+
+/* IV of LSH-512-224, LSH-512-256, LSH-512-384 and LSH-512-512 */
+static const u64 lsh512_224_iv[16] = {
+    0x0c401e9fe8813a55ULL, 0x4a5f446268fd3d35ULL, 0xff13e452334f612aULL, 0xf8227661037e354aULL,
+    0xa5f223723c9ca29dULL, 0x95d965a11aed3979ULL, 0x01e23835b9ab02ccULL, 0x52d49cbad5b30616ULL,
+    0x9e5c2027773f4ed3ULL, 0x66a5c8801925b701ULL, 0x22bbc85b4c6779d9ULL, 0xc13171a42c559c23ULL,
+    0x31e2b67d25be3813ULL, 0xd522c4deed8e4d83ULL, 0xa79f5509b43fbafeULL, 0xe00d2cd88b4b6c6aULL,
+};
+
+static const u64 lsh512_256_iv[16] = {
+    0x6dc57c33df989423ULL, 0xd8ea7f6e8342c199ULL, 0x76df8356f8603ac4ULL, 0x40f1b44de838223aULL,
+    0x39ffe7cfc31484cdULL, 0x39c4326cc5281548ULL, 0x8a2ff85a346045d8ULL, 0xff202aa46dbdd61eULL,
+    0xcf785b3cd5fcdb8bULL, 0x1f0323b64a8150bfULL, 0xff75d972f29ea355ULL, 0x2e567f30bf1ca9e1ULL,
+    0xb596875bf8ff6dbaULL, 0xfcca39b089ef4615ULL, 0xecff4017d020b4b6ULL, 0x7e77384c772ed802ULL,
+};
+
+static const u64 lsh512_384_iv[16] = {
+    0x53156a66292808f6ULL, 0xb2c4f362b204c2bcULL, 0xb84b7213bfa05c4eULL, 0x976ceb7c1b299f73ULL,
+    0xdf0cc63c0570ae97ULL, 0xda4441baa486ce3fULL, 0x6559f5d9b5f2acc2ULL, 0x22dacf19b4b52a16ULL,
+    0xbbcdacefde80953aULL, 0xc9891a2879725b3eULL, 0x7c9fe6330237e440ULL, 0xa30ba550553f7431ULL,
+    0xbb08043fb34e3e30ULL, 0xa0dec48d54618eadULL, 0x150317267464bc57ULL, 0x32d1501fde63dc93ULL,
+};
+
+static const u64 lsh512_512_iv[16] = {
+    0xadd50f3c7f07094eULL, 0xe3f3cee8f9418a4fULL, 0xb527ecde5b3d0ae9ULL, 0x2ef6dec68076f501ULL,
+    0x8cb994cae5aca216ULL, 0xfbb9eae4bba48cc7ULL, 0x650a526174725feaULL, 0x1f9a61a73f8d8085ULL,
+    0xb6607378173b539bULL, 0x1bc99853b0c0b9edULL, 0xdf727fc19b182d47ULL, 0xdbef360cf893a457ULL,
+    0x4981f5e570147e80ULL, 0xd00c4490ca7d3e30ULL, 0x5d73940c0e4ae1ecULL, 0x894085e2edb2d819ULL,
+};
+
+/* ------------------------------------- LSH-256 ------------------------------------- */
+
+cryptomodule_status_t LSH_lsh256_inc_init(LSH_lsh256_ctx *state, size_t outlen) {
+    if (!state || outlen == 0 || outlen > LSH_LSH256_256_DIGEST_SIZE) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    if (outlen == LSH_LSH256_224_DIGEST_SIZE) {
+        memcpy(state->cv, lsh256_224_iv, sizeof(state->cv));
+    } else if (outlen == LSH_LSH256_256_DIGEST_SIZE) {
+        memcpy(state->cv, lsh256_256_iv, sizeof(state->cv));
+    } else {
+        // CV = (32, n, 0, ..., 0) through the steps with an all-zero message block
+        u8 zero[LSH_LSH256_BLOCK_SIZE] = { 0x00, };
+        memset(state->cv, 0, sizeof(state->cv));
+        state->cv[0] = LSH_LSH256_256_DIGEST_SIZE;
+        state->cv[1] = (u32)(outlen * 8);
+        LSH_lsh256_compress(state->cv, zero, 1);
+    }
+    state->data_len = 0;
+    state->outlen = outlen;
+    return CRYPTOMODULE_OK;
+}
+
+void LSH_lsh256_inc(LSH_lsh256_ctx *state, const u8 *in, size_t inlen) {
+    if (state->data_len) {
+        size_t n = LSH_LSH256_BLOCK_SIZE - state->data_len;
+        if (n > inlen) n = inlen;
+        memcpy(state->data + state->data_len, in, n);
+        state->data_len += n;
+        in += n;
+        inlen -= n;
+        if (state->data_len < LSH_LSH256_BLOCK_SIZE) return;
+        LSH_lsh256_compress(state->cv, state->data, 1);
+        state->data_len = 0;
+    }
+
+    size_t nblocks = inlen / LSH_LSH256_BLOCK_SIZE;
+    if (nblocks) {
+        LSH_lsh256_compress(state->cv, in, nblocks);
+        in += nblocks * LSH_LSH256_BLOCK_SIZE;
+        inlen -= nblocks * LSH_LSH256_BLOCK_SIZE;
+    }
+    if (inlen) {
+        memcpy(state->data, in, inlen);
+        state->data_len = inlen;
+    }
+}
+
+void LSH_lsh256_inc_finalize(u8 *out, LSH_lsh256_ctx *state) {
+    u8 digest[LSH_LSH256_256_DIGEST_SIZE];
+
+    state->data[state->data_len] = 0x80;
+    memset(state->data + state->data_len + 1, 0, LSH_LSH256_BLOCK_SIZE - state->data_len - 1);
+    LSH_lsh256_compress(state->cv, state->data, 1);
+
+    for (int l = 0; l < 8; l++) {
+        u32 h = state->cv[l] ^ state->cv[l + 8];
+        digest[4 * l] = (u8)h;
+        digest[4 * l + 1] = (u8)(h >> 8);
+        digest[4 * l + 2] = (u8)(h >> 16);
+        digest[4 * l + 3] = (u8)(h >> 24);
+    }
+    memcpy(out, digest, state->outlen);
+
+    cryptomodule_wipe(digest, sizeof(digest));
+    LSH_lsh256_inc_ctx_release(state);
+}
+
+void LSH_lsh256_inc_ctx_clone(LSH_lsh256_ctx *dest, const LSH_lsh256_ctx *src) {
+    memcpy(dest, src, sizeof(*dest));
+}
+
+void LSH_lsh256_inc_ctx_release(LSH_lsh256_ctx *state) {
+    cryptomodule_wipe(state, sizeof(*state));
+}
+
+cryptomodule_status_t LSH_lsh256(u8 *output, size_t outlen, const u8 *input, size_t inplen) {
+    LSH_lsh256_ctx state;
+
+    cryptomodule_status_t status = LSH_lsh256_inc_init(&state, outlen);
+    if (status != CRYPTOMODULE_OK) return status;
+    LSH_lsh256_inc(&state, input, inplen);
+    LSH_lsh256_inc_finalize(output, &state);
+    return CRYPTOMODULE_OK;
+}
+
+void LSH_lsh256_224(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh256(output, LSH_LSH256_224_DIGEST_SIZE, input, inplen);
+}
+
+void LSH_lsh256_256(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh256(output, LSH_LSH256_256_DIGEST_SIZE, input, inplen);
+}
+
+/* ------------------------------------- LSH-512 ------------------------------------- */
+
+cryptomodule_status_t LSH_lsh512_inc_init(LSH_lsh512_ctx *state, size_t outlen) {
+    if (!state || outlen == 0 || outlen > LSH_LSH512_512_DIGEST_SIZE) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    switch (outlen) {
+    case LSH_LSH512_224_DIGEST_SIZE:
+        memcpy(state->cv, lsh512_224_iv, sizeof(state->cv));
+        break;
+    case LSH_LSH512_256_DIGEST_SIZE:
+        memcpy(state->cv, lsh512_256_iv, sizeof(state->cv));
+        break;
+    case LSH_LSH512_384_DIGEST_SIZE:
+        memcpy(state->cv, lsh512_384_iv, sizeof(state->cv));
+        break;
+    case LSH_LSH512_512_DIGEST_SIZE:
+        memcpy(state->cv, lsh512_512_iv, sizeof(state->cv));
+        break;
+    default: {
+        // CV = (64, n, 0, ..., 0) through the steps with an all-zero message block
+        u8 zero[LSH_LSH512_BLOCK_SIZE] = { 0x00, };
+        memset(state->cv, 0, sizeof(state->cv));
+        state->cv[0] = LSH_LSH512_512_DIGEST_SIZE;
+        state->cv[1] = (u64)(outlen * 8);
+        LSH_lsh512_compress(state->cv, zero, 1);
+        break;
+    }
+    }
+    state->data_len = 0;
+    state->outlen = outlen;
+    return CRYPTOMODULE_OK;
+}
+
+void LSH_lsh512_inc(LSH_lsh512_ctx *state, const u8 *in, size_t inlen) {
+    if (state->data_len) {
+        size_t n = LSH_LSH512_BLOCK_SIZE - state->data_len;
+        if (n > inlen) n = inlen;
+        memcpy(state->data + state->data_len, in, n);
+        state->data_len += n;
+        in += n;
+        inlen -= n;
+        if (state->data_len < LSH_LSH512_BLOCK_SIZE) return;
+        LSH_lsh512_compress(state->cv, state->data, 1);
+        state->data_len = 0;
+    }
+
+    size_t nblocks = inlen / LSH_LSH512_BLOCK_SIZE;
+    if (nblocks) {
+        LSH_lsh512_compress(state->cv, in, nblocks);
+        in += nblocks * LSH_LSH512_BLOCK_SIZE;
+        inlen -= nblocks * LSH_LSH512_BLOCK_SIZE;
+    }
+    if (inlen) {
+        memcpy(state->data, in, inlen);
+        state->data_len = inlen;
+    }
+}
+
+void LSH_lsh512_inc_finalize(u8 *out, LSH_lsh512_ctx *state) {
+    u8 digest[LSH_LSH512_512_DIGEST_SIZE];
+
+    state->data[state->data_len] = 0x80;
+    memset(state->data + state->data_len + 1, 0, LSH_LSH512_BLOCK_SIZE - state->data_len - 1);
+    LSH_lsh512_compress(state->cv, state->data, 1);
+
+    for (int l = 0; l < 8; l++) {
+        u64 h = state->cv[l] ^ state->cv[l + 8];
+        for (int i = 0; i < 8; i++) digest[8 * l + i] = (u8)(h >> (8 * i));
+    }
+    memcpy(out, digest, state->outlen);
+
+    cryptomodule_wipe(digest, sizeof(digest));
+    LSH_lsh512_inc_ctx_release(state);
+}
+
+void LSH_lsh512_inc_ctx_clone(LSH_lsh512_ctx *dest, const LSH_lsh512_ctx *src) {
+    memcpy(dest, src, sizeof(*dest));
+}
+
+void LSH_lsh512_inc_ctx_release(LSH_lsh512_ctx *state) {
+    cryptomodule_wipe(state, sizeof(*state));
+}
+
+cryptomodule_status_t LSH_lsh512(u8 *output, size_t outlen, const u8 *input, size_t inplen) {
+    LSH_lsh512_ctx state;
+
+    cryptomodule_status_t status = LSH_lsh512_inc_init(&state, outlen);
+    if (status != CRYPTOMODULE_OK) return status;
+    LSH_lsh512_inc(&state, input, inplen);
+    LSH_lsh512_inc_finalize(output, &state);
+    return CRYPTOMODULE_OK;
+}
+
+void LSH_lsh512_224(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh512(output, LSH_LSH512_224_DIGEST_SIZE, input, inplen);
+}
+
+void LSH_lsh512_256(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh512(output, LSH_LSH512_256_DIGEST_SIZE, input, inplen);
+}
+
+void LSH_lsh512_384(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh512(output, LSH_LSH512_384_DIGEST_SIZE, input, inplen);
+}
+
+void LSH_lsh512_512(u8 *output, const u8 *input, size_t inplen) {
+    LSH_lsh512(output, LSH_LSH512_512_DIGEST_SIZE, input, inplen);
+}
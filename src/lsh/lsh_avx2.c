@@ -0,0 +1,149 @@
+/* File: src/lsh/lsh_avx2.c */
+
+/**
+ * @file lsh_avx2.c
+ * @brief LSH-256 and LSH-512 compression functions with AVX2.
+ * @details LSH-256 keeps each half of the chaining value in one register and LSH-512 in two, and
+ *          the expanded message blocks likewise. Every gamma rotation is a whole number of bytes,
+ *          so the per-word rotations of the right half are a single byte shuffle. WordPerm moves
+ *          words within 128-bit lanes (VPSHUFD, or VPERMQ for 64-bit words) and then swaps lanes
+ *          between the halves; tau is VPERMD, or VPERMQ on each register of LSH-512. The
+ *          functions carry target attributes, so the file builds with the project's generic CFLAGS
+ *          and the code is only reached when cryptomodule_cpu_has() reports AVX2.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/lsh/lsh.h"
+
+#if LSH_HAVE_X86
+
+#include <immintrin.h>
+
+#define ROL32_256(x, n)     _mm256_or_si256(_mm256_slli_epi32((x), (n)), _mm256_srli_epi32((x), 32 - (n)))
+#define ROL64_256(x, n)     _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+#define LOADU(p)            _mm256_loadu_si256((const __m256i *)(p))
+#define STOREU(p, v)        _mm256_storeu_si256((__m256i *)(p), (v))
+
+/* ------------------------------------- LSH-256 ------------------------------------- */
+
+/* MsgAdd, Mix and WordPerm of one step; l and r are the halves, ml and mr the message block */
+#define LSH256_STEP(ml, mr, sc, alpha, beta)                                        \
+    do {                                                                            \
+        l = _mm256_xor_si256(l, (ml));                                              \
+        r = _mm256_xor_si256(r, (mr));                                              \
+        l = _mm256_add_epi32(l, r);                                                 \
+        l = _mm256_xor_si256(ROL32_256(l, alpha), LOADU(sc));                       \
+        r = _mm256_add_epi32(r, l);                                                 \
+        r = ROL32_256(r, beta);                                                     \
+        l = _mm256_add_epi32(l, r);                                                 \
+        r = _mm256_shuffle_epi8(r, gamma);                                          \
+        l = _mm256_shuffle_epi32(l, _MM_SHUFFLE(3, 1, 0, 2));                       \
+        r = _mm256_shuffle_epi32(r, _MM_SHUFFLE(1, 2, 3, 0));                       \
+        t = _mm256_permute2x128_si256(l, r, 0x20);                                  \
+        l = _mm256_permute2x128_si256(l, r, 0x31);                                  \
+        r = t;                                                                      \
+    } while (0)
+
+__attribute__((target("avx2")))
+void lsh256_compress_avx2(u32 *cv, const u8 *in, size_t nblocks) {
+    // Byte rotations of the right half by gamma = 0, 8, 16, 24, 24, 16, 8, 0
+    const __m256i gamma = _mm256_setr_epi8(0, 1, 2, 3, 7, 4, 5, 6, 10, 11, 8, 9, 13, 14, 15, 12,
+                                           1, 2, 3, 0, 6, 7, 4, 5, 11, 8, 9, 10, 12, 13, 14, 15);
+    const __m256i tau = _mm256_setr_epi32(3, 2, 0, 1, 7, 4, 5, 6);
+    __m256i l = LOADU(cv), r = LOADU(cv + 8), t;
+
+    for (; nblocks; nblocks--, in += LSH_LSH256_BLOCK_SIZE) {
+        __m256i el = LOADU(in), er = LOADU(in + 32), ol = LOADU(in + 64), or_ = LOADU(in + 96);
+
+        LSH256_STEP(el, er, lsh256_step_constants, 29, 1);
+        LSH256_STEP(ol, or_, lsh256_step_constants + 8, 5, 17);
+        for (int j = 2; j < LSH_LSH256_STEPS; j += 2) {
+            el = _mm256_add_epi32(ol, _mm256_permutevar8x32_epi32(el, tau));
+            er = _mm256_add_epi32(or_, _mm256_permutevar8x32_epi32(er, tau));
+            LSH256_STEP(el, er, lsh256_step_constants + 8 * j, 29, 1);
+            ol = _mm256_add_epi32(el, _mm256_permutevar8x32_epi32(ol, tau));
+            or_ = _mm256_add_epi32(er, _mm256_permutevar8x32_epi32(or_, tau));
+            LSH256_STEP(ol, or_, lsh256_step_constants + 8 * (j + 1), 5, 17);
+        }
+        el = _mm256_add_epi32(ol, _mm256_permutevar8x32_epi32(el, tau));
+        er = _mm256_add_epi32(or_, _mm256_permutevar8x32_epi32(er, tau));
+        l = _mm256_xor_si256(l, el);
+        r = _mm256_xor_si256(r, er);
+    }
+
+    STOREU(cv, l);
+    STOREU(cv + 8, r);
+}
+
+/* ------------------------------------- LSH-512 ------------------------------------- */
+
+#define LSH512_STEP(ml0, ml1, mr0, mr1, sc, alpha, beta)                            \
+    do {                                                                            \
+        l0 = _mm256_xor_si256(l0, (ml0));                                           \
+        l1 = _mm256_xor_si256(l1, (ml1));                                           \
+        r0 = _mm256_xor_si256(r0, (mr0));                                           \
+        r1 = _mm256_xor_si256(r1, (mr1));                                           \
+        l0 = _mm256_add_epi64(l0, r0);                                              \
+        l1 = _mm256_add_epi64(l1, r1);                                              \
+        l0 = _mm256_xor_si256(ROL64_256(l0, alpha), LOADU(sc));                     \
+        l1 = _mm256_xor_si256(ROL64_256(l1, alpha), LOADU((sc) + 4));               \
+        r0 = _mm256_add_epi64(r0, l0);                                              \
+        r1 = _mm256_add_epi64(r1, l1);                                              \
+        r0 = ROL64_256(r0, beta);                                                   \
+        r1 = ROL64_256(r1, beta);                                                   \
+        l0 = _mm256_add_epi64(l0, r0);                                              \
+        l1 = _mm256_add_epi64(l1, r1);                                              \
+        r0 = _mm256_shuffle_epi8(r0, gamma0);                                       \
+        r1 = _mm256_shuffle_epi8(r1, gamma1);                                       \
+        t = _mm256_permute4x64_epi64(l0, _MM_SHUFFLE(3, 1, 0, 2));                  \
+        l0 = _mm256_permute4x64_epi64(l1, _MM_SHUFFLE(3, 1, 0, 2));                 \
+        l1 = _mm256_permute4x64_epi64(r1, _MM_SHUFFLE(1, 2, 3, 0));                 \
+        r1 = _mm256_permute4x64_epi64(r0, _MM_SHUFFLE(1, 2, 3, 0));                 \
+        r0 = t;                                                                     \
+    } while (0)
+
+/* Next message block of a parity from the previous block (p) and its own last block (m) */
+#define LSH512_EXPAND(m0, m1, p0, p1)                                               \
+    do {                                                                            \
+        m0 = _mm256_add_epi64((p0), _mm256_permute4x64_epi64(m0, _MM_SHUFFLE(1, 0, 2, 3))); \
+        m1 = _mm256_add_epi64((p1), _mm256_permute4x64_epi64(m1, _MM_SHUFFLE(2, 1, 0, 3))); \
+    } while (0)
+
+__attribute__((target("avx2")))
+void lsh512_compress_avx2(u64 *cv, const u8 *in, size_t nblocks) {
+    // Byte rotations of the right half by gamma = 0, 16, 32, 48 | 8, 24, 40, 56
+    const __m256i gamma0 = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 14, 15, 8, 9, 10, 11, 12, 13,
+                                            4, 5, 6, 7, 0, 1, 2, 3, 10, 11, 12, 13, 14, 15, 8, 9);
+    const __m256i gamma1 = _mm256_setr_epi8(7, 0, 1, 2, 3, 4, 5, 6, 13, 14, 15, 8, 9, 10, 11, 12,
+                                            3, 4, 5, 6, 7, 0, 1, 2, 9, 10, 11, 12, 13, 14, 15, 8);
+    __m256i l0 = LOADU(cv), l1 = LOADU(cv + 4), r0 = LOADU(cv + 8), r1 = LOADU(cv + 12), t;
+
+    for (; nblocks; nblocks--, in += LSH_LSH512_BLOCK_SIZE) {
+        __m256i el0 = LOADU(in), el1 = LOADU(in + 32), er0 = LOADU(in + 64), er1 = LOADU(in + 96);
+        __m256i ol0 = LOADU(in + 128), ol1 = LOADU(in + 160), or0 = LOADU(in + 192), or1 = LOADU(in + 224);
+
+        LSH512_STEP(el0, el1, er0, er1, lsh512_step_constants, 23, 59);
+        LSH512_STEP(ol0, ol1, or0, or1, lsh512_step_constants + 8, 7, 3);
+        for (int j = 2; j < LSH_LSH512_STEPS; j += 2) {
+            LSH512_EXPAND(el0, el1, ol0, ol1);
+            LSH512_EXPAND(er0, er1, or0, or1);
+            LSH512_STEP(el0, el1, er0, er1, lsh512_step_constants + 8 * j, 23, 59);
+            LSH512_EXPAND(ol0, ol1, el0, el1);
+            LSH512_EXPAND(or0, or1, er0, er1);
+            LSH512_STEP(ol0, ol1, or0, or1, lsh512_step_constants + 8 * (j + 1), 7, 3);
+        }
+        LSH512_EXPAND(el0, el1, ol0, ol1);
+        LSH512_EXPAND(er0, er1, or0, or1);
+        l0 = _mm256_xor_si256(l0, el0);
+        l1 = _mm256_xor_si256(l1, el1);
+        r0 = _mm256_xor_si256(r0, er0);
+        r1 = _mm256_xor_si256(r1, er1);
+    }
+
+    STOREU(cv, l0);
+    STOREU(cv + 4, l1);
+    STOREU(cv + 8, r0);
+    STOREU(cv + 12, r1);
+}
+
+#endif /* LSH_HAVE_X86 */
@@ -0,0 +1,268 @@
+/* File: src/lsh/lsh_core.c */
+
+/**
+ * @file lsh_core.c
+ * @brief LSH-256 and LSH-512 compression functions (portable C), constants and backend dispatch.
+ * @details A step is MsgAdd, Mix and WordPerm (KS X 3262): the state is XORed with the expanded
+ *          message block of the step; word l of the left half and word l of the right half are
+ *          mixed with additions, rotations by alpha and beta (which alternate between even and
+ *          odd steps) and gamma_l, and the step constant SC_j[l]; and the sixteen words are
+ *          permuted by sigma. Message block j >= 2 is block j - 1 plus block j - 2 permuted by
+ *          tau, so only two expanded blocks are live at a time.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/lsh/lsh.h"
+#include "../../include/cryptomodule_cpu.h"
+
+#define ROL32(x, n)     (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROL64(x, n)     (((x) << (n)) | ((x) >> (64 - (n))))
+
+/* SC_0 is given by the standard; SC_j[l] = SC_{j-1}[l] + (SC_{j-1}[l] <<< 8) */
+const u32 lsh256_step_constants[8 * LSH_LSH256_STEPS] = {
+    0x917caf90, 0x6c1b10a2, 0x6f352943, 0xcf778243, 0x2ceb7472, 0x29e96ff2, 0x8a9ba428, 0x2eeb2642,
+    0x0e2c4021, 0x872bb30e, 0xa45e6cb2, 0x46f9c612, 0x185fe69e, 0x1359621b, 0x263fccb2, 0x1a116870,
+    0x3a6c612f, 0xb2dec195, 0x02cb1f56, 0x40bfd858, 0x784684b6, 0x6cbb7d2e, 0x660c7ed8, 0x2b79d88a,
+    0xa6cd9069, 0x91a05747, 0xcdea7558, 0x00983098, 0xbecb3b2e, 0x2838ab9a, 0x728b573e, 0xa55262b5,
+    0x745dfa0f, 0x31f79ed8, 0xb85fce25, 0x98c8c898, 0x8a0669ec, 0x60e445c2, 0xfde295b0, 0xf7b5185a,
+    0xd2580983, 0x29967709, 0x182df3dd, 0x61916130, 0x90705676, 0x452a0822, 0xe07846ad, 0xaccd7351,
+    0x2a618d55, 0xc00d8032, 0x4621d0f5, 0xf2f29191, 0x00c6cd06, 0x6f322a67, 0x58bef48d, 0x7a40c4fd,
+    0x8beee27f, 0xcd8db2f2, 0x67f2c63b, 0xe5842383, 0xc793d306, 0xa15c91d6, 0x17b381e5, 0xbb05c277,
+    0x7ad1620a, 0x5b40a5bf, 0x5ab901a2, 0x69a7a768, 0x5b66d9cd, 0xfdee6877, 0xcb3566fc, 0xc0c83a32,
+    0x4c336c84, 0x9be6651a, 0x13baa3fc, 0x114f0fd1, 0xc240a728, 0xec56e074, 0x009c63c7, 0x89026cf2,
+    0x7f9ff0d0, 0x824b7fb5, 0xce5ea00f, 0x605ee0e2, 0x02e7cfea, 0x43375560, 0x9d002ac7, 0x8b6f5f7b,
+    0x1f90c14f, 0xcdcb3537, 0x2cfeafdd, 0xbf3fc342, 0xeab7b9ec, 0x7a8cb5a3, 0x9d2af264, 0xfacedb06,
+    0xb052106e, 0x99006d04, 0x2bae8d09, 0xff030601, 0xa271a6d6, 0x0742591d, 0xc81d5701, 0xc9a9e200,
+    0x02627f1e, 0x996d719d, 0xda3b9634, 0x02090800, 0x14187d78, 0x499b7624, 0xe57458c9, 0x738be2c9,
+    0x64e19d20, 0x06df0f36, 0x15d1cb0e, 0x0b110802, 0x2c95f58c, 0xe5119a6d, 0x59cd22ae, 0xff6eac3c,
+    0x467ebd84, 0xe5ee453c, 0xe79cd923, 0x1c190a0d, 0xc28b81b8, 0xf6ac0852, 0x26efd107, 0x6e1ae93b,
+    0xc53c41ca, 0xd4338221, 0x8475fd0a, 0x35231729, 0x4e0d3a7a, 0xa2b45b48, 0x16c0d82d, 0x890424a9,
+    0x017e0c8f, 0x07b5a3f5, 0xfa73078e, 0x583a405e, 0x5b47b4c8, 0x570fa3ea, 0xd7990543, 0x8d28ce32,
+    0x7f8a9b90, 0xbd5998fc, 0x6d7a9688, 0x927a9eb6, 0xa2fc7d23, 0x66b38e41, 0x709e491a, 0xb5f700bf,
+    0x0a262c0f, 0x16f295b9, 0xe8111ef5, 0x0d195548, 0x9f79a0c5, 0x1a41cfa7, 0x0ee7638a, 0xacf7c074,
+    0x30523b19, 0x09884ecf, 0xf93014dd, 0x266e9d55, 0x191a6664, 0x5c1176c1, 0xf64aed98, 0xa4b83520,
+    0x828d5449, 0x91d71dd8, 0x2944f2d6, 0x950bf27b, 0x3380ca7d, 0x6d88381d, 0x4138868e, 0x5ced55c4,
+    0x0fe19dcb, 0x68f4f669, 0x6e37c8ff, 0xa0fe6e10, 0xb44b47b0, 0xf5c0558a, 0x79bf14cf, 0x4a431a20,
+    0xf17f68da, 0x5deb5fd1, 0xa600c86d, 0x9f6c7eb0, 0xff92f864, 0xb615e07f, 0x38d3e448, 0x8d5d3a6a,
+    0x70e843cb, 0x494b312e, 0xa6c93613, 0x0beb2f4f, 0x928b5d63, 0xcbf66035, 0x0cb82c80, 0xea97a4f7,
+    0x592c0f3b, 0x947c5f77, 0x6fff49b9, 0xf71a7e5a, 0x1de8c0f5, 0xc2569600, 0xc4e4ac8c, 0x823c9ce1,
+};
+
+const u64 lsh512_step_constants[8 * LSH_LSH512_STEPS] = {
+    0x97884283c938982aULL, 0xba1fca93533e2355ULL, 0xc519a2e87aeb1c03ULL, 0x9a0fc95462af17b1ULL,
+    0xfc3dda8ab019a82bULL, 0x02825d079a895407ULL, 0x79f2d0a7ee06a6f7ULL, 0xd76d15eed9fdf5feULL,
+    0x1fcac64d01d0c2c1ULL, 0xd9ea5de69161790fULL, 0xdebc8b6366071fc8ULL, 0xa9d91db711c6c94bULL,
+    0x3a18653ac9c1d427ULL, 0x84df64a223dd5b09ULL, 0x6cc37895f4ad9e70ULL, 0x448304c8d7f3f4d5ULL,
+    0xea91134ed29383e0ULL, 0xc4484477f2da88e8ULL, 0x9b47eec96d26e8a6ULL, 0x82f6d4c8d89014f4ULL,
+    0x527da0048b95fb61ULL, 0x644406c60138648dULL, 0x303c0e8aa24c0edcULL, 0xc787cda0cbe8ca19ULL,
+    0x7ba46221661764caULL, 0x0c8cbc6acd6371acULL, 0xe336b836940f8f41ULL, 0x79cb9da168a50976ULL,
+    0xd01da49021915cb3ULL, 0xa84accc7399cf1f1ULL, 0x6c4a992cee5aeb0cULL, 0x4f556e6cb4b2e3e0ULL,
+    0x200683877d7c2f45ULL, 0x9949273830d51db8ULL, 0x19eeeecaa39ed124ULL, 0x45693f0a0dae7fefULL,
+    0xedc234b1b2ee1083ULL, 0xf3179400d68ee399ULL, 0xb6e3c61b4945f778ULL, 0xa4c3db216796c42fULL,
+    0x268a0b04f9ab7465ULL, 0xe2705f6905f2d651ULL, 0x08ddb96e426ff53dULL, 0xaea84917bc2e6f34ULL,
+    0xaff6e664a0fe9470ULL, 0x0aab94d765727d8cULL, 0x9aa9e1648f3d702eULL, 0x689efc88fe5af3d3ULL,
+    0xb0950ffea51fd98bULL, 0x52cfc86ef8c92833ULL, 0xe69727b0b2653245ULL, 0x56f160d3ea9da3e2ULL,
+    0xa6dd4b059f93051fULL, 0xb6406c3cd7f00996ULL, 0x448b45f3ccad9ec8ULL, 0x079b8587594ec73bULL,
+    0x45a50ea3c4f9653bULL, 0x22983767c1f15b85ULL, 0x7dbed8631797782bULL, 0x485234be88418638ULL,
+    0x842850a5329824c5ULL, 0xf6aca914c7f9a04cULL, 0xcfd139c07a4c670cULL, 0xa3210ce0a8160242ULL,
+    0xeab3b268be5ea080ULL, 0xbacf9f29b34ce0a7ULL, 0x3c973b7aaf0fa3a8ULL, 0x9a86f346c9c7be80ULL,
+    0xac78f5d7cabcea49ULL, 0xa355bddcc199ed42ULL, 0xa10afa3ac6b373dbULL, 0xc42ded88be1844e5ULL,
+    0x9e661b271cff216aULL, 0x8a6ec8dd002d8861ULL, 0xd3d2b629beb34be4ULL, 0x217a3a1091863f1aULL,
+    0x256ecda287a733f5ULL, 0xf9139a9e5b872fe5ULL, 0xac0535017a274f7cULL, 0xf21b7646d65d2aa9ULL,
+    0x048142441c208c08ULL, 0xf937a5dd2db5e9ebULL, 0xa688dfe871ff30b7ULL, 0x9bb44aa217c5593bULL,
+    0x943c702a2edb291aULL, 0x0cae38f9e2b715deULL, 0xb13a367ba176cc28ULL, 0x0d91bd1d3387d49bULL,
+    0x85c386603cac940cULL, 0x30dd830ae39fd5e4ULL, 0x2f68c85a712fe85dULL, 0x4ffeecb9dd1e94d6ULL,
+    0xd0ac9a590a0443aeULL, 0xbae732dc99ccf3eaULL, 0xeb70b21d1842f4d9ULL, 0x9f4eda50bb5c6fa8ULL,
+    0x4949e69ce940a091ULL, 0x0e608dee8375ba14ULL, 0x983122cba118458cULL, 0x4eeba696fbb36b25ULL,
+    0x7d46f3630e47f27eULL, 0xa21a0f7666c0dea4ULL, 0x5c22cf355b37cec4ULL, 0xee292b0c17cc1847ULL,
+    0x9330838629e131daULL, 0x6eee7c71f92fce22ULL, 0xc953ee6cb95dd224ULL, 0x3a923d92af1e9073ULL,
+    0xc43a5671563a70fbULL, 0xbc2985dd279f8346ULL, 0x7ef2049093069320ULL, 0x17543723e3e46035ULL,
+    0xc3b409b00b130c6dULL, 0x5d6aee6b28fdf090ULL, 0x1d425b26172ff6edULL, 0xcccfd041cdaf03adULL,
+    0xfe90c7c790ab6cbfULL, 0xe5af6304c722ca02ULL, 0x70f695239999b39eULL, 0x6b8b5b07c844954cULL,
+    0x77bdb9bb1e1f7a30ULL, 0xc859599426ee80edULL, 0x5f9d813d4726e40aULL, 0x9ca0120f7cb2b179ULL,
+    0x8f588f583c182cbdULL, 0x951267cbe9eccce7ULL, 0x678bb8bd334d520eULL, 0xf6e662d00cd9e1b7ULL,
+    0x357774d93d99aaa7ULL, 0x21b2edbb156f6eb5ULL, 0xfd1ebe846e0aee69ULL, 0x3cb2218c2f642b15ULL,
+    0xe7e7e7945444ea4cULL, 0xa77a33b5d6b9b47cULL, 0xf34475f0809f6075ULL, 0xdd4932dce6bb99adULL,
+    0xacec4e16d74451dcULL, 0xd4a0a8d084de23d6ULL, 0x1bdd42f278f95866ULL, 0xeed3adbb938f4051ULL,
+    0xcfcf7be8992f3733ULL, 0x21ade98c906e3123ULL, 0x37ba66711fffd668ULL, 0x267c0fc3a255478aULL,
+    0x993a64ee1b962e88ULL, 0x754979556301faaaULL, 0xf920356b7251be81ULL, 0xc281694f22cf923fULL,
+    0x9f4b6481c8666b02ULL, 0xcf97761cfe9f5444ULL, 0xf220d7911fd63e9fULL, 0xa28bd365f79cd1b0ULL,
+    0xd39f5309b1c4b721ULL, 0xbec2ceb864fca51fULL, 0x1955a0ddc410407aULL, 0x43eab871f261d201ULL,
+    0xeaafe64a2ed16da1ULL, 0x670d931b9df39913ULL, 0x12f868b0f614de91ULL, 0x2e5f395d946e8252ULL,
+    0x72f25cbb767bd8f4ULL, 0x8191871d61a1c4ddULL, 0x6ef67ea1d450ba93ULL, 0x2ea32a645433d344ULL,
+    0x9a963079003f0f8bULL, 0x74a0aeb9918cac7aULL, 0x0b6119a70af36fa3ULL, 0x8d9896f202f0d480ULL,
+    0x654f1831f254cd66ULL, 0x1318a47f0366a25eULL, 0x65752076250b4e01ULL, 0xd1cd8eb888071772ULL,
+    0x30c6a9793f4e9b25ULL, 0x154f684b1e3926eeULL, 0x6c7ac0b1fe6312aeULL, 0x262f88f4f3c5550dULL,
+    0xb4674a24472233cbULL, 0x2bbd23826a090071ULL, 0xda95969b30594f66ULL, 0x9f5c47408f1e8a43ULL,
+    0xf77022b88de9c055ULL, 0x64b7b36957601503ULL, 0xe73b72b06175c11aULL, 0x55b87de8b91a6233ULL,
+    0x1bb16e6b6955ff7fULL, 0xe8e0a5ec7309719cULL, 0x702c31cb89a8b640ULL, 0xfba387cfada8cde2ULL,
+    0x6792db4677aa164cULL, 0x1c6b1cc0b7751867ULL, 0x22ae2311d736dc01ULL, 0x0e3666a1d37c9588ULL,
+    0xcd1fd9d4bf557e9aULL, 0xc986925f7c7b0e84ULL, 0x9c5dfd55325ef6b0ULL, 0x9f2b577d5676b0ddULL,
+    0xfa6e21be21c062b3ULL, 0x8787dd782c8d7f83ULL, 0xd0d134e90e12dd23ULL, 0x449d087550121d96ULL,
+    0xecf9ae9414d41967ULL, 0x5018f1dbf789934dULL, 0xfa5b52879155a74cULL, 0xca82d4d3cd278e7cULL,
+    0x688fdfdfe22316adULL, 0x0f6555a4ba0d030aULL, 0xa2061df720f000f3ULL, 0xe1a57dc5622fb3daULL,
+    0xe6a842a8e8ed8153ULL, 0x690acdd3811ce09dULL, 0x55adda18e6fcf446ULL, 0x4d57a8a0f4b60b46ULL,
+    0xf86fbfc20539c415ULL, 0x74bafa5ec7100d19ULL, 0xa824151810f0f495ULL, 0x8723432791e38ebbULL,
+    0x8eeaeb91d66ed539ULL, 0x73d8a1549dfd7e06ULL, 0x0387f2ffe3f13a9bULL, 0xa5004995aac15193ULL,
+    0x682f81c73efdda0dULL, 0x2fb55925d71d268dULL, 0xcc392d2901e58a3dULL, 0xaa666ab975724a42ULL,
+};
+
+static const int lsh_tau[16] = { 3, 2, 0, 1, 7, 4, 5, 6, 11, 10, 8, 9, 15, 12, 13, 14 };
+static const int lsh_sigma[16] = { 6, 4, 5, 7, 12, 15, 14, 13, 2, 0, 1, 3, 8, 11, 10, 9 };
+static const int lsh256_gamma[8] = { 0, 8, 16, 24, 24, 16, 8, 0 };
+static const int lsh512_gamma[8] = { 0, 16, 32, 48, 8, 24, 40, 56 };
+
+static u32 load_le32(const u8 *x) {
+    return (u32)x[0] | ((u32)x[1] << 8) | ((u32)x[2] << 16) | ((u32)x[3] << 24);
+}
+
+static u64 load_le64(const u8 *x) {
+    return (u64)load_le32(x) | ((u64)load_le32(x + 4) << 32);
+}
+
+/* ----------------------------------- Portable C ------------------------------------ */
+
+/* MsgAdd, Mix and WordPerm of one LSH-256 step */
+static void lsh256_step_c(u32 *t, const u32 *m, const u32 *sc, int alpha, int beta) {
+    u32 x[16];
+
+    for (int l = 0; l < 8; l++) {
+        u32 a = t[l] ^ m[l], b = t[l + 8] ^ m[l + 8];
+        a += b;
+        a = ROL32(a, alpha) ^ sc[l];
+        b += a;
+        b = ROL32(b, beta);
+        a += b;
+        x[l] = a;
+        x[l + 8] = lsh256_gamma[l] ? ROL32(b, lsh256_gamma[l]) : b;
+    }
+    for (int l = 0; l < 16; l++) t[l] = x[lsh_sigma[l]];
+}
+
+static void lsh512_step_c(u64 *t, const u64 *m, const u64 *sc, int alpha, int beta) {
+    u64 x[16];
+
+    for (int l = 0; l < 8; l++) {
+        u64 a = t[l] ^ m[l], b = t[l + 8] ^ m[l + 8];
+        a += b;
+        a = ROL64(a, alpha) ^ sc[l];
+        b += a;
+        b = ROL64(b, beta);
+        a += b;
+        x[l] = a;
+        x[l + 8] = lsh512_gamma[l] ? ROL64(b, lsh512_gamma[l]) : b;
+    }
+    for (int l = 0; l < 16; l++) t[l] = x[lsh_sigma[l]];
+}
+
+static void lsh256_compress_c(u32 *cv, const u8 *in, size_t nblocks) {
+    u32 even[16], odd[16], tmp[16];
+
+    for (; nblocks; nblocks--, in += LSH_LSH256_BLOCK_SIZE) {
+        for (int l = 0; l < 16; l++) {
+            even[l] = load_le32(in + 4 * l);
+            odd[l] = load_le32(in + 64 + 4 * l);
+        }
+
+        for (int j = 0; j < LSH_LSH256_STEPS; j += 2) {
+            if (j) {
+                for (int l = 0; l < 16; l++) tmp[l] = odd[l] + even[lsh_tau[l]];
+                memcpy(even, tmp, sizeof(tmp));
+            }
+            lsh256_step_c(cv, even, lsh256_step_constants + 8 * j, 29, 1);
+            if (j) {
+                for (int l = 0; l < 16; l++) tmp[l] = even[l] + odd[lsh_tau[l]];
+                memcpy(odd, tmp, sizeof(tmp));
+            }
+            lsh256_step_c(cv, odd, lsh256_step_constants + 8 * (j + 1), 5, 17);
+        }
+        for (int l = 0; l < 16; l++) cv[l] ^= odd[l] + even[lsh_tau[l]];
+    }
+}
+
+static void lsh512_compress_c(u64 *cv, const u8 *in, size_t nblocks) {
+    u64 even[16], odd[16], tmp[16];
+
+    for (; nblocks; nblocks--, in += LSH_LSH512_BLOCK_SIZE) {
+        for (int l = 0; l < 16; l++) {
+            even[l] = load_le64(in + 8 * l);
+            odd[l] = load_le64(in + 128 + 8 * l);
+        }
+
+        for (int j = 0; j < LSH_LSH512_STEPS; j += 2) {
+            if (j) {
+                for (int l = 0; l < 16; l++) tmp[l] = odd[l] + even[lsh_tau[l]];
+                memcpy(even, tmp, sizeof(tmp));
+            }
+            lsh512_step_c(cv, even, lsh512_step_constants + 8 * j, 23, 59);
+            if (j) {
+                for (int l = 0; l < 16; l++) tmp[l] = even[l] + odd[lsh_tau[l]];
+                memcpy(odd, tmp, sizeof(tmp));
+            }
+            lsh512_step_c(cv, odd, lsh512_step_constants + 8 * (j + 1), 7, 3);
+        }
+        for (int l = 0; l < 16; l++) cv[l] ^= odd[l] + even[lsh_tau[l]];
+    }
+}
+
+/* ------------------------------------ Dispatch ------------------------------------- */
+
+static void lsh256_compress_resolve(u32 *cv, const u8 *in, size_t nblocks);
+static void lsh512_compress_resolve(u64 *cv, const u8 *in, size_t nblocks);
+
+static void (*lsh256_compress)(u32 *, const u8 *, size_t) = lsh256_compress_resolve;
+static void (*lsh512_compress)(u64 *, const u8 *, size_t) = lsh512_compress_resolve;
+static LSH_backend_t lsh_backend = LSH_BACKEND_C;
+
+bool LSH_set_backend(LSH_backend_t backend) {
+    switch (backend) {
+    case LSH_BACKEND_C:
+        lsh256_compress = lsh256_compress_c;
+        lsh512_compress = lsh512_compress_c;
+        break;
+#if LSH_HAVE_X86
+    case LSH_BACKEND_SSE2:
+        if (!cryptomodule_cpu_has(CRYPTOMODULE_CPU_SSE2)) return false;
+        lsh256_compress = lsh256_compress_sse2;
+        lsh512_compress = lsh512_compress_sse2;
+        break;
+    case LSH_BACKEND_AVX2:
+        if (!cryptomodule_cpu_has(CRYPTOMODULE_CPU_AVX2)) return false;
+        lsh256_compress = lsh256_compress_avx2;
+        lsh512_compress = lsh512_compress_avx2;
+        break;
+#endif
+    default:
+        return false;
+    }
+    lsh_backend = backend;
+    return true;
+}
+
+LSH_backend_t LSH_get_backend(void) {
+    return lsh_backend;
+}
+
+void LSH_init_dispatch(void) {
+    if (!LSH_set_backend(LSH_BACKEND_AVX2) && !LSH_set_backend(LSH_BACKEND_SSE2)) {
+        LSH_set_backend(LSH_BACKEND_C);
+    }
+}
+
+static void lsh256_compress_resolve(u32 *cv, const u8 *in, size_t nblocks) {
+    LSH_init_dispatch();
+    lsh256_compress(cv, in, nblocks);
+}
+
+static void lsh512_compress_resolve(u64 *cv, const u8 *in, size_t nblocks) {
+    LSH_init_dispatch();
+    lsh512_compress(cv, in, nblocks);
+}
+
+void LSH_lsh256_compress(u32 *cv, const u8 *in, size_t nblocks) {
+    lsh256_compress(cv, in, nblocks);
+}
+
+void LSH_lsh512_compress(u64 *cv, const u8 *in, size_t nblocks) {
+    lsh512_compress(cv, in, nblocks);
+}
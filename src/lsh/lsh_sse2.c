@@ -0,0 +1,187 @@
+/* File: src/lsh/lsh_sse2.c */
+
+/**
+ * @file lsh_sse2.c
+ * @brief LSH-256 and LSH-512 compression functions with SSE2.
+ * @details The halves of the chaining value take two (LSH-256) or four (LSH-512) registers. SSE2
+ *          has neither byte shuffles nor per-element shift counts, so the gamma rotations of the
+ *          right half are uniform rotations merged under word masks (LSH-256) or by taking one
+ *          64-bit element from each of two rotations (LSH-512). WordPerm and tau are PSHUFD within
+ *          a register and 64-bit unpacks, MOVSD or SHUFPD across registers.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/lsh/lsh.h"
+
+#if LSH_HAVE_X86
+
+#include <emmintrin.h>
+
+#define ROL32_128(x, n)     _mm_or_si128(_mm_slli_epi32((x), (n)), _mm_srli_epi32((x), 32 - (n)))
+#define ROL64_128(x, n)     _mm_or_si128(_mm_slli_epi64((x), (n)), _mm_srli_epi64((x), 64 - (n)))
+#define LOADU(p)            _mm_loadu_si128((const __m128i *)(p))
+#define STOREU(p, v)        _mm_storeu_si128((__m128i *)(p), (v))
+
+/* (a[0], b[1]) of two registers of 64-bit elements */
+#define LO_HI(a, b)         _mm_castpd_si128(_mm_move_sd(_mm_castsi128_pd(b), _mm_castsi128_pd(a)))
+
+/* (a[1], b[0]) of two registers of 64-bit elements */
+#define HI_LO(a, b)         _mm_castpd_si128(_mm_shuffle_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b), 1))
+
+/* ------------------------------------- LSH-256 ------------------------------------- */
+
+/* Rotate word k of x by g[k] bits, g a permutation of 0, 8, 16, 24 given by the masks m8, m16, m24 */
+#define LSH256_GAMMA(x, m8, m16, m24)                                               \
+    _mm_or_si128(_mm_or_si128(_mm_andnot_si128(_mm_or_si128(_mm_or_si128(m8, m16), m24), (x)), \
+                              _mm_and_si128(m8, ROL32_128((x), 8))),                \
+                 _mm_or_si128(_mm_and_si128(m16, ROL32_128((x), 16)),               \
+                              _mm_and_si128(m24, ROL32_128((x), 24))))
+
+#define LSH256_STEP(ml0, ml1, mr0, mr1, sc, alpha, beta)                            \
+    do {                                                                            \
+        l0 = _mm_xor_si128(l0, (ml0));                                              \
+        l1 = _mm_xor_si128(l1, (ml1));                                              \
+        r0 = _mm_xor_si128(r0, (mr0));                                              \
+        r1 = _mm_xor_si128(r1, (mr1));                                              \
+        l0 = _mm_add_epi32(l0, r0);                                                 \
+        l1 = _mm_add_epi32(l1, r1);                                                 \
+        l0 = _mm_xor_si128(ROL32_128(l0, alpha), LOADU(sc));                        \
+        l1 = _mm_xor_si128(ROL32_128(l1, alpha), LOADU((sc) + 4));                  \
+        r0 = _mm_add_epi32(r0, l0);                                                 \
+        r1 = _mm_add_epi32(r1, l1);                                                 \
+        r0 = ROL32_128(r0, beta);                                                   \
+        r1 = ROL32_128(r1, beta);                                                   \
+        l0 = _mm_add_epi32(l0, r0);                                                 \
+        l1 = _mm_add_epi32(l1, r1);                                                 \
+        r0 = LSH256_GAMMA(r0, w1, w2, w3);                                          \
+        r1 = LSH256_GAMMA(r1, w2, w1, w0);                                          \
+        t = _mm_shuffle_epi32(l0, _MM_SHUFFLE(3, 1, 0, 2));                         \
+        l0 = _mm_shuffle_epi32(l1, _MM_SHUFFLE(3, 1, 0, 2));                        \
+        l1 = _mm_shuffle_epi32(r1, _MM_SHUFFLE(1, 2, 3, 0));                        \
+        r1 = _mm_shuffle_epi32(r0, _MM_SHUFFLE(1, 2, 3, 0));                        \
+        r0 = t;                                                                     \
+    } while (0)
+
+#define LSH256_EXPAND(m0, m1, p0, p1)                                               \
+    do {                                                                            \
+        m0 = _mm_add_epi32((p0), _mm_shuffle_epi32(m0, _MM_SHUFFLE(1, 0, 2, 3)));   \
+        m1 = _mm_add_epi32((p1), _mm_shuffle_epi32(m1, _MM_SHUFFLE(2, 1, 0, 3)));   \
+    } while (0)
+
+__attribute__((target("sse2")))
+void lsh256_compress_sse2(u32 *cv, const u8 *in, size_t nblocks) {
+    // Masks of word k of a register (gamma = 0, 8, 16, 24 | 24, 16, 8, 0)
+    const __m128i w0 = _mm_setr_epi32(-1, 0, 0, 0), w1 = _mm_setr_epi32(0, -1, 0, 0);
+    const __m128i w2 = _mm_setr_epi32(0, 0, -1, 0), w3 = _mm_setr_epi32(0, 0, 0, -1);
+    __m128i l0 = LOADU(cv), l1 = LOADU(cv + 4), r0 = LOADU(cv + 8), r1 = LOADU(cv + 12), t;
+
+    for (; nblocks; nblocks--, in += LSH_LSH256_BLOCK_SIZE) {
+        __m128i el0 = LOADU(in), el1 = LOADU(in + 16), er0 = LOADU(in + 32), er1 = LOADU(in + 48);
+        __m128i ol0 = LOADU(in + 64), ol1 = LOADU(in + 80), or0 = LOADU(in + 96), or1 = LOADU(in + 112);
+
+        LSH256_STEP(el0, el1, er0, er1, lsh256_step_constants, 29, 1);
+        LSH256_STEP(ol0, ol1, or0, or1, lsh256_step_constants + 8, 5, 17);
+        for (int j = 2; j < LSH_LSH256_STEPS; j += 2) {
+            LSH256_EXPAND(el0, el1, ol0, ol1);
+            LSH256_EXPAND(er0, er1, or0, or1);
+            LSH256_STEP(el0, el1, er0, er1, lsh256_step_constants + 8 * j, 29, 1);
+            LSH256_EXPAND(ol0, ol1, el0, el1);
+            LSH256_EXPAND(or0, or1, er0, er1);
+            LSH256_STEP(ol0, ol1, or0, or1, lsh256_step_constants + 8 * (j + 1), 5, 17);
+        }
+        LSH256_EXPAND(el0, el1, ol0, ol1);
+        LSH256_EXPAND(er0, er1, or0, or1);
+        l0 = _mm_xor_si128(l0, el0);
+        l1 = _mm_xor_si128(l1, el1);
+        r0 = _mm_xor_si128(r0, er0);
+        r1 = _mm_xor_si128(r1, er1);
+    }
+
+    STOREU(cv, l0);
+    STOREU(cv + 4, l1);
+    STOREU(cv + 8, r0);
+    STOREU(cv + 12, r1);
+}
+
+/* ------------------------------------- LSH-512 ------------------------------------- */
+
+#define LSH512_STEP(ml, mr, sc, alpha, beta)                                        \
+    do {                                                                            \
+        for (int k = 0; k < 4; k++) {                                               \
+            l[k] = _mm_xor_si128(l[k], (ml)[k]);                                    \
+            r[k] = _mm_xor_si128(r[k], (mr)[k]);                                    \
+            l[k] = _mm_add_epi64(l[k], r[k]);                                       \
+            l[k] = _mm_xor_si128(ROL64_128(l[k], alpha), LOADU((sc) + 2 * k));      \
+            r[k] = _mm_add_epi64(r[k], l[k]);                                       \
+            r[k] = ROL64_128(r[k], beta);                                           \
+            l[k] = _mm_add_epi64(l[k], r[k]);                                       \
+        }                                                                           \
+        /* gamma = 0, 16 | 32, 48 | 8, 24 | 40, 56 */                               \
+        r[0] = LO_HI(r[0], ROL64_128(r[0], 16));                                    \
+        r[1] = LO_HI(_mm_shuffle_epi32(r[1], _MM_SHUFFLE(2, 3, 0, 1)), ROL64_128(r[1], 48)); \
+        r[2] = LO_HI(ROL64_128(r[2], 8), ROL64_128(r[2], 24));                      \
+        r[3] = LO_HI(ROL64_128(r[3], 40), ROL64_128(r[3], 56));                     \
+        t[0] = _mm_unpacklo_epi64(l[3], l[2]);                                      \
+        t[1] = _mm_unpackhi_epi64(l[2], l[3]);                                      \
+        t[2] = LO_HI(r[2], r[3]);                                                   \
+        t[3] = LO_HI(r[3], r[2]);                                                   \
+        r[2] = LO_HI(r[0], r[1]);                                                   \
+        r[3] = LO_HI(r[1], r[0]);                                                   \
+        r[0] = _mm_unpacklo_epi64(l[1], l[0]);                                      \
+        r[1] = _mm_unpackhi_epi64(l[0], l[1]);                                      \
+        l[0] = t[0]; l[1] = t[1]; l[2] = t[2]; l[3] = t[3];                         \
+    } while (0)
+
+/* Next message block of a parity from the previous block (p) and its own last block (m) */
+static inline __attribute__((always_inline, target("sse2")))
+void lsh512_expand_sse2(__m128i *m, const __m128i *p) {
+    __m128i m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3];
+
+    m[0] = _mm_add_epi64(p[0], _mm_shuffle_epi32(m1, _MM_SHUFFLE(1, 0, 3, 2)));    // m3, m2
+    m[1] = _mm_add_epi64(p[1], m0);                                                 // m0, m1
+    m[2] = _mm_add_epi64(p[2], HI_LO(m3, m2));              // m7, m4
+    m[3] = _mm_add_epi64(p[3], HI_LO(m2, m3));              // m5, m6
+}
+
+__attribute__((target("sse2")))
+void lsh512_compress_sse2(u64 *cv, const u8 *in, size_t nblocks) {
+    __m128i l[4], r[4], t[4], el[4], er[4], ol[4], or_[4];
+
+    for (int k = 0; k < 4; k++) {
+        l[k] = LOADU(cv + 2 * k);
+        r[k] = LOADU(cv + 8 + 2 * k);
+    }
+
+    for (; nblocks; nblocks--, in += LSH_LSH512_BLOCK_SIZE) {
+        for (int k = 0; k < 4; k++) {
+            el[k] = LOADU(in + 16 * k);
+            er[k] = LOADU(in + 64 + 16 * k);
+            ol[k] = LOADU(in + 128 + 16 * k);
+            or_[k] = LOADU(in + 192 + 16 * k);
+        }
+
+        LSH512_STEP(el, er, lsh512_step_constants, 23, 59);
+        LSH512_STEP(ol, or_, lsh512_step_constants + 8, 7, 3);
+        for (int j = 2; j < LSH_LSH512_STEPS; j += 2) {
+            lsh512_expand_sse2(el, ol);
+            lsh512_expand_sse2(er, or_);
+            LSH512_STEP(el, er, lsh512_step_constants + 8 * j, 23, 59);
+            lsh512_expand_sse2(ol, el);
+            lsh512_expand_sse2(or_, er);
+            LSH512_STEP(ol, or_, lsh512_step_constants + 8 * (j + 1), 7, 3);
+        }
+        lsh512_expand_sse2(el, ol);
+        lsh512_expand_sse2(er, or_);
+        for (int k = 0; k < 4; k++) {
+            l[k] = _mm_xor_si128(l[k], el[k]);
+            r[k] = _mm_xor_si128(r[k], er[k]);
+        }
+    }
+
+    for (int k = 0; k < 4; k++) {
+        STOREU(cv + 2 * k, l[k]);
+        STOREU(cv + 8 + 2 * k, r[k]);
+    }
+}
+
+#endif /* LSH_HAVE_X86 */
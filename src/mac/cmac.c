@@ -0,0 +1,203 @@
+/* File: src/mac/cmac.c */
+
+/**
+ * @file cmac.c
+ * @brief This file implements CMAC (NIST SP 800-38B) on top of the block cipher API.
+ * @details CMAC is CBC-MAC with the final block masked by a subkey: K1 = dbl(E_K(0)) for a complete
+ *          final block, K2 = dbl(K1) for a final block padded with 10*. Since a single chain is
+ *          serial, cmac_multi interleaves up to CMAC_MAX_LANES chains: in every step the next block
+ *          of each active message is XORed into its chaining value and all of them go through the
+ *          cipher's multi-block entry together.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/block_cipher/api_block_cipher.h"
+#include "../../include/mac/cmac.h"
+
+/**
+ * @brief Multiply by x in GF(2^128) (big-endian, reduction 0x87).
+ */
+static void cmac_double(u8 *out, const u8 *in) {
+    u8 carry = in[0] >> 7;
+    for (int i = 0; i < BLOCK_SIZE - 1; i++) {
+        out[i] = (u8)((in[i] << 1) | (in[i + 1] >> 7));
+    }
+    out[BLOCK_SIZE - 1] = (u8)((in[BLOCK_SIZE - 1] << 1) ^ (0x87 & (0 - carry)));
+}
+
+/**
+ * @brief Mask the final block: complete blocks use K1, partial ones are padded with 10* and use K2.
+ */
+static void cmac_last_block(const CmacContext *ctx, u8 *x, const u8 *last, size_t last_len) {
+    if (last_len == BLOCK_SIZE) {
+        for (int i = 0; i < BLOCK_SIZE; i++) x[i] ^= last[i] ^ ctx->k1[i];
+    } else {
+        for (size_t i = 0; i < last_len; i++) x[i] ^= last[i];
+        x[last_len] ^= 0x80;
+        for (int i = 0; i < BLOCK_SIZE; i++) x[i] ^= ctx->k2[i];
+    }
+}
+
+cryptomodule_status_t cmac_init(CmacContext *ctx, BlockCipherType type, const u8 *key, size_t key_len) {
+    if (!ctx || !key) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    if (key_len != 16 && key_len != 24 && key_len != 32) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    const BlockCipherApi *cipher_api = block_cipher_resolve(type, key_len);
+    if (!cipher_api) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->cipher_ctx.cipher_api = cipher_api;
+    if (cipher_api->cipher_init(&ctx->cipher_ctx, key, key_len, BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        cryptomodule_wipe(ctx, sizeof(*ctx));
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+
+    // L = E_K(0^128), K1 = dbl(L), K2 = dbl(K1)
+    u8 L[BLOCK_SIZE] = { 0x00, };
+    if (cipher_api->cipher_process(&ctx->cipher_ctx, L, L, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        cmac_dispose(ctx);
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    cmac_double(ctx->k1, L);
+    cmac_double(ctx->k2, ctx->k1);
+    cryptomodule_wipe(L, sizeof(L));
+
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t cmac_update(CmacContext *ctx, const u8 *msg, size_t msg_len) {
+    if (!ctx || !ctx->cipher_ctx.cipher_api || (msg_len && !msg)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    const BlockCipherApi *cipher_api = ctx->cipher_ctx.cipher_api;
+    while (msg_len > 0) {
+        // A full buffer is only processed once more input shows it is not the last block
+        if (ctx->buf_len == BLOCK_SIZE) {
+            for (int i = 0; i < BLOCK_SIZE; i++) ctx->state[i] ^= ctx->buf[i];
+            if (cipher_api->cipher_process(&ctx->cipher_ctx, ctx->state, ctx->state, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+                return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+            }
+            ctx->buf_len = 0;
+        }
+
+        size_t take = BLOCK_SIZE - ctx->buf_len;
+        if (take > msg_len) take = msg_len;
+        memcpy(ctx->buf + ctx->buf_len, msg, take);
+        ctx->buf_len += take;
+        msg += take;
+        msg_len -= take;
+    }
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t cmac_final(CmacContext *ctx, u8 *mac, size_t mac_len) {
+    if (!ctx || !ctx->cipher_ctx.cipher_api || !mac || mac_len == 0 || mac_len > CMAC_MAC_SIZE) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    cmac_last_block(ctx, ctx->state, ctx->buf, ctx->buf_len);
+    if (ctx->cipher_ctx.cipher_api->cipher_process(
+            &ctx->cipher_ctx, ctx->state, ctx->state, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    memcpy(mac, ctx->state, mac_len);
+
+    // Ready for the next message under the same key
+    memset(ctx->state, 0, sizeof(ctx->state));
+    memset(ctx->buf, 0, sizeof(ctx->buf));
+    ctx->buf_len = 0;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t cmac_multi(
+    CmacContext *ctx,
+    const u8 *const *msgs, const size_t *msg_lens, size_t num_msgs,
+    u8 *macs, size_t mac_len) {
+
+    if (!ctx || !ctx->cipher_ctx.cipher_api || !msgs || !msg_lens || (num_msgs && !macs) ||
+        mac_len == 0 || mac_len > CMAC_MAC_SIZE) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    u8 x[CMAC_MAX_LANES][BLOCK_SIZE];           // Chaining values
+    u8 lanes[CMAC_MAX_LANES * BLOCK_SIZE];      // Gathered cipher inputs of the active chains
+    size_t num_blocks[CMAC_MAX_LANES];          // Blocks per message (an empty message has one)
+    size_t active[CMAC_MAX_LANES];
+
+    for (size_t base = 0; base < num_msgs; base += CMAC_MAX_LANES) {
+        size_t group = num_msgs - base;
+        if (group > CMAC_MAX_LANES) group = CMAC_MAX_LANES;
+
+        size_t max_blocks = 0;
+        for (size_t l = 0; l < group; l++) {
+            if (msg_lens[base + l] && !msgs[base + l]) {
+                return CRYPTOMODULE_ERR_INVALID_INPUT;
+            }
+            num_blocks[l] = msg_lens[base + l] ? (msg_lens[base + l] + BLOCK_SIZE - 1) / BLOCK_SIZE : 1;
+            if (num_blocks[l] > max_blocks) max_blocks = num_blocks[l];
+            memset(x[l], 0, BLOCK_SIZE);
+        }
+
+        // Step j: block j of every message that has one, in one multi-block call
+        for (size_t j = 0; j < max_blocks; j++) {
+            size_t n = 0;
+            for (size_t l = 0; l < group; l++) {
+                if (j >= num_blocks[l]) continue;
+
+                const u8 *blk = msgs[base + l] + j * BLOCK_SIZE;
+                if (j + 1 < num_blocks[l]) {
+                    for (int i = 0; i < BLOCK_SIZE; i++) x[l][i] ^= blk[i];
+                } else {
+                    cmac_last_block(ctx, x[l], blk, msg_lens[base + l] - j * BLOCK_SIZE);
+                }
+                memcpy(lanes + n * BLOCK_SIZE, x[l], BLOCK_SIZE);
+                active[n++] = l;
+            }
+
+            if (block_cipher_process_blocks(&ctx->cipher_ctx, lanes, lanes, n, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+                return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+            }
+            for (size_t k = 0; k < n; k++) {
+                memcpy(x[active[k]], lanes + k * BLOCK_SIZE, BLOCK_SIZE);
+            }
+        }
+
+        for (size_t l = 0; l < group; l++) {
+            memcpy(macs + (base + l) * mac_len, x[l], mac_len);
+        }
+    }
+
+    cryptomodule_wipe(x, sizeof(x));
+    cryptomodule_wipe(lanes, sizeof(lanes));
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t cmac(
+    BlockCipherType type, const u8 *key, size_t key_len,
+    const u8 *msg, size_t msg_len,
+    u8 *mac, size_t mac_len) {
+
+    CmacContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    cryptomodule_status_t status = cmac_init(&ctx, type, key, key_len);
+    if (status == CRYPTOMODULE_OK) status = cmac_update(&ctx, msg, msg_len);
+    if (status == CRYPTOMODULE_OK) status = cmac_final(&ctx, mac, mac_len);
+    cmac_dispose(&ctx);
+    return status;
+}
+
+void cmac_dispose(CmacContext *ctx) {
+    if (ctx) {
+        if (ctx->cipher_ctx.cipher_api && ctx->cipher_ctx.cipher_api->cipher_dispose) {
+            ctx->cipher_ctx.cipher_api->cipher_dispose(&ctx->cipher_ctx);
+        }
+        cryptomodule_wipe(ctx, sizeof(*ctx));
+    }
+}
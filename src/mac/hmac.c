@@ -0,0 +1,150 @@
+/* File: src/mac/hmac.c */
+
+/**
+ * @file hmac.c
+ * @brief This file implements HMAC (FIPS 198-1) on top of the SHA-2 incremental API.
+ * @details HMAC(K, m) = H((K0 ^ opad) || H((K0 ^ ipad) || m)), where K0 is the key (hashed first
+ *          if it is longer than a block) padded with zeros to a block. The first block of both
+ *          hashes only depends on the key, so hmac_init runs it once and stores the two midstates;
+ *          hmac_final finishes the inner hash and feeds its digest to a copy of the outer midstate,
+ *          which takes a single compression.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/mac/hmac.h"
+
+size_t hmac_mac_size(HmacHashType hash) {
+    switch (hash) {
+    case HMAC_SHA224: return SHA2_SHA224_DIGEST_SIZE;
+    case HMAC_SHA256: return SHA2_SHA256_DIGEST_SIZE;
+    case HMAC_SHA384: return SHA2_SHA384_DIGEST_SIZE;
+    case HMAC_SHA512: return SHA2_SHA512_DIGEST_SIZE;
+    default:          return 0;
+    }
+}
+
+static void hmac_hash_init(HmacHashType hash, HmacHashState *state) {
+    switch (hash) {
+    case HMAC_SHA224: SHA2_sha224_inc_init(&state->sha256); break;
+    case HMAC_SHA256: SHA2_sha256_inc_init(&state->sha256); break;
+    case HMAC_SHA384: SHA2_sha384_inc_init(&state->sha512); break;
+    default:          SHA2_sha512_inc_init(&state->sha512); break;
+    }
+}
+
+static void hmac_hash_update(HmacHashType hash, HmacHashState *state, const u8 *in, size_t len) {
+    if (hash == HMAC_SHA224 || hash == HMAC_SHA256) {
+        SHA2_sha256_inc(&state->sha256, in, len);
+    } else {
+        SHA2_sha512_inc(&state->sha512, in, len);
+    }
+}
+
+/* Finish the hash of state || in (the state is wiped) */
+static void hmac_hash_final(HmacHashType hash, u8 *out, HmacHashState *state, const u8 *in, size_t len) {
+    switch (hash) {
+    case HMAC_SHA224: SHA2_sha224_inc_finalize(out, &state->sha256, in, len); break;
+    case HMAC_SHA256: SHA2_sha256_inc_finalize(out, &state->sha256, in, len); break;
+    case HMAC_SHA384: SHA2_sha384_inc_finalize(out, &state->sha512, in, len); break;
+    default:          SHA2_sha512_inc_finalize(out, &state->sha512, in, len); break;
+    }
+}
+
+cryptomodule_status_t hmac_init(HmacContext *ctx, HmacHashType hash, const u8 *key, size_t key_len) {
+    if (!ctx || (key_len && !key)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    size_t mac_size = hmac_mac_size(hash);
+    if (mac_size == 0) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->hash = hash;
+    ctx->mac_size = mac_size;
+    ctx->block_size = (hash == HMAC_SHA224 || hash == HMAC_SHA256) ? SHA2_SHA256_BLOCK_SIZE : SHA2_SHA512_BLOCK_SIZE;
+
+    // K0: the key, or its hash if it is longer than a block, padded with zeros
+    u8 k0[HMAC_MAX_BLOCK_SIZE] = { 0x00, };
+    if (key_len > ctx->block_size) {
+        HmacHashState state;
+        hmac_hash_init(hash, &state);
+        hmac_hash_final(hash, k0, &state, key, key_len);
+    } else if (key_len) {
+        memcpy(k0, key, key_len);
+    }
+
+    u8 pad[HMAC_MAX_BLOCK_SIZE];
+    for (size_t i = 0; i < ctx->block_size; i++) pad[i] = k0[i] ^ 0x36;
+    hmac_hash_init(hash, &ctx->inner_key);
+    hmac_hash_update(hash, &ctx->inner_key, pad, ctx->block_size);
+
+    for (size_t i = 0; i < ctx->block_size; i++) pad[i] = k0[i] ^ 0x5c;
+    hmac_hash_init(hash, &ctx->outer_key);
+    hmac_hash_update(hash, &ctx->outer_key, pad, ctx->block_size);
+
+    ctx->inner = ctx->inner_key;
+    ctx->keyed = true;
+
+    cryptomodule_wipe(k0, sizeof(k0));
+    cryptomodule_wipe(pad, sizeof(pad));
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hmac_update(HmacContext *ctx, const u8 *msg, size_t msg_len) {
+    if (!ctx || !ctx->keyed || (msg_len && !msg)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    hmac_hash_update(ctx->hash, &ctx->inner, msg, msg_len);
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hmac_final(HmacContext *ctx, u8 *mac, size_t mac_len) {
+    if (!ctx || !ctx->keyed || !mac || mac_len == 0 || mac_len > ctx->mac_size) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    u8 digest[HMAC_MAX_MAC_SIZE];
+    hmac_hash_final(ctx->hash, digest, &ctx->inner, NULL, 0);
+
+    // The outer hash is the opad midstate plus one block holding the inner digest
+    HmacHashState outer = ctx->outer_key;
+    hmac_hash_final(ctx->hash, digest, &outer, digest, ctx->mac_size);
+    memcpy(mac, digest, mac_len);
+
+    // Ready for the next message under the same key
+    ctx->inner = ctx->inner_key;
+    cryptomodule_wipe(digest, sizeof(digest));
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hmac_ctx_clone(HmacContext *dest, const HmacContext *src) {
+    if (!dest || !src || !src->keyed) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memcpy(dest, src, sizeof(*dest));
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hmac(
+    HmacHashType hash, const u8 *key, size_t key_len,
+    const u8 *msg, size_t msg_len,
+    u8 *mac, size_t mac_len) {
+
+    HmacContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    cryptomodule_status_t status = hmac_init(&ctx, hash, key, key_len);
+    if (status == CRYPTOMODULE_OK) status = hmac_update(&ctx, msg, msg_len);
+    if (status == CRYPTOMODULE_OK) status = hmac_final(&ctx, mac, mac_len);
+    hmac_dispose(&ctx);
+    return status;
+}
+
+void hmac_dispose(HmacContext *ctx) {
+    if (ctx) {
+        cryptomodule_wipe(ctx, sizeof(*ctx));
+    }
+}
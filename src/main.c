@@ -8,8 +8,13 @@
 #include <unistd.h>
 
 // #define BLOCK_CIPHER_TEST_FLAG 1
+// #define MODE_KAT_TEST_FLAG 1
 #define MODE_OF_OPERATION_TEST_FLAG 1
 // #define PADDING_TEST_FLAG 1
+// #define HASH_TEST_FLAG 1
+// #define MAC_TEST_FLAG 1
+// #define KDF_TEST_FLAG 1
+// #define RNG_TEST_FLAG 1
 
 int main(void) {
 
@@ -17,13 +22,56 @@ int main(void) {
     // KAT_TEST_BLOCKCIPHER(BLOCK_CIPHER_AES192);
     // KAT_TEST_BLOCKCIPHER(BLOCK_CIPHER_AES256);
 
+#ifdef MODE_KAT_TEST_FLAG
+    KAT_TEST_MODE_ECB(BLOCK_CIPHER_AES128);
+    KAT_TEST_MODE_ECB(BLOCK_CIPHER_AES192);
+    KAT_TEST_MODE_ECB(BLOCK_CIPHER_AES256);
+    KAT_TEST_AES_BATCH();
+    KAT_TEST_MODE_CBC_CTR();
+    TEST_CTR_SEEK();
+    KAT_TEST_MODE_XTS();
+    KAT_TEST_MODE_CCM();
+    KAT_TEST_MODE_GCM_SIV();
+    KAT_TEST_KW();
+    TEST_ALLOCATOR();
+    TEST_SECURE_ARENA();
+#endif
+
+#ifdef HASH_TEST_FLAG
+    cryptomodule_init();
+    TEST_CPU_DISPATCH();
+    DIFF_TEST_SHA2_BACKENDS();
+    KAT_TEST_SHA3(224);
+    KAT_TEST_SHA3(256);
+    KAT_TEST_SHA3(384);
+    KAT_TEST_SHA3(512);
+    DIFF_TEST_SHA3_X4();
+    KAT_TEST_LSH();
+#endif
+
+#ifdef MAC_TEST_FLAG
+    KAT_TEST_HMAC();
+    KAT_TEST_CMAC();
+#endif
+
+#ifdef KDF_TEST_FLAG
+    cryptomodule_init();
+    KAT_TEST_PBKDF2();
+    KAT_TEST_HKDF();
+#endif
+
+#ifdef RNG_TEST_FLAG
+    KAT_TEST_CTR_DRBG();
+    KAT_TEST_HMAC_DRBG();
+    KAT_TEST_HASH_DRBG();
+#endif
+
 #ifdef MODE_OF_OPERATION_TEST_FLAG
    // 1) Prepare key and IV
    uint8_t key[16] = {
         0x00,0x01,0x02,0x03, 0x04,0x05,0x06,0x07,
         0x08,0x09,0x0A,0x0B, 0x0C,0x0D,0x0E,0x0F
     };
-    uint8_t iv[16] = { 0 };     // for CBC/CTR/GCM
 
     printf("                    Key (%u): ", 16);
     for (size_t i = 0; i < sizeof(key)/sizeof(u8); i++) {
@@ -59,54 +107,48 @@ int main(void) {
 
     // For ECB/CBC with padding, ciphertext_len may grow by +block_size
     uint8_t mode_ct[64] = {0};
-    size_t mode_ct_len = pt_max_len;
+    uint8_t mode_dt[64] = {0};
 
     // 3) Set up BlockCipherContext for AES
-
-
     // 4) Choose a mode: ECB or CBC (both defined in mode_api.h)
     ModeOfOperationContext mode_ctx;
-    // BlockCipherContext cipher_ctx;
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = BLOCK_CIPHER_AES128;
+    mode_ctx.mode_state.ecb_internal.padding = MODE_PADDING_PKCS7;
     mode_ctx.mode_api = mode_factory("ECB");
 
     mode_ctx.mode_api->mode_init(
-        &mode_ctx, BLOCK_CIPHER_AES128, key, sizeof(key)/sizeof(u8), NULL, 0, mode_pt, pt_len, BLOCK_CIPHER_ENCRYPTION);
-    // printf("Total length: %zu\n", mode_ctx.total_len);
-
-    // size_t total_block_size = pkcs7_pad(pt, msg_len, BLOCK_SIZE);
+        &mode_ctx, key, sizeof(key)/sizeof(u8), NULL, 0, mode_pt, pt_len, BLOCK_CIPHER_ENCRYPTION);
+    size_t total_len = mode_ctx.mode_state.ecb_internal.total_len;
 
-    // printf("            Key: ");
-    // for (size_t i = 0; i < sizeof(key)/sizeof(u8); i++) {
-    //     printf("%02X ", key[i]);
-    // }
-    // puts("");
-    // printf("            IV: ");
-    // for (size_t i = 0; i < sizeof(iv)/sizeof(u8); i++) {
-    //     printf("%02X ", iv[i]);
-    // }
-    // puts("");
-    printf("      Padded Plaintext: (%2zu): ", mode_ctx.total_len);
-    for (size_t i = 0; i < mode_ctx.total_len; i++) {
+    printf("      Padded Plaintext: (%2zu): ", total_len);
+    for (size_t i = 0; i < total_len; i++) {
         printf("(%ld)%02X:", i, mode_pt[i]);
     } puts("");
 
-    mode_ctx.mode_api->mode_update(
-        &mode_ctx, mode_pt, mode_ct, mode_ctx.total_len, BLOCK_CIPHER_ENCRYPTION);
-    
-    printf("   (Update) Ciphertext: (%2zu): ", mode_ctx.total_len);
-    for (size_t i = 0; i < mode_ctx.total_len; i++) {
+    mode_ctx.mode_api->mode_process(
+        &mode_ctx, mode_pt, mode_ct, total_len, BLOCK_CIPHER_ENCRYPTION);
+    mode_ctx.mode_api->mode_dispose(&mode_ctx);
+
+    printf("  (Process) Ciphertext: (%2zu): ", total_len);
+    for (size_t i = 0; i < total_len; i++) {
         printf("(%ld)%02X:", i, mode_ct[i]);
     } puts("");
 
-
-    // mode_ctx.api->mode_update(&mode_ctx, pt, ciphertext, pt_max_len, ciphertext_len, BLOCK_CIPHER_ENCRYPTION);
-    // mode_ctx.api->mode_dispose(&mode_ctx);
-    // cipher_ctx.cipher_api->cipher_dispose(&cipher_ctx);
-    // printf("            Ciphertext: (%2zu): ", ciphertext_len);
-    // for (size_t i = 0; i < ciphertext_len; i++) {
-    //     printf("%02X ", ciphertext[i]);
-    // }
-    // puts("");
+    clear_mode_ctx(&mode_ctx);
+    mode_ctx.cipher_type = BLOCK_CIPHER_AES128;
+    mode_ctx.mode_api = mode_factory("ECB");
+    mode_ctx.mode_api->mode_init(
+        &mode_ctx, key, sizeof(key)/sizeof(u8), NULL, 0, NULL, 0, BLOCK_CIPHER_DECRYPTION);
+    mode_ctx.mode_api->mode_process(
+        &mode_ctx, mode_ct, mode_dt, total_len, BLOCK_CIPHER_DECRYPTION);
+    mode_ctx.mode_api->mode_dispose(&mode_ctx);
+    size_t dt_len = mode_unpad(MODE_PADDING_PKCS7, mode_dt, total_len, BLOCK_SIZE);
+
+    printf("   (Process) Decrypted: (%2zu): ", dt_len);
+    for (size_t i = 0; i < dt_len; i++) {
+        printf("(%ld)%02X:", i, mode_dt[i]);
+    } puts("");
 
     free(mode_pt);
 
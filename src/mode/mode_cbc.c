@@ -4,6 +4,9 @@
  * @brief This file implements the CBC (Cipher Block Chaining) mode of operation for block ciphers.
  * @details The CBC mode is a widely used mode of operation for block ciphers.
  *          It provides confidentiality by chaining the encryption of each block with the previous block's ciphertext.
+ *          cbc_init selects the fused kernel of the cipher type and direction once
+ *          (block_cipher_get_mode_kernels), and cbc_process hands it the whole buffer. Ciphers without
+ *          fused kernels get the generic ones below, which go through the cipher API per block.
  */
 
 #include "../../include/block_cipher/api_block_cipher.h"
@@ -32,6 +35,32 @@ static const ModeOfOperationApi CBC_MODE_API = {
 
 const ModeOfOperationApi *get_cbc_api(void) { return &CBC_MODE_API; }
 
+static void cbc_encrypt_generic(
+    BlockCipherContext *cipher_ctx, u8 iv[BLOCK_SIZE], const u8 *in, u8 *out, size_t num_blocks) {
+    for (; num_blocks; num_blocks--, in += BLOCK_SIZE, out += BLOCK_SIZE) {
+        for (size_t j = 0; j < BLOCK_SIZE; j++) {
+            iv[j] ^= in[j];
+        }
+        cipher_ctx->cipher_api->cipher_process(cipher_ctx, iv, iv, BLOCK_CIPHER_ENCRYPTION);
+        memcpy(out, iv, BLOCK_SIZE);
+    }
+}
+
+static void cbc_decrypt_generic(
+    BlockCipherContext *cipher_ctx, u8 iv[BLOCK_SIZE], const u8 *in, u8 *out, size_t num_blocks) {
+    u8 ct[BLOCK_SIZE], pt[BLOCK_SIZE];
+
+    for (; num_blocks; num_blocks--, in += BLOCK_SIZE, out += BLOCK_SIZE) {
+        memcpy(ct, in, BLOCK_SIZE);  // in may alias out
+        cipher_ctx->cipher_api->cipher_process(cipher_ctx, ct, pt, BLOCK_CIPHER_DECRYPTION);
+        for (size_t j = 0; j < BLOCK_SIZE; j++) {
+            out[j] = pt[j] ^ iv[j];
+        }
+        memcpy(iv, ct, BLOCK_SIZE);
+    }
+    memset(pt, 0, sizeof(pt));
+}
+
 void cbc_init(
     ModeOfOperationContext *mode_ctx,
     const u8 *key, size_t key_len,
@@ -55,31 +84,53 @@ void cbc_init(
         return;
     }
     
-    // Set the mode type and cipher type
+    if (dir != BLOCK_CIPHER_ENCRYPTION && dir != BLOCK_CIPHER_DECRYPTION) {
+        fprintf(stderr, "Invalid direction for CBC mode: %s\n", block_cipher_direction_to_string(dir));
+        return;
+    }
+    
+    // Set the mode type and cipher type (left unset, AES with the size of the key as before)
     mode_ctx->mode_type = MODE_CBC;
-    mode_ctx->cipher_type = mode_ctx->cipher_type;
-    size_t padded_len = iso7816_4_pad(in, in_len, BLOCK_SIZE);
-    in_len = padded_len;
-
+    mode_ctx->mode_api = get_cbc_api();
+    if (mode_ctx->cipher_type == BLOCK_CIPHER_UNKNOWN) {
+        mode_ctx->cipher_type = key_len == AES128_KEY_SIZE ? BLOCK_CIPHER_AES128 :
+                                key_len == AES192_KEY_SIZE ? BLOCK_CIPHER_AES192 : BLOCK_CIPHER_AES256;
+    }
+    if (in) {
+        iso7816_4_pad(in, in_len, BLOCK_SIZE);
+    }
+    
+    const BlockCipherApi *cipher_api = block_cipher_resolve(mode_ctx->cipher_type, key_len);
+    if (!cipher_api) {
+        fprintf(stderr, "Unsupported cipher type for CBC mode: %s\n",
+            block_cipher_type_to_string(mode_ctx->cipher_type));
+        return;
+    }
     
     // Initialize the block cipher context
-    mode_ctx->cipher_ctx = malloc(sizeof(BlockCipherContext));
+    mode_ctx->cipher_ctx = block_cipher_ctx_new(cipher_api);
     if (!mode_ctx->cipher_ctx) {
         fprintf(stderr, "Failed to allocate memory for cipher context\n");
         return;
     }
     
-    // Initialize the block cipher API
-    mode_ctx->cipher_ctx->cipher_api = block_cipher_factory("AES");
-    
     // Initialize the block cipher with the provided key and IV
     if (mode_ctx->cipher_ctx->cipher_api->cipher_init(
             mode_ctx->cipher_ctx, key, key_len, BLOCK_SIZE, dir) != BLOCK_CIPHER_OK) {
         fprintf(stderr, "Error initializing block cipher context\n");
-        free(mode_ctx->cipher_ctx);
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        mode_ctx->cipher_ctx = NULL;
         return;
     }
     
+    // The key schedule fixes the direction: keep the one kernel that matches it
+    const BlockCipherModeKernels *kernels = block_cipher_get_mode_kernels(mode_ctx->cipher_type, key_len);
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {
+        mode_ctx->mode_state.cbc_internal.kernel = kernels ? kernels->cbc_encrypt : cbc_encrypt_generic;
+    } else {
+        mode_ctx->mode_state.cbc_internal.kernel = kernels ? kernels->cbc_decrypt : cbc_decrypt_generic;
+    }
+    
     // Copy the IV into the internal state
     memcpy(mode_ctx->mode_state.cbc_internal.iv, iv, BLOCK_SIZE);
 }
@@ -89,7 +140,9 @@ void cbc_process(
     const u8 *in, u8 *out, size_t padded_len,
     BlockCipherDirection dir) {
     
-    if (!mode_ctx || !in || !out) {
+    (void)dir;  // The direction was fixed by cbc_init (key schedule and kernel)
+
+    if (!mode_ctx || !mode_ctx->cipher_ctx || !mode_ctx->mode_state.cbc_internal.kernel || !in || !out) {
         fprintf(stderr, "Invalid mode context or input/output pointers\n");
         return;
     }
@@ -99,33 +152,16 @@ void cbc_process(
         return;
     }
     
-    // Process the input data for each block
-    for (size_t i = 0; i < padded_len; i += BLOCK_SIZE) {
-        // XOR the input block with the IV or previous ciphertext block
-        for (size_t j = 0; j < BLOCK_SIZE; j++) {
-            mode_ctx->mode_state.cbc_internal.iv[j] ^= in[i + j];
-        }
-        
-        // Encrypt the block using the block cipher
-        if (mode_ctx->cipher_ctx->cipher_api->cipher_process(
-                mode_ctx->cipher_ctx, mode_ctx->mode_state.cbc_internal.iv, out + i, dir) != BLOCK_CIPHER_OK) {
-            fprintf(stderr, "Error processing block in CBC mode\n");
-            return;
-        }
-        
-        // Update the IV to the current ciphertext block
-        memcpy(mode_ctx->mode_state.cbc_internal.iv, out + i, BLOCK_SIZE);
-    }
+    // The kernel chains from the IV and leaves the last ciphertext block in it for the next call
+    mode_ctx->mode_state.cbc_internal.kernel(
+        mode_ctx->cipher_ctx, mode_ctx->mode_state.cbc_internal.iv, in, out, padded_len / BLOCK_SIZE);
 }
 
 void cbc_dispose(ModeOfOperationContext *mode_ctx) {
     if (mode_ctx) {
         // Dispose of the cipher context
-        if (mode_ctx->cipher_ctx && mode_ctx->cipher_ctx->cipher_api->cipher_dispose) {
-            mode_ctx->cipher_ctx->cipher_api->cipher_dispose(mode_ctx->cipher_ctx);
-        }
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
         // Clear the context memory
         memset(mode_ctx, 0, sizeof(*mode_ctx));
-        free(mode_ctx->cipher_ctx);
     }
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+/* FILE: src/mode/mode_ccm.c */
+/**
+ * @file mode_ccm.c
+ * @brief This file implements the CCM (Counter with CBC-MAC) mode of operation (NIST SP 800-38C).
+ * @details CCM authenticates B_0 || encoded AAD || payload with CBC-MAC and encrypts the payload and
+ *          the tag with CTR. The CBC-MAC chain is serial, so instead of two passes each MAC block is
+ *          paired with the CTR block of the same step and both go through the cipher's multi-block
+ *          entry in one call; the CTR block rides along in the otherwise idle second lane. On
+ *          decryption the keystream block is produced one step ahead, since the MAC needs the
+ *          recovered plaintext.
+ */
+
+#include "../../include/block_cipher/api_block_cipher.h"
+#include "../../include/mode/api_mode.h"
+#include "../../include/mode/mode_ccm.h"
+
+static void ccm_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir);
+static void ccm_process_with_tag(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t pt_len,
+    const u8 *aad, size_t aad_len,
+    u8 *tag, size_t tag_len,
+    BlockCipherDirection dir);
+static void ccm_dispose(ModeOfOperationContext *mode_ctx);
+
+static const ModeOfOperationApi CCM_MODE_API = {
+    .mode_name = "CCM",
+    .mode_init = ccm_init,
+    .mode_process = NULL,  // CCM always produces/verifies a tag
+    .mode_process_with_tag = ccm_process_with_tag,
+    .mode_dispose = ccm_dispose
+};
+
+const ModeOfOperationApi *get_ccm_api(void) { return &CCM_MODE_API; }
+
+/*
+ * The IV is the nonce N (7..13 bytes). Only the forward cipher is used in both directions.
+ * The block cipher is taken from mode_ctx->cipher_type. CCM needs no padding, so `in` is unused.
+ */
+void ccm_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir) {
+
+    (void)in; (void)in_len; (void)dir;
+
+    // Initialize the CCM mode context
+    if (!mode_ctx || !key || !iv) {
+        fprintf(stderr, "Invalid mode context, key or IV pointer\n");
+        return;
+    }
+    if (key_len != 16 && key_len != 24 && key_len != 32) {
+        fprintf(stderr, "Invalid key length for CCM mode: %zu\n", key_len);
+        return;
+    }
+    if (iv_len < CCM_MIN_NONCE_LEN || iv_len > CCM_MAX_NONCE_LEN) {
+        fprintf(stderr, "Invalid nonce length for CCM mode: %zu\n", iv_len);
+        return;
+    }
+
+    // Set the mode type and the nonce
+    mode_ctx->mode_type = MODE_CCM;
+    mode_ctx->mode_api = get_ccm_api();
+    mode_ctx->cipher_ctx = NULL;
+    memcpy(mode_ctx->mode_state.ccm_internal.nonce, iv, iv_len);
+    mode_ctx->mode_state.ccm_internal.nonce_len = iv_len;
+    mode_ctx->mode_state.ccm_internal.tag_ok = false;
+
+    // Initialize the block cipher context
+    const BlockCipherApi *cipher_api = block_cipher_resolve(mode_ctx->cipher_type, key_len);
+    if (!cipher_api) {
+        fprintf(stderr, "Unsupported cipher type for CCM mode: %s\n",
+            block_cipher_type_to_string(mode_ctx->cipher_type));
+        return;
+    }
+
+    mode_ctx->cipher_ctx = block_cipher_ctx_new(cipher_api);
+    if (!mode_ctx->cipher_ctx) {
+        fprintf(stderr, "Failed to allocate memory for cipher context\n");
+        return;
+    }
+
+    if (cipher_api->cipher_init(
+            mode_ctx->cipher_ctx, key, key_len, BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error initializing block cipher context\n");
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        mode_ctx->cipher_ctx = NULL;
+        return;
+    }
+}
+
+/**
+ * @brief Set the counter field (last q bytes) of a CTR block to i.
+ */
+static void ccm_set_counter(u8 *ctr_block, size_t q, u64 i) {
+    for (size_t j = 0; j < q; j++) {
+        ctr_block[BLOCK_SIZE - 1 - j] = (j < 8) ? (u8)(i >> (8 * j)) : 0;
+    }
+}
+
+/**
+ * @brief One CBC-MAC step for a (zero-padded) block of up to 16 bytes: X <- X ^ B.
+ */
+static void ccm_mac_absorb(u8 *x, const u8 *blk, size_t len) {
+    for (size_t k = 0; k < len; k++) {
+        x[k] ^= blk[k];
+    }
+}
+
+void ccm_process_with_tag(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t pt_len,
+    const u8 *aad, size_t aad_len,
+    u8 *tag, size_t tag_len,
+    BlockCipherDirection dir) {
+
+    if (!mode_ctx || !mode_ctx->cipher_ctx || (pt_len && (!in || !out)) || (aad_len && !aad) || !tag) {
+        fprintf(stderr, "Invalid mode context or input/output pointers\n");
+        return;
+    }
+    if (tag_len < 4 || tag_len > 16 || (tag_len & 1)) {
+        fprintf(stderr, "Invalid tag length for CCM mode: %zu\n", tag_len);
+        return;
+    }
+
+    struct __ccm_internal__ *ccm = &mode_ctx->mode_state.ccm_internal;
+    BlockCipherContext *cipher_ctx = mode_ctx->cipher_ctx;
+    size_t q = 15 - ccm->nonce_len;  // Octets of the length/counter field
+    ccm->tag_ok = false;
+
+    if (q < 8 && (u64)pt_len >> (8 * q)) {
+        fprintf(stderr, "Payload too long for CCM nonce length %zu: %zu\n", ccm->nonce_len, pt_len);
+        return;
+    }
+
+    // lanes[0] = MAC block (B_0, then X ^ B_i), lanes[1] = counter block Ctr_i; lanes[2] = Ctr_1
+    u8 lanes[3 * BLOCK_SIZE];
+    u8 *x = lanes, *ctr = lanes + BLOCK_SIZE;
+    u8 ctr_base[BLOCK_SIZE], s0[BLOCK_SIZE], ks[BLOCK_SIZE];
+    size_t m = (pt_len + BLOCK_SIZE - 1) / BLOCK_SIZE;  // Payload blocks
+
+    // B_0 = flags || N || Q
+    x[0] = (u8)((aad_len ? 0x40 : 0x00) | (((tag_len - 2) / 2) << 3) | (q - 1));
+    memcpy(x + 1, ccm->nonce, ccm->nonce_len);
+    ccm_set_counter(x, q, (u64)pt_len);
+
+    // Ctr_i = (q - 1) || N || [i]_q; the lane is overwritten by E(Ctr_i), so keep the template
+    ctr_base[0] = (u8)(q - 1);
+    memcpy(ctr_base + 1, ccm->nonce, ccm->nonce_len);
+    ccm_set_counter(ctr_base, q, 0);
+    memcpy(ctr, ctr_base, BLOCK_SIZE);
+    memcpy(lanes + 2 * BLOCK_SIZE, ctr_base, BLOCK_SIZE);
+    ccm_set_counter(lanes + 2 * BLOCK_SIZE, q, 1);
+
+    // Step 0: E(B_0) together with S_0 (and S_1, which decryption needs one step ahead)
+    size_t lead = (dir == BLOCK_CIPHER_DECRYPTION && m) ? 3 : 2;
+    if (block_cipher_process_blocks(cipher_ctx, lanes, lanes, lead, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error processing block in CCM mode\n");
+        return;
+    }
+    memcpy(s0, ctr, BLOCK_SIZE);
+    if (lead == 3) {
+        memcpy(ks, lanes + 2 * BLOCK_SIZE, BLOCK_SIZE);
+    }
+
+    // Associated data: length encoding, then zero-padded blocks (MAC only)
+    if (aad_len) {
+        u8 hdr[10];
+        size_t hdr_len;
+        if ((u64)aad_len < 0xFF00) {
+            hdr[0] = (u8)(aad_len >> 8); hdr[1] = (u8)aad_len;
+            hdr_len = 2;
+        } else if ((u64)aad_len <= 0xFFFFFFFFULL) {
+            hdr[0] = 0xFF; hdr[1] = 0xFE;
+            for (int j = 0; j < 4; j++) hdr[2 + j] = (u8)((u64)aad_len >> (24 - 8 * j));
+            hdr_len = 6;
+        } else {
+            hdr[0] = 0xFF; hdr[1] = 0xFF;
+            for (int j = 0; j < 8; j++) hdr[2 + j] = (u8)((u64)aad_len >> (56 - 8 * j));
+            hdr_len = 10;
+        }
+
+        size_t fill = hdr_len, done = 0;
+        ccm_mac_absorb(x, hdr, hdr_len);
+        while (1) {
+            size_t take = aad_len - done;
+            if (take > BLOCK_SIZE - fill) take = BLOCK_SIZE - fill;
+            for (size_t k = 0; k < take; k++) x[fill + k] ^= aad[done + k];
+            done += take;
+            cipher_ctx->cipher_api->cipher_process(cipher_ctx, x, x, BLOCK_CIPHER_ENCRYPTION);
+            if (done == aad_len) break;
+            fill = 0;
+        }
+    }
+
+    // Payload: one MAC block and one CTR block per cipher call
+    for (size_t i = 1; i <= m; i++) {
+        const u8 *src = in + (i - 1) * BLOCK_SIZE;
+        u8 *dst = out + (i - 1) * BLOCK_SIZE;
+        size_t len = (i < m || pt_len % BLOCK_SIZE == 0) ? BLOCK_SIZE : pt_len % BLOCK_SIZE;
+
+        if (dir == BLOCK_CIPHER_ENCRYPTION) {
+            // Lanes: X ^ P_i and Ctr_i
+            ccm_mac_absorb(x, src, len);
+            memcpy(ctr, ctr_base, BLOCK_SIZE);
+            ccm_set_counter(ctr, q, (u64)i);
+            if (block_cipher_process_blocks(cipher_ctx, lanes, lanes, 2, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+                fprintf(stderr, "Error processing block in CCM mode\n");
+                return;
+            }
+            for (size_t k = 0; k < len; k++) dst[k] = src[k] ^ ctr[k];
+        } else {
+            // P_i from the keystream computed in the previous step, then lanes: X ^ P_i and Ctr_{i+1}
+            u8 p[BLOCK_SIZE];
+            for (size_t k = 0; k < len; k++) p[k] = src[k] ^ ks[k];
+            memcpy(dst, p, len);
+            ccm_mac_absorb(x, p, len);
+            size_t lanes_used = 1;
+            if (i < m) {
+                memcpy(ctr, ctr_base, BLOCK_SIZE);
+                ccm_set_counter(ctr, q, (u64)(i + 1));
+                lanes_used = 2;
+            }
+            if (block_cipher_process_blocks(cipher_ctx, lanes, lanes, lanes_used, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+                fprintf(stderr, "Error processing block in CCM mode\n");
+                return;
+            }
+            memcpy(ks, ctr, BLOCK_SIZE);
+        }
+    }
+
+    // T = MSB_t(X) ^ MSB_t(S_0)
+    u8 t[BLOCK_SIZE];
+    for (size_t k = 0; k < tag_len; k++) t[k] = x[k] ^ s0[k];
+
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {
+        memcpy(tag, t, tag_len);
+        ccm->tag_ok = true;
+    } else {
+        u8 diff = 0;
+        for (size_t k = 0; k < tag_len; k++) diff |= (u8)(t[k] ^ tag[k]);
+        ccm->tag_ok = (diff == 0);
+        if (!ccm->tag_ok) {
+            // Do not release unauthenticated plaintext
+            if (pt_len) memset(out, 0, pt_len);
+            fprintf(stderr, "Tag mismatch in CCM mode\n");
+        }
+    }
+    cryptomodule_wipe(lanes, sizeof(lanes));
+    cryptomodule_wipe(ks, sizeof(ks));
+}
+
+void ccm_dispose(ModeOfOperationContext *mode_ctx) {
+    if (mode_ctx) {
+        // Dispose of the cipher context
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        // Clear the context memory
+        memset(mode_ctx, 0, sizeof(*mode_ctx));
+    }
+}
@@ -4,12 +4,19 @@
  * @brief This file implements the CTR (Counter) mode of operation for block ciphers.
  * @details The CTR mode is a widely used mode of operation for block ciphers.
  *          It provides confidentiality by using a counter to generate a unique keystream for each block.
+ *          Counter blocks follow NIST SP 800-38A: the first block uses the IV itself and the whole
+ *          128-bit block is incremented (big-endian). Since keystream block i is E(IV + i), any
+ *          byte offset can be reached directly with ctr_seek() without processing the prefix.
+ *          ctr_init selects the fused CTR kernel of the cipher type once (block_cipher_get_mode_kernels);
+ *          full blocks, partial blocks and seeks all go through that one function pointer.
  */
 
 #include "../../include/block_cipher/api_block_cipher.h"
 #include "../../include/mode/api_mode.h"
 #include "../../include/mode/mode_ctr.h"
 
+#define CTR_BATCH_BLOCKS 8  // Counter blocks encrypted per multi-block cipher call
+
 static void ctr_init(
     ModeOfOperationContext *mode_ctx, 
     const u8 *key, size_t key_len,
@@ -32,6 +39,34 @@ static const ModeOfOperationApi CTR_MODE_API = {
 
 const ModeOfOperationApi *get_ctr_api(void) { return &CTR_MODE_API; }
 
+static void ctr_add(u8 *counter, u64 n);
+
+/* Kernel of ciphers without a fused one: batches of counter blocks through the multi-block entry */
+static void ctr_kernel_generic(
+    BlockCipherContext *cipher_ctx, u8 counter[BLOCK_SIZE], const u8 *in, u8 *out, size_t num_blocks) {
+    u8 ks[CTR_BATCH_BLOCKS * BLOCK_SIZE];
+
+    while (num_blocks > 0) {
+        size_t n = num_blocks > CTR_BATCH_BLOCKS ? CTR_BATCH_BLOCKS : num_blocks;
+
+        for (size_t i = 0; i < n; i++) {
+            memcpy(ks + i * BLOCK_SIZE, counter, BLOCK_SIZE);
+            ctr_add(counter, 1);
+        }
+        if (block_cipher_process_blocks(cipher_ctx, ks, ks, n, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+            fprintf(stderr, "Error processing block in CTR mode\n");
+            break;
+        }
+        for (size_t k = 0; k < n * BLOCK_SIZE; k++) {
+            out[k] = in[k] ^ ks[k];
+        }
+        in += n * BLOCK_SIZE;
+        out += n * BLOCK_SIZE;
+        num_blocks -= n;
+    }
+    memset(ks, 0, sizeof(ks));
+}
+
 void ctr_init(
     ModeOfOperationContext *mode_ctx,
     const u8 *key, size_t key_len,
@@ -39,6 +74,8 @@ void ctr_init(
     u8 *in, size_t in_len,
     BlockCipherDirection dir) {
     
+    (void)in; (void)in_len; (void)dir;  // CTR is a stream mode: no padding, same keystream both ways
+
     // Initialize the CTR mode context
     if (!mode_ctx || !key || !iv) {
         fprintf(stderr, "Invalid mode context, key or IV pointer\n");
@@ -55,32 +92,56 @@ void ctr_init(
         return;
     }
     
-    // Set the mode type and cipher type
+    // Set the mode type and cipher type (left unset, AES with the size of the key as before)
     mode_ctx->mode_type = MODE_CTR;
-    mode_ctx->cipher_type = mode_ctx->cipher_type;
-    size_t padded_len = iso7816_4_pad(in, in_len, BLOCK_SIZE);
-    in_len = padded_len;
+    mode_ctx->mode_api = get_ctr_api();
+    if (mode_ctx->cipher_type == BLOCK_CIPHER_UNKNOWN) {
+        mode_ctx->cipher_type = key_len == AES128_KEY_SIZE ? BLOCK_CIPHER_AES128 :
+                                key_len == AES192_KEY_SIZE ? BLOCK_CIPHER_AES192 : BLOCK_CIPHER_AES256;
+    }
+    
+    const BlockCipherApi *cipher_api = block_cipher_resolve(mode_ctx->cipher_type, key_len);
+    if (!cipher_api) {
+        fprintf(stderr, "Unsupported cipher type for CTR mode: %s\n",
+            block_cipher_type_to_string(mode_ctx->cipher_type));
+        return;
+    }
     
     // Initialize the block cipher context
-    mode_ctx->cipher_ctx = malloc(sizeof(BlockCipherContext));
+    mode_ctx->cipher_ctx = block_cipher_ctx_new(cipher_api);
     if (!mode_ctx->cipher_ctx) {
         fprintf(stderr, "Failed to allocate memory for cipher context\n");
         return;
     }
     
-    // Initialize the block cipher API
-    mode_ctx->cipher_ctx->cipher_api = block_cipher_factory("AES");
-    
-    // Initialize the block cipher with the provided key and IV
+    // The keystream is E(counter) in both directions, so only the encryption key schedule is needed
     if (mode_ctx->cipher_ctx->cipher_api->cipher_init(
-            mode_ctx->cipher_ctx, key, key_len, BLOCK_SIZE, dir) != BLOCK_CIPHER_OK) {
+            mode_ctx->cipher_ctx, key, key_len, BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
         fprintf(stderr, "Error initializing block cipher context\n");
-        free(mode_ctx->cipher_ctx);
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        mode_ctx->cipher_ctx = NULL;
         return;
     }
     
-    // Copy the IV into the internal state
+    const BlockCipherModeKernels *kernels = block_cipher_get_mode_kernels(mode_ctx->cipher_type, key_len);
+    mode_ctx->mode_state.ctr_internal.kernel = kernels ? kernels->ctr : ctr_kernel_generic;
+    
+    // Copy the IV into the internal state; no keystream is buffered yet
+    memcpy(mode_ctx->mode_state.ctr_internal.iv, iv, BLOCK_SIZE);
     memcpy(mode_ctx->mode_state.ctr_internal.counter, iv, BLOCK_SIZE);
+    mode_ctx->mode_state.ctr_internal.ks_used = BLOCK_SIZE;
+}
+
+/**
+ * @brief Add a 64-bit value to a 128-bit big-endian counter block (mod 2^128).
+ */
+static void ctr_add(u8 *counter, u64 n) {
+    u64 carry = n;
+    for (int j = BLOCK_SIZE - 1; j >= 0 && carry; j--) {
+        carry += counter[j];
+        counter[j] = (u8)carry;
+        carry >>= 8;
+    }
 }
 
 void ctr_process(
@@ -88,48 +149,71 @@ void ctr_process(
     const u8 *in, u8 *out, size_t padded_len,
     BlockCipherDirection dir) {
     
+    (void)dir;  // Encryption and decryption are the same operation in CTR mode
+
     // Check for valid input
-    if (!mode_ctx || !in || !out) {
+    if (!mode_ctx || !mode_ctx->cipher_ctx || !mode_ctx->mode_state.ctr_internal.kernel || !in || !out) {
         fprintf(stderr, "Invalid mode context or input/output pointers\n");
         return;
     }
     
-    // Process the input data using the CTR mode
-    size_t block_size = BLOCK_SIZE;
-    size_t num_blocks = padded_len / block_size;
+    struct __ctr_internal__ *ctr = &mode_ctx->mode_state.ctr_internal;
+    size_t len = padded_len;  // Any length: CTR needs no padding
     
-    for (size_t i = 0; i < num_blocks; i++) {
-        // Encrypt the counter value
-        u8 counter_block[BLOCK_SIZE];
-        memcpy(counter_block, mode_ctx->mode_state.ctr_internal.counter, BLOCK_SIZE);
-        
-        // Increment the counter
-        for (int j = BLOCK_SIZE - 1; j >= 0; j--) {
-            if (++counter_block[j] != 0) break;
-        }
-        
-        // Encrypt the counter block
-        mode_ctx->cipher_ctx->cipher_api->cipher_process(
-            mode_ctx->cipher_ctx, counter_block, out + (i * block_size), dir);
-        
-        // XOR with the input block
-        for (size_t k = 0; k < block_size; k++) {
-            out[i * block_size + k] ^= in[i * block_size + k];
+    // Use up the keystream left over from a previous call or a mid-block seek
+    while (len > 0 && ctr->ks_used < BLOCK_SIZE) {
+        *out++ = *in++ ^ ctr->keystream[ctr->ks_used++];
+        len--;
+    }
+    
+    // Full blocks: one kernel call for all of them
+    size_t num_blocks = len / BLOCK_SIZE;
+    if (num_blocks > 0) {
+        ctr->kernel(mode_ctx->cipher_ctx, ctr->counter, in, out, num_blocks);
+        in += num_blocks * BLOCK_SIZE;
+        out += num_blocks * BLOCK_SIZE;
+        len -= num_blocks * BLOCK_SIZE;
+    }
+    
+    // Trailing partial block: keep the unused keystream (the kernel applied to zeros) for the next call
+    if (len > 0) {
+        memset(ctr->keystream, 0, BLOCK_SIZE);
+        ctr->kernel(mode_ctx->cipher_ctx, ctr->counter, ctr->keystream, ctr->keystream, 1);
+        ctr->ks_used = 0;
+        while (len > 0) {
+            *out++ = *in++ ^ ctr->keystream[ctr->ks_used++];
+            len--;
         }
-        
-        // Update the counter in the internal state
-        memcpy(mode_ctx->mode_state.ctr_internal.counter, counter_block, BLOCK_SIZE);
+    }
+}
+
+void ctr_seek(ModeOfOperationContext *mode_ctx, u64 byte_offset) {
+    if (!mode_ctx || !mode_ctx->cipher_ctx || mode_ctx->mode_type != MODE_CTR) {
+        fprintf(stderr, "Invalid mode context for CTR seek\n");
+        return;
+    }
+    
+    struct __ctr_internal__ *ctr = &mode_ctx->mode_state.ctr_internal;
+    
+    // Counter block of the block containing byte_offset: IV + floor(offset / 16)
+    memcpy(ctr->counter, ctr->iv, BLOCK_SIZE);
+    ctr_add(ctr->counter, byte_offset / BLOCK_SIZE);
+    ctr->ks_used = BLOCK_SIZE;
+    
+    // Mid-block offset: generate that block's keystream and skip the bytes before the offset
+    size_t skip = (size_t)(byte_offset % BLOCK_SIZE);
+    if (skip) {
+        memset(ctr->keystream, 0, BLOCK_SIZE);
+        ctr->kernel(mode_ctx->cipher_ctx, ctr->counter, ctr->keystream, ctr->keystream, 1);
+        ctr->ks_used = skip;
     }
 }
 
 void ctr_dispose(ModeOfOperationContext *mode_ctx) {
     if (mode_ctx) {
         // Dispose of the cipher context
-        if (mode_ctx->cipher_ctx && mode_ctx->cipher_ctx->cipher_api->cipher_dispose) {
-            mode_ctx->cipher_ctx->cipher_api->cipher_dispose(mode_ctx->cipher_ctx);
-        }
-        // Clear the context memory
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        // Clear the context memory (including buffered keystream)
         memset(mode_ctx, 0, sizeof(*mode_ctx));
-        free(mode_ctx->cipher_ctx);
     }
-}
\ No newline at end of file
+}
@@ -2,25 +2,46 @@
 
 #include "../../include/mode/api_mode.h"
 
+typedef const ModeOfOperationApi *(*mode_api_getter)(void);
+
+/* Indexed by mode_type_index() */
+static const mode_api_getter mode_apis[MODE_TYPE_COUNT] = {
+    get_ecb_api, get_cbc_api, get_ctr_api, get_gcm_api, get_xts_api, get_ccm_api, get_gcm_siv_api,
+};
+
+static const ModeOfOperationType mode_types[MODE_TYPE_COUNT] = {
+    MODE_ECB, MODE_CBC, MODE_CTR, MODE_GCM, MODE_XTS, MODE_CCM, MODE_GCM_SIV,
+};
+
+const ModeOfOperationApi *mode_get_api(ModeOfOperationType mode) {
+    int index = mode_type_index(mode);
+    return index < 0 ? NULL : mode_apis[index]();
+}
+
 const ModeOfOperationApi *mode_factory(const char *name) {
     if (!name) return NULL;
 
-    if (strcmp(name, "GCM") == 0) {
-        return get_gcm_api();
-    }
-    else if (strcmp(name, "CBC") == 0) {
-        return get_cbc_api();
+    for (int i = 0; i < MODE_TYPE_COUNT; i++) {
+        if (strcmp(name, mode_type_to_string(mode_types[i])) == 0) {
+            return mode_get_api(mode_types[i]);
+        }
     }
-    else if (strcmp(name, "CTR") == 0) {
-        return get_ctr_api();
-    } else {
-       fprintf(stderr, "Invalid cipher type for mode: %s\n", name);
-        return NULL;
-    }
-    // Add more modes as needed
+    fprintf(stderr, "Invalid cipher type for mode: %s\n", name);
     return NULL;
 }
 
+ModeOfOperationContext *mode_ctx_new(void) {
+    return cryptomodule_alloc(sizeof(ModeOfOperationContext));
+}
+
+void mode_ctx_free(ModeOfOperationContext *ctx) {
+    if (!ctx) return;
+    if (ctx->mode_api && ctx->mode_api->mode_dispose) {
+        ctx->mode_api->mode_dispose(ctx);
+    }
+    cryptomodule_free(ctx, sizeof(ModeOfOperationContext));
+}
+
 void print_mode_internal(const ModeOfOperationContext* mode_ctx, const char* mode_type) {
     if (mode_ctx == NULL) {
         printf("ModeOfOperationContext is NULL\n");
@@ -13,8 +13,6 @@
 #include "../../include/cryptomodule_utils.h"
 #include "../../include/api_cryptomodule.h"
 
-static void gf128_Hmul(u8 state[16], const u8 HT[256 * 16], const u8 R0[256], const u8 R1[256]);
-static void ghash(u8* msg, size_t msg_len, u8 HT[256 * 16], u8 R0[256], u8 R1[256], u8 tag[16]);
 
 static const ModeOfOperationApi GCM_MODE_API = {
     .mode_name    = "GCM",
@@ -32,7 +30,8 @@ void gf128_Hmul(u8 state[16], const u8 HT[256 * 16], const u8 R0[256], const u8
     u8 res[16] = { 0x00,}; // Result of the multiplication
     u8 poly;   // Polynomial in GF(2^8)
 
-    for (int i = 0; i < 16; i++) {
+    // Horner over bytes 15..1 (each step multiplies by x^8); byte 0 is added last
+    for (int i = 0; i < 15; i++) {
         poly = state[15 - i];
         const u8* row = HT + (poly << 4);
         for (int j = 0; j < 16; j++)
@@ -51,25 +50,85 @@ void gf128_Hmul(u8 state[16], const u8 HT[256 * 16], const u8 R0[256], const u8
 }
 
 /*
- * ghash: tag <- (…((0 ^ M[0])·H ^ M[1])·H ... ^ M[n-1])·H
+ * ghash: tag <- (…((tag ^ M[0])·H ^ M[1])·H ... ^ M[n-1])·H
  * Uses a 256×16 lookup table for GF(2^128) multiplication.
+ * tag carries the running state, so a zeroed tag starts a new hash and longer inputs can be
+ * hashed in several calls. msg_len is the number of 16-byte blocks.
  */
-void ghash(u8* msg, size_t msg_len, u8 HT[256 * 16], u8 R0[256], u8 R1[256], u8 tag[16]) {
+void ghash(const u8* msg, size_t msg_len, const u8 HT[256 * 16], const u8 R0[256], const u8 R1[256], u8 tag[16]) {
     size_t i, j;
-    u8 out_tag[16] = { 0x00, }; // Output tag
 
     for (i = 0; i < msg_len; i++) {
         const u8 *blk = msg + (i << 4);
 
         for (j = 0; j < 16; j++)
-            out_tag[j] ^= blk[j];
+            tag[j] ^= blk[j];
 
-        gf128_Hmul(out_tag, HT, R0, R1);
+        gf128_Hmul(tag, HT, R0, R1);
     }
+}
 
-    memcpy(tag, out_tag, 16);
+/*
+ * gf128_mulX: state <- state·x in the GHASH bit order (right shift, reduce by 0xE1).
+ */
+static void gf128_mulX(u8 state[16]) {
+    u8 carry = state[15] & 0x01;
+    for (int i = 15; i > 0; i--)
+        state[i] = (u8)((state[i] >> 1) | (state[i - 1] << 7));
+    state[0] = (u8)((state[0] >> 1) ^ (0xE1 & (0 - carry)));
 }
 
+/*
+ * gcm_init_table: HT[b] = b·H, where the byte b holds the coefficients of x^0..x^7 (MSB first).
+ * The eight single-bit rows are H·x^k; every other row is an XOR of those.
+ */
+void gcm_init_table(u8 HT[256 * 16], const u8 H[16]) {
+    u8 v[16];
+
+    memset(HT, 0, 16);
+    memcpy(v, H, 16);
+    for (int bit = 0x80; bit > 0; bit >>= 1) {
+        memcpy(HT + (bit << 4), v, 16);
+        gf128_mulX(v);
+    }
+    for (int b = 2; b < 256; b <<= 1) {
+        for (int j = 1; j < b; j++) {
+            for (int k = 0; k < 16; k++)
+                HT[((b + j) << 4) + k] = HT[(b << 4) + k] ^ HT[(j << 4) + k];
+        }
+    }
+}
+
+/*
+ * POLYVAL is GHASH with the bytes of every block reversed (RFC 8452, Appendix A):
+ * POLYVAL(H, X) = ByteReverse(GHASH(mulX_GHASH(ByteReverse(H)), ByteReverse(X))).
+ */
+static void gf128_byte_reverse(u8 dst[16], const u8 src[16]) {
+    for (int i = 0; i < 16; i++)
+        dst[i] = src[15 - i];
+}
+
+void polyval_init_table(u8 HT[256 * 16], const u8 H[16]) {
+    u8 h[16];
+
+    gf128_byte_reverse(h, H);
+    gf128_mulX(h);
+    gcm_init_table(HT, h);
+    memset(h, 0, sizeof(h));
+}
+
+void polyval(const u8* msg, size_t msg_len, const u8 HT[256 * 16], u8 S[16]) {
+    u8 state[16], blk[16];
+
+    gf128_byte_reverse(state, S);
+    for (size_t i = 0; i < msg_len; i++) {
+        gf128_byte_reverse(blk, msg + (i << 4));
+        for (int j = 0; j < 16; j++)
+            state[j] ^= blk[j];
+        gf128_Hmul(state, HT, R0, R1);
+    }
+    gf128_byte_reverse(S, state);
+}
 
 // /**
 //  * @brief Increment only the low 32 bits of a 128-bit counter (bytes 12-15).
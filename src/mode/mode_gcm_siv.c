@@ -0,0 +1,297 @@
+/* FILE: src/mode/mode_gcm_siv.c */
+/**
+ * @file mode_gcm_siv.c
+ * @brief This file implements AES-GCM-SIV (RFC 8452), a nonce-misuse-resistant AEAD mode.
+ * @details For every nonce, a message-authentication key and a message-encryption key are derived
+ *          from the key-generating key (4 or 6 cipher blocks, computed in one multi-block call).
+ *          The tag is the encryption of POLYVAL(AAD, plaintext, lengths) XOR nonce, and the tag
+ *          (with its top bit set) is the initial counter of a CTR pass with a 32-bit little-endian
+ *          counter. POLYVAL runs on the GHASH table code of mode_gcm.c; the CTR pass produces
+ *          GCM_SIV_BATCH_BLOCKS keystream blocks per multi-block cipher call.
+ */
+
+#include "../../include/block_cipher/api_block_cipher.h"
+#include "../../include/mode/api_mode.h"
+#include "../../include/mode/mode_gcm.h"
+#include "../../include/mode/mode_gcm_siv.h"
+
+#define GCM_SIV_BATCH_BLOCKS 8      // Keystream blocks per multi-block cipher call
+#define GCM_SIV_TAG_LEN      16     // GCM-SIV tags are always 16 bytes
+#define GCM_SIV_MAX_LEN      (1ULL << 36)  // Maximum plaintext / AAD length in bytes
+
+static void gcm_siv_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir);
+static void gcm_siv_process_with_tag(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t pt_len,
+    const u8 *aad, size_t aad_len,
+    u8 *tag, size_t tag_len,
+    BlockCipherDirection dir);
+static void gcm_siv_dispose(ModeOfOperationContext *mode_ctx);
+
+static const ModeOfOperationApi GCM_SIV_MODE_API = {
+    .mode_name = "GCM-SIV",
+    .mode_init = gcm_siv_init,
+    .mode_process = NULL,  // GCM-SIV always produces/verifies a tag
+    .mode_process_with_tag = gcm_siv_process_with_tag,
+    .mode_dispose = gcm_siv_dispose
+};
+
+const ModeOfOperationApi *get_gcm_siv_api(void) { return &GCM_SIV_MODE_API; }
+
+/*
+ * The key is the key-generating key (16 or 32 bytes) and the IV the 12-byte nonce.
+ * The per-nonce keys are derived here, so a new nonce needs a new mode_init.
+ * The block cipher is taken from mode_ctx->cipher_type. GCM-SIV needs no padding, so `in` is unused.
+ */
+void gcm_siv_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir) {
+
+    (void)in; (void)in_len; (void)dir;
+
+    // Initialize the GCM-SIV mode context
+    if (!mode_ctx || !key || !iv) {
+        fprintf(stderr, "Invalid mode context, key or IV pointer\n");
+        return;
+    }
+    if (key_len != 16 && key_len != 32) {
+        fprintf(stderr, "Invalid key length for GCM-SIV mode: %zu\n", key_len);
+        return;
+    }
+    if (iv_len != GCM_IV_LEN) {
+        fprintf(stderr, "Invalid nonce length for GCM-SIV mode: %zu\n", iv_len);
+        return;
+    }
+
+    // Set the mode type and the nonce
+    mode_ctx->mode_type = MODE_GCM_SIV;
+    mode_ctx->mode_api = get_gcm_siv_api();
+    mode_ctx->cipher_ctx = NULL;
+    mode_ctx->mode_state.gcm_siv_internal.polyval_table = NULL;
+    mode_ctx->mode_state.gcm_siv_internal.tag_ok = false;
+    memcpy(mode_ctx->mode_state.gcm_siv_internal.nonce, iv, GCM_IV_LEN);
+
+    const BlockCipherApi *cipher_api = block_cipher_resolve(mode_ctx->cipher_type, key_len);
+    if (!cipher_api) {
+        fprintf(stderr, "Unsupported cipher type for GCM-SIV mode: %s\n",
+            block_cipher_type_to_string(mode_ctx->cipher_type));
+        return;
+    }
+
+    // Key derivation: E_K(LE32(i) || nonce) for i = 0..3 (or 0..5), in one multi-block call
+    BlockCipherContext kgk_ctx;
+    u8 blocks[6 * BLOCK_SIZE] = { 0x00, };
+    u8 auth_key[BLOCK_SIZE], enc_key[32];
+    size_t num_blocks = (key_len == 32) ? 6 : 4;
+
+    clear_block_cipher_ctx(&kgk_ctx);
+    kgk_ctx.cipher_api = cipher_api;
+    if (cipher_api->cipher_init(&kgk_ctx, key, key_len, BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error initializing block cipher context\n");
+        return;
+    }
+    for (size_t i = 0; i < num_blocks; i++) {
+        blocks[i * BLOCK_SIZE] = (u8)i;
+        memcpy(blocks + i * BLOCK_SIZE + 4, iv, GCM_IV_LEN);
+    }
+    block_cipher_status_t status = block_cipher_process_blocks(
+        &kgk_ctx, blocks, blocks, num_blocks, BLOCK_CIPHER_ENCRYPTION);
+    if (cipher_api->cipher_dispose) {
+        cipher_api->cipher_dispose(&kgk_ctx);
+    }
+    cryptomodule_wipe(&kgk_ctx, sizeof(kgk_ctx));
+    if (status != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error deriving GCM-SIV keys\n");
+        return;
+    }
+
+    // The first 8 bytes of each block: 2 blocks of authentication key, 2 (or 4) of encryption key
+    for (size_t i = 0; i < num_blocks; i++) {
+        u8 *dst = (i < 2) ? auth_key + 8 * i : enc_key + 8 * (i - 2);
+        memcpy(dst, blocks + i * BLOCK_SIZE, 8);
+    }
+    cryptomodule_wipe(blocks, sizeof(blocks));
+
+    // POLYVAL table for the authentication key
+    mode_ctx->mode_state.gcm_siv_internal.polyval_table = (u8*)cryptomodule_alloc(GCM_TABLE_SIZE);
+    mode_ctx->cipher_ctx = block_cipher_ctx_new(cipher_api);
+    if (!mode_ctx->mode_state.gcm_siv_internal.polyval_table || !mode_ctx->cipher_ctx) {
+        fprintf(stderr, "Failed to allocate memory for GCM-SIV context\n");
+        cryptomodule_free(mode_ctx->mode_state.gcm_siv_internal.polyval_table, GCM_TABLE_SIZE);
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        mode_ctx->mode_state.gcm_siv_internal.polyval_table = NULL;
+        mode_ctx->cipher_ctx = NULL;
+        cryptomodule_wipe(auth_key, sizeof(auth_key));
+        cryptomodule_wipe(enc_key, sizeof(enc_key));
+        return;
+    }
+    polyval_init_table(mode_ctx->mode_state.gcm_siv_internal.polyval_table, auth_key);
+
+    // Message-encryption key schedule
+    if (cipher_api->cipher_init(
+            mode_ctx->cipher_ctx, enc_key, key_len, BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error initializing block cipher context\n");
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        mode_ctx->cipher_ctx = NULL;
+    }
+    cryptomodule_wipe(auth_key, sizeof(auth_key));
+    cryptomodule_wipe(enc_key, sizeof(enc_key));
+}
+
+/**
+ * @brief Absorb len bytes into POLYVAL, zero-padding the final partial block.
+ */
+static void gcm_siv_polyval_padded(const u8 *HT, u8 S[16], const u8 *data, size_t len) {
+    size_t full = len / BLOCK_SIZE;
+    if (full) {
+        polyval(data, full, HT, S);
+    }
+    if (len % BLOCK_SIZE) {
+        u8 last[BLOCK_SIZE] = { 0x00, };
+        memcpy(last, data + full * BLOCK_SIZE, len % BLOCK_SIZE);
+        polyval(last, 1, HT, S);
+    }
+}
+
+/**
+ * @brief Compute the tag E(POLYVAL(AAD, PT, lengths) ^ nonce, top bit cleared).
+ */
+static int gcm_siv_tag(ModeOfOperationContext *mode_ctx,
+                       const u8 *pt, size_t pt_len, const u8 *aad, size_t aad_len, u8 tag[16]) {
+    struct __gcm_siv_internal__ *siv = &mode_ctx->mode_state.gcm_siv_internal;
+    u8 S[BLOCK_SIZE] = { 0x00, };
+    u8 length_block[BLOCK_SIZE];
+
+    gcm_siv_polyval_padded(siv->polyval_table, S, aad, aad_len);
+    gcm_siv_polyval_padded(siv->polyval_table, S, pt, pt_len);
+
+    // LE64(bit length of AAD) || LE64(bit length of plaintext)
+    for (int i = 0; i < 8; i++) {
+        length_block[i] = (u8)(((u64)aad_len * 8) >> (8 * i));
+        length_block[8 + i] = (u8)(((u64)pt_len * 8) >> (8 * i));
+    }
+    polyval(length_block, 1, siv->polyval_table, S);
+
+    for (int i = 0; i < GCM_IV_LEN; i++) {
+        S[i] ^= siv->nonce[i];
+    }
+    S[15] &= 0x7F;
+    return mode_ctx->cipher_ctx->cipher_api->cipher_process(
+        mode_ctx->cipher_ctx, S, tag, BLOCK_CIPHER_ENCRYPTION) == BLOCK_CIPHER_OK ? 0 : -1;
+}
+
+/**
+ * @brief CTR pass from the tag: counter block = tag | 0x80 in the top byte, 32-bit LE increment.
+ */
+static int gcm_siv_ctr(ModeOfOperationContext *mode_ctx, const u8 tag[16], const u8 *in, u8 *out, size_t len) {
+    u8 ks[GCM_SIV_BATCH_BLOCKS * BLOCK_SIZE];
+    u8 ctr[BLOCK_SIZE];
+    u32 counter;
+
+    memcpy(ctr, tag, BLOCK_SIZE);
+    ctr[15] |= 0x80;
+    counter = (u32)ctr[0] | ((u32)ctr[1] << 8) | ((u32)ctr[2] << 16) | ((u32)ctr[3] << 24);
+
+    while (len > 0) {
+        size_t num_blocks = (len + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        if (num_blocks > GCM_SIV_BATCH_BLOCKS) num_blocks = GCM_SIV_BATCH_BLOCKS;
+
+        for (size_t i = 0; i < num_blocks; i++, counter++) {
+            u8 *blk = ks + i * BLOCK_SIZE;
+            memcpy(blk, ctr, BLOCK_SIZE);
+            blk[0] = (u8)counter;
+            blk[1] = (u8)(counter >> 8);
+            blk[2] = (u8)(counter >> 16);
+            blk[3] = (u8)(counter >> 24);
+        }
+        if (block_cipher_process_blocks(
+                mode_ctx->cipher_ctx, ks, ks, num_blocks, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+            return -1;
+        }
+
+        size_t n = num_blocks * BLOCK_SIZE;
+        if (n > len) n = len;
+        for (size_t k = 0; k < n; k++) {
+            out[k] = in[k] ^ ks[k];
+        }
+        in += n;
+        out += n;
+        len -= n;
+    }
+    cryptomodule_wipe(ks, sizeof(ks));
+    return 0;
+}
+
+void gcm_siv_process_with_tag(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t pt_len,
+    const u8 *aad, size_t aad_len,
+    u8 *tag, size_t tag_len,
+    BlockCipherDirection dir) {
+
+    if (!mode_ctx || !mode_ctx->cipher_ctx || !mode_ctx->mode_state.gcm_siv_internal.polyval_table ||
+        (pt_len && (!in || !out)) || (aad_len && !aad) || !tag) {
+        fprintf(stderr, "Invalid mode context or input/output pointers\n");
+        return;
+    }
+    if (tag_len != GCM_SIV_TAG_LEN) {
+        fprintf(stderr, "Invalid tag length for GCM-SIV mode: %zu\n", tag_len);
+        return;
+    }
+    if ((u64)pt_len > GCM_SIV_MAX_LEN || (u64)aad_len > GCM_SIV_MAX_LEN) {
+        fprintf(stderr, "Input too long for GCM-SIV mode\n");
+        return;
+    }
+
+    struct __gcm_siv_internal__ *siv = &mode_ctx->mode_state.gcm_siv_internal;
+    u8 expected[GCM_SIV_TAG_LEN];
+    siv->tag_ok = false;
+
+    if (dir == BLOCK_CIPHER_ENCRYPTION) {
+        // Pass 1: tag over the plaintext; pass 2: CTR keyed by the tag
+        if (gcm_siv_tag(mode_ctx, in, pt_len, aad, aad_len, expected) != 0 ||
+            gcm_siv_ctr(mode_ctx, expected, in, out, pt_len) != 0) {
+            fprintf(stderr, "Error processing block in GCM-SIV mode\n");
+            return;
+        }
+        memcpy(tag, expected, GCM_SIV_TAG_LEN);
+        siv->tag_ok = true;
+        return;
+    }
+
+    // Decryption: CTR with the received tag, then recompute the tag over the recovered plaintext
+    if (gcm_siv_ctr(mode_ctx, tag, in, out, pt_len) != 0 ||
+        gcm_siv_tag(mode_ctx, out, pt_len, aad, aad_len, expected) != 0) {
+        fprintf(stderr, "Error processing block in GCM-SIV mode\n");
+        if (pt_len) memset(out, 0, pt_len);
+        return;
+    }
+
+    u8 diff = 0;
+    for (size_t k = 0; k < GCM_SIV_TAG_LEN; k++) diff |= (u8)(expected[k] ^ tag[k]);
+    siv->tag_ok = (diff == 0);
+    if (!siv->tag_ok) {
+        // Do not release unauthenticated plaintext
+        if (pt_len) memset(out, 0, pt_len);
+        fprintf(stderr, "Tag mismatch in GCM-SIV mode\n");
+    }
+}
+
+void gcm_siv_dispose(ModeOfOperationContext *mode_ctx) {
+    if (mode_ctx) {
+        // Dispose of the cipher context
+        block_cipher_ctx_free(mode_ctx->cipher_ctx);
+        // The POLYVAL table is derived from the authentication key (cryptomodule_free wipes it)
+        cryptomodule_free(mode_ctx->mode_state.gcm_siv_internal.polyval_table, GCM_TABLE_SIZE);
+        // Clear the context memory
+        memset(mode_ctx, 0, sizeof(*mode_ctx));
+    }
+}
@@ -0,0 +1,278 @@
+/* FILE: src/mode/mode_kw.c */
+/**
+ * @file mode_kw.c
+ * @brief This file implements the KW and KWP key wrapping modes (NIST SP 800-38F, RFC 3394/5649).
+ * @details The wrapping function W runs 6n steps over n semiblocks: B = E(A || R[i]),
+ *          A = MSB64(B) ^ t, R[i] = LSB64(B). The steps of one key are strictly serial, so the batch
+ *          unwrap runs the inverse steps of up to KW_MAX_LANES keys side by side and hands one
+ *          block per key to the cipher's multi-block entry.
+ */
+
+#include "../../include/block_cipher/api_block_cipher.h"
+#include "../../include/mode/api_mode.h"
+#include "../../include/mode/mode_kw.h"
+
+/* Initial values: KW ICV1 and the KWP prefix (ICV2 || 32-bit message length indicator) */
+static const u8 KW_ICV1[KW_SEMIBLOCK_SIZE] = { 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6, 0xA6 };
+static const u8 KW_ICV2[4] = { 0xA6, 0x59, 0x59, 0xA6 };
+
+/* Unwrap state of one wrapped key */
+typedef struct {
+    u8 A[KW_SEMIBLOCK_SIZE];    // Integrity register
+    u8 *R;                      // n semiblocks, unwrapped in place in the output buffer
+    size_t n;                   // Number of semiblocks in R
+    size_t steps;               // 6n, or 1 for a single-block KWP ciphertext
+} kw_lane_t;
+
+/**
+ * @brief A ^= t for the 64-bit big-endian step counter t.
+ */
+static void kw_xor_counter(u8 *A, u64 t) {
+    for (int k = 0; k < KW_SEMIBLOCK_SIZE; k++) {
+        A[KW_SEMIBLOCK_SIZE - 1 - k] ^= (u8)(t >> (8 * k));
+    }
+}
+
+/*
+ * Key a cipher context for the KEK in the given direction.
+ */
+static cryptomodule_status_t kw_cipher_init(
+    BlockCipherContext *cipher_ctx, BlockCipherType type,
+    const u8 *kek, size_t kek_len, BlockCipherDirection dir) {
+
+    if (!kek || (kek_len != 16 && kek_len != 24 && kek_len != 32)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    const BlockCipherApi *cipher_api = block_cipher_resolve(type, kek_len);
+    if (!cipher_api) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    clear_block_cipher_ctx(cipher_ctx);
+    cipher_ctx->cipher_api = cipher_api;
+    if (cipher_api->cipher_init(cipher_ctx, kek, kek_len, BLOCK_SIZE, dir) != BLOCK_CIPHER_OK) {
+        clear_block_cipher_ctx(cipher_ctx);
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    return CRYPTOMODULE_OK;
+}
+
+static void kw_cipher_dispose(BlockCipherContext *cipher_ctx) {
+    if (cipher_ctx->cipher_api && cipher_ctx->cipher_api->cipher_dispose) {
+        cipher_ctx->cipher_api->cipher_dispose(cipher_ctx);
+    }
+    clear_block_cipher_ctx(cipher_ctx);
+}
+
+/**
+ * @brief Check the integrity register of an unwrapped key and return its length (0 on failure).
+ */
+static size_t kw_check(const kw_lane_t *lane, bool padded) {
+    u8 diff = 0;
+
+    if (!padded) {
+        for (int k = 0; k < KW_SEMIBLOCK_SIZE; k++) diff |= (u8)(lane->A[k] ^ KW_ICV1[k]);
+        return diff ? 0 : lane->n * KW_SEMIBLOCK_SIZE;
+    }
+
+    // KWP: ICV2, then 8(n-1) < MLI <= 8n, then zero padding
+    for (int k = 0; k < 4; k++) diff |= (u8)(lane->A[k] ^ KW_ICV2[k]);
+    size_t mli = ((size_t)lane->A[4] << 24) | ((size_t)lane->A[5] << 16) |
+                 ((size_t)lane->A[6] << 8) | (size_t)lane->A[7];
+    size_t max_len = lane->n * KW_SEMIBLOCK_SIZE;
+    if (diff || mli + KW_SEMIBLOCK_SIZE <= max_len || mli > max_len) {
+        return 0;
+    }
+    for (size_t k = mli; k < max_len; k++) diff |= lane->R[k];
+    return diff ? 0 : mli;
+}
+
+/**
+ * @brief Run the inverse wrapping steps of num_lanes keys (at most KW_MAX_LANES) together.
+ * @details Step s of a key with n semiblocks is (j, i) = (5 - s / n, n - s % n), t = n*j + i:
+ *          B = D((A ^ t) || R[i]), A = MSB64(B), R[i] = LSB64(B).
+ *          A single-block KWP ciphertext is one plain decryption of A || R[1].
+ */
+static cryptomodule_status_t kw_unwrap_lanes(BlockCipherContext *cipher_ctx, kw_lane_t *lanes, size_t num_lanes) {
+    u8 blocks[KW_MAX_LANES * BLOCK_SIZE];
+    size_t active[KW_MAX_LANES];
+    size_t max_steps = 0;
+
+    for (size_t l = 0; l < num_lanes; l++) {
+        if (lanes[l].steps > max_steps) max_steps = lanes[l].steps;
+    }
+
+    for (size_t s = 0; s < max_steps; s++) {
+        size_t num = 0;
+        for (size_t l = 0; l < num_lanes; l++) {
+            kw_lane_t *lane = &lanes[l];
+            if (s >= lane->steps) continue;
+
+            size_t i = lane->n - s % lane->n;  // 1-based semiblock index
+            u8 *blk = blocks + num * BLOCK_SIZE;
+            memcpy(blk, lane->A, KW_SEMIBLOCK_SIZE);
+            if (lane->steps > 1) {
+                kw_xor_counter(blk, (u64)lane->n * (5 - s / lane->n) + i);
+            }
+            memcpy(blk + KW_SEMIBLOCK_SIZE, lane->R + (i - 1) * KW_SEMIBLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+            active[num++] = l;
+        }
+
+        if (block_cipher_process_blocks(cipher_ctx, blocks, blocks, num, BLOCK_CIPHER_DECRYPTION) != BLOCK_CIPHER_OK) {
+            return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+        }
+
+        for (size_t k = 0; k < num; k++) {
+            kw_lane_t *lane = &lanes[active[k]];
+            size_t i = lane->n - s % lane->n;
+            memcpy(lane->A, blocks + k * BLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+            memcpy(lane->R + (i - 1) * KW_SEMIBLOCK_SIZE, blocks + k * BLOCK_SIZE + KW_SEMIBLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+        }
+    }
+    cryptomodule_wipe(blocks, sizeof(blocks));
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t kw_wrap(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *in, size_t in_len, u8 *out, size_t *out_len, bool padded) {
+
+    if (!in || !out || !out_len) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    if (padded ? (in_len == 0 || (u64)in_len > 0xFFFFFFFFULL)
+               : (in_len < 2 * KW_SEMIBLOCK_SIZE || in_len % KW_SEMIBLOCK_SIZE)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    BlockCipherContext cipher_ctx;
+    cryptomodule_status_t status = kw_cipher_init(&cipher_ctx, type, kek, kek_len, BLOCK_CIPHER_ENCRYPTION);
+    if (status != CRYPTOMODULE_OK) {
+        return status;
+    }
+
+    // A = ICV, R = key data (zero-padded for KWP), placed directly in the output
+    size_t n = (in_len + KW_SEMIBLOCK_SIZE - 1) / KW_SEMIBLOCK_SIZE;
+    u8 A[KW_SEMIBLOCK_SIZE];
+    u8 *R = out + KW_SEMIBLOCK_SIZE;
+    if (padded) {
+        memcpy(A, KW_ICV2, 4);
+        A[4] = (u8)(in_len >> 24); A[5] = (u8)(in_len >> 16);
+        A[6] = (u8)(in_len >> 8);  A[7] = (u8)in_len;
+    } else {
+        memcpy(A, KW_ICV1, KW_SEMIBLOCK_SIZE);
+    }
+    memmove(R, in, in_len);
+    memset(R + in_len, 0, n * KW_SEMIBLOCK_SIZE - in_len);
+
+    u8 B[BLOCK_SIZE];
+    const BlockCipherApi *cipher_api = cipher_ctx.cipher_api;
+    if (n == 1) {
+        // KWP with at most 8 bytes: a single encryption of A || P
+        memcpy(B, A, KW_SEMIBLOCK_SIZE);
+        memcpy(B + KW_SEMIBLOCK_SIZE, R, KW_SEMIBLOCK_SIZE);
+        if (cipher_api->cipher_process(&cipher_ctx, B, B, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+            status = CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+        }
+        memcpy(A, B, KW_SEMIBLOCK_SIZE);
+        memcpy(R, B + KW_SEMIBLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+    } else {
+        for (size_t j = 0; j < 6 && status == CRYPTOMODULE_OK; j++) {
+            for (size_t i = 1; i <= n; i++) {
+                memcpy(B, A, KW_SEMIBLOCK_SIZE);
+                memcpy(B + KW_SEMIBLOCK_SIZE, R + (i - 1) * KW_SEMIBLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+                if (cipher_api->cipher_process(&cipher_ctx, B, B, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+                    status = CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+                    break;
+                }
+                memcpy(A, B, KW_SEMIBLOCK_SIZE);
+                kw_xor_counter(A, (u64)n * j + i);
+                memcpy(R + (i - 1) * KW_SEMIBLOCK_SIZE, B + KW_SEMIBLOCK_SIZE, KW_SEMIBLOCK_SIZE);
+            }
+        }
+    }
+    memcpy(out, A, KW_SEMIBLOCK_SIZE);
+    cryptomodule_wipe(B, sizeof(B));
+    kw_cipher_dispose(&cipher_ctx);
+
+    if (status != CRYPTOMODULE_OK) {
+        memset(out, 0, (n + 1) * KW_SEMIBLOCK_SIZE);
+        return status;
+    }
+    *out_len = (n + 1) * KW_SEMIBLOCK_SIZE;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t kw_unwrap_batch(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *const *in, const size_t *in_lens, size_t num_keys,
+    u8 *const *out, size_t *out_lens,
+    cryptomodule_status_t *results, bool padded) {
+
+    if (!in || !in_lens || !out || !out_lens) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    BlockCipherContext cipher_ctx;
+    cryptomodule_status_t status = kw_cipher_init(&cipher_ctx, type, kek, kek_len, BLOCK_CIPHER_DECRYPTION);
+    if (status != CRYPTOMODULE_OK) {
+        return status;
+    }
+
+    kw_lane_t lanes[KW_MAX_LANES];
+    size_t index[KW_MAX_LANES];
+    size_t next = 0;
+    size_t min_len = padded ? 2 * KW_SEMIBLOCK_SIZE : 3 * KW_SEMIBLOCK_SIZE;
+
+    while (next < num_keys) {
+        // Fill a group with the next well-formed inputs; malformed ones fail immediately
+        size_t num_lanes = 0;
+        while (next < num_keys && num_lanes < KW_MAX_LANES) {
+            size_t k = next++;
+            out_lens[k] = 0;
+            if (!in[k] || !out[k] || in_lens[k] < min_len || in_lens[k] % KW_SEMIBLOCK_SIZE) {
+                if (results) results[k] = CRYPTOMODULE_ERR_INVALID_INPUT;
+                if (status == CRYPTOMODULE_OK) status = CRYPTOMODULE_ERR_INVALID_INPUT;
+                continue;
+            }
+
+            kw_lane_t *lane = &lanes[num_lanes];
+            lane->n = in_lens[k] / KW_SEMIBLOCK_SIZE - 1;
+            lane->steps = (lane->n == 1) ? 1 : 6 * lane->n;
+            lane->R = out[k];
+            memcpy(lane->A, in[k], KW_SEMIBLOCK_SIZE);
+            memmove(lane->R, in[k] + KW_SEMIBLOCK_SIZE, lane->n * KW_SEMIBLOCK_SIZE);
+            index[num_lanes++] = k;
+        }
+        if (num_lanes == 0) {
+            continue;
+        }
+
+        cryptomodule_status_t group_status = kw_unwrap_lanes(&cipher_ctx, lanes, num_lanes);
+        for (size_t l = 0; l < num_lanes; l++) {
+            size_t k = index[l];
+            size_t len = (group_status == CRYPTOMODULE_OK) ? kw_check(&lanes[l], padded) : 0;
+            cryptomodule_status_t key_status = len ? CRYPTOMODULE_OK : CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+            if (key_status != CRYPTOMODULE_OK) {
+                // Never release key data that failed the integrity check
+                memset(lanes[l].R, 0, lanes[l].n * KW_SEMIBLOCK_SIZE);
+                if (status == CRYPTOMODULE_OK) status = key_status;
+            }
+            out_lens[k] = len;
+            if (results) results[k] = key_status;
+        }
+    }
+
+    cryptomodule_wipe(lanes, sizeof(lanes));
+    kw_cipher_dispose(&cipher_ctx);
+    return status;
+}
+
+cryptomodule_status_t kw_unwrap(
+    BlockCipherType type, const u8 *kek, size_t kek_len,
+    const u8 *in, size_t in_len, u8 *out, size_t *out_len, bool padded) {
+
+    if (!out_len) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+    return kw_unwrap_batch(type, kek, kek_len, &in, &in_len, 1, &out, out_len, NULL, padded);
+}
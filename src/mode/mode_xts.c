@@ -0,0 +1,306 @@
+/* FILE: src/mode/mode_xts.c */
+/**
+ * @file mode_xts.c
+ * @brief This file implements the XTS mode of operation (IEEE 1619 / NIST SP 800-38E) for block ciphers.
+ * @details XTS is the standard mode for sector-based storage encryption. The key is the concatenation
+ *          Key1 || Key2: Key1 encrypts the data and Key2 encrypts the sector number into the tweak.
+ *          Block j of a sector is processed as C = E_K1(P ^ T_j) ^ T_j with T_j = E_K2(i) * x^j in
+ *          GF(2^128), so all blocks of a sector are independent. Tweaks are doubled in batches of
+ *          XTS_BATCH_BLOCKS and the batch is handed to the cipher's multi-block entry in one call.
+ *          A sector that is not a multiple of the block size is finished with ciphertext stealing.
+ *          The block cipher is taken from mode_ctx->cipher_type, so any 128-bit block cipher works.
+ */
+
+#include "../../include/block_cipher/api_block_cipher.h"
+#include "../../include/mode/api_mode.h"
+#include "../../include/mode/mode_xts.h"
+
+#define XTS_BATCH_BLOCKS 8  // Blocks (and tweaks) processed per multi-block cipher call
+
+static void xts_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir);
+static void xts_process(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t padded_len,
+    BlockCipherDirection dir);
+static void xts_dispose(ModeOfOperationContext *mode_ctx);
+
+static const ModeOfOperationApi XTS_MODE_API = {
+    .mode_name = "XTS",
+    .mode_init = xts_init,
+    .mode_process = xts_process,
+    .mode_process_with_tag = NULL,  // XTS does not provide authentication
+    .mode_dispose = xts_dispose
+};
+
+const ModeOfOperationApi *get_xts_api(void) { return &XTS_MODE_API; }
+
+/**
+ * @brief Multiply a tweak by x in GF(2^128) (little-endian convention of IEEE 1619).
+ */
+static void xts_double(u8 *out, const u8 *in) {
+    u8 carry = in[BLOCK_SIZE - 1] >> 7;
+    for (int j = BLOCK_SIZE - 1; j > 0; j--) {
+        out[j] = (u8)((in[j] << 1) | (in[j - 1] >> 7));
+    }
+    out[0] = (u8)((in[0] << 1) ^ (0x87 & (0 - carry)));
+}
+
+/*
+ * Release the cipher contexts allocated by xts_init.
+ */
+static void xts_free_ciphers(ModeOfOperationContext *mode_ctx) {
+    BlockCipherContext *ctxs[2] = { mode_ctx->cipher_ctx, mode_ctx->mode_state.xts_internal.tweak_ctx };
+    for (int i = 0; i < 2; i++) {
+        block_cipher_ctx_free(ctxs[i]);
+    }
+    mode_ctx->cipher_ctx = NULL;
+    mode_ctx->mode_state.xts_internal.tweak_ctx = NULL;
+}
+
+/*
+ * The key is Key1 || Key2 (32, 48 or 64 bytes); the halves must differ (SP 800-38E).
+ * The IV is the 16-byte tweak value of the data unit handled by mode_process.
+ * The block cipher is taken from mode_ctx->cipher_type. XTS needs no padding, so `in` is unused.
+ */
+void xts_init(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *key, size_t key_len,
+    const u8 *iv, size_t iv_len,
+    u8 *in, size_t in_len,
+    BlockCipherDirection dir) {
+
+    (void)in; (void)in_len;
+
+    // Initialize the XTS mode context
+    if (!mode_ctx || !key) {
+        fprintf(stderr, "Invalid mode context, or key pointer\n");
+        return;
+    }
+    if (key_len != 32 && key_len != 48 && key_len != 64) {
+        fprintf(stderr, "Invalid key length for XTS mode: %zu\n", key_len);
+        return;
+    }
+    if (iv && iv_len != BLOCK_SIZE) {
+        fprintf(stderr, "Invalid IV length for XTS mode: %zu\n", iv_len);
+        return;
+    }
+    size_t half_len = key_len / 2;
+    if (memcmp(key, key + half_len, half_len) == 0) {
+        fprintf(stderr, "XTS mode requires two different key halves\n");
+        return;
+    }
+
+    // Set the mode type and the tweak value
+    mode_ctx->mode_type = MODE_XTS;
+    mode_ctx->mode_api = get_xts_api();
+    mode_ctx->cipher_ctx = NULL;
+    mode_ctx->mode_state.xts_internal.tweak_ctx = NULL;
+    if (iv) {
+        memcpy(mode_ctx->mode_state.xts_internal.tweak, iv, BLOCK_SIZE);
+    } else {
+        memset(mode_ctx->mode_state.xts_internal.tweak, 0, BLOCK_SIZE);
+    }
+
+    // Initialize the two block cipher contexts: data (Key1, in `dir`) and tweak (Key2, encryption)
+    const BlockCipherApi *cipher_api = block_cipher_resolve(mode_ctx->cipher_type, half_len);
+    if (!cipher_api) {
+        fprintf(stderr, "Unsupported cipher type for XTS mode: %s\n",
+            block_cipher_type_to_string(mode_ctx->cipher_type));
+        return;
+    }
+
+    mode_ctx->cipher_ctx = block_cipher_ctx_new(cipher_api);
+    mode_ctx->mode_state.xts_internal.tweak_ctx = block_cipher_ctx_new(cipher_api);
+    if (!mode_ctx->cipher_ctx || !mode_ctx->mode_state.xts_internal.tweak_ctx) {
+        fprintf(stderr, "Failed to allocate memory for cipher context\n");
+        xts_free_ciphers(mode_ctx);
+        return;
+    }
+
+    if (cipher_api->cipher_init(
+            mode_ctx->cipher_ctx, key, half_len, BLOCK_SIZE, dir) != BLOCK_CIPHER_OK ||
+        cipher_api->cipher_init(
+            mode_ctx->mode_state.xts_internal.tweak_ctx, key + half_len, half_len,
+            BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        fprintf(stderr, "Error initializing block cipher context\n");
+        xts_free_ciphers(mode_ctx);
+        return;
+    }
+}
+
+/**
+ * @brief Process one data unit whose encrypted tweak T_0 = E_K2(i) is already known.
+ * @details Full blocks are processed XTS_BATCH_BLOCKS at a time: the batch of tweaks is derived by
+ *          repeated doubling, XORed in, run through the cipher in one multi-block call and XORed
+ *          out. With a partial last block the final full block and the partial block are handled
+ *          with ciphertext stealing (the two tweaks are swapped on decryption).
+ */
+static int xts_process_unit(
+    ModeOfOperationContext *mode_ctx, const u8 *tweak0,
+    const u8 *in, u8 *out, size_t len, BlockCipherDirection dir) {
+
+    BlockCipherContext *cipher_ctx = mode_ctx->cipher_ctx;
+    u8 tw[XTS_BATCH_BLOCKS * BLOCK_SIZE];
+    u8 buf[XTS_BATCH_BLOCKS * BLOCK_SIZE];
+    u8 t[BLOCK_SIZE];
+    size_t rem = len % BLOCK_SIZE;
+    // With stealing, the last full block is processed together with the partial one
+    size_t bulk_blocks = len / BLOCK_SIZE - (rem ? 1 : 0);
+
+    memcpy(t, tweak0, BLOCK_SIZE);
+    while (bulk_blocks > 0) {
+        size_t n = bulk_blocks < XTS_BATCH_BLOCKS ? bulk_blocks : XTS_BATCH_BLOCKS;
+
+        // Tweaks for the batch, then P ^ T for all blocks
+        for (size_t i = 0; i < n; i++) {
+            memcpy(tw + i * BLOCK_SIZE, t, BLOCK_SIZE);
+            xts_double(t, t);
+        }
+        for (size_t k = 0; k < n * BLOCK_SIZE; k++) {
+            buf[k] = in[k] ^ tw[k];
+        }
+        if (block_cipher_process_blocks(cipher_ctx, buf, buf, n, dir) != BLOCK_CIPHER_OK) {
+            return -1;
+        }
+        for (size_t k = 0; k < n * BLOCK_SIZE; k++) {
+            out[k] = buf[k] ^ tw[k];
+        }
+
+        in += n * BLOCK_SIZE;
+        out += n * BLOCK_SIZE;
+        bulk_blocks -= n;
+    }
+    if (rem == 0) {
+        return 0;
+    }
+
+    // Ciphertext stealing: `in` now points at the last full block followed by rem bytes
+    u8 t_next[BLOCK_SIZE];
+    const u8 *t_first = t, *t_second = t_next;
+    xts_double(t_next, t);
+    if (dir == BLOCK_CIPHER_DECRYPTION) {
+        // Decryption consumes the last full block with the later tweak
+        t_first = t_next;
+        t_second = t;
+    }
+
+    // Last full block
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        buf[k] = in[k] ^ t_first[k];
+    }
+    if (cipher_ctx->cipher_api->cipher_process(cipher_ctx, buf, buf, dir) != BLOCK_CIPHER_OK) {
+        return -1;
+    }
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        buf[k] ^= t_first[k];
+    }
+
+    // Steal the tail of that block to complete the partial block (inputs read before writing)
+    u8 pp[BLOCK_SIZE];
+    memcpy(pp, in + BLOCK_SIZE, rem);
+    memcpy(pp + rem, buf + rem, BLOCK_SIZE - rem);
+    memcpy(out + BLOCK_SIZE, buf, rem);
+
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        pp[k] ^= t_second[k];
+    }
+    if (cipher_ctx->cipher_api->cipher_process(cipher_ctx, pp, pp, dir) != BLOCK_CIPHER_OK) {
+        return -1;
+    }
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        out[k] = pp[k] ^ t_second[k];
+    }
+    return 0;
+}
+
+/*
+ * Processes one data unit of padded_len bytes (>= 16, any length) with the tweak given as IV.
+ */
+void xts_process(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out, size_t padded_len,
+    BlockCipherDirection dir) {
+
+    if (!mode_ctx || !mode_ctx->cipher_ctx || !mode_ctx->mode_state.xts_internal.tweak_ctx || !in || !out) {
+        fprintf(stderr, "Invalid mode context or input/output pointers\n");
+        return;
+    }
+    if (padded_len < BLOCK_SIZE) {
+        fprintf(stderr, "Invalid data length for XTS mode: %zu\n", padded_len);
+        return;
+    }
+
+    // T_0 = E_K2(tweak value)
+    u8 tweak0[BLOCK_SIZE];
+    BlockCipherContext *tweak_ctx = mode_ctx->mode_state.xts_internal.tweak_ctx;
+    if (tweak_ctx->cipher_api->cipher_process(
+            tweak_ctx, mode_ctx->mode_state.xts_internal.tweak, tweak0,
+            BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK ||
+        xts_process_unit(mode_ctx, tweak0, in, out, padded_len, dir) != 0) {
+        fprintf(stderr, "Error processing block in XTS mode\n");
+        return;
+    }
+}
+
+void xts_process_sectors(
+    ModeOfOperationContext *mode_ctx,
+    const u8 *in, u8 *out,
+    size_t sector_size, size_t num_sectors, u64 first_sector,
+    BlockCipherDirection dir) {
+
+    if (!mode_ctx || !mode_ctx->cipher_ctx || !mode_ctx->mode_state.xts_internal.tweak_ctx || !in || !out) {
+        fprintf(stderr, "Invalid mode context or input/output pointers\n");
+        return;
+    }
+    if (sector_size < BLOCK_SIZE) {
+        fprintf(stderr, "Invalid sector size for XTS mode: %zu\n", sector_size);
+        return;
+    }
+
+    BlockCipherContext *tweak_ctx = mode_ctx->mode_state.xts_internal.tweak_ctx;
+    u8 tweaks[XTS_BATCH_BLOCKS * BLOCK_SIZE];
+    size_t done = 0;
+
+    while (done < num_sectors) {
+        size_t n = num_sectors - done;
+        if (n > XTS_BATCH_BLOCKS) n = XTS_BATCH_BLOCKS;
+
+        // Sector numbers as 128-bit little-endian values, encrypted together
+        memset(tweaks, 0, n * BLOCK_SIZE);
+        for (size_t i = 0; i < n; i++) {
+            u64 sector = first_sector + done + i;
+            for (int b = 0; b < 8; b++) {
+                tweaks[i * BLOCK_SIZE + b] = (u8)(sector >> (8 * b));
+            }
+        }
+        if (block_cipher_process_blocks(
+                tweak_ctx, tweaks, tweaks, n, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+            fprintf(stderr, "Error processing block in XTS mode\n");
+            return;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            size_t offset = (done + i) * sector_size;
+            if (xts_process_unit(mode_ctx, tweaks + i * BLOCK_SIZE,
+                    in + offset, out + offset, sector_size, dir) != 0) {
+                fprintf(stderr, "Error processing block in XTS mode\n");
+                return;
+            }
+        }
+        done += n;
+    }
+}
+
+void xts_dispose(ModeOfOperationContext *mode_ctx) {
+    if (mode_ctx) {
+        // Dispose of both cipher contexts
+        xts_free_ciphers(mode_ctx);
+        // Clear the context memory
+        memset(mode_ctx, 0, sizeof(*mode_ctx));
+    }
+}
@@ -101,4 +101,27 @@ size_t iso7816_4_unpad(u8 *buf, size_t buf_len, size_t block_size) {
         return 0;  // Marker not found or bad padding
     }
     return (size_t)i;
-}
\ No newline at end of file
+}
+
+/* Dispatch on the padding scheme selected for a mode context. */
+size_t mode_pad(ModePaddingType type, u8 *buf, size_t data_len, size_t block_size) {
+    switch (type) {
+        case MODE_PADDING_NONE:
+            if (block_size == 0 || data_len % block_size != 0) return 0;
+            return data_len;
+        case MODE_PADDING_PKCS7:      return pkcs7_pad(buf, data_len, block_size);
+        case MODE_PADDING_ANSI923:    return ansi923_pad(buf, data_len, block_size);
+        case MODE_PADDING_ISO7816_4:  return iso7816_4_pad(buf, data_len, block_size);
+        default: return 0;
+    }
+}
+
+size_t mode_unpad(ModePaddingType type, u8 *buf, size_t buf_len, size_t block_size) {
+    switch (type) {
+        case MODE_PADDING_NONE:       return buf_len;
+        case MODE_PADDING_PKCS7:      return pkcs7_unpad(buf, buf_len, block_size);
+        case MODE_PADDING_ANSI923:    return ansi923_unpad(buf, buf_len, block_size);
+        case MODE_PADDING_ISO7816_4:  return iso7816_4_unpad(buf, buf_len, block_size);
+        default: return 0;
+    }
+}
@@ -0,0 +1,314 @@
+/* File: src/rng/ctr_drbg.c */
+
+/**
+ * @file ctr_drbg.c
+ * @brief This file implements CTR_DRBG (SP 800-90A Rev. 1, section 10.2.1) on the AES backend.
+ * @details The counter field is the whole 128-bit block V. Block_Cipher_df is computed by
+ *          streaming IV || L || N || input || 0x80 || 0^* through BCC, so the seed material is
+ *          never assembled in memory.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/rng/ctr_drbg.h"
+
+/* Instance and output buffer of one thread for ctr_drbg_random_bytes */
+typedef struct {
+    CtrDrbgContext drbg;
+    DrbgThreadBuffer out;
+} ctr_drbg_thread_state;
+
+static __thread ctr_drbg_thread_state thread_state;
+
+static void store_be32(u8 *x, u32 v) {
+    x[0] = (u8)(v >> 24);
+    x[1] = (u8)(v >> 16);
+    x[2] = (u8)(v >> 8);
+    x[3] = (u8)v;
+}
+
+static cryptomodule_status_t ctr_drbg_set_key(BlockCipherContext *cipher, const u8 *key, size_t key_len) {
+    cipher->cipher_api = get_aes_api();
+    if (cipher->cipher_api->cipher_init(cipher, key, key_len, AES_BLOCK_SIZE, BLOCK_CIPHER_ENCRYPTION) != BLOCK_CIPHER_OK) {
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    return CRYPTOMODULE_OK;
+}
+
+/* V = (V + 1) mod 2^128 */
+static void ctr_drbg_increment(u8 *v) {
+    for (int i = CTR_DRBG_BLOCK_SIZE - 1; i >= 0; i--) {
+        if (++v[i] != 0) break;
+    }
+}
+
+/**
+ * @brief CTR_DRBG_Update: refresh Key and V with seed_len bytes of provided data (NULL for zeros).
+ */
+static cryptomodule_status_t ctr_drbg_update(CtrDrbgContext *ctx, const u8 *provided) {
+    u8 temp[CTR_DRBG_MAX_SEED_SIZE + CTR_DRBG_BLOCK_SIZE];
+    const size_t blocks = (ctx->seed_len + CTR_DRBG_BLOCK_SIZE - 1) / CTR_DRBG_BLOCK_SIZE;
+
+    for (size_t i = 0; i < blocks; i++) {
+        ctr_drbg_increment(ctx->v);
+        memcpy(temp + i * CTR_DRBG_BLOCK_SIZE, ctx->v, CTR_DRBG_BLOCK_SIZE);
+    }
+    block_cipher_process_blocks(&ctx->cipher, temp, temp, blocks, BLOCK_CIPHER_ENCRYPTION);
+    if (provided) {
+        for (size_t i = 0; i < ctx->seed_len; i++) temp[i] ^= provided[i];
+    }
+
+    cryptomodule_status_t status = ctr_drbg_set_key(&ctx->cipher, temp, ctx->key_len);
+    memcpy(ctx->v, temp + ctx->key_len, CTR_DRBG_BLOCK_SIZE);
+    drbg_wipe(temp, sizeof(temp));
+    return status;
+}
+
+/* XOR len bytes into the BCC chaining value, encrypting each time a block is complete */
+static void ctr_drbg_bcc_absorb(BlockCipherContext *cipher, u8 *chain, size_t *fill, const u8 *in, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        chain[(*fill)++] ^= in[i];
+        if (*fill == CTR_DRBG_BLOCK_SIZE) {
+            block_cipher_process_blocks(cipher, chain, chain, 1, BLOCK_CIPHER_ENCRYPTION);
+            *fill = 0;
+        }
+    }
+}
+
+/**
+ * @brief Block_Cipher_df of the concatenation of num inputs, returning seed_len bytes.
+ */
+static cryptomodule_status_t ctr_drbg_df(const CtrDrbgContext *ctx,
+                                         const u8 *const *in, const size_t *in_lens, size_t num,
+                                         u8 *out) {
+    static const u8 df_key[CTR_DRBG_MAX_KEY_SIZE] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+    };
+    static const u8 zeros[CTR_DRBG_BLOCK_SIZE] = { 0x00, };
+    static const u8 marker = 0x80;
+
+    BlockCipherContext cipher;
+    u8 temp[CTR_DRBG_MAX_SEED_SIZE + CTR_DRBG_BLOCK_SIZE];
+    u8 header[8];       // L || N
+    size_t total = 0;
+    for (size_t k = 0; k < num; k++) total += in_lens[k];
+    store_be32(header, (u32)total);
+    store_be32(header + 4, (u32)ctx->seed_len);
+
+    cryptomodule_status_t status = ctr_drbg_set_key(&cipher, df_key, ctx->key_len);
+    for (size_t i = 0; status == CRYPTOMODULE_OK && i * CTR_DRBG_BLOCK_SIZE < ctx->seed_len; i++) {
+        u8 iv[CTR_DRBG_BLOCK_SIZE] = { 0x00, };
+        u8 *chain = temp + i * CTR_DRBG_BLOCK_SIZE;
+        size_t fill = 0;
+
+        memset(chain, 0, CTR_DRBG_BLOCK_SIZE);
+        store_be32(iv, (u32)i);
+        ctr_drbg_bcc_absorb(&cipher, chain, &fill, iv, sizeof(iv));
+        ctr_drbg_bcc_absorb(&cipher, chain, &fill, header, sizeof(header));
+        for (size_t k = 0; k < num; k++) {
+            ctr_drbg_bcc_absorb(&cipher, chain, &fill, in[k], in_lens[k]);
+        }
+        ctr_drbg_bcc_absorb(&cipher, chain, &fill, &marker, 1);
+        if (fill) {
+            ctr_drbg_bcc_absorb(&cipher, chain, &fill, zeros, CTR_DRBG_BLOCK_SIZE - fill);
+        }
+    }
+
+    // K = leftmost key_len bytes of temp, X = the next block; output E(K, X), E(K, E(K, X)), ...
+    if (status == CRYPTOMODULE_OK) {
+        status = ctr_drbg_set_key(&cipher, temp, ctx->key_len);
+    }
+    if (status == CRYPTOMODULE_OK) {
+        u8 x[CTR_DRBG_BLOCK_SIZE];
+        memcpy(x, temp + ctx->key_len, CTR_DRBG_BLOCK_SIZE);
+        for (size_t off = 0; off < ctx->seed_len; off += CTR_DRBG_BLOCK_SIZE) {
+            block_cipher_process_blocks(&cipher, x, x, 1, BLOCK_CIPHER_ENCRYPTION);
+            size_t n = ctx->seed_len - off < CTR_DRBG_BLOCK_SIZE ? ctx->seed_len - off : CTR_DRBG_BLOCK_SIZE;
+            memcpy(out + off, x, n);
+        }
+        drbg_wipe(x, sizeof(x));
+    }
+
+    get_aes_api()->cipher_dispose(&cipher);
+    drbg_wipe(temp, sizeof(temp));
+    return status;
+}
+
+/**
+ * @brief Seed material from entropy and an optional string: df(entropy || str) or entropy ^ str.
+ */
+static cryptomodule_status_t ctr_drbg_seed_material(const CtrDrbgContext *ctx,
+                                                    const u8 *entropy, size_t entropy_len,
+                                                    const u8 *str, size_t str_len,
+                                                    u8 *seed) {
+    if (ctx->use_df) {
+        const u8 *in[2] = { entropy, str };
+        size_t in_lens[2] = { entropy_len, str_len };
+        return ctr_drbg_df(ctx, in, in_lens, 2, seed);
+    }
+
+    memcpy(seed, entropy, ctx->seed_len);
+    for (size_t i = 0; i < str_len; i++) seed[i] ^= str[i];
+    return CRYPTOMODULE_OK;
+}
+
+static bool ctr_drbg_input_ok(const CtrDrbgContext *ctx, const u8 *in, size_t len) {
+    if (len && !in) return false;
+    return ctx->use_df ? (len <= DRBG_MAX_INPUT_SIZE) : (len <= ctx->seed_len);
+}
+
+cryptomodule_status_t ctr_drbg_instantiate(
+    CtrDrbgContext *ctx, size_t key_len, bool use_df,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len) {
+
+    if (!ctx || (key_len != AES128_KEY_SIZE && key_len != AES192_KEY_SIZE && key_len != AES256_KEY_SIZE)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->key_len = key_len;
+    ctx->seed_len = key_len + CTR_DRBG_BLOCK_SIZE;
+    ctx->use_df = use_df;
+    ctx->reseed_interval = DRBG_DEFAULT_RESEED_INTERVAL;
+    ctx->entropy = entropy ? entropy : drbg_system_entropy;
+    ctx->entropy_arg = entropy_arg;
+    if (!ctr_drbg_input_ok(ctx, pers, pers_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    // With df: entropy input of the security strength plus a nonce of half of it
+    u8 ent[CTR_DRBG_MAX_SEED_SIZE], seed[CTR_DRBG_MAX_SEED_SIZE];
+    const size_t ent_len = use_df ? key_len + key_len / 2 : ctx->seed_len;
+    ctx->fork_generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ent_len);
+    if (status == CRYPTOMODULE_OK) status = ctr_drbg_seed_material(ctx, ent, ent_len, pers, pers_len, seed);
+
+    // Key = 0^keylen, V = 0^blocklen
+    static const u8 zero_key[CTR_DRBG_MAX_KEY_SIZE] = { 0x00, };
+    if (status == CRYPTOMODULE_OK) status = ctr_drbg_set_key(&ctx->cipher, zero_key, key_len);
+    if (status == CRYPTOMODULE_OK) status = ctr_drbg_update(ctx, seed);
+
+    drbg_wipe(ent, sizeof(ent));
+    drbg_wipe(seed, sizeof(seed));
+    if (status != CRYPTOMODULE_OK) {
+        ctr_drbg_dispose(ctx);
+        return status;
+    }
+    ctx->reseed_counter = 1;
+    ctx->instantiated = true;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t ctr_drbg_reseed(CtrDrbgContext *ctx, const u8 *additional, size_t additional_len) {
+    if (!ctx || !ctx->instantiated || !ctr_drbg_input_ok(ctx, additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    u8 ent[CTR_DRBG_MAX_SEED_SIZE], seed[CTR_DRBG_MAX_SEED_SIZE];
+    const size_t ent_len = ctx->use_df ? ctx->key_len : ctx->seed_len;
+    u64 generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ent_len);
+    if (status == CRYPTOMODULE_OK) status = ctr_drbg_seed_material(ctx, ent, ent_len, additional, additional_len, seed);
+    if (status == CRYPTOMODULE_OK) status = ctr_drbg_update(ctx, seed);
+
+    drbg_wipe(ent, sizeof(ent));
+    drbg_wipe(seed, sizeof(seed));
+    if (status == CRYPTOMODULE_OK) {
+        ctx->reseed_counter = 1;
+        ctx->fork_generation = generation;
+    }
+    return status;
+}
+
+cryptomodule_status_t ctr_drbg_generate(
+    CtrDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len) {
+
+    if (!ctx || !ctx->instantiated || (out_len && !out) || out_len > DRBG_MAX_REQUEST_SIZE ||
+        !ctr_drbg_input_ok(ctx, additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+    if (ctx->reseed_counter > ctx->reseed_interval || ctx->fork_generation != drbg_fork_generation()) {
+        // The additional input goes into the reseed and is not used again below
+        status = ctr_drbg_reseed(ctx, additional, additional_len);
+        additional = NULL;
+        additional_len = 0;
+        if (status != CRYPTOMODULE_OK) return status;
+    }
+
+    u8 add[CTR_DRBG_MAX_SEED_SIZE] = { 0x00, };
+    const u8 *provided = NULL;
+    if (additional_len) {
+        if (ctx->use_df) {
+            status = ctr_drbg_df(ctx, &additional, &additional_len, 1, add);
+        } else {
+            memcpy(add, additional, additional_len);
+        }
+        if (status == CRYPTOMODULE_OK) status = ctr_drbg_update(ctx, add);
+        provided = add;
+    }
+
+    if (status == CRYPTOMODULE_OK) {
+        // Lay out V+1, V+2, ... in the output and encrypt them all in one call
+        const size_t full = out_len / CTR_DRBG_BLOCK_SIZE;
+        const size_t tail = out_len % CTR_DRBG_BLOCK_SIZE;
+        for (size_t i = 0; i < full; i++) {
+            ctr_drbg_increment(ctx->v);
+            memcpy(out + i * CTR_DRBG_BLOCK_SIZE, ctx->v, CTR_DRBG_BLOCK_SIZE);
+        }
+        if (full) {
+            block_cipher_process_blocks(&ctx->cipher, out, out, full, BLOCK_CIPHER_ENCRYPTION);
+        }
+        if (tail) {
+            u8 block[CTR_DRBG_BLOCK_SIZE];
+            ctr_drbg_increment(ctx->v);
+            block_cipher_process_blocks(&ctx->cipher, ctx->v, block, 1, BLOCK_CIPHER_ENCRYPTION);
+            memcpy(out + full * CTR_DRBG_BLOCK_SIZE, block, tail);
+            drbg_wipe(block, sizeof(block));
+        }
+
+        status = ctr_drbg_update(ctx, provided);
+        ctx->reseed_counter++;
+    }
+
+    drbg_wipe(add, sizeof(add));
+    return status;
+}
+
+void ctr_drbg_dispose(CtrDrbgContext *ctx) {
+    if (ctx) {
+        drbg_wipe(ctx, sizeof(*ctx));
+    }
+}
+
+static cryptomodule_status_t ctr_drbg_generate_plain(void *drbg, u8 *out, size_t len) {
+    return ctr_drbg_generate((CtrDrbgContext *)drbg, out, len, NULL, 0);
+}
+
+cryptomodule_status_t ctr_drbg_random_bytes(u8 *out, size_t len) {
+    if (len && !out) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    ctr_drbg_thread_state *st = &thread_state;
+    if (!st->drbg.instantiated) {
+        // The state's address tells apart the threads alive at the same time
+        static const char label[] = "CryptoModule CTR_DRBG thread instance";
+        u8 pers[sizeof(label) + sizeof(void *)];
+        void *self = st;
+        memcpy(pers, label, sizeof(label));
+        memcpy(pers + sizeof(label), &self, sizeof(self));
+
+        cryptomodule_status_t status = ctr_drbg_instantiate(&st->drbg, AES256_KEY_SIZE, true, NULL, NULL, pers, sizeof(pers));
+        if (status != CRYPTOMODULE_OK) return status;
+        st->out.avail = 0;
+    }
+    return drbg_buffered_read(&st->out, st->drbg.fork_generation, ctr_drbg_generate_plain, &st->drbg, out, len);
+}
+
+void ctr_drbg_thread_cleanup(void) {
+    drbg_wipe(&thread_state, sizeof(thread_state));
+}
@@ -0,0 +1,111 @@
+/* File: src/rng/drbg.c */
+
+/**
+ * @file drbg.c
+ * @brief This file implements the entropy source, fork detection and per-thread output buffer
+ *        shared by the DRBGs.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/rng/drbg.h"
+
+#include <pthread.h>
+
+static volatile u64 fork_generation = 0;
+static pthread_once_t fork_handler_once = PTHREAD_ONCE_INIT;
+
+static void drbg_atfork_child(void) {
+    fork_generation++;
+}
+
+static void drbg_register_fork_handler(void) {
+    pthread_atfork(NULL, NULL, drbg_atfork_child);
+}
+
+u64 drbg_fork_generation(void) {
+    pthread_once(&fork_handler_once, drbg_register_fork_handler);
+    return fork_generation;
+}
+
+cryptomodule_status_t drbg_system_entropy(void *arg, u8 *out, size_t len) {
+    (void)arg;
+    if (len && !out) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    FILE *fp = fopen("/dev/urandom", "rb");
+    if (!fp) {
+        fprintf(stderr, "Failed to open the system entropy source\n");
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    setvbuf(fp, NULL, _IONBF, 0);   // No copy of the entropy left in a stdio buffer
+    size_t n = fread(out, 1, len, fp);
+    fclose(fp);
+
+    if (n != len) {
+        fprintf(stderr, "Short read from the system entropy source\n");
+        return CRYPTOMODULE_ERR_CRYPTO_FAILURE;
+    }
+    return CRYPTOMODULE_OK;
+}
+
+size_t drbg_hash_size(DrbgHashType hash) {
+    switch (hash) {
+    case DRBG_SHA224: return SHA2_SHA224_DIGEST_SIZE;
+    case DRBG_SHA256: return SHA2_SHA256_DIGEST_SIZE;
+    case DRBG_SHA384: return SHA2_SHA384_DIGEST_SIZE;
+    case DRBG_SHA512: return SHA2_SHA512_DIGEST_SIZE;
+    default:          return 0;
+    }
+}
+
+size_t drbg_hash_strength(DrbgHashType hash) {
+    switch (hash) {
+    case DRBG_SHA224: return 24;
+    case DRBG_SHA256:
+    case DRBG_SHA384:
+    case DRBG_SHA512: return 32;
+    default:          return 0;
+    }
+}
+
+void drbg_wipe(void *p, size_t len) {
+    cryptomodule_wipe(p, len);
+}
+
+cryptomodule_status_t drbg_buffered_read(DrbgThreadBuffer *tb, u64 seeded_generation,
+                                         drbg_generate_fn generate, void *drbg,
+                                         u8 *out, size_t len) {
+    if (!tb || !generate || (len && !out)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    if (seeded_generation != drbg_fork_generation()) {
+        // Output buffered before a fork must not be returned by both processes
+        drbg_wipe(tb->buf, sizeof(tb->buf));
+        tb->avail = 0;
+    }
+
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+    while (len && status == CRYPTOMODULE_OK) {
+        if (tb->avail) {
+            size_t n = len < tb->avail ? len : tb->avail;
+            u8 *src = tb->buf + sizeof(tb->buf) - tb->avail;
+            memcpy(out, src, n);
+            drbg_wipe(src, n);
+            tb->avail -= n;
+            out += n;
+            len -= n;
+        } else if (len >= sizeof(tb->buf)) {
+            // Large requests go straight to the output
+            size_t n = len < DRBG_MAX_REQUEST_SIZE ? len : DRBG_MAX_REQUEST_SIZE;
+            status = generate(drbg, out, n);
+            out += n;
+            len -= n;
+        } else {
+            status = generate(drbg, tb->buf, sizeof(tb->buf));
+            if (status == CRYPTOMODULE_OK) tb->avail = sizeof(tb->buf);
+        }
+    }
+    return status;
+}
@@ -0,0 +1,325 @@
+/* File: src/rng/hash_drbg.c */
+
+/**
+ * @file hash_drbg.c
+ * @brief This file implements Hash_DRBG (SP 800-90A Rev. 1, section 10.1.1) on the SHA-2 block
+ *        functions.
+ * @details Hash_df and the state update hash short concatenations through the incremental API.
+ *          Hashgen builds the block data || 0x80 || 0^* || bitlen(seedlen) once and then
+ *          increments data in place; with SHA-224/256 and a multi-buffer backend, groups of
+ *          SHA2_sha256_multi_lanes() consecutive counters are compressed together, word k of lane l
+ *          at w[k * lanes + l].
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/rng/hash_drbg.h"
+
+/* Instance and output buffer of one thread for hash_drbg_random_bytes */
+typedef struct {
+    HashDrbgContext drbg;
+    DrbgThreadBuffer out;
+} hash_drbg_thread_state;
+
+static __thread hash_drbg_thread_state thread_state;
+
+static u32 load_be32(const u8 *x) {
+    return ((u32)x[0] << 24) | ((u32)x[1] << 16) | ((u32)x[2] << 8) | (u32)x[3];
+}
+
+static void store_be32(u8 *x, u32 v) {
+    x[0] = (u8)(v >> 24);
+    x[1] = (u8)(v >> 16);
+    x[2] = (u8)(v >> 8);
+    x[3] = (u8)v;
+}
+
+static bool hash_drbg_wide(DrbgHashType hash) {
+    return hash == DRBG_SHA384 || hash == DRBG_SHA512;
+}
+
+/**
+ * @brief Hash of the concatenation of num inputs.
+ */
+static void hash_drbg_hash(DrbgHashType hash, u8 *out, const u8 *const *in, const size_t *in_lens, size_t num) {
+    if (hash_drbg_wide(hash)) {
+        SHA2_sha512_ctx state;
+        if (hash == DRBG_SHA384) SHA2_sha384_inc_init(&state); else SHA2_sha512_inc_init(&state);
+        for (size_t i = 0; i < num; i++) SHA2_sha512_inc(&state, in[i], in_lens[i]);
+        if (hash == DRBG_SHA384) SHA2_sha384_inc_finalize(out, &state, NULL, 0); else SHA2_sha512_inc_finalize(out, &state, NULL, 0);
+        drbg_wipe(&state, sizeof(state));
+    } else {
+        SHA2_sha256_ctx state;
+        if (hash == DRBG_SHA224) SHA2_sha224_inc_init(&state); else SHA2_sha256_inc_init(&state);
+        for (size_t i = 0; i < num; i++) SHA2_sha256_inc(&state, in[i], in_lens[i]);
+        if (hash == DRBG_SHA224) SHA2_sha224_inc_finalize(out, &state, NULL, 0); else SHA2_sha256_inc_finalize(out, &state, NULL, 0);
+        drbg_wipe(&state, sizeof(state));
+    }
+}
+
+/**
+ * @brief Hash_df of the concatenation of up to four inputs, returning seed_len bytes.
+ */
+static void hash_drbg_df(const HashDrbgContext *ctx, const u8 *const *in, const size_t *in_lens, size_t num, u8 *out) {
+    const u8 *parts[6];
+    size_t part_lens[6];
+    u8 counter, bits[4], digest[SHA2_SHA512_DIGEST_SIZE];
+
+    // Hash(counter || no_of_bits_to_return || input), counter = 1, 2, ...
+    store_be32(bits, (u32)(ctx->seed_len * 8));
+    parts[0] = &counter;
+    part_lens[0] = 1;
+    parts[1] = bits;
+    part_lens[1] = sizeof(bits);
+    for (size_t i = 0; i < num; i++) {
+        parts[2 + i] = in[i];
+        part_lens[2 + i] = in_lens[i];
+    }
+
+    counter = 1;
+    for (size_t off = 0; off < ctx->seed_len; off += ctx->out_len, counter++) {
+        hash_drbg_hash(ctx->hash, digest, parts, part_lens, 2 + num);
+        size_t n = ctx->seed_len - off < ctx->out_len ? ctx->seed_len - off : ctx->out_len;
+        memcpy(out + off, digest, n);
+    }
+    drbg_wipe(digest, sizeof(digest));
+}
+
+/* x = (x + y) mod 2^(8 * x_len), both big-endian, y_len <= x_len */
+static void hash_drbg_add(u8 *x, size_t x_len, const u8 *y, size_t y_len) {
+    u32 carry = 0;
+    for (size_t i = 0; i < x_len; i++) {
+        u32 sum = (u32)x[x_len - 1 - i] + carry + (i < y_len ? y[y_len - 1 - i] : 0);
+        x[x_len - 1 - i] = (u8)sum;
+        carry = sum >> 8;
+    }
+}
+
+/* x = (x + 1) mod 2^(8 * x_len) */
+static void hash_drbg_increment(u8 *x, size_t x_len) {
+    for (size_t i = x_len; i-- > 0; ) {
+        if (++x[i] != 0) break;
+    }
+}
+
+/**
+ * @brief V = seed, C = Hash_df(0x00 || V); starts a new reseed period.
+ */
+static void hash_drbg_set_seed(HashDrbgContext *ctx, const u8 *seed) {
+    static const u8 zero = 0x00;
+    const u8 *in[2] = { &zero, seed };
+    size_t in_lens[2] = { 1, ctx->seed_len };
+
+    memcpy(ctx->v, seed, ctx->seed_len);
+    hash_drbg_df(ctx, in, in_lens, 2, ctx->c);
+    ctx->reseed_counter = 1;
+}
+
+static bool hash_drbg_input_ok(const u8 *in, size_t len) {
+    return !(len && !in) && len <= DRBG_MAX_INPUT_SIZE;
+}
+
+cryptomodule_status_t hash_drbg_instantiate(
+    HashDrbgContext *ctx, DrbgHashType hash,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len) {
+
+    if (!ctx || drbg_hash_size(hash) == 0 || !hash_drbg_input_ok(pers, pers_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->hash = hash;
+    ctx->out_len = drbg_hash_size(hash);
+    ctx->seed_len = hash_drbg_wide(hash) ? 111 : 55;
+    ctx->strength = drbg_hash_strength(hash);
+    ctx->reseed_interval = DRBG_DEFAULT_RESEED_INTERVAL;
+    ctx->entropy = entropy ? entropy : drbg_system_entropy;
+    ctx->entropy_arg = entropy_arg;
+
+    // seed = Hash_df(entropy_input || nonce || personalization_string)
+    u8 ent[48], seed[HASH_DRBG_MAX_SEED_SIZE];
+    const size_t ent_len = ctx->strength + ctx->strength / 2;
+    ctx->fork_generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ent_len);
+    if (status == CRYPTOMODULE_OK) {
+        const u8 *in[2] = { ent, pers };
+        size_t in_lens[2] = { ent_len, pers_len };
+        hash_drbg_df(ctx, in, in_lens, 2, seed);
+        hash_drbg_set_seed(ctx, seed);
+        ctx->instantiated = true;
+    }
+
+    drbg_wipe(ent, sizeof(ent));
+    drbg_wipe(seed, sizeof(seed));
+    return status;
+}
+
+cryptomodule_status_t hash_drbg_reseed(HashDrbgContext *ctx, const u8 *additional, size_t additional_len) {
+    if (!ctx || !ctx->instantiated || !hash_drbg_input_ok(additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    // seed = Hash_df(0x01 || V || entropy_input || additional_input)
+    static const u8 one = 0x01;
+    u8 ent[32], seed[HASH_DRBG_MAX_SEED_SIZE];
+    u64 generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ctx->strength);
+    if (status == CRYPTOMODULE_OK) {
+        const u8 *in[4] = { &one, ctx->v, ent, additional };
+        size_t in_lens[4] = { 1, ctx->seed_len, ctx->strength, additional_len };
+        hash_drbg_df(ctx, in, in_lens, 4, seed);
+        hash_drbg_set_seed(ctx, seed);
+        ctx->fork_generation = generation;
+    }
+
+    drbg_wipe(ent, sizeof(ent));
+    drbg_wipe(seed, sizeof(seed));
+    return status;
+}
+
+/**
+ * @brief Hashgen: out_len bytes of Hash(V) || Hash(V + 1) || ... (V itself is not changed).
+ */
+static void hash_drbg_hashgen(const HashDrbgContext *ctx, u8 *out, size_t out_len) {
+    const bool wide = hash_drbg_wide(ctx->hash);
+    const size_t block_size = wide ? SHA2_SHA512_BLOCK_SIZE : SHA2_SHA256_BLOCK_SIZE;
+    const size_t state_size = wide ? 64 : 32;
+    u8 block[SHA2_SHA512_BLOCK_SIZE] = { 0x00, }, iv[64], st[64];
+
+    // The initial hash value of the selected function
+    if (wide) {
+        SHA2_sha512_ctx init;
+        if (ctx->hash == DRBG_SHA384) SHA2_sha384_inc_init(&init); else SHA2_sha512_inc_init(&init);
+        memcpy(iv, init.ctx, state_size);
+    } else {
+        SHA2_sha256_ctx init;
+        if (ctx->hash == DRBG_SHA224) SHA2_sha224_inc_init(&init); else SHA2_sha256_inc_init(&init);
+        memcpy(iv, init.ctx, state_size);
+    }
+
+    // data || 0x80 || bitlen(seedlen): exactly one block
+    const u32 bits = (u32)(ctx->seed_len * 8);
+    memcpy(block, ctx->v, ctx->seed_len);
+    block[ctx->seed_len] = 0x80;
+    block[block_size - 2] = (u8)(bits >> 8);
+    block[block_size - 1] = (u8)bits;
+
+    /*
+     * Eight AVX2 lanes are slower than one SHA-NI compression per block, sixteen AVX-512 lanes are
+     * faster; against the C rounds any multi-buffer backend wins.
+     */
+    const size_t lanes = wide ? 1 : SHA2_sha256_multi_lanes();
+    if (lanes > 1 && (SHA2_sha256_get_backend() != SHA2_BACKEND_SHA_NI || lanes == SHA2_SHA256_MB_MAX_LANES)) {
+        u32 sv[8 * SHA2_SHA256_MB_MAX_LANES], w[16 * SHA2_SHA256_MB_MAX_LANES];
+        const size_t group_bytes = lanes * ctx->out_len;
+        while (out_len >= group_bytes) {
+            for (size_t l = 0; l < lanes; l++) {
+                for (int k = 0; k < 16; k++) w[k * lanes + l] = load_be32(block + 4 * k);
+                for (int k = 0; k < 8; k++) sv[k * lanes + l] = load_be32(iv + 4 * k);
+                hash_drbg_increment(block, ctx->seed_len);
+            }
+            SHA2_sha256_multi_compress(sv, w, lanes);
+            for (size_t l = 0; l < lanes; l++) {
+                for (int k = 0; k < 8; k++) store_be32(st + 4 * k, sv[k * lanes + l]);
+                memcpy(out, st, ctx->out_len);
+                out += ctx->out_len;
+            }
+            out_len -= group_bytes;
+        }
+        drbg_wipe(sv, sizeof(sv));
+        drbg_wipe(w, sizeof(w));
+    }
+
+    while (out_len) {
+        memcpy(st, iv, state_size);
+        if (wide) crypto_hashblocks_sha512(st, block, block_size); else crypto_hashblocks_sha256(st, block, block_size);
+        size_t n = out_len < ctx->out_len ? out_len : ctx->out_len;
+        memcpy(out, st, n);
+        out += n;
+        out_len -= n;
+        hash_drbg_increment(block, ctx->seed_len);
+    }
+
+    drbg_wipe(block, sizeof(block));
+    drbg_wipe(st, sizeof(st));
+}
+
+cryptomodule_status_t hash_drbg_generate(
+    HashDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len) {
+
+    if (!ctx || !ctx->instantiated || (out_len && !out) || out_len > DRBG_MAX_REQUEST_SIZE ||
+        !hash_drbg_input_ok(additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    if (ctx->reseed_counter > ctx->reseed_interval || ctx->fork_generation != drbg_fork_generation()) {
+        // The additional input goes into the reseed and is not used again below
+        cryptomodule_status_t status = hash_drbg_reseed(ctx, additional, additional_len);
+        additional = NULL;
+        additional_len = 0;
+        if (status != CRYPTOMODULE_OK) return status;
+    }
+
+    u8 digest[SHA2_SHA512_DIGEST_SIZE];
+    if (additional_len) {
+        // V = V + Hash(0x02 || V || additional_input)
+        static const u8 two = 0x02;
+        const u8 *in[3] = { &two, ctx->v, additional };
+        size_t in_lens[3] = { 1, ctx->seed_len, additional_len };
+        hash_drbg_hash(ctx->hash, digest, in, in_lens, 3);
+        hash_drbg_add(ctx->v, ctx->seed_len, digest, ctx->out_len);
+    }
+
+    hash_drbg_hashgen(ctx, out, out_len);
+
+    // V = V + Hash(0x03 || V) + C + reseed_counter
+    static const u8 three = 0x03;
+    const u8 *in[2] = { &three, ctx->v };
+    size_t in_lens[2] = { 1, ctx->seed_len };
+    u8 counter[8];
+    for (int i = 0; i < 8; i++) counter[i] = (u8)(ctx->reseed_counter >> (56 - 8 * i));
+    hash_drbg_hash(ctx->hash, digest, in, in_lens, 2);
+    hash_drbg_add(ctx->v, ctx->seed_len, digest, ctx->out_len);
+    hash_drbg_add(ctx->v, ctx->seed_len, ctx->c, ctx->seed_len);
+    hash_drbg_add(ctx->v, ctx->seed_len, counter, sizeof(counter));
+    ctx->reseed_counter++;
+
+    drbg_wipe(digest, sizeof(digest));
+    return CRYPTOMODULE_OK;
+}
+
+void hash_drbg_dispose(HashDrbgContext *ctx) {
+    if (ctx) {
+        drbg_wipe(ctx, sizeof(*ctx));
+    }
+}
+
+static cryptomodule_status_t hash_drbg_generate_plain(void *drbg, u8 *out, size_t len) {
+    return hash_drbg_generate((HashDrbgContext *)drbg, out, len, NULL, 0);
+}
+
+cryptomodule_status_t hash_drbg_random_bytes(u8 *out, size_t len) {
+    if (len && !out) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    hash_drbg_thread_state *st = &thread_state;
+    if (!st->drbg.instantiated) {
+        // The state's address tells apart the threads alive at the same time
+        static const char label[] = "CryptoModule Hash_DRBG thread instance";
+        u8 pers[sizeof(label) + sizeof(void *)];
+        void *self = st;
+        memcpy(pers, label, sizeof(label));
+        memcpy(pers + sizeof(label), &self, sizeof(self));
+
+        cryptomodule_status_t status = hash_drbg_instantiate(&st->drbg, DRBG_SHA256, NULL, NULL, pers, sizeof(pers));
+        if (status != CRYPTOMODULE_OK) return status;
+        st->out.avail = 0;
+    }
+    return drbg_buffered_read(&st->out, st->drbg.fork_generation, hash_drbg_generate_plain, &st->drbg, out, len);
+}
+
+void hash_drbg_thread_cleanup(void) {
+    drbg_wipe(&thread_state, sizeof(thread_state));
+}
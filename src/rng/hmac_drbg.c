@@ -0,0 +1,232 @@
+/* File: src/rng/hmac_drbg.c */
+
+/**
+ * @file hmac_drbg.c
+ * @brief This file implements HMAC_DRBG (SP 800-90A Rev. 1, section 10.1.2) on the SHA-2 block
+ *        functions.
+ * @details Update goes through the HMAC API. The V chain of a generate request skips it: the
+ *          inner block is V || 0x80 || 0^* || bitlen(block + V) and the outer block is the inner
+ *          digest with the same padding, so both are written once and only their first out_len
+ *          bytes change from one V to the next.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/rng/hmac_drbg.h"
+
+/* Instance and output buffer of one thread for hmac_drbg_random_bytes */
+typedef struct {
+    HmacDrbgContext drbg;
+    DrbgThreadBuffer out;
+} hmac_drbg_thread_state;
+
+static __thread hmac_drbg_thread_state thread_state;
+
+static HmacHashType hmac_drbg_mac_type(DrbgHashType hash) {
+    switch (hash) {
+    case DRBG_SHA224: return HMAC_SHA224;
+    case DRBG_SHA256: return HMAC_SHA256;
+    case DRBG_SHA384: return HMAC_SHA384;
+    default:          return HMAC_SHA512;
+    }
+}
+
+/**
+ * @brief HMAC_DRBG_Update with provided data given as up to three pieces (NULL/0 for none).
+ */
+static cryptomodule_status_t hmac_drbg_update(HmacDrbgContext *ctx, const u8 *const *in, const size_t *in_lens, size_t num) {
+    u8 k[HMAC_MAX_MAC_SIZE];
+    size_t provided = 0;
+    for (size_t i = 0; i < num; i++) provided += in_lens[i];
+
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+    for (u8 round = 0x00; round <= 0x01 && status == CRYPTOMODULE_OK; round++) {
+        if (round == 0x01 && provided == 0) break;
+
+        // K = HMAC(K, V || round || provided_data); V = HMAC(K, V)
+        status = hmac_update(&ctx->key, ctx->v, ctx->out_len);
+        if (status == CRYPTOMODULE_OK) status = hmac_update(&ctx->key, &round, 1);
+        for (size_t i = 0; i < num && status == CRYPTOMODULE_OK; i++) {
+            status = hmac_update(&ctx->key, in[i], in_lens[i]);
+        }
+        if (status == CRYPTOMODULE_OK) status = hmac_final(&ctx->key, k, ctx->out_len);
+        if (status == CRYPTOMODULE_OK) status = hmac_init(&ctx->key, hmac_drbg_mac_type(ctx->hash), k, ctx->out_len);
+        if (status == CRYPTOMODULE_OK) status = hmac_update(&ctx->key, ctx->v, ctx->out_len);
+        if (status == CRYPTOMODULE_OK) status = hmac_final(&ctx->key, ctx->v, ctx->out_len);
+    }
+
+    drbg_wipe(k, sizeof(k));
+    return status;
+}
+
+static bool hmac_drbg_input_ok(const u8 *in, size_t len) {
+    return !(len && !in) && len <= DRBG_MAX_INPUT_SIZE;
+}
+
+cryptomodule_status_t hmac_drbg_instantiate(
+    HmacDrbgContext *ctx, DrbgHashType hash,
+    drbg_entropy_fn entropy, void *entropy_arg,
+    const u8 *pers, size_t pers_len) {
+
+    if (!ctx || drbg_hash_size(hash) == 0 || !hmac_drbg_input_ok(pers, pers_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->hash = hash;
+    ctx->out_len = drbg_hash_size(hash);
+    ctx->strength = drbg_hash_strength(hash);
+    ctx->reseed_interval = DRBG_DEFAULT_RESEED_INTERVAL;
+    ctx->entropy = entropy ? entropy : drbg_system_entropy;
+    ctx->entropy_arg = entropy_arg;
+
+    // Entropy input and nonce: the security strength and half of it
+    u8 ent[48];
+    const size_t ent_len = ctx->strength + ctx->strength / 2;
+    ctx->fork_generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ent_len);
+
+    // K = 0x00 00 ... 00, V = 0x01 01 ... 01
+    u8 k[HMAC_MAX_MAC_SIZE] = { 0x00, };
+    memset(ctx->v, 0x01, ctx->out_len);
+    if (status == CRYPTOMODULE_OK) status = hmac_init(&ctx->key, hmac_drbg_mac_type(hash), k, ctx->out_len);
+    if (status == CRYPTOMODULE_OK) {
+        const u8 *in[2] = { ent, pers };
+        size_t in_lens[2] = { ent_len, pers_len };
+        status = hmac_drbg_update(ctx, in, in_lens, 2);
+    }
+
+    drbg_wipe(ent, sizeof(ent));
+    if (status != CRYPTOMODULE_OK) {
+        hmac_drbg_dispose(ctx);
+        return status;
+    }
+    ctx->reseed_counter = 1;
+    ctx->instantiated = true;
+    return CRYPTOMODULE_OK;
+}
+
+cryptomodule_status_t hmac_drbg_reseed(HmacDrbgContext *ctx, const u8 *additional, size_t additional_len) {
+    if (!ctx || !ctx->instantiated || !hmac_drbg_input_ok(additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    u8 ent[32];
+    u64 generation = drbg_fork_generation();
+    cryptomodule_status_t status = ctx->entropy(ctx->entropy_arg, ent, ctx->strength);
+    if (status == CRYPTOMODULE_OK) {
+        const u8 *in[2] = { ent, additional };
+        size_t in_lens[2] = { ctx->strength, additional_len };
+        status = hmac_drbg_update(ctx, in, in_lens, 2);
+    }
+
+    drbg_wipe(ent, sizeof(ent));
+    if (status == CRYPTOMODULE_OK) {
+        ctx->reseed_counter = 1;
+        ctx->fork_generation = generation;
+    }
+    return status;
+}
+
+/**
+ * @brief Write out_len bytes of V = HMAC(K, V), V = HMAC(K, V), ... from the key midstates.
+ */
+static void hmac_drbg_chain(HmacDrbgContext *ctx, u8 *out, size_t out_len) {
+    const bool wide = (ctx->hash == DRBG_SHA384 || ctx->hash == DRBG_SHA512);
+    const size_t block_size = wide ? SHA2_SHA512_BLOCK_SIZE : SHA2_SHA256_BLOCK_SIZE;
+    const size_t state_size = wide ? 64 : 32;
+    const u8 *inner_key = wide ? ctx->key.inner_key.sha512.ctx : ctx->key.inner_key.sha256.ctx;
+    const u8 *outer_key = wide ? ctx->key.outer_key.sha512.ctx : ctx->key.outer_key.sha256.ctx;
+
+    // Both messages are one digest after the key block: same padding for inner and outer
+    u8 inner[SHA2_SHA512_BLOCK_SIZE] = { 0x00, }, outer[SHA2_SHA512_BLOCK_SIZE] = { 0x00, };
+    u8 st[64];
+    const u32 bits = (u32)((block_size + ctx->out_len) * 8);
+    memcpy(inner, ctx->v, ctx->out_len);
+    inner[ctx->out_len] = 0x80;
+    inner[block_size - 2] = (u8)(bits >> 8);
+    inner[block_size - 1] = (u8)bits;
+    memcpy(outer + ctx->out_len, inner + ctx->out_len, block_size - ctx->out_len);
+
+    while (out_len) {
+        memcpy(st, inner_key, state_size);
+        if (wide) crypto_hashblocks_sha512(st, inner, block_size); else crypto_hashblocks_sha256(st, inner, block_size);
+        memcpy(outer, st, ctx->out_len);
+        memcpy(st, outer_key, state_size);
+        if (wide) crypto_hashblocks_sha512(st, outer, block_size); else crypto_hashblocks_sha256(st, outer, block_size);
+        memcpy(inner, st, ctx->out_len);
+
+        size_t n = out_len < ctx->out_len ? out_len : ctx->out_len;
+        memcpy(out, st, n);
+        out += n;
+        out_len -= n;
+    }
+    memcpy(ctx->v, inner, ctx->out_len);
+
+    drbg_wipe(inner, sizeof(inner));
+    drbg_wipe(outer, sizeof(outer));
+    drbg_wipe(st, sizeof(st));
+}
+
+cryptomodule_status_t hmac_drbg_generate(
+    HmacDrbgContext *ctx, u8 *out, size_t out_len,
+    const u8 *additional, size_t additional_len) {
+
+    if (!ctx || !ctx->instantiated || (out_len && !out) || out_len > DRBG_MAX_REQUEST_SIZE ||
+        !hmac_drbg_input_ok(additional, additional_len)) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    cryptomodule_status_t status = CRYPTOMODULE_OK;
+    if (ctx->reseed_counter > ctx->reseed_interval || ctx->fork_generation != drbg_fork_generation()) {
+        // The additional input goes into the reseed and is not used again below
+        status = hmac_drbg_reseed(ctx, additional, additional_len);
+        additional = NULL;
+        additional_len = 0;
+        if (status != CRYPTOMODULE_OK) return status;
+    }
+
+    if (additional_len) {
+        status = hmac_drbg_update(ctx, &additional, &additional_len, 1);
+    }
+    if (status == CRYPTOMODULE_OK) {
+        hmac_drbg_chain(ctx, out, out_len);
+        status = hmac_drbg_update(ctx, &additional, &additional_len, additional_len ? 1 : 0);
+        ctx->reseed_counter++;
+    }
+    return status;
+}
+
+void hmac_drbg_dispose(HmacDrbgContext *ctx) {
+    if (ctx) {
+        drbg_wipe(ctx, sizeof(*ctx));
+    }
+}
+
+static cryptomodule_status_t hmac_drbg_generate_plain(void *drbg, u8 *out, size_t len) {
+    return hmac_drbg_generate((HmacDrbgContext *)drbg, out, len, NULL, 0);
+}
+
+cryptomodule_status_t hmac_drbg_random_bytes(u8 *out, size_t len) {
+    if (len && !out) {
+        return CRYPTOMODULE_ERR_INVALID_INPUT;
+    }
+
+    hmac_drbg_thread_state *st = &thread_state;
+    if (!st->drbg.instantiated) {
+        // The state's address tells apart the threads alive at the same time
+        static const char label[] = "CryptoModule HMAC_DRBG thread instance";
+        u8 pers[sizeof(label) + sizeof(void *)];
+        void *self = st;
+        memcpy(pers, label, sizeof(label));
+        memcpy(pers + sizeof(label), &self, sizeof(self));
+
+        cryptomodule_status_t status = hmac_drbg_instantiate(&st->drbg, DRBG_SHA256, NULL, NULL, pers, sizeof(pers));
+        if (status != CRYPTOMODULE_OK) return status;
+        st->out.avail = 0;
+    }
+    return drbg_buffered_read(&st->out, st->drbg.fork_generation, hmac_drbg_generate_plain, &st->drbg, out, len);
+}
+
+void hmac_drbg_thread_cleanup(void) {
+    drbg_wipe(&thread_state, sizeof(thread_state));
+}
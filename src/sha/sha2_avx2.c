@@ -0,0 +1,128 @@
+/* File: src/sha/sha2_avx2.c */
+
+/**
+ * @file sha2_avx2.c
+ * @brief SHA-512 compression with an AVX2 message schedule.
+ * @details The scalar rounds are inherently serial, but the schedule is not: W[t] and W[t+1]
+ *          only depend on words at least two positions back, so two of them can be computed at
+ *          once. Two blocks are scheduled together, one per 128-bit half of each ymm register, and
+ *          the full W[t] + K[t] arrays are written out before the rounds run, so each round only
+ *          adds one precomputed word.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha2.h"
+
+#if SHA2_HAVE_X86
+
+#include <immintrin.h>
+
+#define ROR64_256(x, n) _mm256_or_si256(_mm256_srli_epi64((x), (n)), _mm256_slli_epi64((x), 64 - (n)))
+#define s0_x2(x)    _mm256_xor_si256(_mm256_xor_si256(ROR64_256((x), 1), ROR64_256((x), 8)), _mm256_srli_epi64((x), 7))
+#define s1_x2(x)    _mm256_xor_si256(_mm256_xor_si256(ROR64_256((x), 19), ROR64_256((x), 61)), _mm256_srli_epi64((x), 6))
+
+/**
+ * @brief W[t] + K[t] for t = 0..79 of two blocks: block b's W[2i + j] + K[2i + j] is at wk[4i + 2b + j].
+ * @details x[i & 7] holds W[2i], W[2i + 1] of block 0 in the low half and of block 1 in the high
+ *          half. Pairs that straddle two registers (W[t-15], W[t-7]) are taken with ALIGNR.
+ */
+__attribute__((target("avx2")))
+static void sha512_schedule_x2(u64 *wk, const u8 *blk0, const u8 *blk1) {
+    const __m256i bswap = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL,
+                                            0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+    __m256i x[8];
+
+    for (int i = 0; i < 8; i++) {
+        __m256i m = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)(blk0 + 16 * i))),
+            _mm_loadu_si128((const __m128i *)(blk1 + 16 * i)), 1);
+        x[i] = _mm256_shuffle_epi8(m, bswap);
+        __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&sha2_sha512_k[2 * i]));
+        _mm256_storeu_si256((__m256i *)(wk + 4 * i), _mm256_add_epi64(x[i], k));
+    }
+
+    for (int i = 8; i < 40; i++) {
+        // W[2i..2i+1] = s1(W[2i-2..]) + W[2i-7..] + s0(W[2i-15..]) + W[2i-16..]
+        __m256i w16 = x[i & 7];
+        __m256i w15 = _mm256_alignr_epi8(x[(i - 7) & 7], x[i & 7], 8);
+        __m256i w7  = _mm256_alignr_epi8(x[(i - 3) & 7], x[(i - 4) & 7], 8);
+        __m256i w2  = x[(i - 1) & 7];
+        x[i & 7] = _mm256_add_epi64(_mm256_add_epi64(w16, s0_x2(w15)),
+                                    _mm256_add_epi64(w7, s1_x2(w2)));
+        __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)&sha2_sha512_k[2 * i]));
+        _mm256_storeu_si256((__m256i *)(wk + 4 * i), _mm256_add_epi64(x[i & 7], k));
+    }
+}
+
+#define ROTR64(x, n)    (((x) >> (n)) | ((x) << (64 - (n))))
+#define BSIG0(x)        (ROTR64(x, 28) ^ ROTR64(x, 34) ^ ROTR64(x, 39))
+#define BSIG1(x)        (ROTR64(x, 14) ^ ROTR64(x, 18) ^ ROTR64(x, 41))
+#define CH64(x, y, z)   (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ64(x, y, z)  (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+
+/* One round with the variables renamed instead of shifted; wk is W[t] + K[t] */
+#define RND512(a, b, c, d, e, f, g, h, wk)                      \
+    t1 = (h) + BSIG1(e) + CH64(e, f, g) + (wk);                 \
+    (d) += t1;                                                  \
+    (h) = t1 + BSIG0(a) + MAJ64(a, b, c);
+
+/**
+ * @brief 80 rounds on one block whose W + K words are at p[4 * (t / 2) + (t % 2)] (see sha512_schedule_x2).
+ */
+static void sha512_rounds(u64 *state, const u64 *p) {
+    u64 a = state[0], b = state[1], c = state[2], d = state[3];
+    u64 e = state[4], f = state[5], g = state[6], h = state[7];
+    u64 t1;
+
+    for (int t = 0; t < 80; t += 8, p += 16) {
+        RND512(a, b, c, d, e, f, g, h, p[0])
+        RND512(h, a, b, c, d, e, f, g, p[1])
+        RND512(g, h, a, b, c, d, e, f, p[4])
+        RND512(f, g, h, a, b, c, d, e, p[5])
+        RND512(e, f, g, h, a, b, c, d, p[8])
+        RND512(d, e, f, g, h, a, b, c, p[9])
+        RND512(c, d, e, f, g, h, a, b, p[12])
+        RND512(b, c, d, e, f, g, h, a, p[13])
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static u64 load_be64(const u8 *x) {
+    u64 v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | x[i];
+    return v;
+}
+
+static void store_be64(u8 *x, u64 v) {
+    for (int i = 7; i >= 0; i--) {
+        x[i] = (u8)v;
+        v >>= 8;
+    }
+}
+
+size_t crypto_hashblocks_sha512_avx2_x2(u8 *statebytes, const u8 *in, size_t inlen) {
+    u64 wk[4 * 40];     // [W0 W1 | W0' W1'] [W2 W3 | W2' W3'] ... (block 0 | block 1), plus K
+    u64 state[8];
+
+    for (int i = 0; i < 8; i++) {
+        state[i] = load_be64(statebytes + 8 * i);
+    }
+
+    while (inlen >= 256) {
+        sha512_schedule_x2(wk, in, in + 128);
+        sha512_rounds(state, wk);
+        sha512_rounds(state, wk + 2);
+
+        in += 256;
+        inlen -= 256;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        store_be64(statebytes + 8 * i, state[i]);
+    }
+    return inlen;
+}
+
+#endif /* SHA2_HAVE_X86 */
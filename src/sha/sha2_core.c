@@ -1,21 +1,18 @@
 // SPDX-License-Identifier: Public domain
 
-// #include <oqs/oqs.h>
-
-// #include "sha2_local.h"
-// #include <stdio.h>
-
-#define PQC_SHA256CTX_BYTES 40
-#define PQC_SHA512CTX_BYTES 72
 /* Based on the public domain implementation in
  * crypto_hash/sha512/ref/ from http://bench.cr.yp.to/supercop.html
  * by D. J. Bernstein */
 
+#include <pthread.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha2.h"
+
 static uint32_t load_bigendian_32(const uint8_t *x) {
 	return (uint32_t)(x[3]) | (((uint32_t)(x[2])) << 8) |
 	       (((uint32_t)(x[1])) << 16) | (((uint32_t)(x[0])) << 24);
@@ -469,6 +466,42 @@ static size_t crypto_hashblocks_sha512_c(uint8_t *statebytes,
 	return inlen;
 }
 
+/* SHA-256 round constants as words, for the vector backends */
+const uint32_t sha2_sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/* SHA-512 round constants as words, for the vector backends */
+const uint64_t sha2_sha512_k[80] = {
+	0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+	0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+	0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+	0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+	0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+	0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+	0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+	0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+	0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+	0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+	0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+	0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+	0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+	0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+	0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+	0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+	0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
 static const uint8_t iv_224[32] = {
 	0xc1, 0x05, 0x9e, 0xd8, 0x36, 0x7c, 0xd5, 0x07,
 	0x30, 0x70, 0xdd, 0x17, 0xf7, 0x0e, 0x59, 0x39,
@@ -501,345 +534,431 @@ static const uint8_t iv_512[64] = {
 	0x6b, 0x5b, 0xe0, 0xcd, 0x19, 0x13, 0x7e, 0x21, 0x79
 };
 
-// void oqs_sha2_sha224_inc_init_c(sha224ctx *state) {
-// 	state->ctx = OQS_MEM_malloc(PQC_SHA256CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(state->ctx, "SHA2");
-// 	for (size_t i = 0; i < 32; ++i) {
-// 		state->ctx[i] = iv_224[i];
-// 	}
-// 	for (size_t i = 32; i < 40; ++i) {
-// 		state->ctx[i] = 0;
-// 	}
-// 	state->data_len = 0;
-// 	memset(state->data, 0, 128);
-// }
-
-// void oqs_sha2_sha256_inc_init_c(sha256ctx *state) {
-// 	state->data_len = 0;
-// 	state->ctx = OQS_MEM_malloc(PQC_SHA256CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(state->ctx, "SHA2");
-// 	for (size_t i = 0; i < 32; ++i) {
-// 		state->ctx[i] = iv_256[i];
-// 	}
-// 	for (size_t i = 32; i < 40; ++i) {
-// 		state->ctx[i] = 0;
-// 	}
-// 	state->data_len = 0;
-// 	memset(state->data, 0, 128);
-// }
-
-// void oqs_sha2_sha384_inc_init_c(sha384ctx *state) {
-// 	state->ctx = OQS_MEM_malloc(PQC_SHA512CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(state->ctx, "SHA2");
-// 	for (size_t i = 0; i < 64; ++i) {
-// 		state->ctx[i] = iv_384[i];
-// 	}
-// 	for (size_t i = 64; i < 72; ++i) {
-// 		state->ctx[i] = 0;
-// 	}
-// 	state->data_len = 0;
-// 	memset(state->data, 0, 128);
-// }
-
-// void oqs_sha2_sha512_inc_init_c(sha512ctx *state) {
-// 	state->ctx = OQS_MEM_malloc(PQC_SHA512CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(state->ctx, "SHA2");
-// 	for (size_t i = 0; i < 64; ++i) {
-// 		state->ctx[i] = iv_512[i];
-// 	}
-// 	for (size_t i = 64; i < 72; ++i) {
-// 		state->ctx[i] = 0;
-// 	}
-// 	state->data_len = 0;
-// 	memset(state->data, 0, 128);
-// }
-
-// void oqs_sha2_sha224_inc_ctx_clone_c(sha224ctx *stateout, const sha224ctx *statein) {
-// 	stateout->ctx = OQS_MEM_malloc(PQC_SHA256CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(stateout->ctx, "SHA2");
-// 	stateout->data_len = statein->data_len;
-// 	memcpy(stateout->data, statein->data, 128);
-// 	memcpy(stateout->ctx, statein->ctx, PQC_SHA256CTX_BYTES);
-// }
-
-// void oqs_sha2_sha256_inc_ctx_clone_c(sha256ctx *stateout, const sha256ctx *statein) {
-// 	stateout->ctx = OQS_MEM_malloc(PQC_SHA256CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(stateout->ctx, "SHA2");
-// 	stateout->data_len = statein->data_len;
-// 	memcpy(stateout->data, statein->data, 128);
-// 	memcpy(stateout->ctx, statein->ctx, PQC_SHA256CTX_BYTES);
-// }
-
-// void oqs_sha2_sha384_inc_ctx_clone_c(sha384ctx *stateout, const sha384ctx *statein) {
-// 	stateout->ctx = OQS_MEM_malloc(PQC_SHA512CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(stateout->ctx, "SHA2");
-// 	stateout->data_len = statein->data_len;
-// 	memcpy(stateout->data, statein->data, 128);
-// 	memcpy(stateout->ctx, statein->ctx, PQC_SHA512CTX_BYTES);
-// }
-
-// void oqs_sha2_sha512_inc_ctx_clone_c(sha512ctx *stateout, const sha512ctx *statein) {
-// 	stateout->ctx = OQS_MEM_malloc(PQC_SHA512CTX_BYTES);
-// 	OQS_EXIT_IF_NULLPTR(stateout->ctx, "SHA2");
-// 	stateout->data_len = statein->data_len;
-// 	memcpy(stateout->data, statein->data, 128);
-// 	memcpy(stateout->ctx, statein->ctx, PQC_SHA512CTX_BYTES);
-// }
-
-// /* Destroy the hash state. */
-// void oqs_sha2_sha224_inc_ctx_release_c(sha224ctx *state) {
-// 	OQS_MEM_insecure_free(state->ctx);
-// }
-
-// /* Destroy the hash state. */
-// void oqs_sha2_sha256_inc_ctx_release_c(sha256ctx *state) {
-// 	OQS_MEM_insecure_free(state->ctx);
-// }
-
-// /* Destroy the hash state. */
-// void oqs_sha2_sha384_inc_ctx_release_c(sha384ctx *state) {
-// 	OQS_MEM_insecure_free(state->ctx);
-// }
-
-// /* Destroy the hash state. */
-// void oqs_sha2_sha512_inc_ctx_release_c(sha512ctx *state) {
-// 	OQS_MEM_insecure_free(state->ctx);
-// }
-
-// void oqs_sha2_sha256_inc_blocks_c(sha256ctx *state, const uint8_t *in, size_t inblocks) {
-// 	uint64_t bytes = load_bigendian_64(state->ctx + 32);
-// 	size_t tmp_buflen = 64 * inblocks;
-// 	const uint8_t *new_in;
-// 	uint8_t *tmp_in = NULL;
-
-// 	/*  Process any existing incremental data first */
-// 	if (state->data_len) {
-// 		tmp_in = OQS_MEM_malloc(tmp_buflen);
-// 		OQS_EXIT_IF_NULLPTR(tmp_in, "SHA2");
-// 		memcpy(tmp_in, state->data, state->data_len);
-// 		memcpy(tmp_in + state->data_len, in, tmp_buflen - state->data_len);
-
-// 		/* store the reminder input as incremental data */
-// 		memcpy(state->data, in + (tmp_buflen - state->data_len), state->data_len);
-// 		new_in = tmp_in;
-// 	} else {
-// 		new_in = in;
-// 	}
-
-// 	crypto_hashblocks_sha256_c(state->ctx, new_in, 64 * inblocks);
-// 	bytes += 64 * inblocks;
-
-// 	store_bigendian_64(state->ctx + 32, bytes);
-// 	OQS_MEM_secure_free(tmp_in, tmp_buflen);
-// }
-
-// void oqs_sha2_sha256_inc_c(sha256ctx *state, const uint8_t *in, size_t len) {
-// 	while (len) {
-// 		size_t incr = 64 - state->data_len;
-// 		if (incr > len) {
-// 			incr = len;
-// 		}
-
-// 		memcpy(state->data + state->data_len, in, incr);
-// 		state->data_len += incr;
-// 		in += incr;
-
-// 		if (state->data_len < 64) {
-// 			break;
-// 		}
-
-// 		/*
-// 		 * Process a complete block now
-// 		 */
-// 		uint64_t bytes = load_bigendian_64(state->ctx + 32) + 64;
-// 		crypto_hashblocks_sha256_c(state->ctx, state->data, 64);
-// 		store_bigendian_64(state->ctx + 32, bytes);
-
-// 		/*
-// 		 * update the remaining input
-// 		 */
-// 		len -= incr;
-// 		state->data_len = 0;
-// 	}
-// }
-
-// void oqs_sha2_sha224_inc_blocks_c(sha224ctx *state, const uint8_t *in, size_t inblocks) {
-// 	oqs_sha2_sha256_inc_blocks_c((sha256ctx *) state, in, inblocks);
-// }
-
-// void oqs_sha2_sha512_inc_blocks_c(sha512ctx *state, const uint8_t *in, size_t inblocks) {
-// 	uint64_t bytes = load_bigendian_64(state->ctx + 64);
-
-// 	crypto_hashblocks_sha512_c(state->ctx, in, 128 * inblocks);
-// 	bytes += 128 * inblocks;
-
-// 	store_bigendian_64(state->ctx + 64, bytes);
-// }
-
-// void oqs_sha2_sha384_inc_blocks_c(sha384ctx *state, const uint8_t *in, size_t inblocks) {
-// 	oqs_sha2_sha512_inc_blocks_c((sha512ctx *) state, in, inblocks);
-// }
-
-// void oqs_sha2_sha256_inc_finalize_c(uint8_t *out, sha256ctx *state, const uint8_t *in, size_t inlen) {
-// 	uint8_t padded[128];
-
-// 	size_t new_inlen = state->data_len + inlen;
-// 	size_t tmp_len = new_inlen;
-// 	const uint8_t *new_in;
-// 	uint8_t *tmp_in = NULL;
-
-// 	if (new_inlen == inlen) {
-// 		new_in = in;
-// 	} else { //Combine incremental data with final input
-// 		tmp_in = OQS_MEM_malloc(tmp_len);
-// 		OQS_EXIT_IF_NULLPTR(tmp_in, "SHA2");
-// 		memcpy(tmp_in, state->data, state->data_len);
-// 		if (in && inlen) {
-// 			memcpy(tmp_in + state->data_len, in, inlen);
-// 		}
-// 		new_in = tmp_in;
-// 		state->data_len = 0;
-// 	}
-
-// 	uint64_t bytes = load_bigendian_64(state->ctx + 32) + new_inlen;
-
-// 	crypto_hashblocks_sha256_c(state->ctx, new_in, new_inlen);
-// 	new_in += new_inlen;
-// 	new_inlen &= 63;
-// 	new_in -= new_inlen;
-
-// 	for (size_t i = 0; i < new_inlen; ++i) {
-// 		padded[i] = new_in[i];
-// 	}
-// 	padded[new_inlen] = 0x80;
-
-// 	if (new_inlen < 56) {
-// 		for (size_t i = new_inlen + 1; i < 56; ++i) {
-// 			padded[i] = 0;
-// 		}
-// 		padded[56] = (uint8_t) (bytes >> 53);
-// 		padded[57] = (uint8_t) (bytes >> 45);
-// 		padded[58] = (uint8_t) (bytes >> 37);
-// 		padded[59] = (uint8_t) (bytes >> 29);
-// 		padded[60] = (uint8_t) (bytes >> 21);
-// 		padded[61] = (uint8_t) (bytes >> 13);
-// 		padded[62] = (uint8_t) (bytes >> 5);
-// 		padded[63] = (uint8_t) (bytes << 3);
-// 		crypto_hashblocks_sha256_c(state->ctx, padded, 64);
-// 	} else {
-// 		for (size_t i = new_inlen + 1; i < 120; ++i) {
-// 			padded[i] = 0;
-// 		}
-// 		padded[120] = (uint8_t) (bytes >> 53);
-// 		padded[121] = (uint8_t) (bytes >> 45);
-// 		padded[122] = (uint8_t) (bytes >> 37);
-// 		padded[123] = (uint8_t) (bytes >> 29);
-// 		padded[124] = (uint8_t) (bytes >> 21);
-// 		padded[125] = (uint8_t) (bytes >> 13);
-// 		padded[126] = (uint8_t) (bytes >> 5);
-// 		padded[127] = (uint8_t) (bytes << 3);
-// 		crypto_hashblocks_sha256_c(state->ctx, padded, 128);
-// 	}
-
-// 	for (size_t i = 0; i < 32; ++i) {
-// 		out[i] = state->ctx[i];
-// 	}
-// 	oqs_sha2_sha256_inc_ctx_release_c(state);
-// 	OQS_MEM_secure_free(tmp_in, tmp_len);
-// }
-
-// void oqs_sha2_sha224_inc_finalize_c(uint8_t *out, sha224ctx *state, const uint8_t *in, size_t inlen) {
-// 	uint8_t tmp[32];
-// 	oqs_sha2_sha256_inc_finalize_c(tmp, (sha256ctx *)state, in, inlen);
-
-// 	for (size_t i = 0; i < 28; ++i) {
-// 		out[i] = tmp[i];
-// 	}
-// }
-
-// void oqs_sha2_sha512_inc_finalize_c(uint8_t *out, sha512ctx *state, const uint8_t *in, size_t inlen) {
-// 	uint8_t padded[256];
-// 	uint64_t bytes = load_bigendian_64(state->ctx + 64) + inlen;
-
-// 	crypto_hashblocks_sha512_c(state->ctx, in, inlen);
-// 	in += inlen;
-// 	inlen &= 127;
-// 	in -= inlen;
-
-// 	for (size_t i = 0; i < inlen; ++i) {
-// 		padded[i] = in[i];
-// 	}
-// 	padded[inlen] = 0x80;
-
-// 	if (inlen < 112) {
-// 		for (size_t i = inlen + 1; i < 119; ++i) {
-// 			padded[i] = 0;
-// 		}
-// 		padded[119] = (uint8_t) (bytes >> 61);
-// 		padded[120] = (uint8_t) (bytes >> 53);
-// 		padded[121] = (uint8_t) (bytes >> 45);
-// 		padded[122] = (uint8_t) (bytes >> 37);
-// 		padded[123] = (uint8_t) (bytes >> 29);
-// 		padded[124] = (uint8_t) (bytes >> 21);
-// 		padded[125] = (uint8_t) (bytes >> 13);
-// 		padded[126] = (uint8_t) (bytes >> 5);
-// 		padded[127] = (uint8_t) (bytes << 3);
-// 		crypto_hashblocks_sha512_c(state->ctx, padded, 128);
-// 	} else {
-// 		for (size_t i = inlen + 1; i < 247; ++i) {
-// 			padded[i] = 0;
-// 		}
-// 		padded[247] = (uint8_t) (bytes >> 61);
-// 		padded[248] = (uint8_t) (bytes >> 53);
-// 		padded[249] = (uint8_t) (bytes >> 45);
-// 		padded[250] = (uint8_t) (bytes >> 37);
-// 		padded[251] = (uint8_t) (bytes >> 29);
-// 		padded[252] = (uint8_t) (bytes >> 21);
-// 		padded[253] = (uint8_t) (bytes >> 13);
-// 		padded[254] = (uint8_t) (bytes >> 5);
-// 		padded[255] = (uint8_t) (bytes << 3);
-// 		crypto_hashblocks_sha512_c(state->ctx, padded, 256);
-// 	}
-
-// 	for (size_t i = 0; i < 64; ++i) {
-// 		out[i] = state->ctx[i];
-// 	}
-// 	oqs_sha2_sha512_inc_ctx_release_c(state);
-// }
-
-// void oqs_sha2_sha384_inc_finalize_c(uint8_t *out, sha384ctx *state, const uint8_t *in, size_t inlen) {
-// 	uint8_t tmp[64];
-// 	oqs_sha2_sha512_inc_finalize_c(tmp, (sha512ctx *)state, in, inlen);
-
-// 	for (size_t i = 0; i < 48; ++i) {
-// 		out[i] = tmp[i];
-// 	}
-// }
-
-// void oqs_sha2_sha224_c(uint8_t *out, const uint8_t *in, size_t inlen) {
-// 	sha224ctx state;
-
-// 	oqs_sha2_sha224_inc_init_c(&state);
-// 	oqs_sha2_sha224_inc_finalize_c(out, &state, in, inlen);
-// }
-
-// void oqs_sha2_sha256_c(uint8_t *out, const uint8_t *in, size_t inlen) {
-// 	sha256ctx state;
-
-// 	oqs_sha2_sha256_inc_init_c(&state);
-// 	oqs_sha2_sha256_inc_finalize_c(out, &state, in, inlen);
-// }
-
-// void oqs_sha2_sha384_c(uint8_t *out, const uint8_t *in, size_t inlen) {
-// 	sha384ctx state;
-
-// 	oqs_sha2_sha384_inc_init_c(&state);
-// 	oqs_sha2_sha384_inc_finalize_c(out, &state, in, inlen);
-// }
-
-// void oqs_sha2_sha512_c(uint8_t *out, const uint8_t *in, size_t inlen) {
-// 	sha512ctx state;
-
-// 	oqs_sha2_sha512_inc_init_c(&state);
-// 	oqs_sha2_sha512_inc_finalize_c(out, &state, in, inlen);
-// }
+/*
+ * SHA-256 block function dispatch. The pointer starts at a resolver, so the first call selects
+ * the backend even if SHA2_init_dispatch() (run by cryptomodule_init) was never called. The
+ * resolver only installs the SHA-256 default, once, so it never overrides a backend forced on
+ * SHA-512 or the multi-buffer path; the pointer and backend are read and written atomically
+ * because that first call can come from any thread.
+ */
+typedef size_t (*sha2_hashblocks_fn)(uint8_t *statebytes, const uint8_t *in, size_t inlen);
+
+static size_t sha256_hashblocks_resolve(uint8_t *statebytes, const uint8_t *in, size_t inlen);
+
+static sha2_hashblocks_fn sha256_hashblocks = sha256_hashblocks_resolve;
+static SHA2_backend_t sha256_backend = SHA2_BACKEND_C;
+static pthread_once_t sha256_resolve_once = PTHREAD_ONCE_INIT;
+
+bool SHA2_sha256_set_backend(SHA2_backend_t backend) {
+	sha2_hashblocks_fn fn;
+
+	switch (backend) {
+	case SHA2_BACKEND_C:
+		fn = crypto_hashblocks_sha256_c;
+		break;
+#if SHA2_HAVE_X86
+	case SHA2_BACKEND_SHA_NI:
+		if (!sha2_cpu_has_sha_ni()) {
+			return false;
+		}
+		fn = crypto_hashblocks_sha256_ni;
+		break;
+#endif
+	default:
+		return false;
+	}
+	__atomic_store_n(&sha256_hashblocks, fn, __ATOMIC_RELAXED);
+	__atomic_store_n(&sha256_backend, backend, __ATOMIC_RELAXED);
+	return true;
+}
+
+SHA2_backend_t SHA2_sha256_get_backend(void) {
+	return __atomic_load_n(&sha256_backend, __ATOMIC_RELAXED);
+}
+
+void SHA2_sha256_init_dispatch(void) {
+	if (!SHA2_sha256_set_backend(SHA2_BACKEND_SHA_NI)) {
+		SHA2_sha256_set_backend(SHA2_BACKEND_C);
+	}
+}
+
+void SHA2_init_dispatch(void) {
+	SHA2_sha256_init_dispatch();
+	SHA2_sha512_init_dispatch();
+	SHA2_sha256_multi_init_dispatch();
+}
+
+static size_t sha256_hashblocks_resolve(uint8_t *statebytes, const uint8_t *in, size_t inlen) {
+	pthread_once(&sha256_resolve_once, SHA2_sha256_init_dispatch);
+	return crypto_hashblocks_sha256(statebytes, in, inlen);
+}
+
+size_t crypto_hashblocks_sha256(uint8_t *statebytes, const uint8_t *in, size_t inlen) {
+	return __atomic_load_n(&sha256_hashblocks, __ATOMIC_RELAXED)(statebytes, in, inlen);
+}
+
+#if SHA2_HAVE_X86
+/* Pairs of blocks through the AVX2 schedule, an odd last block through the C rounds */
+static size_t crypto_hashblocks_sha512_avx2(uint8_t *statebytes, const uint8_t *in, size_t inlen) {
+	size_t rest = inlen;
+	if (inlen >= 256) {
+		rest = crypto_hashblocks_sha512_avx2_x2(statebytes, in, inlen);
+	}
+	return crypto_hashblocks_sha512_c(statebytes, in + (inlen - rest), rest);
+}
+#endif
+
+/* SHA-512 block function dispatch, resolved the same way */
+static size_t sha512_hashblocks_resolve(uint8_t *statebytes, const uint8_t *in, size_t inlen);
+
+static sha2_hashblocks_fn sha512_hashblocks = sha512_hashblocks_resolve;
+static SHA2_backend_t sha512_backend = SHA2_BACKEND_C;
+static pthread_once_t sha512_resolve_once = PTHREAD_ONCE_INIT;
+
+bool SHA2_sha512_set_backend(SHA2_backend_t backend) {
+	sha2_hashblocks_fn fn;
+
+	switch (backend) {
+	case SHA2_BACKEND_C:
+		fn = crypto_hashblocks_sha512_c;
+		break;
+#if SHA2_HAVE_X86
+	case SHA2_BACKEND_AVX2:
+		if (!sha2_cpu_has_avx2()) {
+			return false;
+		}
+		fn = crypto_hashblocks_sha512_avx2;
+		break;
+#endif
+	default:
+		return false;
+	}
+	__atomic_store_n(&sha512_hashblocks, fn, __ATOMIC_RELAXED);
+	__atomic_store_n(&sha512_backend, backend, __ATOMIC_RELAXED);
+	return true;
+}
+
+SHA2_backend_t SHA2_sha512_get_backend(void) {
+	return __atomic_load_n(&sha512_backend, __ATOMIC_RELAXED);
+}
+
+void SHA2_sha512_init_dispatch(void) {
+	if (!SHA2_sha512_set_backend(SHA2_BACKEND_AVX2)) {
+		SHA2_sha512_set_backend(SHA2_BACKEND_C);
+	}
+}
+
+static size_t sha512_hashblocks_resolve(uint8_t *statebytes, const uint8_t *in, size_t inlen) {
+	pthread_once(&sha512_resolve_once, SHA2_sha512_init_dispatch);
+	return crypto_hashblocks_sha512(statebytes, in, inlen);
+}
+
+size_t crypto_hashblocks_sha512(uint8_t *statebytes, const uint8_t *in, size_t inlen) {
+	return __atomic_load_n(&sha512_hashblocks, __ATOMIC_RELAXED)(statebytes, in, inlen);
+}
+
+/*
+ * The contexts live with the caller, so none of the functions below allocate. Input is
+ * compressed straight from the caller's buffer whenever it is block aligned; only a partial
+ * block is ever copied into state->data.
+ */
+
+void SHA2_sha224_inc_init(SHA2_sha224_ctx *state) {
+	memcpy(state->ctx, iv_224, 32);
+	memset(state->ctx + 32, 0, 8);
+	memset(state->data, 0, sizeof(state->data));
+	state->data_len = 0;
+}
+
+void SHA2_sha256_inc_init(SHA2_sha256_ctx *state) {
+	memcpy(state->ctx, iv_256, 32);
+	memset(state->ctx + 32, 0, 8);
+	memset(state->data, 0, sizeof(state->data));
+	state->data_len = 0;
+}
+
+void SHA2_sha384_inc_init(SHA2_sha384_ctx *state) {
+	memcpy(state->ctx, iv_384, 64);
+	memset(state->ctx + 64, 0, 8);
+	memset(state->data, 0, sizeof(state->data));
+	state->data_len = 0;
+}
+
+void SHA2_sha512_inc_init(SHA2_sha512_ctx *state) {
+	memcpy(state->ctx, iv_512, 64);
+	memset(state->ctx + 64, 0, 8);
+	memset(state->data, 0, sizeof(state->data));
+	state->data_len = 0;
+}
+
+void SHA2_sha224_inc_ctx_clone(SHA2_sha224_ctx *stateout, const SHA2_sha224_ctx *statein) {
+	memcpy(stateout, statein, sizeof(*stateout));
+}
+
+void SHA2_sha256_inc_ctx_clone(SHA2_sha256_ctx *stateout, const SHA2_sha256_ctx *statein) {
+	memcpy(stateout, statein, sizeof(*stateout));
+}
+
+void SHA2_sha384_inc_ctx_clone(SHA2_sha384_ctx *stateout, const SHA2_sha384_ctx *statein) {
+	memcpy(stateout, statein, sizeof(*stateout));
+}
+
+void SHA2_sha512_inc_ctx_clone(SHA2_sha512_ctx *stateout, const SHA2_sha512_ctx *statein) {
+	memcpy(stateout, statein, sizeof(*stateout));
+}
+
+/* Destroy the hash state. */
+void SHA2_sha224_inc_ctx_release(SHA2_sha224_ctx *state) {
+	memset(state, 0, sizeof(*state));
+}
+
+/* Destroy the hash state. */
+void SHA2_sha256_inc_ctx_release(SHA2_sha256_ctx *state) {
+	memset(state, 0, sizeof(*state));
+}
+
+/* Destroy the hash state. */
+void SHA2_sha384_inc_ctx_release(SHA2_sha384_ctx *state) {
+	memset(state, 0, sizeof(*state));
+}
+
+/* Destroy the hash state. */
+void SHA2_sha512_inc_ctx_release(SHA2_sha512_ctx *state) {
+	memset(state, 0, sizeof(*state));
+}
+
+void SHA2_sha256_inc(SHA2_sha256_ctx *state, const uint8_t *in, size_t len) {
+	uint64_t bytes = load_bigendian_64(state->ctx + 32);
+
+	/* Top up a pending partial block first */
+	if (state->data_len) {
+		size_t incr = 64 - state->data_len;
+		if (incr > len) {
+			incr = len;
+		}
+		memcpy(state->data + state->data_len, in, incr);
+		state->data_len += incr;
+		in += incr;
+		len -= incr;
+
+		if (state->data_len < 64) {
+			return;
+		}
+		crypto_hashblocks_sha256(state->ctx, state->data, 64);
+		bytes += 64;
+		state->data_len = 0;
+	}
+
+	/* Whole blocks directly from the input */
+	size_t whole = len & ~(size_t)63;
+	if (whole) {
+		crypto_hashblocks_sha256(state->ctx, in, whole);
+		bytes += whole;
+		in += whole;
+		len -= whole;
+	}
+
+	if (len) {
+		memcpy(state->data, in, len);
+		state->data_len = len;
+	}
+	store_bigendian_64(state->ctx + 32, bytes);
+}
+
+void SHA2_sha224_inc(SHA2_sha224_ctx *state, const uint8_t *in, size_t len) {
+	SHA2_sha256_inc(state, in, len);
+}
+
+void SHA2_sha256_inc_blocks(SHA2_sha256_ctx *state, const uint8_t *in, size_t inblocks) {
+	if (state->data_len) {
+		SHA2_sha256_inc(state, in, 64 * inblocks);
+		return;
+	}
+
+	uint64_t bytes = load_bigendian_64(state->ctx + 32);
+	crypto_hashblocks_sha256(state->ctx, in, 64 * inblocks);
+	bytes += 64 * inblocks;
+	store_bigendian_64(state->ctx + 32, bytes);
+}
+
+void SHA2_sha224_inc_blocks(SHA2_sha224_ctx *state, const uint8_t *in, size_t inblocks) {
+	SHA2_sha256_inc_blocks(state, in, inblocks);
+}
+
+void SHA2_sha512_inc(SHA2_sha512_ctx *state, const uint8_t *in, size_t len) {
+	uint64_t bytes = load_bigendian_64(state->ctx + 64);
+
+	/* Top up a pending partial block first */
+	if (state->data_len) {
+		size_t incr = 128 - state->data_len;
+		if (incr > len) {
+			incr = len;
+		}
+		memcpy(state->data + state->data_len, in, incr);
+		state->data_len += incr;
+		in += incr;
+		len -= incr;
+
+		if (state->data_len < 128) {
+			return;
+		}
+		crypto_hashblocks_sha512(state->ctx, state->data, 128);
+		bytes += 128;
+		state->data_len = 0;
+	}
+
+	/* Whole blocks directly from the input */
+	size_t whole = len & ~(size_t)127;
+	if (whole) {
+		crypto_hashblocks_sha512(state->ctx, in, whole);
+		bytes += whole;
+		in += whole;
+		len -= whole;
+	}
+
+	if (len) {
+		memcpy(state->data, in, len);
+		state->data_len = len;
+	}
+	store_bigendian_64(state->ctx + 64, bytes);
+}
+
+void SHA2_sha384_inc(SHA2_sha384_ctx *state, const uint8_t *in, size_t len) {
+	SHA2_sha512_inc(state, in, len);
+}
+
+void SHA2_sha512_inc_blocks(SHA2_sha512_ctx *state, const uint8_t *in, size_t inblocks) {
+	if (state->data_len) {
+		SHA2_sha512_inc(state, in, 128 * inblocks);
+		return;
+	}
+
+	uint64_t bytes = load_bigendian_64(state->ctx + 64);
+	crypto_hashblocks_sha512(state->ctx, in, 128 * inblocks);
+	bytes += 128 * inblocks;
+	store_bigendian_64(state->ctx + 64, bytes);
+}
+
+void SHA2_sha384_inc_blocks(SHA2_sha384_ctx *state, const uint8_t *in, size_t inblocks) {
+	SHA2_sha512_inc_blocks(state, in, inblocks);
+}
+
+size_t SHA2_sha256_pad(uint8_t *padded, const uint8_t *in, size_t inlen, uint64_t bytes) {
+	if (inlen) {
+		memcpy(padded, in, inlen);
+	}
+	padded[inlen] = 0x80;
+
+	if (inlen < 56) {
+		for (size_t i = inlen + 1; i < 56; ++i) {
+			padded[i] = 0;
+		}
+		padded[56] = (uint8_t) (bytes >> 53);
+		padded[57] = (uint8_t) (bytes >> 45);
+		padded[58] = (uint8_t) (bytes >> 37);
+		padded[59] = (uint8_t) (bytes >> 29);
+		padded[60] = (uint8_t) (bytes >> 21);
+		padded[61] = (uint8_t) (bytes >> 13);
+		padded[62] = (uint8_t) (bytes >> 5);
+		padded[63] = (uint8_t) (bytes << 3);
+		return 64;
+	}
+
+	for (size_t i = inlen + 1; i < 120; ++i) {
+		padded[i] = 0;
+	}
+	padded[120] = (uint8_t) (bytes >> 53);
+	padded[121] = (uint8_t) (bytes >> 45);
+	padded[122] = (uint8_t) (bytes >> 37);
+	padded[123] = (uint8_t) (bytes >> 29);
+	padded[124] = (uint8_t) (bytes >> 21);
+	padded[125] = (uint8_t) (bytes >> 13);
+	padded[126] = (uint8_t) (bytes >> 5);
+	padded[127] = (uint8_t) (bytes << 3);
+	return 128;
+}
+
+static void sha256_inc_finalize(uint8_t *out, size_t outlen, SHA2_sha256_ctx *state, const uint8_t *in, size_t inlen) {
+	uint8_t padded[128];
+
+	if (inlen) {
+		SHA2_sha256_inc(state, in, inlen);
+	}
+
+	uint64_t bytes = load_bigendian_64(state->ctx + 32) + state->data_len;
+	size_t padded_len = SHA2_sha256_pad(padded, state->data, state->data_len, bytes);
+	crypto_hashblocks_sha256(state->ctx, padded, padded_len);
+
+	memcpy(out, state->ctx, outlen);
+	memset(padded, 0, sizeof(padded));
+	SHA2_sha256_inc_ctx_release(state);
+}
+
+void SHA2_sha256_inc_finalize(uint8_t *out, SHA2_sha256_ctx *state, const uint8_t *in, size_t inlen) {
+	sha256_inc_finalize(out, SHA2_SHA256_DIGEST_SIZE, state, in, inlen);
+}
+
+void SHA2_sha224_inc_finalize(uint8_t *out, SHA2_sha224_ctx *state, const uint8_t *in, size_t inlen) {
+	sha256_inc_finalize(out, SHA2_SHA224_DIGEST_SIZE, state, in, inlen);
+}
+
+size_t SHA2_sha512_pad(uint8_t *padded, const uint8_t *in, size_t inlen, uint64_t bytes) {
+	if (inlen) {
+		memcpy(padded, in, inlen);
+	}
+	padded[inlen] = 0x80;
+
+	if (inlen < 112) {
+		for (size_t i = inlen + 1; i < 119; ++i) {
+			padded[i] = 0;
+		}
+		padded[119] = (uint8_t) (bytes >> 61);
+		padded[120] = (uint8_t) (bytes >> 53);
+		padded[121] = (uint8_t) (bytes >> 45);
+		padded[122] = (uint8_t) (bytes >> 37);
+		padded[123] = (uint8_t) (bytes >> 29);
+		padded[124] = (uint8_t) (bytes >> 21);
+		padded[125] = (uint8_t) (bytes >> 13);
+		padded[126] = (uint8_t) (bytes >> 5);
+		padded[127] = (uint8_t) (bytes << 3);
+		return 128;
+	}
+
+	for (size_t i = inlen + 1; i < 247; ++i) {
+		padded[i] = 0;
+	}
+	padded[247] = (uint8_t) (bytes >> 61);
+	padded[248] = (uint8_t) (bytes >> 53);
+	padded[249] = (uint8_t) (bytes >> 45);
+	padded[250] = (uint8_t) (bytes >> 37);
+	padded[251] = (uint8_t) (bytes >> 29);
+	padded[252] = (uint8_t) (bytes >> 21);
+	padded[253] = (uint8_t) (bytes >> 13);
+	padded[254] = (uint8_t) (bytes >> 5);
+	padded[255] = (uint8_t) (bytes << 3);
+	return 256;
+}
+
+static void sha512_inc_finalize(uint8_t *out, size_t outlen, SHA2_sha512_ctx *state, const uint8_t *in, size_t inlen) {
+	uint8_t padded[256];
+
+	if (inlen) {
+		SHA2_sha512_inc(state, in, inlen);
+	}
+
+	uint64_t bytes = load_bigendian_64(state->ctx + 64) + state->data_len;
+	size_t padded_len = SHA2_sha512_pad(padded, state->data, state->data_len, bytes);
+	crypto_hashblocks_sha512(state->ctx, padded, padded_len);
+
+	memcpy(out, state->ctx, outlen);
+	memset(padded, 0, sizeof(padded));
+	SHA2_sha512_inc_ctx_release(state);
+}
+
+void SHA2_sha512_inc_finalize(uint8_t *out, SHA2_sha512_ctx *state, const uint8_t *in, size_t inlen) {
+	sha512_inc_finalize(out, SHA2_SHA512_DIGEST_SIZE, state, in, inlen);
+}
+
+void SHA2_sha384_inc_finalize(uint8_t *out, SHA2_sha384_ctx *state, const uint8_t *in, size_t inlen) {
+	sha512_inc_finalize(out, SHA2_SHA384_DIGEST_SIZE, state, in, inlen);
+}
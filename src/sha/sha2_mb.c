@@ -0,0 +1,471 @@
+/* File: src/sha/sha2_mb.c */
+
+/**
+ * @file sha2_mb.c
+ * @brief Multi-buffer SHA-256: independent messages hashed side by side in SIMD lanes.
+ * @details Lane l of every vector belongs to a different message. The chaining values are kept
+ *          transposed (state[j][l] is word j of lane l), and each step gathers the next 64-byte
+ *          block of every lane and transposes it so that W[t] holds word t of all lanes. Whole
+ *          blocks are read straight from the messages; the last partial block and the padding
+ *          (SHA2_sha256_pad) come from a small per-lane tail buffer. When a message ends, its
+ *          lane writes the digest and is refilled with the next message, so lanes stay busy when
+ *          lengths differ. Idle lanes hash a dummy block whose result is discarded.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha2.h"
+
+#if SHA2_HAVE_X86
+#include <immintrin.h>
+#endif
+
+typedef void (*sha256_xN_fn)(u32 *state, const u8 *const *blocks);
+
+typedef struct {
+    const u8 *msg;          // Message read in place for its whole blocks
+    size_t full_blocks;     // Number of whole blocks in msg
+    size_t num_blocks;      // full_blocks + padded tail blocks (1 or 2)
+    size_t next;            // Next block to hash
+    size_t idx;             // Message index (output slot)
+    bool busy;
+    u8 tail[2 * SHA2_SHA256_BLOCK_SIZE];
+} sha256_lane;
+
+static u32 load_be32(const u8 *x) {
+    return ((u32)x[0] << 24) | ((u32)x[1] << 16) | ((u32)x[2] << 8) | (u32)x[3];
+}
+
+static void store_be32(u8 *x, u32 v) {
+    x[0] = (u8)(v >> 24);
+    x[1] = (u8)(v >> 16);
+    x[2] = (u8)(v >> 8);
+    x[3] = (u8)v;
+}
+
+/**
+ * @brief Drive a lanes-wide kernel over num messages, refilling lanes as messages finish.
+ */
+static void sha256_multi_lanes(size_t lanes, sha256_xN_fn kernel,
+    u8 *out, const u8 *const *in, const size_t *inlen, size_t num) {
+
+    static const u8 idle_block[SHA2_SHA256_BLOCK_SIZE] = { 0x00, };
+    sha256_lane lane[SHA2_SHA256_MB_MAX_LANES];
+    u32 state[8 * SHA2_SHA256_MB_MAX_LANES];
+    const u8 *blocks[SHA2_SHA256_MB_MAX_LANES];
+    u32 iv[8];
+    size_t next_msg = 0, busy = 0;
+
+    SHA2_sha256_ctx init;
+    SHA2_sha256_inc_init(&init);
+    for (int j = 0; j < 8; j++) {
+        iv[j] = load_be32(init.ctx + 4 * j);
+    }
+
+    for (size_t l = 0; l < lanes; l++) {
+        lane[l].busy = false;
+    }
+
+    for (;;) {
+        // Refill idle lanes
+        for (size_t l = 0; l < lanes && next_msg < num; l++) {
+            if (lane[l].busy) continue;
+
+            size_t len = inlen[next_msg];
+            size_t full = len / SHA2_SHA256_BLOCK_SIZE;
+            size_t rem = len - full * SHA2_SHA256_BLOCK_SIZE;
+
+            lane[l].msg = in[next_msg];
+            lane[l].full_blocks = full;
+            lane[l].num_blocks = full + SHA2_sha256_pad(lane[l].tail,
+                in[next_msg] + full * SHA2_SHA256_BLOCK_SIZE, rem, (u64)len) / SHA2_SHA256_BLOCK_SIZE;
+            lane[l].next = 0;
+            lane[l].idx = next_msg++;
+            lane[l].busy = true;
+            for (int j = 0; j < 8; j++) {
+                state[j * lanes + l] = iv[j];
+            }
+            busy++;
+        }
+        if (busy == 0) break;
+
+        for (size_t l = 0; l < lanes; l++) {
+            if (!lane[l].busy) {
+                blocks[l] = idle_block;
+            } else if (lane[l].next < lane[l].full_blocks) {
+                blocks[l] = lane[l].msg + lane[l].next * SHA2_SHA256_BLOCK_SIZE;
+            } else {
+                blocks[l] = lane[l].tail + (lane[l].next - lane[l].full_blocks) * SHA2_SHA256_BLOCK_SIZE;
+            }
+        }
+
+        kernel(state, blocks);
+
+        for (size_t l = 0; l < lanes; l++) {
+            if (!lane[l].busy || ++lane[l].next < lane[l].num_blocks) continue;
+
+            u8 *digest = out + lane[l].idx * SHA2_SHA256_DIGEST_SIZE;
+            for (int j = 0; j < 8; j++) {
+                store_be32(digest + 4 * j, state[j * lanes + l]);
+            }
+            lane[l].busy = false;
+            busy--;
+        }
+    }
+
+    memset(state, 0, sizeof(state));
+    for (size_t l = 0; l < lanes; l++) {
+        memset(lane[l].tail, 0, sizeof(lane[l].tail));
+    }
+}
+
+#if SHA2_HAVE_X86
+
+bool sha2_cpu_has_avx2(void) {
+    return cryptomodule_cpu_has(CRYPTOMODULE_CPU_AVX2);
+}
+
+bool sha2_cpu_has_avx512(void) {
+    return cryptomodule_cpu_has(CRYPTOMODULE_CPU_AVX2 | CRYPTOMODULE_CPU_AVX512F | CRYPTOMODULE_CPU_AVX512BW);
+}
+
+/* ---------------------------------- AVX2, 8 lanes ---------------------------------- */
+
+#define ROR256(x, n)    _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+#define XOR3_256(x, y, z) _mm256_xor_si256(_mm256_xor_si256((x), (y)), (z))
+
+#define S0_256(x)   XOR3_256(ROR256((x), 2), ROR256((x), 13), ROR256((x), 22))
+#define S1_256(x)   XOR3_256(ROR256((x), 6), ROR256((x), 11), ROR256((x), 25))
+#define s0_256(x)   XOR3_256(ROR256((x), 7), ROR256((x), 18), _mm256_srli_epi32((x), 3))
+#define s1_256(x)   XOR3_256(ROR256((x), 17), ROR256((x), 19), _mm256_srli_epi32((x), 10))
+#define CH_256(e, f, g)     _mm256_xor_si256(_mm256_and_si256((e), (f)), _mm256_andnot_si256((e), (g)))
+#define MAJ_256(a, b, c)    _mm256_or_si256(_mm256_and_si256((a), (b)), _mm256_and_si256(_mm256_or_si256((a), (b)), (c)))
+
+/* W[i] for t = base + i >= 16, computed in place in the 16-entry ring */
+#define SCHED_256(i)                                                                \
+    w[i] = _mm256_add_epi32(_mm256_add_epi32(w[i], s1_256(w[((i) + 14) & 15])),     \
+                            _mm256_add_epi32(w[((i) + 9) & 15], s0_256(w[((i) + 1) & 15])));
+
+#define ROUND_256(i)                                                                \
+    t1 = _mm256_add_epi32(_mm256_add_epi32(h, S1_256(e)),                           \
+         _mm256_add_epi32(_mm256_add_epi32(CH_256(e, f, g),                         \
+                          _mm256_set1_epi32((int)sha2_sha256_k[base + (i)])), w[i])); \
+    t2 = _mm256_add_epi32(S0_256(a), MAJ_256(a, b, c));                             \
+    h = g; g = f; f = e; e = _mm256_add_epi32(d, t1);                               \
+    d = c; c = b; b = a; a = _mm256_add_epi32(t1, t2);
+
+/**
+ * @brief Load words [8*half, 8*half + 8) of eight blocks, transposed and converted from big-endian.
+ */
+__attribute__((target("avx2")))
+static void sha256_load_x8(__m256i *w, const u8 *const *blocks, int half) {
+    const __m256i bswap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                            0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m256i r[8], t[8], u[8];
+
+    for (int l = 0; l < 8; l++) {
+        r[l] = _mm256_loadu_si256((const __m256i *)(blocks[l] + 32 * half));
+    }
+    for (int i = 0; i < 8; i += 2) {
+        t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        u[i]     = _mm256_unpacklo_epi64(t[i],     t[i + 2]);
+        u[i + 1] = _mm256_unpackhi_epi64(t[i],     t[i + 2]);
+        u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+        u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+    }
+    for (int j = 0; j < 4; j++) {
+        w[j]     = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[j], u[j + 4], 0x20), bswap);
+        w[j + 4] = _mm256_shuffle_epi8(_mm256_permute2x128_si256(u[j], u[j + 4], 0x31), bswap);
+    }
+}
+
+/**
+ * @brief One compression of eight transposed states with the transposed message words w (clobbered).
+ */
+__attribute__((target("avx2")))
+static inline void sha256_rounds_x8(u32 *state, __m256i *w) {
+    __m256i a, b, c, d, e, f, g, h, t1, t2;
+
+    a = _mm256_loadu_si256((const __m256i *)(state + 0 * 8));
+    b = _mm256_loadu_si256((const __m256i *)(state + 1 * 8));
+    c = _mm256_loadu_si256((const __m256i *)(state + 2 * 8));
+    d = _mm256_loadu_si256((const __m256i *)(state + 3 * 8));
+    e = _mm256_loadu_si256((const __m256i *)(state + 4 * 8));
+    f = _mm256_loadu_si256((const __m256i *)(state + 5 * 8));
+    g = _mm256_loadu_si256((const __m256i *)(state + 6 * 8));
+    h = _mm256_loadu_si256((const __m256i *)(state + 7 * 8));
+
+    for (int base = 0; base < 64; base += 16) {
+        if (base) {
+            SCHED_256(0)  SCHED_256(1)  SCHED_256(2)  SCHED_256(3)
+            SCHED_256(4)  SCHED_256(5)  SCHED_256(6)  SCHED_256(7)
+            SCHED_256(8)  SCHED_256(9)  SCHED_256(10) SCHED_256(11)
+            SCHED_256(12) SCHED_256(13) SCHED_256(14) SCHED_256(15)
+        }
+        ROUND_256(0)  ROUND_256(1)  ROUND_256(2)  ROUND_256(3)
+        ROUND_256(4)  ROUND_256(5)  ROUND_256(6)  ROUND_256(7)
+        ROUND_256(8)  ROUND_256(9)  ROUND_256(10) ROUND_256(11)
+        ROUND_256(12) ROUND_256(13) ROUND_256(14) ROUND_256(15)
+    }
+
+    __m256i *s = (__m256i *)state;
+    _mm256_storeu_si256(s + 0, _mm256_add_epi32(a, _mm256_loadu_si256(s + 0)));
+    _mm256_storeu_si256(s + 1, _mm256_add_epi32(b, _mm256_loadu_si256(s + 1)));
+    _mm256_storeu_si256(s + 2, _mm256_add_epi32(c, _mm256_loadu_si256(s + 2)));
+    _mm256_storeu_si256(s + 3, _mm256_add_epi32(d, _mm256_loadu_si256(s + 3)));
+    _mm256_storeu_si256(s + 4, _mm256_add_epi32(e, _mm256_loadu_si256(s + 4)));
+    _mm256_storeu_si256(s + 5, _mm256_add_epi32(f, _mm256_loadu_si256(s + 5)));
+    _mm256_storeu_si256(s + 6, _mm256_add_epi32(g, _mm256_loadu_si256(s + 6)));
+    _mm256_storeu_si256(s + 7, _mm256_add_epi32(h, _mm256_loadu_si256(s + 7)));
+}
+
+__attribute__((target("avx2")))
+static void sha256_x8_avx2(u32 *state, const u8 *const *blocks) {
+    __m256i w[16];
+
+    sha256_load_x8(w, blocks, 0);
+    sha256_load_x8(w + 8, blocks, 1);
+    sha256_rounds_x8(state, w);
+}
+
+__attribute__((target("avx2")))
+static void sha256_x8_avx2_words(u32 *state, const u32 *words) {
+    __m256i w[16];
+
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm256_loadu_si256((const __m256i *)(words + 8 * t));
+    }
+    sha256_rounds_x8(state, w);
+}
+
+/* -------------------------------- AVX-512, 16 lanes -------------------------------- */
+
+/* Ternary logic: 0x96 = x ^ y ^ z, 0xCA = Ch, 0xE8 = Maj */
+#define XOR3_512(x, y, z)   _mm512_ternarylogic_epi32((x), (y), (z), 0x96)
+
+#define S0_512(x)   XOR3_512(_mm512_ror_epi32((x), 2), _mm512_ror_epi32((x), 13), _mm512_ror_epi32((x), 22))
+#define S1_512(x)   XOR3_512(_mm512_ror_epi32((x), 6), _mm512_ror_epi32((x), 11), _mm512_ror_epi32((x), 25))
+#define s0_512(x)   XOR3_512(_mm512_ror_epi32((x), 7), _mm512_ror_epi32((x), 18), _mm512_srli_epi32((x), 3))
+#define s1_512(x)   XOR3_512(_mm512_ror_epi32((x), 17), _mm512_ror_epi32((x), 19), _mm512_srli_epi32((x), 10))
+
+#define SCHED_512(i)                                                                \
+    w[i] = _mm512_add_epi32(_mm512_add_epi32(w[i], s1_512(w[((i) + 14) & 15])),     \
+                            _mm512_add_epi32(w[((i) + 9) & 15], s0_512(w[((i) + 1) & 15])));
+
+#define ROUND_512(i)                                                                \
+    t1 = _mm512_add_epi32(_mm512_add_epi32(h, S1_512(e)),                           \
+         _mm512_add_epi32(_mm512_add_epi32(_mm512_ternarylogic_epi32(e, f, g, 0xCA),\
+                          _mm512_set1_epi32((int)sha2_sha256_k[base + (i)])), w[i])); \
+    t2 = _mm512_add_epi32(S0_512(a), _mm512_ternarylogic_epi32(a, b, c, 0xE8));    \
+    h = g; g = f; f = e; e = _mm512_add_epi32(d, t1);                               \
+    d = c; c = b; b = a; a = _mm512_add_epi32(t1, t2);
+
+/**
+ * @brief Load sixteen blocks, transposed (w[t] = word t of every lane) and converted from big-endian.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static void sha256_load_x16(__m512i *w, const u8 *const *blocks) {
+    const __m512i bswap = _mm512_set_epi64(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                           0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                           0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                           0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m512i r[16], t[16];
+
+    for (int l = 0; l < 16; l++) {
+        r[l] = _mm512_loadu_si512((const void *)blocks[l]);
+    }
+    // 4x4 transposes inside each 128-bit chunk: t[4i + j] chunk k = word 4k + j of rows 4i..4i+3
+    for (int i = 0; i < 16; i += 2) {
+        w[i]     = _mm512_unpacklo_epi32(r[i], r[i + 1]);
+        w[i + 1] = _mm512_unpackhi_epi32(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 16; i += 4) {
+        t[i]     = _mm512_unpacklo_epi64(w[i],     w[i + 2]);
+        t[i + 1] = _mm512_unpackhi_epi64(w[i],     w[i + 2]);
+        t[i + 2] = _mm512_unpacklo_epi64(w[i + 1], w[i + 3]);
+        t[i + 3] = _mm512_unpackhi_epi64(w[i + 1], w[i + 3]);
+    }
+    // Then gather chunk k of the four row groups into w[4k + j]
+    for (int j = 0; j < 4; j++) {
+        __m512i v0 = _mm512_shuffle_i32x4(t[j],     t[4 + j],  0x44);
+        __m512i v1 = _mm512_shuffle_i32x4(t[j],     t[4 + j],  0xEE);
+        __m512i v2 = _mm512_shuffle_i32x4(t[8 + j], t[12 + j], 0x44);
+        __m512i v3 = _mm512_shuffle_i32x4(t[8 + j], t[12 + j], 0xEE);
+        w[j]      = _mm512_shuffle_epi8(_mm512_shuffle_i32x4(v0, v2, 0x88), bswap);
+        w[4 + j]  = _mm512_shuffle_epi8(_mm512_shuffle_i32x4(v0, v2, 0xDD), bswap);
+        w[8 + j]  = _mm512_shuffle_epi8(_mm512_shuffle_i32x4(v1, v3, 0x88), bswap);
+        w[12 + j] = _mm512_shuffle_epi8(_mm512_shuffle_i32x4(v1, v3, 0xDD), bswap);
+    }
+}
+
+/**
+ * @brief One compression of sixteen transposed states with the transposed message words w (clobbered).
+ */
+__attribute__((target("avx512f,avx512bw")))
+static inline void sha256_rounds_x16(u32 *state, __m512i *w) {
+    __m512i a, b, c, d, e, f, g, h, t1, t2;
+
+    a = _mm512_loadu_si512((const void *)(state + 0 * 16));
+    b = _mm512_loadu_si512((const void *)(state + 1 * 16));
+    c = _mm512_loadu_si512((const void *)(state + 2 * 16));
+    d = _mm512_loadu_si512((const void *)(state + 3 * 16));
+    e = _mm512_loadu_si512((const void *)(state + 4 * 16));
+    f = _mm512_loadu_si512((const void *)(state + 5 * 16));
+    g = _mm512_loadu_si512((const void *)(state + 6 * 16));
+    h = _mm512_loadu_si512((const void *)(state + 7 * 16));
+
+    for (int base = 0; base < 64; base += 16) {
+        if (base) {
+            SCHED_512(0)  SCHED_512(1)  SCHED_512(2)  SCHED_512(3)
+            SCHED_512(4)  SCHED_512(5)  SCHED_512(6)  SCHED_512(7)
+            SCHED_512(8)  SCHED_512(9)  SCHED_512(10) SCHED_512(11)
+            SCHED_512(12) SCHED_512(13) SCHED_512(14) SCHED_512(15)
+        }
+        ROUND_512(0)  ROUND_512(1)  ROUND_512(2)  ROUND_512(3)
+        ROUND_512(4)  ROUND_512(5)  ROUND_512(6)  ROUND_512(7)
+        ROUND_512(8)  ROUND_512(9)  ROUND_512(10) ROUND_512(11)
+        ROUND_512(12) ROUND_512(13) ROUND_512(14) ROUND_512(15)
+    }
+
+    _mm512_storeu_si512((void *)(state + 0 * 16), _mm512_add_epi32(a, _mm512_loadu_si512((const void *)(state + 0 * 16))));
+    _mm512_storeu_si512((void *)(state + 1 * 16), _mm512_add_epi32(b, _mm512_loadu_si512((const void *)(state + 1 * 16))));
+    _mm512_storeu_si512((void *)(state + 2 * 16), _mm512_add_epi32(c, _mm512_loadu_si512((const void *)(state + 2 * 16))));
+    _mm512_storeu_si512((void *)(state + 3 * 16), _mm512_add_epi32(d, _mm512_loadu_si512((const void *)(state + 3 * 16))));
+    _mm512_storeu_si512((void *)(state + 4 * 16), _mm512_add_epi32(e, _mm512_loadu_si512((const void *)(state + 4 * 16))));
+    _mm512_storeu_si512((void *)(state + 5 * 16), _mm512_add_epi32(f, _mm512_loadu_si512((const void *)(state + 5 * 16))));
+    _mm512_storeu_si512((void *)(state + 6 * 16), _mm512_add_epi32(g, _mm512_loadu_si512((const void *)(state + 6 * 16))));
+    _mm512_storeu_si512((void *)(state + 7 * 16), _mm512_add_epi32(h, _mm512_loadu_si512((const void *)(state + 7 * 16))));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void sha256_x16_avx512(u32 *state, const u8 *const *blocks) {
+    __m512i w[16];
+
+    sha256_load_x16(w, blocks);
+    sha256_rounds_x16(state, w);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void sha256_x16_avx512_words(u32 *state, const u32 *words) {
+    __m512i w[16];
+
+    for (int t = 0; t < 16; t++) {
+        w[t] = _mm512_loadu_si512((const void *)(words + 16 * t));
+    }
+    sha256_rounds_x16(state, w);
+}
+
+#else
+
+bool sha2_cpu_has_avx2(void) {
+    return false;
+}
+
+bool sha2_cpu_has_avx512(void) {
+    return false;
+}
+
+#endif /* SHA2_HAVE_X86 */
+
+/* ------------------------------------ Dispatch ------------------------------------- */
+
+static SHA2_backend_t sha256_multi_backend = SHA2_BACKEND_C;
+static bool sha256_multi_resolved = false;
+
+bool SHA2_sha256_multi_set_backend(SHA2_backend_t backend) {
+    switch (backend) {
+    case SHA2_BACKEND_C:
+        break;
+#if SHA2_HAVE_X86
+    case SHA2_BACKEND_AVX2:
+        if (!sha2_cpu_has_avx2()) return false;
+        break;
+    case SHA2_BACKEND_AVX512:
+        if (!sha2_cpu_has_avx512()) return false;
+        break;
+#endif
+    default:
+        return false;
+    }
+    // Any thread may resolve the backend on its first call, so both are accessed atomically
+    __atomic_store_n(&sha256_multi_backend, backend, __ATOMIC_RELAXED);
+    __atomic_store_n(&sha256_multi_resolved, true, __ATOMIC_RELAXED);
+    return true;
+}
+
+SHA2_backend_t SHA2_sha256_multi_get_backend(void) {
+    return __atomic_load_n(&sha256_multi_backend, __ATOMIC_RELAXED);
+}
+
+void SHA2_sha256_multi_init_dispatch(void) {
+    /*
+     * 16 lanes beat one-at-a-time SHA-NI; 8 lanes do not, so AVX2 is only used without SHA-NI.
+     */
+    if (SHA2_sha256_multi_set_backend(SHA2_BACKEND_AVX512)) {
+        return;
+    }
+    if (!sha2_cpu_has_sha_ni() && SHA2_sha256_multi_set_backend(SHA2_BACKEND_AVX2)) {
+        return;
+    }
+    SHA2_sha256_multi_set_backend(SHA2_BACKEND_C);
+}
+
+/* The backend in use, selected from CPUID on the first call unless one was forced */
+static SHA2_backend_t sha256_multi_current(void) {
+    if (!__atomic_load_n(&sha256_multi_resolved, __ATOMIC_RELAXED)) {
+        SHA2_sha256_multi_init_dispatch();
+    }
+    return SHA2_sha256_multi_get_backend();
+}
+
+void SHA2_sha256_multi(u8 *out, const u8 *const *in, const size_t *inlen, size_t num) {
+    switch (sha256_multi_current()) {
+#if SHA2_HAVE_X86
+    case SHA2_BACKEND_AVX512:
+        sha256_multi_lanes(16, sha256_x16_avx512, out, in, inlen, num);
+        return;
+    case SHA2_BACKEND_AVX2:
+        sha256_multi_lanes(8, sha256_x8_avx2, out, in, inlen, num);
+        return;
+#endif
+    default:
+        for (size_t i = 0; i < num; i++) {
+            SHA2_sha256(out + i * SHA2_SHA256_DIGEST_SIZE, in[i], inlen[i]);
+        }
+        return;
+    }
+}
+
+size_t SHA2_sha256_multi_lanes(void) {
+    switch (sha256_multi_current()) {
+    case SHA2_BACKEND_AVX512: return 16;
+    case SHA2_BACKEND_AVX2:   return 8;
+    default:                  return 1;
+    }
+}
+
+void SHA2_sha256_multi_compress(u32 *state, const u32 *words, size_t lanes) {
+#if SHA2_HAVE_X86
+    SHA2_backend_t backend = sha256_multi_current();
+    if (lanes == 16 && backend == SHA2_BACKEND_AVX512) {
+        sha256_x16_avx512_words(state, words);
+        return;
+    }
+    if (lanes == 8 && (backend == SHA2_BACKEND_AVX2 || backend == SHA2_BACKEND_AVX512)) {
+        sha256_x8_avx2_words(state, words);
+        return;
+    }
+#endif
+
+    // One lane at a time through the single-block function (SHA-NI or C)
+    u8 statebytes[SHA2_SHA256_DIGEST_SIZE], block[SHA2_SHA256_BLOCK_SIZE];
+    for (size_t l = 0; l < lanes; l++) {
+        for (int j = 0; j < 8; j++) store_be32(statebytes + 4 * j, state[j * lanes + l]);
+        for (int t = 0; t < 16; t++) store_be32(block + 4 * t, words[t * lanes + l]);
+        crypto_hashblocks_sha256(statebytes, block, SHA2_SHA256_BLOCK_SIZE);
+        for (int j = 0; j < 8; j++) state[j * lanes + l] = load_be32(statebytes + 4 * j);
+    }
+    memset(block, 0, sizeof(block));
+}
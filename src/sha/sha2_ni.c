@@ -0,0 +1,105 @@
+/* File: src/sha/sha2_ni.c */
+
+/**
+ * @file sha2_ni.c
+ * @brief SHA-256 compression with the x86 SHA extensions (SHA256RNDS2/SHA256MSG1/SHA256MSG2).
+ * @details The state is kept in the ABEF/CDGH register layout the instructions expect; each
+ *          SHA256RNDS2 performs two rounds, and the message schedule for group g+1 is finished
+ *          (MSG2) and for group g+3 started (MSG1) while group g is being hashed. The functions
+ *          carry target attributes, so the file builds with the project's generic CFLAGS and the
+ *          code is only reached when sha2_cpu_has_sha_ni() reports support.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha2.h"
+
+#if SHA2_HAVE_X86
+
+#include <immintrin.h>
+
+bool sha2_cpu_has_sha_ni(void) {
+    return cryptomodule_cpu_has(CRYPTOMODULE_CPU_SHA_NI | CRYPTOMODULE_CPU_SSSE3 | CRYPTOMODULE_CPU_SSE41);
+}
+
+/* Four rounds on message group g: two SHA256RNDS2, each taking two W+K words */
+#define SHA256_NI_ROUNDS(m, g)                                                          \
+    msg = _mm_add_epi32((m), _mm_loadu_si128((const __m128i *)&sha2_sha256_k[4 * (g)]));  \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                                \
+    msg = _mm_shuffle_epi32(msg, 0x0E);                                                 \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+
+/* Finish the next group: next += W[t-7..t-4] (from prev||cur), then the sigma1 part */
+#define SHA256_NI_MSG2(next, cur, prev)                                             \
+    tmp = _mm_alignr_epi8((cur), (prev), 4);                                        \
+    next = _mm_add_epi32((next), tmp);                                              \
+    next = _mm_sha256msg2_epu32((next), (cur));
+
+/* Start the group three ahead with the sigma0 part */
+#define SHA256_NI_MSG1(prev, cur)                                                   \
+    prev = _mm_sha256msg1_epu32((prev), (cur));
+
+__attribute__((target("sha,sse4.1,ssse3")))
+size_t crypto_hashblocks_sha256_ni(u8 *statebytes, const u8 *in, size_t inlen) {
+    // Byte swap within each 32-bit word (big-endian <-> native)
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i state0, state1, msg, tmp, m0, m1, m2, m3, abef_save, cdgh_save;
+
+    tmp = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(statebytes + 0)), bswap);     // DCBA
+    state1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(statebytes + 16)), bswap); // HGFE
+
+    tmp = _mm_shuffle_epi32(tmp, 0xB1);                 // CDAB
+    state1 = _mm_shuffle_epi32(state1, 0x1B);           // EFGH
+    state0 = _mm_alignr_epi8(tmp, state1, 8);           // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);        // CDGH
+
+    while (inlen >= 64) {
+        abef_save = state0;
+        cdgh_save = state1;
+
+        m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 0)), bswap);
+        m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 16)), bswap);
+        m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 32)), bswap);
+        m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(in + 48)), bswap);
+
+        SHA256_NI_ROUNDS(m0, 0)
+        SHA256_NI_ROUNDS(m1, 1)     SHA256_NI_MSG1(m0, m1)
+        SHA256_NI_ROUNDS(m2, 2)     SHA256_NI_MSG1(m1, m2)
+        SHA256_NI_ROUNDS(m3, 3)     SHA256_NI_MSG2(m0, m3, m2)  SHA256_NI_MSG1(m2, m3)
+        SHA256_NI_ROUNDS(m0, 4)     SHA256_NI_MSG2(m1, m0, m3)  SHA256_NI_MSG1(m3, m0)
+        SHA256_NI_ROUNDS(m1, 5)     SHA256_NI_MSG2(m2, m1, m0)  SHA256_NI_MSG1(m0, m1)
+        SHA256_NI_ROUNDS(m2, 6)     SHA256_NI_MSG2(m3, m2, m1)  SHA256_NI_MSG1(m1, m2)
+        SHA256_NI_ROUNDS(m3, 7)     SHA256_NI_MSG2(m0, m3, m2)  SHA256_NI_MSG1(m2, m3)
+        SHA256_NI_ROUNDS(m0, 8)     SHA256_NI_MSG2(m1, m0, m3)  SHA256_NI_MSG1(m3, m0)
+        SHA256_NI_ROUNDS(m1, 9)     SHA256_NI_MSG2(m2, m1, m0)  SHA256_NI_MSG1(m0, m1)
+        SHA256_NI_ROUNDS(m2, 10)    SHA256_NI_MSG2(m3, m2, m1)  SHA256_NI_MSG1(m1, m2)
+        SHA256_NI_ROUNDS(m3, 11)    SHA256_NI_MSG2(m0, m3, m2)  SHA256_NI_MSG1(m2, m3)
+        SHA256_NI_ROUNDS(m0, 12)    SHA256_NI_MSG2(m1, m0, m3)  SHA256_NI_MSG1(m3, m0)
+        SHA256_NI_ROUNDS(m1, 13)    SHA256_NI_MSG2(m2, m1, m0)
+        SHA256_NI_ROUNDS(m2, 14)    SHA256_NI_MSG2(m3, m2, m1)
+        SHA256_NI_ROUNDS(m3, 15)
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+
+        in += 64;
+        inlen -= 64;
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);              // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);           // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);        // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);           // HGFE
+
+    _mm_storeu_si128((__m128i *)(statebytes + 0), _mm_shuffle_epi8(state0, bswap));
+    _mm_storeu_si128((__m128i *)(statebytes + 16), _mm_shuffle_epi8(state1, bswap));
+
+    return inlen;
+}
+
+#else
+
+bool sha2_cpu_has_sha_ni(void) {
+    return false;
+}
+
+#endif /* SHA2_HAVE_X86 */
@@ -0,0 +1,319 @@
+/* File: src/sha/sha3.c */
+
+/**
+ * @file sha3.c
+ * @brief Keccak-f[1600] and the SHA-3 / SHAKE sponge (FIPS 202).
+ * @details The permutation keeps the 25 lanes in local variables and runs a fully unrolled round
+ *          that ping-pongs between two sets of them, so no lane is ever moved. Chi is computed
+ *          with lane complementing (the "bebigokimisa" pattern of the Keccak team): with lanes
+ *          1, 2, 8, 12, 17 and 20 stored inverted, every row needs a single NOT instead of five,
+ *          and the inversion is undone when the state leaves the permutation.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha3.h"
+
+#define ROL64(x, n)     (((x) << (n)) | ((x) >> (64 - (n))))
+
+const u64 sha3_keccak_rc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+    0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+    0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
+};
+
+/*
+ * One round from the lanes X..  into the lanes Y.. (a, e, i, o, u = x 0..4; b, g, k, m, s = y 0..4).
+ * Theta, rho and pi are folded into the loads of each output row, chi and iota into its stores.
+ */
+#define KECCAK_ROUND(X, Y, rc)                                                  \
+    Ca = X##ba ^ X##ga ^ X##ka ^ X##ma ^ X##sa;                                 \
+    Ce = X##be ^ X##ge ^ X##ke ^ X##me ^ X##se;                                 \
+    Ci = X##bi ^ X##gi ^ X##ki ^ X##mi ^ X##si;                                 \
+    Co = X##bo ^ X##go ^ X##ko ^ X##mo ^ X##so;                                 \
+    Cu = X##bu ^ X##gu ^ X##ku ^ X##mu ^ X##su;                                 \
+    Da = Cu ^ ROL64(Ce, 1);                                                     \
+    De = Ca ^ ROL64(Ci, 1);                                                     \
+    Di = Ce ^ ROL64(Co, 1);                                                     \
+    Do = Ci ^ ROL64(Cu, 1);                                                     \
+    Du = Co ^ ROL64(Ca, 1);                                                     \
+                                                                                \
+    Ba = X##ba ^ Da;                                                            \
+    Be = ROL64(X##ge ^ De, 44);                                                 \
+    Bi = ROL64(X##ki ^ Di, 43);                                                 \
+    Bo = ROL64(X##mo ^ Do, 21);                                                 \
+    Bu = ROL64(X##su ^ Du, 14);                                                 \
+    Y##ba = Ba ^ (Be | Bi) ^ (rc);                                              \
+    Y##be = Be ^ (~Bi | Bo);                                                    \
+    Y##bi = Bi ^ (Bo & Bu);                                                     \
+    Y##bo = Bo ^ (Bu | Ba);                                                     \
+    Y##bu = Bu ^ (Ba & Be);                                                     \
+                                                                                \
+    Ba = ROL64(X##bo ^ Do, 28);                                                 \
+    Be = ROL64(X##gu ^ Du, 20);                                                 \
+    Bi = ROL64(X##ka ^ Da, 3);                                                  \
+    Bo = ROL64(X##me ^ De, 45);                                                 \
+    Bu = ROL64(X##si ^ Di, 61);                                                 \
+    Y##ga = Ba ^ (Be | Bi);                                                     \
+    Y##ge = Be ^ (Bi & Bo);                                                     \
+    Y##gi = Bi ^ (Bo | ~Bu);                                                    \
+    Y##go = Bo ^ (Bu | Ba);                                                     \
+    Y##gu = Bu ^ (Ba & Be);                                                     \
+                                                                                \
+    Ba = ROL64(X##be ^ De, 1);                                                  \
+    Be = ROL64(X##gi ^ Di, 6);                                                  \
+    Bi = ROL64(X##ko ^ Do, 25);                                                 \
+    Bo = ROL64(X##mu ^ Du, 8);                                                  \
+    Bu = ROL64(X##sa ^ Da, 18);                                                 \
+    Y##ka = Ba ^ (Be | Bi);                                                     \
+    Y##ke = Be ^ (Bi & Bo);                                                     \
+    Y##ki = Bi ^ (~Bo & Bu);                                                    \
+    Y##ko = ~Bo ^ (Bu | Ba);                                                    \
+    Y##ku = Bu ^ (Ba & Be);                                                     \
+                                                                                \
+    Ba = ROL64(X##bu ^ Du, 27);                                                 \
+    Be = ROL64(X##ga ^ Da, 36);                                                 \
+    Bi = ROL64(X##ke ^ De, 10);                                                 \
+    Bo = ROL64(X##mi ^ Di, 15);                                                 \
+    Bu = ROL64(X##so ^ Do, 56);                                                 \
+    Y##ma = Ba ^ (Be & Bi);                                                     \
+    Y##me = Be ^ (Bi | Bo);                                                     \
+    Y##mi = Bi ^ (~Bo | Bu);                                                    \
+    Y##mo = ~Bo ^ (Bu & Ba);                                                    \
+    Y##mu = Bu ^ (Ba | Be);                                                     \
+                                                                                \
+    Ba = ROL64(X##bi ^ Di, 62);                                                 \
+    Be = ROL64(X##go ^ Do, 55);                                                 \
+    Bi = ROL64(X##ku ^ Du, 39);                                                 \
+    Bo = ROL64(X##ma ^ Da, 41);                                                 \
+    Bu = ROL64(X##se ^ De, 2);                                                  \
+    Y##sa = Ba ^ (~Be & Bi);                                                    \
+    Y##se = ~Be ^ (Bi | Bo);                                                    \
+    Y##si = Bi ^ (Bo & Bu);                                                     \
+    Y##so = Bo ^ (Bu | Ba);                                                     \
+    Y##su = Bu ^ (Ba & Be);
+
+void SHA3_keccakf1600(u64 *s) {
+    u64 Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku;
+    u64 Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+    u64 Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+    u64 Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+    u64 Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+
+    // Complemented lanes: (1,0) (2,0) (3,1) (2,2) (2,3) (0,4)
+    Aba = s[0];  Abe = ~s[1];  Abi = ~s[2];  Abo = s[3];  Abu = s[4];
+    Aga = s[5];  Age = s[6];   Agi = s[7];   Ago = ~s[8]; Agu = s[9];
+    Aka = s[10]; Ake = s[11];  Aki = ~s[12]; Ako = s[13]; Aku = s[14];
+    Ama = s[15]; Ame = s[16];  Ami = ~s[17]; Amo = s[18]; Amu = s[19];
+    Asa = ~s[20]; Ase = s[21]; Asi = s[22];  Aso = s[23]; Asu = s[24];
+
+    for (int round = 0; round < 24; round += 2) {
+        KECCAK_ROUND(A, E, sha3_keccak_rc[round])
+        KECCAK_ROUND(E, A, sha3_keccak_rc[round + 1])
+    }
+
+    s[0] = Aba;   s[1] = ~Abe;  s[2] = ~Abi;  s[3] = Abo;   s[4] = Abu;
+    s[5] = Aga;   s[6] = Age;   s[7] = Agi;   s[8] = ~Ago;  s[9] = Agu;
+    s[10] = Aka;  s[11] = Ake;  s[12] = ~Aki; s[13] = Ako;  s[14] = Aku;
+    s[15] = Ama;  s[16] = Ame;  s[17] = ~Ami; s[18] = Amo;  s[19] = Amu;
+    s[20] = ~Asa; s[21] = Ase;  s[22] = Asi;  s[23] = Aso;  s[24] = Asu;
+}
+
+static u64 load_le64(const u8 *x) {
+    u64 v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | x[i];
+    return v;
+}
+
+static void store_le64(u8 *x, u64 v) {
+    for (int i = 0; i < 8; i++) {
+        x[i] = (u8)v;
+        v >>= 8;
+    }
+}
+
+/* XOR len bytes into the state starting at byte offset pos (pos + len <= rate) */
+static void sha3_xor_bytes(u64 *s, size_t pos, const u8 *in, size_t len) {
+    while (len > 0 && (pos & 7) != 0) {
+        s[pos >> 3] ^= (u64)*in++ << (8 * (pos & 7));
+        pos++;
+        len--;
+    }
+    for (; len >= 8; len -= 8, pos += 8, in += 8) {
+        s[pos >> 3] ^= load_le64(in);
+    }
+    for (; len > 0; len--, pos++) {
+        s[pos >> 3] ^= (u64)*in++ << (8 * (pos & 7));
+    }
+}
+
+/* Copy len bytes of the state starting at byte offset pos (pos + len <= rate) */
+static void sha3_extract_bytes(const u64 *s, size_t pos, u8 *out, size_t len) {
+    while (len > 0 && (pos & 7) != 0) {
+        *out++ = (u8)(s[pos >> 3] >> (8 * (pos & 7)));
+        pos++;
+        len--;
+    }
+    for (; len >= 8; len -= 8, pos += 8, out += 8) {
+        store_le64(out, s[pos >> 3]);
+    }
+    for (; len > 0; len--, pos++) {
+        *out++ = (u8)(s[pos >> 3] >> (8 * (pos & 7)));
+    }
+}
+
+static void sha3_inc_init(SHA3_ctx *state, u32 rate, u32 outlen, u8 dsbyte) {
+    memset(state->s, 0, sizeof(state->s));
+    state->rate = rate;
+    state->pos = 0;
+    state->outlen = outlen;
+    state->dsbyte = dsbyte;
+    state->squeezing = false;
+}
+
+void SHA3_sha3_224_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHA3_224_RATE, SHA3_SHA3_224_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_256_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHA3_256_RATE, SHA3_SHA3_256_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_384_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHA3_384_RATE, SHA3_SHA3_384_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_512_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHA3_512_RATE, SHA3_SHA3_512_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_shake128_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHAKE128_RATE, 0, 0x1F);
+}
+
+void SHA3_shake256_inc_init(SHA3_ctx *state) {
+    sha3_inc_init(state, SHA3_SHAKE256_RATE, 0, 0x1F);
+}
+
+void SHA3_inc_absorb(SHA3_ctx *state, const u8 *input, size_t inplen) {
+    const size_t rate = state->rate;
+
+    // Fill up a pending partial block first
+    if (state->pos > 0) {
+        size_t take = rate - state->pos;
+        if (take > inplen) take = inplen;
+        sha3_xor_bytes(state->s, state->pos, input, take);
+        state->pos += (u32)take;
+        input += take;
+        inplen -= take;
+        if (state->pos < rate) {
+            return;
+        }
+        SHA3_keccakf1600(state->s);
+        state->pos = 0;
+    }
+
+    // Whole blocks straight from the input, lane by lane
+    while (inplen >= rate) {
+        for (size_t i = 0; i < rate / 8; i++) {
+            state->s[i] ^= load_le64(input + 8 * i);
+        }
+        SHA3_keccakf1600(state->s);
+        input += rate;
+        inplen -= rate;
+    }
+
+    sha3_xor_bytes(state->s, 0, input, inplen);
+    state->pos = (u32)inplen;
+}
+
+/* Domain separation and pad10*1; leaves the first output block in the state */
+static void sha3_pad(SHA3_ctx *state) {
+    state->s[state->pos >> 3] ^= (u64)state->dsbyte << (8 * (state->pos & 7));
+    state->s[(state->rate - 1) >> 3] ^= 0x80ULL << (8 * ((state->rate - 1) & 7));
+    SHA3_keccakf1600(state->s);
+    state->pos = 0;
+}
+
+void SHA3_sha3_inc_finalize(u8 *output, SHA3_ctx *state) {
+    sha3_pad(state);
+    sha3_extract_bytes(state->s, 0, output, state->outlen);
+    SHA3_inc_ctx_release(state);
+}
+
+void SHA3_shake_inc_finalize(SHA3_ctx *state) {
+    sha3_pad(state);
+    state->squeezing = true;
+}
+
+void SHA3_shake_inc_squeeze(u8 *output, size_t outlen, SHA3_ctx *state) {
+    const size_t rate = state->rate;
+
+    if (!state->squeezing) {
+        SHA3_shake_inc_finalize(state);
+    }
+    while (outlen > 0) {
+        if (state->pos == rate) {
+            SHA3_keccakf1600(state->s);
+            state->pos = 0;
+        }
+        size_t take = rate - state->pos;
+        if (take > outlen) take = outlen;
+        sha3_extract_bytes(state->s, state->pos, output, take);
+        state->pos += (u32)take;
+        output += take;
+        outlen -= take;
+    }
+}
+
+void SHA3_inc_ctx_clone(SHA3_ctx *dest, const SHA3_ctx *src) {
+    memcpy(dest, src, sizeof(SHA3_ctx));
+}
+
+void SHA3_inc_ctx_release(SHA3_ctx *state) {
+    cryptomodule_wipe(state, sizeof(*state));
+}
+
+static void sha3_oneshot(u8 *output, const u8 *input, size_t inplen,
+                         void (*init)(SHA3_ctx *)) {
+    SHA3_ctx state;
+    init(&state);
+    SHA3_inc_absorb(&state, input, inplen);
+    SHA3_sha3_inc_finalize(output, &state);
+}
+
+void SHA3_sha3_224(u8 *output, const u8 *input, size_t inplen) {
+    sha3_oneshot(output, input, inplen, SHA3_sha3_224_inc_init);
+}
+
+void SHA3_sha3_256(u8 *output, const u8 *input, size_t inplen) {
+    sha3_oneshot(output, input, inplen, SHA3_sha3_256_inc_init);
+}
+
+void SHA3_sha3_384(u8 *output, const u8 *input, size_t inplen) {
+    sha3_oneshot(output, input, inplen, SHA3_sha3_384_inc_init);
+}
+
+void SHA3_sha3_512(u8 *output, const u8 *input, size_t inplen) {
+    sha3_oneshot(output, input, inplen, SHA3_sha3_512_inc_init);
+}
+
+void SHA3_shake128(u8 *output, size_t outlen, const u8 *input, size_t inplen) {
+    SHA3_ctx state;
+    SHA3_shake128_inc_init(&state);
+    SHA3_inc_absorb(&state, input, inplen);
+    SHA3_shake_inc_finalize(&state);
+    SHA3_shake_inc_squeeze(output, outlen, &state);
+    SHA3_inc_ctx_release(&state);
+}
+
+void SHA3_shake256(u8 *output, size_t outlen, const u8 *input, size_t inplen) {
+    SHA3_ctx state;
+    SHA3_shake256_inc_init(&state);
+    SHA3_inc_absorb(&state, input, inplen);
+    SHA3_shake_inc_finalize(&state);
+    SHA3_shake_inc_squeeze(output, outlen, &state);
+    SHA3_inc_ctx_release(&state);
+}
@@ -0,0 +1,401 @@
+/* File: src/sha/sha3x4.c */
+
+/**
+ * @file sha3x4.c
+ * @brief Four-way Keccak-f[1600] (AVX2 or four single permutations) and the SHA-3 / SHAKE x4 sponge.
+ * @details The AVX2 round has the same shape as the scalar one in sha3.c, with one instance per
+ *          64-bit element. Lane complementing is not needed here since VPANDN computes ~a & b in
+ *          one instruction; the rotations by 8 and 56 are byte shuffles, the others shift pairs.
+ */
+
+#include "../../include/api_cryptomodule.h"
+#include "../../include/sha/sha3.h"
+
+static u64 load_le64(const u8 *x) {
+    u64 v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | x[i];
+    return v;
+}
+
+static void store_le64(u8 *x, u64 v) {
+    for (int i = 0; i < 8; i++) {
+        x[i] = (u8)v;
+        v >>= 8;
+    }
+}
+
+/* ------------------------------- Portable backend -------------------------------- */
+
+static void keccakf1600_x4_c(u64 *s) {
+    u64 lanes[SHA3_KECCAK_LANES];
+
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < SHA3_KECCAK_LANES; i++) lanes[i] = s[4 * i + j];
+        SHA3_keccakf1600(lanes);
+        for (int i = 0; i < SHA3_KECCAK_LANES; i++) s[4 * i + j] = lanes[i];
+    }
+}
+
+/* --------------------------------- AVX2 backend ---------------------------------- */
+
+#if SHA2_HAVE_X86
+
+#include <immintrin.h>
+
+#define ROL64_256(x, n)     _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+#define ROL64_256_8(x)      _mm256_shuffle_epi8((x), rho8)
+#define ROL64_256_56(x)     _mm256_shuffle_epi8((x), rho56)
+#define XOR5(a, b, c, d, e) _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256((a), (b)), _mm256_xor_si256((c), (d))), (e))
+#define CHI(a, b, c)        _mm256_xor_si256((a), _mm256_andnot_si256((b), (c)))
+
+/* One round from the lanes X.. into the lanes Y.., as KECCAK_ROUND in sha3.c */
+#define KECCAK_ROUND_X4(X, Y, rc)                                               \
+    Ca = XOR5(X##ba, X##ga, X##ka, X##ma, X##sa);                               \
+    Ce = XOR5(X##be, X##ge, X##ke, X##me, X##se);                               \
+    Ci = XOR5(X##bi, X##gi, X##ki, X##mi, X##si);                               \
+    Co = XOR5(X##bo, X##go, X##ko, X##mo, X##so);                               \
+    Cu = XOR5(X##bu, X##gu, X##ku, X##mu, X##su);                               \
+    Da = _mm256_xor_si256(Cu, ROL64_256(Ce, 1));                                \
+    De = _mm256_xor_si256(Ca, ROL64_256(Ci, 1));                                \
+    Di = _mm256_xor_si256(Ce, ROL64_256(Co, 1));                                \
+    Do = _mm256_xor_si256(Ci, ROL64_256(Cu, 1));                                \
+    Du = _mm256_xor_si256(Co, ROL64_256(Ca, 1));                                \
+                                                                                \
+    Ba = _mm256_xor_si256(X##ba, Da);                                           \
+    Be = ROL64_256(_mm256_xor_si256(X##ge, De), 44);                            \
+    Bi = ROL64_256(_mm256_xor_si256(X##ki, Di), 43);                            \
+    Bo = ROL64_256(_mm256_xor_si256(X##mo, Do), 21);                            \
+    Bu = ROL64_256(_mm256_xor_si256(X##su, Du), 14);                            \
+    Y##ba = _mm256_xor_si256(CHI(Ba, Be, Bi), _mm256_set1_epi64x((long long)(rc))); \
+    Y##be = CHI(Be, Bi, Bo);                                                    \
+    Y##bi = CHI(Bi, Bo, Bu);                                                    \
+    Y##bo = CHI(Bo, Bu, Ba);                                                    \
+    Y##bu = CHI(Bu, Ba, Be);                                                    \
+                                                                                \
+    Ba = ROL64_256(_mm256_xor_si256(X##bo, Do), 28);                            \
+    Be = ROL64_256(_mm256_xor_si256(X##gu, Du), 20);                            \
+    Bi = ROL64_256(_mm256_xor_si256(X##ka, Da), 3);                             \
+    Bo = ROL64_256(_mm256_xor_si256(X##me, De), 45);                            \
+    Bu = ROL64_256(_mm256_xor_si256(X##si, Di), 61);                            \
+    Y##ga = CHI(Ba, Be, Bi);                                                    \
+    Y##ge = CHI(Be, Bi, Bo);                                                    \
+    Y##gi = CHI(Bi, Bo, Bu);                                                    \
+    Y##go = CHI(Bo, Bu, Ba);                                                    \
+    Y##gu = CHI(Bu, Ba, Be);                                                    \
+                                                                                \
+    Ba = ROL64_256(_mm256_xor_si256(X##be, De), 1);                             \
+    Be = ROL64_256(_mm256_xor_si256(X##gi, Di), 6);                             \
+    Bi = ROL64_256(_mm256_xor_si256(X##ko, Do), 25);                            \
+    Bo = ROL64_256_8(_mm256_xor_si256(X##mu, Du));                              \
+    Bu = ROL64_256(_mm256_xor_si256(X##sa, Da), 18);                            \
+    Y##ka = CHI(Ba, Be, Bi);                                                    \
+    Y##ke = CHI(Be, Bi, Bo);                                                    \
+    Y##ki = CHI(Bi, Bo, Bu);                                                    \
+    Y##ko = CHI(Bo, Bu, Ba);                                                    \
+    Y##ku = CHI(Bu, Ba, Be);                                                    \
+                                                                                \
+    Ba = ROL64_256(_mm256_xor_si256(X##bu, Du), 27);                            \
+    Be = ROL64_256(_mm256_xor_si256(X##ga, Da), 36);                            \
+    Bi = ROL64_256(_mm256_xor_si256(X##ke, De), 10);                            \
+    Bo = ROL64_256(_mm256_xor_si256(X##mi, Di), 15);                            \
+    Bu = ROL64_256_56(_mm256_xor_si256(X##so, Do));                             \
+    Y##ma = CHI(Ba, Be, Bi);                                                    \
+    Y##me = CHI(Be, Bi, Bo);                                                    \
+    Y##mi = CHI(Bi, Bo, Bu);                                                    \
+    Y##mo = CHI(Bo, Bu, Ba);                                                    \
+    Y##mu = CHI(Bu, Ba, Be);                                                    \
+                                                                                \
+    Ba = ROL64_256(_mm256_xor_si256(X##bi, Di), 62);                            \
+    Be = ROL64_256(_mm256_xor_si256(X##go, Do), 55);                            \
+    Bi = ROL64_256(_mm256_xor_si256(X##ku, Du), 39);                            \
+    Bo = ROL64_256(_mm256_xor_si256(X##ma, Da), 41);                            \
+    Bu = ROL64_256(_mm256_xor_si256(X##se, De), 2);                             \
+    Y##sa = CHI(Ba, Be, Bi);                                                    \
+    Y##se = CHI(Be, Bi, Bo);                                                    \
+    Y##si = CHI(Bi, Bo, Bu);                                                    \
+    Y##so = CHI(Bo, Bu, Ba);                                                    \
+    Y##su = CHI(Bu, Ba, Be);
+
+#define LOAD_LANE(i)        _mm256_loadu_si256((const __m256i *)(s + 4 * (i)))
+#define STORE_LANE(i, v)    _mm256_storeu_si256((__m256i *)(s + 4 * (i)), (v))
+
+__attribute__((target("avx2")))
+static void keccakf1600_x4_avx2(u64 *s) {
+    const __m256i rho8 = _mm256_set_epi8(14, 13, 12, 11, 10, 9, 8, 15, 6, 5, 4, 3, 2, 1, 0, 7,
+                                         14, 13, 12, 11, 10, 9, 8, 15, 6, 5, 4, 3, 2, 1, 0, 7);
+    const __m256i rho56 = _mm256_set_epi8(8, 15, 14, 13, 12, 11, 10, 9, 0, 7, 6, 5, 4, 3, 2, 1,
+                                          8, 15, 14, 13, 12, 11, 10, 9, 0, 7, 6, 5, 4, 3, 2, 1);
+    __m256i Aba, Abe, Abi, Abo, Abu, Aga, Age, Agi, Ago, Agu, Aka, Ake, Aki, Ako, Aku;
+    __m256i Ama, Ame, Ami, Amo, Amu, Asa, Ase, Asi, Aso, Asu;
+    __m256i Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+    __m256i Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+    __m256i Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+
+    Aba = LOAD_LANE(0);  Abe = LOAD_LANE(1);  Abi = LOAD_LANE(2);  Abo = LOAD_LANE(3);  Abu = LOAD_LANE(4);
+    Aga = LOAD_LANE(5);  Age = LOAD_LANE(6);  Agi = LOAD_LANE(7);  Ago = LOAD_LANE(8);  Agu = LOAD_LANE(9);
+    Aka = LOAD_LANE(10); Ake = LOAD_LANE(11); Aki = LOAD_LANE(12); Ako = LOAD_LANE(13); Aku = LOAD_LANE(14);
+    Ama = LOAD_LANE(15); Ame = LOAD_LANE(16); Ami = LOAD_LANE(17); Amo = LOAD_LANE(18); Amu = LOAD_LANE(19);
+    Asa = LOAD_LANE(20); Ase = LOAD_LANE(21); Asi = LOAD_LANE(22); Aso = LOAD_LANE(23); Asu = LOAD_LANE(24);
+
+    for (int round = 0; round < 24; round += 2) {
+        KECCAK_ROUND_X4(A, E, sha3_keccak_rc[round])
+        KECCAK_ROUND_X4(E, A, sha3_keccak_rc[round + 1])
+    }
+
+    STORE_LANE(0, Aba);  STORE_LANE(1, Abe);  STORE_LANE(2, Abi);  STORE_LANE(3, Abo);  STORE_LANE(4, Abu);
+    STORE_LANE(5, Aga);  STORE_LANE(6, Age);  STORE_LANE(7, Agi);  STORE_LANE(8, Ago);  STORE_LANE(9, Agu);
+    STORE_LANE(10, Aka); STORE_LANE(11, Ake); STORE_LANE(12, Aki); STORE_LANE(13, Ako); STORE_LANE(14, Aku);
+    STORE_LANE(15, Ama); STORE_LANE(16, Ame); STORE_LANE(17, Ami); STORE_LANE(18, Amo); STORE_LANE(19, Amu);
+    STORE_LANE(20, Asa); STORE_LANE(21, Ase); STORE_LANE(22, Asi); STORE_LANE(23, Aso); STORE_LANE(24, Asu);
+}
+
+#endif /* SHA2_HAVE_X86 */
+
+/* ------------------------------------ Dispatch ------------------------------------- */
+
+static void keccakf1600_x4_resolve(u64 *s);
+
+static void (*keccakf1600_x4)(u64 *) = keccakf1600_x4_resolve;
+static SHA3_backend_t sha3_x4_backend = SHA3_BACKEND_C;
+
+bool SHA3_x4_set_backend(SHA3_backend_t backend) {
+    switch (backend) {
+    case SHA3_BACKEND_C:
+        keccakf1600_x4 = keccakf1600_x4_c;
+        break;
+#if SHA2_HAVE_X86
+    case SHA3_BACKEND_AVX2:
+        if (!sha2_cpu_has_avx2()) return false;
+        keccakf1600_x4 = keccakf1600_x4_avx2;
+        break;
+#endif
+    default:
+        return false;
+    }
+    sha3_x4_backend = backend;
+    return true;
+}
+
+SHA3_backend_t SHA3_x4_get_backend(void) {
+    return sha3_x4_backend;
+}
+
+void SHA3_x4_init_dispatch(void) {
+    if (!SHA3_x4_set_backend(SHA3_BACKEND_AVX2)) {
+        SHA3_x4_set_backend(SHA3_BACKEND_C);
+    }
+}
+
+static void keccakf1600_x4_resolve(u64 *s) {
+    SHA3_x4_init_dispatch();
+    keccakf1600_x4(s);
+}
+
+void SHA3_keccakf1600_x4(u64 *s) {
+    keccakf1600_x4(s);
+}
+
+/* -------------------------------------- Sponge ------------------------------------- */
+
+/* XOR len bytes of in into instance j starting at byte offset pos (pos + len <= rate) */
+static void sha3_x4_xor_bytes(u64 *s, int j, size_t pos, const u8 *in, size_t len) {
+    while (len > 0 && (pos & 7) != 0) {
+        s[4 * (pos >> 3) + j] ^= (u64)*in++ << (8 * (pos & 7));
+        pos++;
+        len--;
+    }
+    for (; len >= 8; len -= 8, pos += 8, in += 8) {
+        s[4 * (pos >> 3) + j] ^= load_le64(in);
+    }
+    for (; len > 0; len--, pos++) {
+        s[4 * (pos >> 3) + j] ^= (u64)*in++ << (8 * (pos & 7));
+    }
+}
+
+/* Copy len bytes of instance j starting at byte offset pos (pos + len <= rate) */
+static void sha3_x4_extract_bytes(const u64 *s, int j, size_t pos, u8 *out, size_t len) {
+    while (len > 0 && (pos & 7) != 0) {
+        *out++ = (u8)(s[4 * (pos >> 3) + j] >> (8 * (pos & 7)));
+        pos++;
+        len--;
+    }
+    for (; len >= 8; len -= 8, pos += 8, out += 8) {
+        store_le64(out, s[4 * (pos >> 3) + j]);
+    }
+    for (; len > 0; len--, pos++) {
+        *out++ = (u8)(s[4 * (pos >> 3) + j] >> (8 * (pos & 7)));
+    }
+}
+
+static void sha3_x4_inc_init(SHA3_ctx_x4 *state, u32 rate, u32 outlen, u8 dsbyte) {
+    memset(state->s, 0, sizeof(state->s));
+    state->rate = rate;
+    state->pos = 0;
+    state->outlen = outlen;
+    state->dsbyte = dsbyte;
+    state->squeezing = false;
+}
+
+void SHA3_sha3_224_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHA3_224_RATE, SHA3_SHA3_224_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_256_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHA3_256_RATE, SHA3_SHA3_256_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_384_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHA3_384_RATE, SHA3_SHA3_384_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_sha3_512_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHA3_512_RATE, SHA3_SHA3_512_DIGEST_SIZE, 0x06);
+}
+
+void SHA3_shake128_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHAKE128_RATE, 0, 0x1F);
+}
+
+void SHA3_shake256_x4_inc_init(SHA3_ctx_x4 *state) {
+    sha3_x4_inc_init(state, SHA3_SHAKE256_RATE, 0, 0x1F);
+}
+
+void SHA3_x4_inc_absorb(SHA3_ctx_x4 *state, const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3,
+                        size_t inplen) {
+    const u8 *in[4] = { in0, in1, in2, in3 };
+    const size_t rate = state->rate;
+
+    while (inplen > 0) {
+        size_t take = rate - state->pos;
+        if (take > inplen) take = inplen;
+
+        if (take == rate) {
+            // Whole block, lane by lane
+            for (size_t i = 0; i < rate / 8; i++) {
+                for (int j = 0; j < 4; j++) {
+                    state->s[4 * i + j] ^= load_le64(in[j] + 8 * i);
+                }
+            }
+        } else {
+            for (int j = 0; j < 4; j++) {
+                sha3_x4_xor_bytes(state->s, j, state->pos, in[j], take);
+            }
+        }
+        for (int j = 0; j < 4; j++) in[j] += take;
+        inplen -= take;
+        state->pos += (u32)take;
+
+        if (state->pos == rate) {
+            keccakf1600_x4(state->s);
+            state->pos = 0;
+        }
+    }
+}
+
+/* Domain separation and pad10*1 of all four instances; leaves the first output block in the state */
+static void sha3_x4_pad(SHA3_ctx_x4 *state) {
+    for (int j = 0; j < 4; j++) {
+        state->s[4 * (state->pos >> 3) + j] ^= (u64)state->dsbyte << (8 * (state->pos & 7));
+        state->s[4 * ((state->rate - 1) >> 3) + j] ^= 0x80ULL << (8 * ((state->rate - 1) & 7));
+    }
+    keccakf1600_x4(state->s);
+    state->pos = 0;
+}
+
+void SHA3_sha3_x4_inc_finalize(u8 *out0, u8 *out1, u8 *out2, u8 *out3, SHA3_ctx_x4 *state) {
+    u8 *out[4] = { out0, out1, out2, out3 };
+
+    sha3_x4_pad(state);
+    for (int j = 0; j < 4; j++) {
+        sha3_x4_extract_bytes(state->s, j, 0, out[j], state->outlen);
+    }
+    SHA3_x4_inc_ctx_release(state);
+}
+
+void SHA3_shake_x4_inc_finalize(SHA3_ctx_x4 *state) {
+    sha3_x4_pad(state);
+    state->squeezing = true;
+}
+
+void SHA3_shake_x4_inc_squeeze(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen, SHA3_ctx_x4 *state) {
+    u8 *out[4] = { out0, out1, out2, out3 };
+    const size_t rate = state->rate;
+
+    if (!state->squeezing) {
+        SHA3_shake_x4_inc_finalize(state);
+    }
+    while (outlen > 0) {
+        if (state->pos == rate) {
+            keccakf1600_x4(state->s);
+            state->pos = 0;
+        }
+        size_t take = rate - state->pos;
+        if (take > outlen) take = outlen;
+        for (int j = 0; j < 4; j++) {
+            sha3_x4_extract_bytes(state->s, j, state->pos, out[j], take);
+            out[j] += take;
+        }
+        state->pos += (u32)take;
+        outlen -= take;
+    }
+}
+
+void SHA3_x4_inc_ctx_clone(SHA3_ctx_x4 *dest, const SHA3_ctx_x4 *src) {
+    memcpy(dest, src, sizeof(SHA3_ctx_x4));
+}
+
+void SHA3_x4_inc_ctx_release(SHA3_ctx_x4 *state) {
+    cryptomodule_wipe(state, sizeof(*state));
+}
+
+/* ------------------------------------ One-shot -------------------------------------- */
+
+static void sha3_x4_oneshot(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                            const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen,
+                            void (*init)(SHA3_ctx_x4 *)) {
+    SHA3_ctx_x4 state;
+    init(&state);
+    SHA3_x4_inc_absorb(&state, in0, in1, in2, in3, inplen);
+    SHA3_sha3_x4_inc_finalize(out0, out1, out2, out3, &state);
+}
+
+void SHA3_sha3_224_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    sha3_x4_oneshot(out0, out1, out2, out3, in0, in1, in2, in3, inplen, SHA3_sha3_224_x4_inc_init);
+}
+
+void SHA3_sha3_256_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    sha3_x4_oneshot(out0, out1, out2, out3, in0, in1, in2, in3, inplen, SHA3_sha3_256_x4_inc_init);
+}
+
+void SHA3_sha3_384_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    sha3_x4_oneshot(out0, out1, out2, out3, in0, in1, in2, in3, inplen, SHA3_sha3_384_x4_inc_init);
+}
+
+void SHA3_sha3_512_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    sha3_x4_oneshot(out0, out1, out2, out3, in0, in1, in2, in3, inplen, SHA3_sha3_512_x4_inc_init);
+}
+
+static void shake_x4_oneshot(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen,
+                             const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen,
+                             void (*init)(SHA3_ctx_x4 *)) {
+    SHA3_ctx_x4 state;
+    init(&state);
+    SHA3_x4_inc_absorb(&state, in0, in1, in2, in3, inplen);
+    SHA3_shake_x4_inc_finalize(&state);
+    SHA3_shake_x4_inc_squeeze(out0, out1, out2, out3, outlen, &state);
+    SHA3_x4_inc_ctx_release(&state);
+}
+
+void SHA3_shake128_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    shake_x4_oneshot(out0, out1, out2, out3, outlen, in0, in1, in2, in3, inplen, SHA3_shake128_x4_inc_init);
+}
+
+void SHA3_shake256_x4(u8 *out0, u8 *out1, u8 *out2, u8 *out3, size_t outlen,
+                      const u8 *in0, const u8 *in1, const u8 *in2, const u8 *in3, size_t inplen) {
+    shake_x4_oneshot(out0, out1, out2, out3, outlen, in0, in1, in2, in3, inplen, SHA3_shake256_x4_inc_init);
+}